@@ -50,6 +50,9 @@ WebAssembly.instantiateStreaming(wasm_promise, {
     updateCompile: timeReportUpdateCompile,
     updateRunTest: timeReportUpdateRunTest,
   },
+  mem_report: {
+    updateCompile: memReportUpdateCompile,
+  },
 }).then(function(obj) {
   setConnectionStatus("Connecting to WebSocket...", true);
   connectWebSocket();
@@ -137,6 +140,7 @@ function hello(
   }
 
   if (time_report) timeReportReset(steps_len);
+  memReportReset();
   fuzzReset();
 }
 
@@ -169,9 +173,9 @@ function updateBuildStatus(s) {
     domButtonRebuild.disabled = false;
   }
   if (reset_time_reports) {
-    // Grey out and collapse all the time reports
-    for (const time_report_host of domTimeReportList.children) {
-      const details = time_report_host.shadowRoot.querySelector(":host > details");
+    // Grey out and collapse all the time and memory reports
+    for (const report_host of [...domTimeReportList.children, ...domMemReportList.children]) {
+      const details = report_host.shadowRoot.querySelector(":host > details");
       details.classList.add("pending");
       details.open = false;
     }
@@ -236,11 +240,14 @@ function timeReportUpdateCompile(
   file_table_html_len,
   decl_table_html_ptr,
   decl_table_html_len,
+  fn_table_html_ptr,
+  fn_table_html_len,
   use_llvm,
 ) {
   const inner_html = decodeString(inner_html_ptr, inner_html_len);
   const file_table_html = decodeString(file_table_html_ptr, file_table_html_len);
   const decl_table_html = decodeString(decl_table_html_ptr, decl_table_html_len);
+  const fn_table_html = decodeString(fn_table_html_ptr, fn_table_html_len);
 
   const host = domTimeReportList.children.item(step_idx);
   const shadow = host.shadowRoot;
@@ -255,6 +262,7 @@ function timeReportUpdateCompile(
   host.innerHTML = inner_html;
   shadow.getElementById("fileTableBody").innerHTML = file_table_html;
   shadow.getElementById("declTableBody").innerHTML = decl_table_html;
+  shadow.getElementById("fnTableBody").innerHTML = fn_table_html;
 }
 function timeReportUpdateGeneric(
   step_idx,
@@ -288,6 +296,52 @@ function timeReportUpdateRunTest(
   shadow.getElementById("runTestTableBody").innerHTML = table_html;
 }
 
+const mem_report_entry_template = document.getElementById("memReportEntryTemplate").content;
+const domMemReport = document.getElementById("memReport");
+const domMemReportList = document.getElementById("memReportList");
+// Only steps which send a memory report get an entry, so they are keyed by step index.
+let domMemReportEntries = new Map();
+function memReportReset() {
+  domMemReportEntries = new Map();
+  domMemReportList.replaceChildren();
+  domMemReport.classList.add("hidden");
+}
+function memReportUpdateCompile(
+  step_idx,
+  inner_html_ptr,
+  inner_html_len,
+  file_table_html_ptr,
+  file_table_html_len,
+  decl_table_html_ptr,
+  decl_table_html_len,
+  tag_table_html_ptr,
+  tag_table_html_len,
+  separate_codegen,
+) {
+  const inner_html = decodeString(inner_html_ptr, inner_html_len);
+  const file_table_html = decodeString(file_table_html_ptr, file_table_html_len);
+  const decl_table_html = decodeString(decl_table_html_ptr, decl_table_html_len);
+  const tag_table_html = decodeString(tag_table_html_ptr, tag_table_html_len);
+
+  let host = domMemReportEntries.get(step_idx);
+  if (host === undefined) {
+    host = document.createElement("div");
+    const shadow = host.attachShadow({ mode: "open" });
+    shadow.appendChild(mem_report_entry_template.cloneNode(true));
+    domMemReportEntries.set(step_idx, host);
+    domMemReportList.appendChild(host);
+    domMemReport.classList.remove("hidden");
+  }
+  const shadow = host.shadowRoot;
+
+  shadow.querySelector(":host > details").classList.remove("pending", "no-separate-codegen");
+  if (!separate_codegen) shadow.querySelector(":host > details").classList.add("no-separate-codegen");
+  host.innerHTML = inner_html;
+  shadow.getElementById("fileTableBody").innerHTML = file_table_html;
+  shadow.getElementById("declTableBody").innerHTML = decl_table_html;
+  shadow.getElementById("tagTableBody").innerHTML = tag_table_html;
+}
+
 const fuzz_entry_template = document.getElementById("fuzzEntryTemplate").content;
 const domFuzz = document.getElementById("fuzz");
 const domFuzzStatus = document.getElementById("fuzzStatus");
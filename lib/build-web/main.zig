@@ -6,6 +6,7 @@ const log = std.log;
 const Allocator = std.mem.Allocator;
 
 const fuzz = @import("fuzz.zig");
+const mem_report = @import("mem_report.zig");
 const time_report = @import("time_report.zig");
 
 /// Nanoseconds.
@@ -95,6 +96,8 @@ export fn message_end() void {
         .time_report_generic_result => return time_report.genericResultMessage(msg_bytes) catch @panic("OOM"),
         .time_report_compile_result => return time_report.compileResultMessage(msg_bytes) catch @panic("OOM"),
         .time_report_run_test_result => return time_report.runTestResultMessage(msg_bytes) catch @panic("OOM"),
+
+        .mem_report_compile_result => return mem_report.compileResultMessage(msg_bytes) catch @panic("OOM"),
     }
 }
 
@@ -0,0 +1,251 @@
+const std = @import("std");
+const gpa = std.heap.wasm_allocator;
+const abi = std.Build.abi.mem_report;
+const fmtEscapeHtml = @import("root").fmtEscapeHtml;
+const step_list = &@import("root").step_list;
+
+const js = struct {
+    extern "mem_report" fn updateCompile(
+        /// The index of the step.
+        step_idx: u32,
+        // The HTML which will be used to populate the template slots.
+        inner_html_ptr: [*]const u8,
+        inner_html_len: usize,
+        // The HTML which will populate the <tbody> of the file table.
+        file_table_html_ptr: [*]const u8,
+        file_table_html_len: usize,
+        // The HTML which will populate the <tbody> of the decl table.
+        decl_table_html_ptr: [*]const u8,
+        decl_table_html_len: usize,
+        // The HTML which will populate the <tbody> of the InternPool tag table.
+        tag_table_html_ptr: [*]const u8,
+        tag_table_html_len: usize,
+        /// Whether code generation ran separately from linking. If not, the AIR peak is hidden.
+        separate_codegen: bool,
+    ) void;
+};
+
+pub fn compileResultMessage(msg_bytes: []u8) error{ OutOfMemory, WriteFailed }!void {
+    const max_table_rows = 500;
+
+    if (msg_bytes.len < @sizeOf(abi.CompileResult)) @panic("malformed CompileResult message");
+    const hdr: *const abi.CompileResult = @ptrCast(msg_bytes[0..@sizeOf(abi.CompileResult)]);
+    if (hdr.step_idx >= step_list.*.len) @panic("malformed CompileResult message");
+    var trailing = msg_bytes[@sizeOf(abi.CompileResult)..];
+
+    const FileMemReport = struct {
+        name: []const u8,
+        ip_bytes: u64,
+        air_bytes: u64,
+        link_bytes: u64,
+    };
+    const DeclMemReport = struct {
+        file_name: []const u8,
+        name: []const u8,
+        sema_count: u32,
+        max_air_bytes: u32,
+        ip_bytes: u64,
+        air_bytes: u64,
+        link_bytes: u64,
+    };
+    const TagMemReport = struct {
+        name: []const u8,
+        count: u32,
+        bytes: u64,
+    };
+
+    const largest_files = try gpa.alloc(FileMemReport, hdr.files_len);
+    defer gpa.free(largest_files);
+
+    const largest_tags = try gpa.alloc(TagMemReport, hdr.tags_len);
+    defer gpa.free(largest_tags);
+
+    const largest_decls = try gpa.alloc(DeclMemReport, hdr.decls_len);
+    defer gpa.free(largest_decls);
+
+    for (largest_files) |*file_out| {
+        const i = std.mem.indexOfScalar(u8, trailing, 0) orelse @panic("malformed CompileResult message");
+        file_out.* = .{
+            .name = trailing[0..i],
+            .ip_bytes = 0,
+            .air_bytes = 0,
+            .link_bytes = 0,
+        };
+        trailing = trailing[i + 1 ..];
+    }
+
+    for (largest_tags) |*tag_out| {
+        const i = std.mem.indexOfScalar(u8, trailing, 0) orelse @panic("malformed CompileResult message");
+        tag_out.* = .{
+            .name = trailing[0..i],
+            .count = std.mem.readInt(u32, trailing[i..][1..5], .little),
+            .bytes = std.mem.readInt(u64, trailing[i..][5..13], .little),
+        };
+        trailing = trailing[i + 13 ..];
+    }
+
+    for (largest_decls) |*decl_out| {
+        const i = std.mem.indexOfScalar(u8, trailing, 0) orelse @panic("malformed CompileResult message");
+        const file_idx = std.mem.readInt(u32, trailing[i..][1..5], .little);
+        const ip_bytes = std.mem.readInt(u64, trailing[i..][13..21], .little);
+        const air_bytes = std.mem.readInt(u64, trailing[i..][21..29], .little);
+        const link_bytes = std.mem.readInt(u64, trailing[i..][29..37], .little);
+        const file = &largest_files[file_idx];
+        decl_out.* = .{
+            .file_name = file.name,
+            .name = trailing[0..i],
+            .sema_count = std.mem.readInt(u32, trailing[i..][5..9], .little),
+            .max_air_bytes = std.mem.readInt(u32, trailing[i..][9..13], .little),
+            .ip_bytes = ip_bytes,
+            .air_bytes = air_bytes,
+            .link_bytes = link_bytes,
+        };
+        trailing = trailing[i + 37 ..];
+        file.ip_bytes += ip_bytes;
+        file.air_bytes += air_bytes;
+        file.link_bytes += link_bytes;
+    }
+
+    const S = struct {
+        fn fileLessThan(_: void, lhs: FileMemReport, rhs: FileMemReport) bool {
+            const lhs_bytes = lhs.ip_bytes + lhs.air_bytes + lhs.link_bytes;
+            const rhs_bytes = rhs.ip_bytes + rhs.air_bytes + rhs.link_bytes;
+            return lhs_bytes > rhs_bytes; // flipped to sort in reverse order
+        }
+        fn declLessThan(_: void, lhs: DeclMemReport, rhs: DeclMemReport) bool {
+            const lhs_bytes = lhs.ip_bytes + lhs.air_bytes + lhs.link_bytes;
+            const rhs_bytes = rhs.ip_bytes + rhs.air_bytes + rhs.link_bytes;
+            return lhs_bytes > rhs_bytes; // flipped to sort in reverse order
+        }
+        fn tagLessThan(_: void, lhs: TagMemReport, rhs: TagMemReport) bool {
+            return lhs.bytes > rhs.bytes; // flipped to sort in reverse order
+        }
+    };
+    std.mem.sort(FileMemReport, largest_files, {}, S.fileLessThan);
+    std.mem.sort(DeclMemReport, largest_decls, {}, S.declLessThan);
+    std.mem.sort(TagMemReport, largest_tags, {}, S.tagLessThan);
+
+    const stats = hdr.stats;
+    const inner_html = try std.fmt.allocPrint(gpa,
+        \\<code slot="step-name">{[step_name]f}</code>
+        \\<span slot="stat-intern-pool">{[stat_intern_pool]Bi:.1}</span>
+        \\<span slot="stat-air-peak">{[stat_air_peak]Bi:.1}</span>
+        \\<span slot="stat-linked">{[stat_linked]Bi:.1}</span>
+        \\<span slot="stat-dep-entries">{[stat_dep_entries]d} ({[stat_free_dep_entries]d} free)</span>
+        \\<span slot="stat-removed-items">{[stat_removed_items]d}</span>
+        \\<span slot="stat-dependency-gc">{[stat_dependency_gc]f}</span>
+        \\
+    , .{
+        .step_name = fmtEscapeHtml(step_list.*[hdr.step_idx].name),
+        .stat_intern_pool = stats.ip_bytes,
+        .stat_air_peak = stats.air_peak_bytes,
+        .stat_linked = stats.link_bytes,
+        .stat_dep_entries = stats.dep_entries,
+        .stat_free_dep_entries = stats.free_dep_entries,
+        .stat_removed_items = stats.removed_items,
+        .stat_dependency_gc = fmtDependencyGc(stats),
+    });
+    defer gpa.free(inner_html);
+
+    var file_table_html: std.Io.Writer.Allocating = .init(gpa);
+    defer file_table_html.deinit();
+
+    for (largest_files[0..@min(max_table_rows, largest_files.len)]) |file| {
+        try file_table_html.writer.print(
+            \\<tr>
+            \\  <th scope="row"><code>{f}</code></th>
+            \\  <td>{Bi:.1}</td>
+            \\  <td>{Bi:.1}</td>
+            \\  <td>{Bi:.1}</td>
+            \\</tr>
+            \\
+        , .{
+            fmtEscapeHtml(file.name),
+            file.ip_bytes,
+            file.air_bytes,
+            file.link_bytes,
+        });
+    }
+    if (largest_files.len > max_table_rows) {
+        try file_table_html.writer.print(
+            \\<tr><td colspan="4">{d} more rows omitted</td></tr>
+            \\
+        , .{largest_files.len - max_table_rows});
+    }
+
+    var decl_table_html: std.Io.Writer.Allocating = .init(gpa);
+    defer decl_table_html.deinit();
+
+    for (largest_decls[0..@min(max_table_rows, largest_decls.len)]) |decl| {
+        try decl_table_html.writer.print(
+            \\<tr>
+            \\  <th scope="row"><code>{f}</code></th>
+            \\  <th scope="row"><code>{f}</code></th>
+            \\  <td>{d}</td>
+            \\  <td>{Bi:.1}</td>
+            \\  <td>{Bi:.1}</td>
+            \\  <td>{Bi:.1}</td>
+            \\  <td>{Bi:.1}</td>
+            \\</tr>
+            \\
+        , .{
+            fmtEscapeHtml(decl.file_name),
+            fmtEscapeHtml(decl.name),
+            decl.sema_count,
+            decl.ip_bytes,
+            decl.air_bytes,
+            decl.max_air_bytes,
+            decl.link_bytes,
+        });
+    }
+    if (largest_decls.len > max_table_rows) {
+        try decl_table_html.writer.print(
+            \\<tr><td colspan="7">{d} more rows omitted</td></tr>
+            \\
+        , .{largest_decls.len - max_table_rows});
+    }
+
+    var tag_table_html: std.Io.Writer.Allocating = .init(gpa);
+    defer tag_table_html.deinit();
+
+    for (largest_tags) |tag| {
+        try tag_table_html.writer.print(
+            \\<tr>
+            \\  <th scope="row"><code>{f}</code></th>
+            \\  <td>{d}</td>
+            \\  <td>{Bi:.1}</td>
+            \\</tr>
+            \\
+        , .{
+            fmtEscapeHtml(tag.name),
+            tag.count,
+            tag.bytes,
+        });
+    }
+
+    js.updateCompile(
+        hdr.step_idx,
+        inner_html.ptr,
+        inner_html.len,
+        file_table_html.written().ptr,
+        file_table_html.written().len,
+        decl_table_html.written().ptr,
+        decl_table_html.written().len,
+        tag_table_html.written().ptr,
+        tag_table_html.written().len,
+        stats.flags.separate_codegen,
+    );
+}
+
+fn fmtDependencyGc(stats: abi.CompileResult.Stats) std.fmt.Alt(abi.CompileResult.Stats, formatDependencyGc) {
+    return .{ .data = stats };
+}
+fn formatDependencyGc(stats: abi.CompileResult.Stats, w: *std.Io.Writer) std.Io.Writer.Error!void {
+    if (!stats.flags.dependency_gc) return w.writeAll("not run");
+    try w.print("reclaimed {d} entries and {d} dependees, {Bi:.1} &rarr; {Bi:.1}", .{
+        stats.dependency_gc_entries_reclaimed,
+        stats.dependency_gc_dependees_removed,
+        stats.dependency_gc_bytes_before,
+        stats.dependency_gc_bytes_after,
+    });
+}
@@ -24,6 +24,9 @@ const js = struct {
         // The HTML which will populate the <tbody> of the decl table.
         decl_table_html_ptr: [*]const u8,
         decl_table_html_len: usize,
+        // The HTML which will populate the <tbody> of the function call table.
+        fn_table_html_ptr: [*]const u8,
+        fn_table_html_len: usize,
         /// Whether the LLVM backend was used. If not, LLVM-specific statistics are hidden.
         use_llvm: bool,
     ) void;
@@ -76,6 +79,16 @@ pub fn compileResultMessage(msg_bytes: []u8) error{ OutOfMemory, WriteFailed }!v
         ns_codegen: u64,
         ns_link: u64,
     };
+    const FnCallReport = struct {
+        file_name: []const u8,
+        name: []const u8,
+        comptime_count: u32,
+        comptime_memoized_count: u32,
+        generic_count: u32,
+        generic_instances: u32,
+        comptime_branches: u64,
+        ns_comptime: u64,
+    };
 
     const slowest_files = try gpa.alloc(FileTimeReport, hdr.files_len);
     defer gpa.free(slowest_files);
@@ -83,6 +96,9 @@ pub fn compileResultMessage(msg_bytes: []u8) error{ OutOfMemory, WriteFailed }!v
     const slowest_decls = try gpa.alloc(DeclTimeReport, hdr.decls_len);
     defer gpa.free(slowest_decls);
 
+    const slowest_fns = try gpa.alloc(FnCallReport, hdr.fns_len);
+    defer gpa.free(slowest_fns);
+
     for (slowest_files) |*file_out| {
         const i = std.mem.indexOfScalar(u8, trailing, 0) orelse @panic("malformed CompileResult message");
         file_out.* = .{
@@ -116,6 +132,22 @@ pub fn compileResultMessage(msg_bytes: []u8) error{ OutOfMemory, WriteFailed }!v
         file.ns_link += link_ns;
     }
 
+    for (slowest_fns) |*fn_out| {
+        const i = std.mem.indexOfScalar(u8, trailing, 0) orelse @panic("malformed CompileResult message");
+        const file_idx = std.mem.readInt(u32, trailing[i..][1..5], .little);
+        fn_out.* = .{
+            .file_name = slowest_files[file_idx].name,
+            .name = trailing[0..i],
+            .comptime_count = std.mem.readInt(u32, trailing[i..][5..9], .little),
+            .comptime_memoized_count = std.mem.readInt(u32, trailing[i..][9..13], .little),
+            .generic_count = std.mem.readInt(u32, trailing[i..][13..17], .little),
+            .generic_instances = std.mem.readInt(u32, trailing[i..][17..21], .little),
+            .comptime_branches = std.mem.readInt(u64, trailing[i..][21..29], .little),
+            .ns_comptime = std.mem.readInt(u64, trailing[i..][29..37], .little),
+        };
+        trailing = trailing[i + 37 ..];
+    }
+
     const S = struct {
         fn fileLessThan(_: void, lhs: FileTimeReport, rhs: FileTimeReport) bool {
             const lhs_ns = lhs.ns_sema + lhs.ns_codegen + lhs.ns_link;
@@ -128,9 +160,14 @@ pub fn compileResultMessage(msg_bytes: []u8) error{ OutOfMemory, WriteFailed }!v
             const rhs_ns = rhs.ns_sema + rhs.ns_codegen + rhs.ns_link;
             return lhs_ns > rhs_ns; // flipped to sort in reverse order
         }
+        fn fnLessThan(_: void, lhs: FnCallReport, rhs: FnCallReport) bool {
+            if (lhs.ns_comptime != rhs.ns_comptime) return lhs.ns_comptime > rhs.ns_comptime;
+            return lhs.generic_count > rhs.generic_count;
+        }
     };
     std.mem.sort(FileTimeReport, slowest_files, {}, S.fileLessThan);
     std.mem.sort(DeclTimeReport, slowest_decls, {}, S.declLessThan);
+    std.mem.sort(FnCallReport, slowest_fns, {}, S.fnLessThan);
 
     const stats = hdr.stats;
     const inner_html = try std.fmt.allocPrint(gpa,
@@ -233,6 +270,40 @@ pub fn compileResultMessage(msg_bytes: []u8) error{ OutOfMemory, WriteFailed }!v
         , .{slowest_decls.len - max_table_rows});
     }
 
+    var fn_table_html: std.Io.Writer.Allocating = .init(gpa);
+    defer fn_table_html.deinit();
+
+    for (slowest_fns[0..@min(max_table_rows, slowest_fns.len)]) |f| {
+        try fn_table_html.writer.print(
+            \\<tr>
+            \\  <th scope="row"><code>{f}</code></th>
+            \\  <th scope="row"><code>{f}</code></th>
+            \\  <td>{d}</td>
+            \\  <td>{d}</td>
+            \\  <td>{d}</td>
+            \\  <td>{D}</td>
+            \\  <td>{d}</td>
+            \\  <td>{d}</td>
+            \\</tr>
+            \\
+        , .{
+            fmtEscapeHtml(f.file_name),
+            fmtEscapeHtml(f.name),
+            f.comptime_count,
+            f.comptime_memoized_count,
+            f.comptime_branches,
+            f.ns_comptime,
+            f.generic_count,
+            f.generic_instances,
+        });
+    }
+    if (slowest_fns.len > max_table_rows) {
+        try fn_table_html.writer.print(
+            \\<tr><td colspan="8">{d} more rows omitted</td></tr>
+            \\
+        , .{slowest_fns.len - max_table_rows});
+    }
+
     js.updateCompile(
         hdr.step_idx,
         inner_html.ptr,
@@ -241,6 +312,8 @@ pub fn compileResultMessage(msg_bytes: []u8) error{ OutOfMemory, WriteFailed }!v
         file_table_html.written().len,
         decl_table_html.written().ptr,
         decl_table_html.written().len,
+        fn_table_html.written().ptr,
+        fn_table_html.written().len,
         hdr.flags.use_llvm,
     );
 }
@@ -3,6 +3,7 @@ pub const Compilation = @import("aro/Compilation.zig");
 pub const Diagnostics = @import("aro/Diagnostics.zig");
 pub const Driver = @import("aro/Driver.zig");
 pub const Parser = @import("aro/Parser.zig");
+pub const Pch = @import("aro/Pch.zig");
 pub const Preprocessor = @import("aro/Preprocessor.zig");
 pub const Source = @import("aro/Source.zig");
 pub const StringInterner = @import("aro/StringInterner.zig");
@@ -34,6 +35,7 @@ test {
     _ = @import("aro/Driver/GCCVersion.zig");
     _ = @import("aro/InitList.zig");
     _ = @import("aro/LangOpts.zig");
+    _ = @import("aro/Pch.zig");
     _ = @import("aro/Preprocessor.zig");
     _ = @import("aro/Target.zig");
     _ = @import("aro/Tokenizer.zig");
@@ -13,6 +13,7 @@ const Builtins = @import("Builtins.zig");
 const Diagnostics = @import("Diagnostics.zig");
 const DepFile = @import("DepFile.zig");
 const LangOpts = @import("LangOpts.zig");
+const Pch = @import("Pch.zig");
 const Pragma = @import("Pragma.zig");
 const record_layout = @import("record_layout.zig");
 const Source = @import("Source.zig");
@@ -180,6 +181,9 @@ pragma_handlers: std.StringArrayHashMapUnmanaged(*Pragma) = .empty,
 /// If this is not null, the directory containing the specified Source will be searched for includes
 /// Used by MS extensions which allow searching for includes relative to the directory of the main source file.
 ms_cwd_source_id: ?Source.Id = null,
+/// The contents of the precompiled header loaded by `Pch.load`, if any. Sources and strings
+/// loaded from it point into this memory, which is released by `deinit`.
+pch_bytes: []align(std.heap.page_size_min) const u8 = &.{},
 
 pub fn init(gpa: Allocator, arena: Allocator, io: Io, diagnostics: *Diagnostics, cwd: std.fs.Dir) Compilation {
     return .{
@@ -214,6 +218,7 @@ pub fn deinit(comp: *Compilation) void {
         pragma.deinit(pragma, comp);
     }
     for (comp.sources.values()) |source| {
+        if (Pch.owns(comp, source.path)) continue;
         gpa.free(source.path);
         gpa.free(source.buf);
         gpa.free(source.splice_locs);
@@ -229,6 +234,7 @@ pub fn deinit(comp: *Compilation) void {
     comp.interner.deinit(gpa);
     comp.environment.deinit(gpa);
     comp.type_store.deinit(gpa);
+    Pch.unmap(comp);
     comp.* = undefined;
 }
 
@@ -11,6 +11,7 @@ const char_info = @import("char_info.zig");
 const Compilation = @import("Compilation.zig");
 const Diagnostics = @import("Diagnostics.zig");
 const InitList = @import("InitList.zig");
+const Pch = @import("Pch.zig");
 const Preprocessor = @import("Preprocessor.zig");
 const record_layout = @import("record_layout.zig");
 const Source = @import("Source.zig");
@@ -780,8 +781,21 @@ fn diagnoseIncompleteDefinitions(p: *Parser) !void {
     }
 }
 
+pub const ParseOptions = struct {
+    /// Continue after the header of this precompiled header rather than starting an empty
+    /// translation unit. Its preprocessor state must have been loaded before preprocessing.
+    pch: ?*Pch = null,
+    /// Write a precompiled header of the translation unit once its last top-level
+    /// declaration has been parsed.
+    emit_pch: ?*std.Io.Writer.Allocating = null,
+};
+
 /// root : (decl | assembly ';' | staticAssert)*
 pub fn parse(pp: *Preprocessor) Compilation.Error!Tree {
+    return parseExtra(pp, .{});
+}
+
+pub fn parseExtra(pp: *Preprocessor, options: ParseOptions) Compilation.Error!Tree {
     const gpa = pp.comp.gpa;
     assert(pp.linemarkers == .none);
     pp.comp.pragmaEvent(.before_parse);
@@ -826,7 +840,11 @@ pub fn parse(pp: *Preprocessor) Compilation.Error!Tree {
     try p.syms.pushScope(&p);
     defer p.syms.popScope();
 
-    {
+    const implicit_typedef_count = if (options.pch) |pch| count: {
+        const count = try pch.restoreParser(&p);
+        p.tree.tokens = p.pp.tokens.slice();
+        break :count count;
+    } else count: {
         if (p.comp.langopts.hasChar8_T()) {
             try p.addImplicitTypedef("char8_t", .uchar);
         }
@@ -847,8 +865,8 @@ pub fn parse(pp: *Preprocessor) Compilation.Error!Tree {
 
         // Set here so that the newly generated tokens are included.
         p.tree.tokens = p.pp.tokens.slice();
-    }
-    const implicit_typedef_count = p.decl_buf.items.len;
+        break :count p.decl_buf.items.len;
+    };
     assert(implicit_typedef_count <= expected_implicit_typedef_max);
 
     while (p.eatToken(.eof) == null) {
@@ -896,6 +914,10 @@ pub fn parse(pp: *Preprocessor) Compilation.Error!Tree {
         try p.err(p.tok_i, .expected_external_decl, .{});
         p.nextExternDecl();
     }
+    if (options.emit_pch) |out| Pch.write(&p, implicit_typedef_count, &out.writer) catch |er| switch (er) {
+        // Only fails when the allocating writer runs out of memory.
+        error.WriteFailed, error.OutOfMemory => return error.OutOfMemory,
+    };
     if (p.tentative_defs.count() > 0) {
         try p.diagnoseIncompleteDefinitions();
     }
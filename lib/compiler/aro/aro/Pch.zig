@@ -0,0 +1,784 @@
+//! A precompiled header holds the state of the preprocessor and parser after a header was
+//! preprocessed and parsed as a translation unit of its own. A translation unit that starts
+//! with the same header loads it with `load` and carries on from there instead of
+//! preprocessing and parsing the header again.
+//!
+//! The file contains the sources that were read, the generated buffer, the string and value
+//! interners, the `TypeStore`, the macro table with include guards and `#pragma once` state,
+//! the token list, and the `Tree` nodes together with the top-level symbols. Every array is
+//! stored in host byte order and layout and aligned to 8 bytes, so the file is memory-mapped
+//! when loaded: source buffers and strings are used in place, and tables that keep growing
+//! during the rest of the translation unit are copied out of the mapping.
+//!
+//! A file is only accepted by the build of Aro that wrote it, which `fingerprint` checks.
+//! Source ids are renumbered on load since the loading `Compilation` already contains the
+//! main source and predefined macros. Open `#pragma GCC diagnostic push` and
+//! `#pragma pack(push)` stacks are not saved.
+
+const std = @import("std");
+const assert = std.debug.assert;
+const mem = std.mem;
+const Allocator = mem.Allocator;
+const native_endian = @import("builtin").cpu.arch.endian();
+const native_os = @import("builtin").os.tag;
+
+const Attribute = @import("Attribute.zig");
+const Compilation = @import("Compilation.zig");
+const Diagnostics = @import("Diagnostics.zig");
+const Driver = @import("Driver.zig");
+const Interner = @import("../backend.zig").Interner;
+const Once = @import("pragmas/once.zig");
+const Parser = @import("Parser.zig");
+const Preprocessor = @import("Preprocessor.zig");
+const Source = @import("Source.zig");
+const SymbolStack = @import("SymbolStack.zig");
+const Tokenizer = @import("Tokenizer.zig");
+const RawToken = Tokenizer.Token;
+const Tree = @import("Tree.zig");
+const Token = Tree.Token;
+const TokenWithExpansionLocs = Tree.TokenWithExpansionLocs;
+const TypeStore = @import("TypeStore.zig");
+const QualType = TypeStore.QualType;
+
+const Pch = @This();
+
+/// Maps the source ids stored in the file to ids in the loading `Compilation`.
+source_ids: []Source.Id,
+/// Index of the first source alias loaded from the file.
+alias_base: u32,
+/// The number of tokens loaded from the file, after which parsing resumes.
+tokens_len: usize,
+/// Positioned at the parser state, which `restoreParser` reads.
+parser_state: Deserializer,
+
+const magic = "aroPCH01".*;
+
+/// Changes whenever the layout of the data stored in a precompiled header may have changed.
+const fingerprint: u64 = blk: {
+    @setEvalBranchQuota(10_000);
+    var hasher: std.hash.Fnv1a_64 = .init();
+    hasher.update(@import("builtin").zig_version_string);
+    hasher.update(@import("../backend.zig").version_str);
+    for ([_]type{
+        RawToken,
+        Token,
+        Source.Location,
+        Tree.Node.Repr,
+        Attribute,
+        SymbolStack.Symbol,
+    }) |T| {
+        hasher.update(@typeName(T));
+        hasher.update(mem.asBytes(&@as(u64, @sizeOf(T))));
+    }
+    for ([_]type{ Token.Id, Tree.Node.Repr.Tag, Attribute.Tag, Interner.Tag }) |T| {
+        hasher.update(mem.asBytes(&@as(u64, @typeInfo(T).@"enum".fields.len)));
+    }
+    break :blk hasher.final();
+};
+
+const Header = extern struct {
+    magic: [8]u8,
+    fingerprint: u64,
+};
+
+/// Source flags stored alongside each source.
+const SourceInfo = extern struct {
+    kind: u8,
+    /// Whether `size` and `mtime` describe a file on disk, as opposed to e.g. `<builtin>`.
+    on_disk: bool,
+    size: u64,
+    mtime: i64,
+};
+
+/// Writes a precompiled header of everything parsed so far. Called by the parser
+/// after the last top-level declaration, before the translation unit is finished.
+pub fn write(p: *const Parser, implicit_typedef_count: usize, w: *std.Io.Writer) (std.Io.Writer.Error || Allocator.Error)!void {
+    const comp = p.comp;
+    const pp = p.pp;
+    var s: Serializer = .{ .w = w, .gpa = comp.gpa };
+
+    try s.value(Header, .{ .magic = magic, .fingerprint = fingerprint });
+
+    try s.int(comp.sources.count());
+    for (comp.sources.values()) |source| {
+        var info: SourceInfo = .{ .kind = @intFromEnum(source.kind), .on_disk = false, .size = 0, .mtime = 0 };
+        if (!isVirtualPath(source.path)) {
+            if (comp.cwd.statFile(source.path)) |stat| {
+                info.on_disk = true;
+                info.size = stat.size;
+                info.mtime = @truncate(stat.mtime.nanoseconds);
+            } else |_| {}
+        }
+        try s.value(SourceInfo, info);
+        try s.slice(u8, source.path);
+        try s.slice(u8, source.buf);
+        try s.slice(u32, source.splice_locs);
+    }
+    try s.int(comp.source_aliases.items.len);
+    for (comp.source_aliases.items) |alias| {
+        try s.int(@intFromEnum(alias.kind));
+        try s.slice(u8, alias.path);
+        try s.slice(u8, alias.buf);
+        try s.slice(u32, alias.splice_locs);
+    }
+    try s.slice(u8, comp.generated_buf.items);
+
+    try s.strings(comp.string_interner.table.keys());
+
+    try s.multiArrayList(&comp.interner.items);
+    try s.slice(u32, comp.interner.extra.items);
+    try s.slice(std.math.big.Limb, comp.interner.limbs.items);
+    try s.slice(u8, comp.interner.strings.items);
+
+    const ts = &comp.type_store;
+    try s.multiArrayList(&ts.types);
+    try s.slice(u32, ts.extra.items);
+    try s.slice(Attribute, ts.attributes.items);
+    inline for (named_types) |name| try s.value(QualType, @field(ts, name));
+
+    try s.int(pp.defines.count());
+    for (pp.defines.keys(), pp.defines.values()) |name, macro| {
+        try s.slice(u8, name);
+        try s.int(@as(u64, @intFromBool(macro.is_func)) |
+            @as(u64, @intFromBool(macro.var_args)) << 1 |
+            @as(u64, @intFromBool(macro.isBuiltin())) << 2);
+        if (macro.isBuiltin()) continue;
+        try s.value(Source.Location, macro.loc);
+        try s.strings(macro.params);
+        try s.slice(RawToken, macro.tokens);
+    }
+    try s.int(pp.include_guards.count());
+    var guard_it = pp.include_guards.iterator();
+    while (guard_it.next()) |entry| {
+        try s.value(Source.Id, entry.key_ptr.*);
+        try s.slice(u8, entry.value_ptr.*);
+    }
+    {
+        const poisoned = try s.gpa.alloc([]const u8, pp.poisoned_identifiers.count());
+        defer s.gpa.free(poisoned);
+        var it = pp.poisoned_identifiers.keyIterator();
+        for (poisoned) |*name| name.* = it.next().?.*;
+        try s.strings(poisoned);
+    }
+    try s.int(pp.counter);
+    try s.int(pp.preprocess_count);
+    if (onceState(comp)) |once| {
+        try s.int(once.preprocess_count);
+        try s.hashMapKeys(&once.pragma_once);
+    } else {
+        try s.int(0);
+        try s.slice(Source.Id, &.{});
+    }
+
+    try s.multiArrayList(&pp.tokens);
+    try s.slice(Tree.TokenIndex, pp.expansion_entries.items(.idx));
+    {
+        var locs: std.ArrayList(Source.Location) = .empty;
+        defer locs.deinit(s.gpa);
+        const lens = try s.gpa.alloc(u32, pp.expansion_entries.len);
+        defer s.gpa.free(lens);
+        for (pp.expansion_entries.items(.locs), lens) |entry_locs, *len| {
+            const slice = (TokenWithExpansionLocs{ .id = .invalid, .loc = .{}, .expansion_locs = entry_locs }).expansionSlice();
+            len.* = @intCast(slice.len);
+            try locs.appendSlice(s.gpa, slice);
+        }
+        try s.slice(u32, lens);
+        try s.slice(Source.Location, locs.items);
+    }
+
+    try s.int(implicit_typedef_count);
+    try s.multiArrayList(&p.tree.nodes);
+    try s.slice(u32, p.tree.extra.items);
+    try s.hashMap(&p.tree.value_map);
+    try s.slice(Tree.Node.Index, p.decl_buf.items);
+    assert(p.syms.active_len == 1);
+    const file_scope = &p.syms.scopes.items[0];
+    try s.hashMap(&file_scope.vars);
+    try s.hashMap(&file_scope.tags);
+    try s.hashMap(&p.tentative_defs);
+    try s.int(if (p.pragma_pack) |pack| pack else std.math.maxInt(u64));
+
+    try s.value([8]u8, magic);
+}
+
+/// Loads the preprocessor state of the precompiled header in `file` into `pp`, which must not
+/// have preprocessed anything yet. The predefined macros of `pp.comp` must match the ones the
+/// precompiled header was written with. Pass the result to `Parser.parseExtra` to resume
+/// parsing after the header, and call `deinit` afterwards; the mapped file itself stays in
+/// use until `Compilation.deinit`.
+pub fn load(pp: *Preprocessor, file: std.fs.File, path: []const u8) Compilation.Error!Pch {
+    const comp = pp.comp;
+    assert(comp.pch_bytes.len == 0); // Only one precompiled header can be loaded.
+    assert(pp.tokens.len == 0 and comp.generated_buf.items.len == 0);
+
+    comp.pch_bytes = map(comp.gpa, file) catch |err|
+        return fatal(comp, "unable to read precompiled header '{s}': {s}", .{ path, Driver.errorDescription(err) });
+
+    var d: Deserializer = .{ .bytes = comp.pch_bytes };
+    const header = d.value(Header) catch return fatal(comp, "'{s}' is not a precompiled header", .{path});
+    if (!mem.eql(u8, &header.magic, &magic) or
+        !mem.eql(u8, comp.pch_bytes[comp.pch_bytes.len - 8 ..], &magic))
+    {
+        return fatal(comp, "'{s}' is not a precompiled header", .{path});
+    }
+    if (header.fingerprint != fingerprint) {
+        return fatal(comp, "precompiled header '{s}' was written by a different build of the compiler", .{path});
+    }
+
+    var pch: Pch = .{ .source_ids = &.{}, .alias_base = 0, .tokens_len = 0, .parser_state = undefined };
+    errdefer pch.deinit(comp.gpa);
+    pch.loadPreprocessor(pp, &d, path) catch |err| switch (err) {
+        error.InvalidPch => return fatal(comp, "precompiled header '{s}' is corrupt", .{path}),
+        else => |e| return e,
+    };
+    if (pp.dep_file) |dep_file| try dep_file.addDependency(comp.gpa, path);
+    pch.parser_state = d;
+    return pch;
+}
+
+pub fn deinit(pch: *Pch, gpa: Allocator) void {
+    gpa.free(pch.source_ids);
+    pch.* = undefined;
+}
+
+fn loadPreprocessor(pch: *Pch, pp: *Preprocessor, d: *Deserializer, path: []const u8) (Compilation.Error || error{InvalidPch})!void {
+    const comp = pp.comp;
+    const gpa = comp.gpa;
+
+    const sources_len = try d.int();
+    pch.source_ids = try gpa.alloc(Source.Id, try d.count(sources_len));
+    try comp.sources.ensureUnusedCapacity(gpa, pch.source_ids.len);
+    for (pch.source_ids) |*id| {
+        const info = try d.value(SourceInfo);
+        const kind = try d.enumValue(Source.Kind, info.kind);
+        const source_path = try d.slice(u8);
+        const buf = try d.slice(u8);
+        const splice_locs = try d.slice(u32);
+        if (comp.sources.get(source_path)) |existing| {
+            if (!mem.eql(u8, existing.buf, buf)) {
+                if (isVirtualPath(source_path)) return fatal(
+                    comp,
+                    "predefined macros in '{s}' differ from those of precompiled header '{s}'",
+                    .{ source_path, path },
+                );
+                return fatal(comp, "'{s}' has changed since precompiled header '{s}' was written", .{ source_path, path });
+            }
+            id.* = existing.id;
+            continue;
+        }
+        if (info.on_disk) {
+            const stat = comp.cwd.statFile(source_path) catch |err| return fatal(
+                comp,
+                "unable to check '{s}' for precompiled header '{s}': {s}",
+                .{ source_path, path, Driver.errorDescription(err) },
+            );
+            if (stat.size != info.size or @as(i64, @truncate(stat.mtime.nanoseconds)) != info.mtime) {
+                return fatal(comp, "'{s}' has changed since precompiled header '{s}' was written", .{ source_path, path });
+            }
+            if (pp.dep_file) |dep_file| try dep_file.addDependency(gpa, source_path);
+        }
+        id.* = .{ .index = @enumFromInt(comp.sources.count()) };
+        comp.sources.putAssumeCapacityNoClobber(source_path, .{
+            .path = source_path,
+            .buf = buf,
+            .id = id.*,
+            .splice_locs = splice_locs,
+            .kind = kind,
+        });
+    }
+
+    pch.alias_base = @intCast(comp.source_aliases.items.len);
+    const aliases_len = try d.count(try d.int());
+    try comp.source_aliases.ensureUnusedCapacity(gpa, aliases_len);
+    for (0..aliases_len) |_| {
+        const kind = try d.enumValue(Source.Kind, try d.int());
+        comp.source_aliases.appendAssumeCapacity(.{
+            .path = try d.slice(u8),
+            .buf = try d.slice(u8),
+            .splice_locs = try d.slice(u32),
+            .id = .{ .index = @enumFromInt(comp.source_aliases.items.len), .alias = true },
+            .kind = kind,
+        });
+    }
+    try comp.generated_buf.appendSlice(gpa, try d.slice(u8));
+
+    {
+        var strings = try d.strings();
+        comp.string_interner.table.clearRetainingCapacity();
+        try comp.string_interner.table.ensureTotalCapacity(gpa, strings.lens.len);
+        while (strings.next()) |str| comp.string_interner.table.putAssumeCapacityNoClobber(str, {});
+    }
+
+    {
+        var interner: Interner = .{};
+        errdefer interner.deinit(gpa);
+        try d.multiArrayList(gpa, &interner.items);
+        try interner.extra.appendSlice(gpa, try d.slice(u32));
+        try interner.limbs.appendSlice(gpa, try d.slice(std.math.big.Limb));
+        try interner.strings.appendSlice(gpa, try d.slice(u8));
+        try interner.rebuildMap(gpa);
+        comp.interner.deinit(gpa);
+        comp.interner = interner;
+    }
+
+    {
+        var ts: TypeStore = .{};
+        errdefer ts.deinit(gpa);
+        try d.multiArrayList(gpa, &ts.types);
+        try ts.extra.appendSlice(gpa, try d.slice(u32));
+        try ts.attributes.appendSlice(gpa, try d.slice(Attribute));
+        inline for (named_types) |name| @field(ts, name) = try d.value(QualType);
+        comp.type_store.deinit(gpa);
+        comp.type_store = ts;
+    }
+
+    {
+        var builtins = pp.defines.move();
+        defer builtins.deinit(gpa);
+        const defines_len = try d.count(try d.int());
+        try pp.defines.ensureTotalCapacity(gpa, defines_len);
+        const arena = pp.arena.allocator();
+        for (0..defines_len) |_| {
+            const name = try d.slice(u8);
+            const flags = try d.int();
+            const macro: Preprocessor.Macro = if (flags & 0b100 != 0)
+                builtins.get(name) orelse return fatal(
+                    comp,
+                    "builtin macro '{s}' of precompiled header '{s}' is not available",
+                    .{ name, path },
+                )
+            else macro: {
+                const loc = try d.value(Source.Location);
+                var strings = try d.strings();
+                const params = try arena.alloc([]const u8, strings.lens.len);
+                for (params) |*param| param.* = strings.next().?;
+                const tokens = try arena.dupe(RawToken, try d.slice(RawToken));
+                for (tokens) |*tok| tok.source = try pch.mapId(comp, tok.source);
+                break :macro .{
+                    .params = params,
+                    .tokens = tokens,
+                    .var_args = flags & 0b10 != 0,
+                    .is_func = flags & 0b1 != 0,
+                    .loc = try pch.mapLoc(comp, loc),
+                };
+            };
+            pp.defines.putAssumeCapacity(name, macro);
+        }
+    }
+    const guards_len = try d.count(try d.int());
+    try pp.include_guards.ensureUnusedCapacity(gpa, @intCast(guards_len));
+    for (0..guards_len) |_| {
+        const id = try pch.mapId(comp, try d.value(Source.Id));
+        pp.include_guards.putAssumeCapacity(id, try d.slice(u8));
+    }
+    {
+        var strings = try d.strings();
+        try pp.poisoned_identifiers.ensureUnusedCapacity(gpa, @intCast(strings.lens.len));
+        while (strings.next()) |name| pp.poisoned_identifiers.putAssumeCapacity(name, {});
+    }
+    pp.counter = @truncate(try d.int());
+    pp.preprocess_count = @truncate(try d.int());
+    const once_preprocess_count: u32 = @truncate(try d.int());
+    const once_ids = try d.slice(Source.Id);
+    if (onceState(comp)) |once| {
+        once.preprocess_count = once_preprocess_count;
+        try once.pragma_once.ensureUnusedCapacity(gpa, @intCast(once_ids.len));
+        for (once_ids) |id| once.pragma_once.putAssumeCapacity(try pch.mapId(comp, id), {});
+    }
+
+    try d.multiArrayList(gpa, &pp.tokens);
+    for (pp.tokens.items(.loc)) |*loc| loc.* = try pch.mapLoc(comp, loc.*);
+    pch.tokens_len = pp.tokens.len;
+    const expansion_idxs = try d.slice(Tree.TokenIndex);
+    const expansion_lens = try d.slice(u32);
+    const expansion_locs = try d.slice(Source.Location);
+    if (expansion_lens.len != expansion_idxs.len) return error.InvalidPch;
+    try pp.expansion_entries.ensureTotalCapacity(gpa, expansion_idxs.len);
+    var locs_i: usize = 0;
+    for (expansion_idxs, expansion_lens) |idx, len| {
+        if (idx >= pp.tokens.len or len > expansion_locs.len - locs_i) return error.InvalidPch;
+        // Allocated the way `TokenWithExpansionLocs.free` expects: terminated by an unused
+        // location, followed by one whose `byte_offset` is 1 to mark the end of the allocation.
+        const locs = try gpa.alloc(Source.Location, len + 1);
+        for (locs[0..len], expansion_locs[locs_i..][0..len]) |*loc, stored| loc.* = try pch.mapLoc(comp, stored);
+        locs[len] = .{ .byte_offset = 1 };
+        locs_i += len;
+        pp.expansion_entries.appendAssumeCapacity(.{ .idx = idx, .locs = locs.ptr });
+    }
+}
+
+/// Restores the tree and file-scope symbols of the precompiled header into `p`, and
+/// positions it after the tokens of the header. Returns the number of implicit typedefs,
+/// which the parser adds at the start of the translation unit.
+pub fn restoreParser(pch: *Pch, p: *Parser) Compilation.Error!usize {
+    return pch.restoreParserInner(p) catch |err| switch (err) {
+        error.InvalidPch => return fatal(p.comp, "precompiled header is corrupt", .{}),
+        error.OutOfMemory => |e| return e,
+    };
+}
+
+fn restoreParserInner(pch: *Pch, p: *Parser) (Allocator.Error || error{InvalidPch})!usize {
+    const gpa = p.comp.gpa;
+    const d = &pch.parser_state;
+    const implicit_typedef_count = try d.count(try d.int());
+    try d.multiArrayList(gpa, &p.tree.nodes);
+    try p.tree.extra.appendSlice(gpa, try d.slice(u32));
+    try d.hashMap(gpa, &p.tree.value_map);
+    try p.decl_buf.appendSlice(gpa, try d.slice(Tree.Node.Index));
+    const file_scope = &p.syms.scopes.items[0];
+    try d.hashMap(gpa, &file_scope.vars);
+    try d.hashMap(gpa, &file_scope.tags);
+    try d.hashMap(gpa, &p.tentative_defs);
+    const pack = try d.int();
+    p.pragma_pack = if (pack == std.math.maxInt(u64)) null else @truncate(pack);
+    if (implicit_typedef_count > p.decl_buf.items.len) return error.InvalidPch;
+
+    // The saved tokens end with the eof of the header followed by the implicit typedef names,
+    // none of which the parser visits again.
+    p.tok_i = @intCast(pch.tokens_len);
+    return implicit_typedef_count;
+}
+
+fn mapId(pch: *const Pch, comp: *const Compilation, id: Source.Id) error{InvalidPch}!Source.Id {
+    switch (id.index) {
+        .unused, .generated => return id,
+        _ => {},
+    }
+    const index = @intFromEnum(id.index);
+    if (id.alias) {
+        if (pch.alias_base + index >= comp.source_aliases.items.len) return error.InvalidPch;
+        return .{ .index = @enumFromInt(pch.alias_base + index), .alias = true };
+    }
+    if (index >= pch.source_ids.len) return error.InvalidPch;
+    return pch.source_ids[index];
+}
+
+fn mapLoc(pch: *const Pch, comp: *const Compilation, loc: Source.Location) error{InvalidPch}!Source.Location {
+    var mapped = loc;
+    mapped.id = try pch.mapId(comp, loc.id);
+    return mapped;
+}
+
+/// Whether `slice` points into a precompiled header loaded into `comp`, so must not be freed.
+pub fn owns(comp: *const Compilation, slice: []const u8) bool {
+    const start = @intFromPtr(comp.pch_bytes.ptr);
+    return @intFromPtr(slice.ptr) >= start and @intFromPtr(slice.ptr) < start + comp.pch_bytes.len;
+}
+
+/// Releases the memory of a precompiled header loaded into `comp`.
+pub fn unmap(comp: *Compilation) void {
+    if (comp.pch_bytes.len == 0) return;
+    switch (native_os) {
+        .windows, .wasi => comp.gpa.free(comp.pch_bytes),
+        else => std.posix.munmap(comp.pch_bytes),
+    }
+    comp.pch_bytes = &.{};
+}
+
+fn map(gpa: Allocator, file: std.fs.File) ![]align(std.heap.page_size_min) const u8 {
+    const size = std.math.cast(usize, try file.getEndPos()) orelse return error.FileTooBig;
+    // Too short to be valid; `load` rejects it without mapping an empty file.
+    if (size < @sizeOf(Header) + magic.len) return error.EndOfStream;
+    switch (native_os) {
+        .windows, .wasi => {
+            const buf = try gpa.alignedAlloc(u8, .fromByteUnits(std.heap.page_size_min), size);
+            errdefer gpa.free(buf);
+            if (try file.preadAll(buf, 0) != size) return error.EndOfStream;
+            return buf;
+        },
+        // Read-only and private: the file may be replaced or shared with other processes,
+        // and nothing loaded from it is modified in place.
+        else => return std.posix.mmap(null, size, std.posix.PROT.READ, .{ .TYPE = .PRIVATE }, file.handle, 0),
+    }
+}
+
+fn fatal(comp: *Compilation, comptime fmt: []const u8, args: anytype) Compilation.Error {
+    var sf = std.heap.stackFallback(1024, comp.gpa);
+    var allocating: std.Io.Writer.Allocating = .init(sf.get());
+    defer allocating.deinit();
+
+    Diagnostics.formatArgs(&allocating.writer, fmt, args) catch return error.OutOfMemory;
+    try comp.diagnostics.add(.{ .kind = .@"fatal error", .text = allocating.written(), .location = null });
+    unreachable;
+}
+
+/// `<builtin>`, `<command line>` and the like are not files.
+fn isVirtualPath(path: []const u8) bool {
+    return path.len > 0 and path[0] == '<';
+}
+
+fn onceState(comp: *Compilation) ?*Once {
+    const pragma = comp.getPragma("once") orelse return null;
+    return @fieldParentPtr("pragma", pragma);
+}
+
+/// Fields of `TypeStore` caching commonly used types.
+const named_types = blk: {
+    var names: []const []const u8 = &.{};
+    for (@typeInfo(TypeStore).@"struct".fields) |field| {
+        if (field.type == QualType) names = names ++ .{field.name};
+    }
+    break :blk names;
+};
+
+/// Asserts that `T` holds no pointers, so that its bytes can be written as they are.
+fn assertFlat(comptime T: type) void {
+    switch (@typeInfo(T)) {
+        .int, .float, .bool, .@"enum", .void => {},
+        .array => |info| assertFlat(info.child),
+        .optional => |info| assertFlat(info.child),
+        .@"struct" => |info| for (info.fields) |field| assertFlat(field.type),
+        .@"union" => |info| for (info.fields) |field| assertFlat(field.type),
+        else => @compileError(@typeName(T) ++ " cannot be stored in a precompiled header"),
+    }
+}
+
+const Serializer = struct {
+    w: *std.Io.Writer,
+    gpa: Allocator,
+    pos: u64 = 0,
+
+    fn int(s: *Serializer, value_: u64) !void {
+        try s.w.writeInt(u64, value_, native_endian);
+        s.pos += 8;
+    }
+
+    fn value(s: *Serializer, comptime T: type, value_: T) !void {
+        try s.raw(T, &.{value_});
+    }
+
+    fn slice(s: *Serializer, comptime T: type, items: []const T) !void {
+        try s.int(items.len);
+        try s.raw(T, items);
+    }
+
+    fn raw(s: *Serializer, comptime T: type, items: []const T) !void {
+        comptime assertFlat(T);
+        comptime assert(@alignOf(T) <= 8);
+        const bytes: []const u8 = @ptrCast(items);
+        try s.w.writeAll(bytes);
+        s.pos += bytes.len;
+        const aligned = mem.alignForward(u64, s.pos, 8);
+        try s.w.splatByteAll(0, @intCast(aligned - s.pos));
+        s.pos = aligned;
+    }
+
+    /// Stored as the lengths followed by the concatenated bytes.
+    fn strings(s: *Serializer, list: []const []const u8) !void {
+        const lens = try s.gpa.alloc(u32, list.len);
+        defer s.gpa.free(lens);
+        var total: u64 = 0;
+        for (lens, list) |*len, str| {
+            len.* = @intCast(str.len);
+            total += str.len;
+        }
+        try s.slice(u32, lens);
+        try s.int(total);
+        for (list) |str| try s.w.writeAll(str);
+        s.pos += total;
+        const aligned = mem.alignForward(u64, s.pos, 8);
+        try s.w.splatByteAll(0, @intCast(aligned - s.pos));
+        s.pos = aligned;
+    }
+
+    fn multiArrayList(s: *Serializer, list: anytype) !void {
+        const columns = list.slice();
+        inline for (comptime std.enums.values(@TypeOf(list.*).Field)) |field| {
+            const column = columns.items(field);
+            try s.slice(@typeInfo(@TypeOf(column)).pointer.child, column);
+        }
+    }
+
+    fn hashMapKeys(s: *Serializer, map_: anytype) !void {
+        const K = @FieldType(@TypeOf(map_.*).KV, "key");
+        const keys = try s.gpa.alloc(K, map_.count());
+        defer s.gpa.free(keys);
+        var it = map_.keyIterator();
+        for (keys) |*key| key.* = it.next().?.*;
+        try s.slice(K, keys);
+    }
+
+    fn hashMap(s: *Serializer, map_: anytype) !void {
+        const KV = @TypeOf(map_.*).KV;
+        const K = @FieldType(KV, "key");
+        const V = @FieldType(KV, "value");
+        const keys = try s.gpa.alloc(K, map_.count());
+        defer s.gpa.free(keys);
+        const values = try s.gpa.alloc(V, map_.count());
+        defer s.gpa.free(values);
+        var it = map_.iterator();
+        for (keys, values) |*key, *val| {
+            const entry = it.next().?;
+            key.* = entry.key_ptr.*;
+            val.* = entry.value_ptr.*;
+        }
+        try s.slice(K, keys);
+        try s.slice(V, values);
+    }
+};
+
+const Deserializer = struct {
+    bytes: []align(8) const u8,
+    pos: usize = 0,
+
+    fn int(d: *Deserializer) error{InvalidPch}!u64 {
+        if (d.bytes.len - d.pos < 8) return error.InvalidPch;
+        defer d.pos += 8;
+        return mem.readInt(u64, d.bytes[d.pos..][0..8], native_endian);
+    }
+
+    /// Checks a stored element count against the size of the file, so that a corrupt count
+    /// fails cleanly rather than as an enormous allocation.
+    fn count(d: *const Deserializer, n: u64) error{InvalidPch}!usize {
+        if (n > d.bytes.len - d.pos) return error.InvalidPch;
+        return @intCast(n);
+    }
+
+    fn value(d: *Deserializer, comptime T: type) error{InvalidPch}!T {
+        return (try d.raw(T, 1))[0];
+    }
+
+    fn enumValue(d: *const Deserializer, comptime E: type, int_: u64) error{InvalidPch}!E {
+        _ = d;
+        return std.enums.fromInt(E, int_) orelse error.InvalidPch;
+    }
+
+    fn slice(d: *Deserializer, comptime T: type) error{InvalidPch}![]const T {
+        return d.raw(T, try d.int());
+    }
+
+    fn raw(d: *Deserializer, comptime T: type, len: u64) error{InvalidPch}![]const T {
+        comptime assertFlat(T);
+        comptime assert(@alignOf(T) <= 8);
+        const size = std.math.mul(u64, len, @sizeOf(T)) catch return error.InvalidPch;
+        if (size > d.bytes.len - d.pos) return error.InvalidPch;
+        const bytes: []align(8) const u8 = @alignCast(d.bytes[d.pos..][0..@intCast(size)]);
+        d.pos = @min(d.bytes.len, mem.alignForward(usize, d.pos + bytes.len, 8));
+        return mem.bytesAsSlice(T, bytes);
+    }
+
+    const Strings = struct {
+        lens: []const u32,
+        bytes: []const u8,
+        index: usize = 0,
+        offset: usize = 0,
+
+        fn next(it: *Strings) ?[]const u8 {
+            if (it.index == it.lens.len) return null;
+            defer it.index += 1;
+            defer it.offset += it.lens[it.index];
+            return it.bytes[it.offset..][0..it.lens[it.index]];
+        }
+    };
+
+    fn strings(d: *Deserializer) error{InvalidPch}!Strings {
+        const lens = try d.slice(u32);
+        const bytes = try d.slice(u8);
+        var total: u64 = 0;
+        for (lens) |len| total += len;
+        if (total != bytes.len) return error.InvalidPch;
+        return .{ .lens = lens, .bytes = bytes };
+    }
+
+    /// Fills the empty `list`.
+    fn multiArrayList(d: *Deserializer, gpa: Allocator, list: anytype) (Allocator.Error || error{InvalidPch})!void {
+        assert(list.len == 0);
+        inline for (comptime std.enums.values(@TypeOf(list.*).Field), 0..) |field, i| {
+            const column = try d.slice(@typeInfo(@TypeOf(list.items(field))).pointer.child);
+            if (i == 0) {
+                try list.setCapacity(gpa, column.len);
+                list.len = column.len;
+            } else if (column.len != list.len) return error.InvalidPch;
+            @memcpy(list.items(field), column);
+        }
+    }
+
+    fn hashMap(d: *Deserializer, gpa: Allocator, map_: anytype) (Allocator.Error || error{InvalidPch})!void {
+        const KV = @TypeOf(map_.*).KV;
+        const keys = try d.slice(@FieldType(KV, "key"));
+        const values = try d.slice(@FieldType(KV, "value"));
+        if (keys.len != values.len) return error.InvalidPch;
+        try map_.ensureUnusedCapacity(gpa, @intCast(keys.len));
+        for (keys, values) |key, val| map_.putAssumeCapacity(key, val);
+    }
+};
+
+test "resume after a precompiled header" {
+    const gpa = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    try tmp.dir.writeFile(.{ .sub_path = "header.h", .data =
+        \\#ifndef HEADER_H
+        \\#define HEADER_H
+        \\#define SQUARE(x) ((x) * (x))
+        \\typedef struct point { int x, y; } point;
+        \\enum { answer = SQUARE(6) + 6 };
+        \\int area(point p);
+        \\#endif
+        \\
+    });
+
+    {
+        var arena_state: std.heap.ArenaAllocator = .init(gpa);
+        defer arena_state.deinit();
+        var diagnostics: Diagnostics = .{ .output = .ignore };
+        var comp = Compilation.init(gpa, arena_state.allocator(), std.testing.io, &diagnostics, tmp.dir);
+        defer comp.deinit();
+
+        // The path `#include "header.h"` in `main.c` resolves to, so that both are the same source.
+        const header = try comp.addSourceFromPath(try std.fs.path.join(arena_state.allocator(), &.{ ".", "header.h" }));
+        const builtin_macros = try comp.generateBuiltinMacros(.no_system_defines);
+        var pp = Preprocessor.init(&comp, .default);
+        defer pp.deinit();
+        try pp.addBuiltinMacros();
+        try pp.preprocessSources(.{ .main = header, .builtin = builtin_macros });
+
+        var out: std.Io.Writer.Allocating = .init(gpa);
+        defer out.deinit();
+        var tree = try pp.parseExtra(.{ .emit_pch = &out });
+        defer tree.deinit();
+        try std.testing.expectEqual(0, diagnostics.total);
+        try tmp.dir.writeFile(.{ .sub_path = "header.pch", .data = out.written() });
+    }
+
+    var arena_state: std.heap.ArenaAllocator = .init(gpa);
+    defer arena_state.deinit();
+    var diagnostics: Diagnostics = .{ .output = .ignore };
+    var comp = Compilation.init(gpa, arena_state.allocator(), std.testing.io, &diagnostics, tmp.dir);
+    defer comp.deinit();
+
+    const main = try comp.addSourceFromBuffer("main.c",
+        \\#include "header.h"
+        \\point origin = { 0, SQUARE(2) };
+        \\int lengths[answer];
+        \\
+    );
+    const builtin_macros = try comp.generateBuiltinMacros(.no_system_defines);
+    var pp = Preprocessor.init(&comp, .default);
+    defer pp.deinit();
+    try pp.addBuiltinMacros();
+
+    const file = try tmp.dir.openFile("header.pch", .{});
+    var pch = pch: {
+        defer file.close();
+        break :pch try Pch.load(&pp, file, "header.pch");
+    };
+    defer pch.deinit(gpa);
+    try pp.preprocessSources(.{ .main = main, .builtin = builtin_macros, .pch = true });
+    var tree = try pp.parseExtra(.{ .pch = &pch });
+    defer tree.deinit();
+
+    // Including the header again is skipped due to its include guard, or it would redefine `point`.
+    try std.testing.expectEqual(0, diagnostics.total);
+    try std.testing.expect(pp.defines.get("SQUARE").?.is_func);
+    const decls = tree.root_decls.items;
+    try std.testing.expectEqualStrings("area", tree.tokSlice(decls[decls.len - 3].tok(&tree)));
+    const lengths = decls[decls.len - 1].get(&tree).variable;
+    try std.testing.expectEqualStrings("lengths", tree.tokSlice(lengths.name_tok));
+    try std.testing.expectEqual(42, lengths.qt.arrayLen(&comp));
+    try std.testing.expectEqualStrings(
+        try std.fs.path.join(arena_state.allocator(), &.{ ".", "header.h" }),
+        decls[decls.len - 3].loc(&tree).expand(&comp).path,
+    );
+}
@@ -275,6 +275,7 @@ m_times: std.AutoHashMapUnmanaged(Source.Id, u64) = .empty,
 dep_file: ?*DepFile = null,
 
 pub const parse = Parser.parse;
+pub const parseExtra = Parser.parseExtra;
 
 pub const Linemarkers = enum {
     /// No linemarker tokens. Required setting if parser will run
@@ -436,16 +437,19 @@ pub fn preprocessSources(pp: *Preprocessor, sources: struct {
     command_line: ?Source = null,
     imacros: []const Source = &.{},
     implicit_includes: []const Source = &.{},
+    /// Set when a precompiled header was loaded with `Pch.load`; `builtin` and `command_line`
+    /// were already preprocessed when it was written.
+    pch: bool = false,
 }) Error!void {
     try pp.addIncludeStart(sources.main.id);
 
     pp.include_depth = 1;
     try pp.addIncludeStart(sources.builtin.id);
-    _ = try pp.preprocess(sources.builtin);
+    if (!sources.pch) _ = try pp.preprocess(sources.builtin);
 
     if (sources.command_line) |command_line| {
         try pp.addIncludeStart(command_line.id);
-        _ = try pp.preprocess(command_line);
+        if (!sources.pch) _ = try pp.preprocess(command_line);
 
         for (sources.imacros) |imacro| {
             try pp.addIncludeStart(imacro.id);
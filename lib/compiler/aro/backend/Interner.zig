@@ -578,6 +578,18 @@ pub fn deinit(i: *Interner, gpa: Allocator) void {
     i.strings.deinit(gpa);
 }
 
+/// Rebuilds `map` after `items`, `extra`, `limbs` and `strings` were filled in directly,
+/// e.g. when loading a precompiled header.
+pub fn rebuildMap(i: *Interner, gpa: Allocator) Allocator.Error!void {
+    const adapter: KeyAdapter = .{ .interner = i };
+    i.map.clearRetainingCapacity();
+    try i.map.ensureTotalCapacity(gpa, i.items.len);
+    for (0..i.items.len) |index| {
+        const gop = i.map.getOrPutAssumeCapacityAdapted(i.get(@enumFromInt(index)), adapter);
+        assert(!gop.found_existing and gop.index == index);
+    }
+}
+
 pub fn put(i: *Interner, gpa: Allocator, key: Key) !Ref {
     if (key.toRef()) |some| return some;
     const adapter: KeyAdapter = .{ .interner = i };
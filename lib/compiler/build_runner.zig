@@ -10,6 +10,7 @@ const process = std.process;
 const File = std.fs.File;
 const Step = std.Build.Step;
 const Watch = std.Build.Watch;
+const Daemon = std.Build.Daemon;
 const WebServer = std.Build.WebServer;
 const Allocator = std.mem.Allocator;
 const fatal = std.process.fatal;
@@ -117,14 +118,17 @@ pub fn main() !void {
     var max_rss: u64 = 0;
     var skip_oom_steps = false;
     var test_timeout_ns: ?u64 = null;
+    var test_jobs: u32 = 1;
     var color: Color = .auto;
     var help_menu = false;
     var steps_menu = false;
     var output_tmp_nonce: ?[16]u8 = null;
     var watch = false;
+    var daemon_mode = false;
     var fuzz: ?std.Build.Fuzz.Mode = null;
     var debounce_interval_ms: u16 = 50;
     var webui_listen: ?Io.net.IpAddress = null;
+    var trace_path: ?[]const u8 = null;
 
     if (try std.zig.EnvVar.ZIG_BUILD_ERROR_STYLE.get(arena)) |str| {
         if (std.meta.stringToEnum(ErrorStyle, str)) |style| {
@@ -232,6 +236,13 @@ pub fn main() !void {
                     .{ timeout_str, num_str, err },
                 );
                 test_timeout_ns = std.math.lossyCast(u64, unit_factor * num_parsed);
+            } else if (mem.eql(u8, arg, "--test-jobs")) {
+                const num = nextArgOrFatal(args, &arg_idx);
+                test_jobs = std.fmt.parseUnsigned(u32, num, 10) catch |err| fatal(
+                    "unable to parse test jobs count '{s}': {t}",
+                    .{ num, err },
+                );
+                if (test_jobs < 1) fatal("number of test jobs must be at least 1", .{});
             } else if (mem.eql(u8, arg, "--search-prefix")) {
                 const search_prefix = nextArgOrFatal(args, &arg_idx);
                 builder.addSearchPrefix(search_prefix);
@@ -335,9 +346,17 @@ pub fn main() !void {
                 builder.verbose_llvm_cpu_features = true;
             } else if (mem.eql(u8, arg, "--watch")) {
                 watch = true;
+            } else if (mem.eql(u8, arg, "--daemon")) {
+                daemon_mode = true;
             } else if (mem.eql(u8, arg, "--time-report")) {
                 graph.time_report = true;
                 if (webui_listen == null) webui_listen = .{ .ip6 = .loopback(0) };
+            } else if (mem.eql(u8, arg, "--mem-report")) {
+                graph.mem_report = true;
+                if (webui_listen == null) webui_listen = .{ .ip6 = .loopback(0) };
+            } else if (mem.startsWith(u8, arg, "--trace=")) {
+                trace_path = arg["--trace=".len..];
+                if (trace_path.?.len == 0) fatal("missing argument to --trace", .{});
             } else if (mem.eql(u8, arg, "--fuzz")) {
                 fuzz = .{ .forever = undefined };
                 if (webui_listen == null) webui_listen = .{ .ip6 = .loopback(0) };
@@ -442,10 +461,25 @@ pub fn main() !void {
         if (builtin.single_threaded) fatal("'--webui' is not yet supported on single-threaded hosts", .{});
     }
 
+    if (daemon_mode) {
+        if (!Daemon.have_impl) fatal("--daemon not yet implemented for {t}", .{builtin.os.tag});
+        if (watch or webui_listen != null or fuzz != null) {
+            fatal("'--daemon' cannot be combined with '--watch', '--webui' or '--fuzz'", .{});
+        }
+    }
+
+    var trace: ?std.Build.Trace = if (trace_path != null) std.Build.Trace.init(gpa, io) catch |err| {
+        fatal("--trace not supported on this host: {t}", .{err});
+    } else null;
+    defer if (trace) |*t| t.deinit();
+    if (trace) |*t| graph.trace = t;
+
     const ttyconf = color.detectTtyConf();
 
     const main_progress_node = std.Progress.start(.{
-        .disable_printing = (color == .off),
+        // The progress of a daemon would be drawn on the terminal it was started from, rather
+        // than on that of the `zig build` invocation it is building for.
+        .disable_printing = (color == .off) or daemon_mode,
     });
     defer main_progress_node.end();
 
@@ -454,28 +488,14 @@ pub fn main() !void {
     {
         var prog_node = main_progress_node.start("Configure", 0);
         defer prog_node.end();
+        const trace_start_ns = if (graph.trace) |t| t.now() else 0;
         try builder.runBuild(root);
         createModuleDependencies(builder) catch @panic("OOM");
+        if (graph.trace) |t| t.complete("Configure", "build", trace_start_ns, t.now(), .{});
     }
 
     if (graph.needed_lazy_dependencies.entries.len != 0) {
-        var buffer: std.ArrayList(u8) = .empty;
-        for (graph.needed_lazy_dependencies.keys()) |k| {
-            try buffer.appendSlice(arena, k);
-            try buffer.append(arena, '\n');
-        }
-        const s = std.fs.path.sep_str;
-        const tmp_sub_path = "tmp" ++ s ++ (output_tmp_nonce orelse fatal("missing -Z arg", .{}));
-        local_cache_directory.handle.writeFile(.{
-            .sub_path = tmp_sub_path,
-            .data = buffer.items,
-            .flags = .{ .exclusive = true },
-        }) catch |err| {
-            fatal("unable to write configuration results to '{f}{s}': {s}", .{
-                local_cache_directory, tmp_sub_path, @errorName(err),
-            });
-        };
-        process.exit(3); // Indicate configure phase failed with meaningful stdout.
+        requestLazyDependencies(arena, local_cache_directory, output_tmp_nonce, graph.needed_lazy_dependencies.keys());
     }
 
     if (builder.validateUserInputDidItFail()) {
@@ -503,16 +523,25 @@ pub fn main() !void {
 
         .max_rss = max_rss,
         .max_rss_is_default = false,
-        .max_rss_mutex = .{},
+        .scheduler_mutex = .{},
         .skip_oom_steps = skip_oom_steps,
         .unit_test_timeout_ns = test_timeout_ns,
+        .unit_test_jobs = test_jobs,
+        .trace_path = trace_path,
 
-        .watch = watch,
+        .watch = watch or daemon_mode,
         .web_server = undefined, // set after `prepare`
-        .memory_blocked_steps = .empty,
+        .blocked_steps = .empty,
+        .ready_steps = undefined, // set after `prepare`
         .step_stack = .empty,
+        .critical_path_ns = undefined, // set after `prepare`
+        .step_durations = .empty,
+        .step_durations_changed = false,
 
         .claimed_rss = 0,
+        .claimed_cpu = 0,
+        .running_steps = 0,
+        .max_cpu = undefined, // set after the thread pool is initialized
         .error_style = error_style,
         .multiline_errors = multiline_errors,
         .summary = summary orelse if (watch or webui_listen != null) .line else .failures,
@@ -521,8 +550,9 @@ pub fn main() !void {
         .ttyconf = ttyconf,
     };
     defer {
-        run.memory_blocked_steps.deinit(gpa);
+        run.blocked_steps.deinit(gpa);
         run.step_stack.deinit(gpa);
+        run.step_durations.deinit(gpa);
     }
 
     if (run.max_rss == 0) {
@@ -541,14 +571,30 @@ pub fn main() !void {
         else => |e| return e,
     };
 
+    // Lazy dependencies which only some steps need are fetched once it is
+    // known that those steps are going to run.
+    for (graph.step_lazy_dependencies.items) |entry| {
+        const step, const pkg_hash = entry;
+        if (run.step_stack.contains(step)) try graph.needed_lazy_dependencies.put(arena, pkg_hash, {});
+    }
+    if (graph.needed_lazy_dependencies.entries.len != 0) {
+        requestLazyDependencies(arena, local_cache_directory, output_tmp_nonce, graph.needed_lazy_dependencies.keys());
+    }
+
+    run.critical_path_ns = try arena.alloc(u64, run.step_stack.count());
+    run.ready_steps = .init(gpa, run.critical_path_ns);
+    defer run.ready_steps.deinit();
+    loadStepDurations(&run, local_cache_directory);
+
     var w: Watch = w: {
-        if (!watch) break :w undefined;
+        if (!run.watch) break :w undefined;
         if (!Watch.have_impl) fatal("--watch not yet implemented for {t}", .{builtin.os.tag});
         break :w try .init();
     };
 
     try run.thread_pool.init(thread_pool_options);
     defer run.thread_pool.deinit();
+    run.max_cpu = @intCast(@max(1, run.thread_pool.threads.len));
 
     const now = Io.Clock.Timestamp.now(io, .awake) catch |err| fatal("failed to collect timestamp: {t}", .{err});
 
@@ -571,6 +617,12 @@ pub fn main() !void {
         ws.start() catch |err| fatal("failed to start web server: {t}", .{err});
     }
 
+    var daemon: ?Daemon = if (Daemon.have_impl and daemon_mode) Daemon.init(io, arena, cache_root) catch |err| switch (err) {
+        error.AlreadyRunning => fatal("a build daemon is already running for '{s}'", .{cache_root}),
+        else => |e| fatal("failed to start build daemon: {t}", .{e}),
+    } else null;
+    defer if (daemon) |*d| d.deinit(io);
+
     rebuild: while (true) : (if (run.error_style.clearOnUpdate()) {
         const bw, _ = std.debug.lockStderrWriter(&stdio_buffer_allocation);
         defer std.debug.unlockStderrWriter();
@@ -578,7 +630,7 @@ pub fn main() !void {
     }) {
         if (run.web_server) |*ws| ws.startBuild();
 
-        try runStepNames(
+        _ = try runStepNames(
             builder,
             targets.items,
             main_progress_node,
@@ -599,10 +651,7 @@ pub fn main() !void {
             assert(!watch); // fatal error after CLI parsing
             while (true) switch (ws.wait()) {
                 .rebuild => {
-                    for (run.step_stack.keys()) |step| {
-                        step.state = .precheck_done;
-                        step.reset(gpa);
-                    }
+                    markAllStepsDirty(gpa, run.step_stack.keys());
                     continue :rebuild;
                 },
             };
@@ -613,6 +662,15 @@ pub fn main() !void {
 
         try w.update(gpa, run.step_stack.keys());
 
+        if (daemon) |*d| {
+            if (!Daemon.have_impl) unreachable;
+            try serveDaemon(d, &w, builder, targets.items, main_progress_node, &run, args, color);
+            // Like `runStepNames` without `--watch`, exit rather than tearing down the step graph.
+            d.deinit(io);
+            std.debug.lockStdErr();
+            process.exit(0);
+        }
+
         // Wait until a file system notification arrives. Read all such events
         // until the buffer is empty. Then wait for a debounce interval, resetting
         // if any more events come in. After the debounce interval has passed,
@@ -641,6 +699,99 @@ pub fn main() !void {
     }
 }
 
+/// Runs the build for each `zig build` invocation which connects with the same configuration,
+/// until one reveals that the build runner executable changed.
+fn serveDaemon(
+    d: *Daemon,
+    w: *Watch,
+    b: *std.Build,
+    step_names: []const []const u8,
+    parent_prog_node: std.Progress.Node,
+    run: *Run,
+    args: []const []const u8,
+    color: Color,
+) !void {
+    const gpa = run.gpa;
+    const io = b.graph.io;
+    while (true) {
+        var arena_allocator: std.heap.ArenaAllocator = .init(gpa);
+        defer arena_allocator.deinit();
+        const arena = arena_allocator.allocator();
+
+        var req = d.accept(io, arena) catch |err| {
+            std.log.err("failed to accept build daemon request: {t}", .{err});
+            continue;
+        };
+        const status = req.check(arena, args, &b.graph.env_map) catch |err| {
+            std.log.err("failed to check build daemon request: {t}", .{err});
+            // The client runs the build itself.
+            d.finish(io, &req, .{ .status = .mismatch, .exit_code = 0 });
+            continue;
+        };
+        if (status != .exited) {
+            d.finish(io, &req, .{ .status = status, .exit_code = 0 });
+            if (status == .stale) return;
+            continue;
+        }
+        req.redirect() catch |err| {
+            std.log.err("failed to redirect build daemon output: {t}", .{err});
+            d.finish(io, &req, .{ .status = .mismatch, .exit_code = 0 });
+            continue;
+        };
+        run.ttyconf = color.detectTtyConf();
+
+        // Mark the steps with inputs that changed since the last build dirty. Without any
+        // watched directories there is nothing to poll. Errors are reported to the client, whose
+        // standard streams are in use now, and leave the daemon unable to tell which steps are up
+        // to date, so all of them run again.
+        if (w.dir_count != 0) while (true) {
+            const result = w.wait(gpa, .{ .ms = 0 }) catch |err| {
+                std.log.err("failed to read file system changes: {t}", .{err});
+                markAllStepsDirty(gpa, run.step_stack.keys());
+                break;
+            };
+            if (result == .timeout) break;
+        };
+        markEffectfulStepsDirty(gpa, run.step_stack.keys());
+        markFailedStepsDirty(gpa, run.step_stack.keys());
+
+        const code = runStepNames(b, step_names, parent_prog_node, run, null) catch |err| code: {
+            std.log.err("failed to run build: {t}", .{err});
+            markAllStepsDirty(gpa, run.step_stack.keys());
+            break :code 1;
+        };
+        w.update(gpa, run.step_stack.keys()) catch |err| {
+            std.log.err("failed to update file system watches: {t}", .{err});
+            markAllStepsDirty(gpa, run.step_stack.keys());
+        };
+        d.finish(io, &req, .{ .status = .exited, .exit_code = code });
+    }
+}
+
+/// Forgets the results of all steps, so that the next build runs each of them again, looking up
+/// the cache.
+fn markAllStepsDirty(gpa: Allocator, all_steps: []const *Step) void {
+    for (all_steps) |step| {
+        step.state = .precheck_done;
+        step.reset(gpa);
+    }
+}
+
+/// Marks the steps with effects outside of the cache dirty, so that each daemon request runs them
+/// like a separate `zig build` invocation would: installed files may have been removed or modified
+/// since the previous request, and commands run for their side effects must run again.
+fn markEffectfulStepsDirty(gpa: Allocator, all_steps: []const *Step) void {
+    for (all_steps) |step| {
+        if (step.state == .precheck_done) continue;
+        const effectful = switch (step.id) {
+            .install_artifact, .install_file, .install_dir, .remove_dir, .update_source_files, .fmt => true,
+            .run => step.cast(Step.Run).?.hasSideEffects(),
+            else => false,
+        };
+        if (effectful) step.recursiveReset(gpa);
+    }
+}
+
 fn markFailedStepsDirty(gpa: Allocator, all_steps: []const *Step) void {
     for (all_steps) |step| switch (step.state) {
         .dependency_failure, .failure, .skipped => step.recursiveReset(gpa),
@@ -662,25 +813,73 @@ fn countSubProcesses(all_steps: []const *Step) usize {
     return count;
 }
 
+/// Tells the parent process which lazy dependencies to fetch before running the
+/// build script again.
+fn requestLazyDependencies(
+    arena: Allocator,
+    local_cache_directory: std.Build.Cache.Directory,
+    output_tmp_nonce: ?[16]u8,
+    pkg_hashes: []const []const u8,
+) noreturn {
+    var buffer: std.ArrayList(u8) = .empty;
+    for (pkg_hashes) |k| {
+        buffer.appendSlice(arena, k) catch @panic("OOM");
+        buffer.append(arena, '\n') catch @panic("OOM");
+    }
+    const s = std.fs.path.sep_str;
+    const tmp_sub_path = "tmp" ++ s ++ (output_tmp_nonce orelse fatal("missing -Z arg", .{}));
+    local_cache_directory.handle.writeFile(.{
+        .sub_path = tmp_sub_path,
+        .data = buffer.items,
+        .flags = .{ .exclusive = true },
+    }) catch |err| {
+        fatal("unable to write configuration results to '{f}{s}': {s}", .{
+            local_cache_directory, tmp_sub_path, @errorName(err),
+        });
+    };
+    process.exit(3); // Indicate configure phase failed with meaningful stdout.
+}
+
 const Run = struct {
     gpa: Allocator,
     max_rss: u64,
     max_rss_is_default: bool,
-    max_rss_mutex: std.Thread.Mutex,
+    /// Guards `claimed_rss`, `claimed_cpu`, `blocked_steps`, `ready_steps`
+    /// and `step_durations`.
+    scheduler_mutex: std.Thread.Mutex,
     skip_oom_steps: bool,
     unit_test_timeout_ns: ?u64,
+    unit_test_jobs: u32,
+    /// Where to write the trace after each build, if `--trace` was given.
+    trace_path: ?[]const u8,
     watch: bool,
     web_server: if (!builtin.single_threaded) ?WebServer else ?noreturn,
+    /// Steps which are waiting for other steps to give back memory or CPU cores.
     /// Allocated into `gpa`.
-    memory_blocked_steps: std.ArrayList(*Step),
+    blocked_steps: std.ArrayList(*Step),
+    /// Indexes into `step_stack` of the steps which workers are spawned for, with the
+    /// longest critical path first. A step in the queue may not be ready to run yet, in
+    /// which case the worker which takes it from the queue drops it.
+    ready_steps: std.PriorityQueue(u32, []const u64, compareCriticalPaths),
     /// Allocated into `gpa`.
     step_stack: std.AutoArrayHashMapUnmanaged(*Step, void),
+    /// For each step in `step_stack`, the estimated time from when it starts until the last of
+    /// its transitive dependants finishes, based on `step_durations`.
+    critical_path_ns: []u64,
+    /// How long each step took the last time it ran without being cached, keyed by `stepKey`.
+    /// Persisted in the local cache between runs. Allocated into `gpa`.
+    step_durations: std.AutoHashMapUnmanaged(u64, u64),
+    step_durations_changed: bool,
     thread_pool: std.Thread.Pool,
     /// Similar to the `tty.Config` returned by `std.debug.lockStderrWriter`,
     /// but also respects the '--color' flag.
     ttyconf: tty.Config,
 
     claimed_rss: usize,
+    claimed_cpu: u32,
+    running_steps: u32,
+    /// The number of jobs.
+    max_cpu: u32,
     error_style: ErrorStyle,
     multiline_errors: MultilineErrors,
     summary: Summary,
@@ -750,7 +949,7 @@ fn runStepNames(
     parent_prog_node: std.Progress.Node,
     run: *Run,
     fuzz: ?std.Build.Fuzz.Mode,
-) !void {
+) !u8 {
     const gpa = run.gpa;
     const io = b.graph.io;
     const step_stack = &run.step_stack;
@@ -763,21 +962,40 @@ fn runStepNames(
         var wait_group: std.Thread.WaitGroup = .{};
         defer wait_group.wait();
 
-        // Here we spawn the initial set of tasks with a nice heuristic -
-        // dependency order. Each worker when it finishes a step will then
-        // check whether it should run any dependants.
-        const steps_slice = step_stack.keys();
-        for (0..steps_slice.len) |i| {
-            const step = steps_slice[steps_slice.len - i - 1];
-            if (step.state == .skipped_oom) continue;
-
-            thread_pool.spawnWg(&wait_group, workerMakeOneStep, .{
-                &wait_group, b, step, step_prog, run,
+        // Here we queue up the initial set of tasks, longest critical path
+        // first. Ties keep a nice heuristic - dependency order. Each worker
+        // when it finishes a step will then check whether it should run any
+        // dependants.
+        computeCriticalPaths(run);
+        var queued: usize = 0;
+        {
+            run.scheduler_mutex.lock();
+            defer run.scheduler_mutex.unlock();
+            for (step_stack.keys(), 0..) |step, i| {
+                if (step.state == .skipped_oom) continue;
+                run.ready_steps.add(@intCast(i)) catch @panic("OOM");
+                queued += 1;
+            }
+        }
+        for (0..queued) |_| {
+            thread_pool.spawnWg(&wait_group, workerMakeNextStep, .{
+                &wait_group, b, step_prog, run,
             });
         }
     }
 
-    assert(run.memory_blocked_steps.items.len == 0);
+    assert(run.blocked_steps.items.len == 0);
+    assert(run.ready_steps.count() == 0);
+
+    if (run.step_durations_changed) {
+        saveStepDurations(run, b.cache_root);
+        run.step_durations_changed = false;
+    }
+
+    if (b.graph.trace) |trace| {
+        const path = run.trace_path.?;
+        trace.write(std.fs.cwd(), path) catch |err| fatal("unable to write trace to '{s}': {t}", .{ path, err });
+    }
 
     var test_pass_count: usize = 0;
     var test_skip_count: usize = 0;
@@ -968,17 +1186,18 @@ fn runStepNames(
         w.writeByte('\n') catch {};
     }
 
-    if (run.watch or run.web_server != null) return;
-
-    // Perhaps in the future there could be an Advanced Options flag such as
-    // --debug-build-runner-leaks which would make this code return instead of
-    // calling exit.
-
     const code: u8 = code: {
         if (failure_count == 0) break :code 0; // success
         if (run.error_style.verboseContext()) break :code 1; // failure; print build command
         break :code 2; // failure; do not print build command
     };
+
+    if (run.watch or run.web_server != null) return code;
+
+    // Perhaps in the future there could be an Advanced Options flag such as
+    // --debug-build-runner-leaks which would make this code return instead of
+    // calling exit.
+
     std.debug.lockStdErr();
     process.exit(code);
 }
@@ -1317,6 +1536,39 @@ fn constructGraphAndCheckForDependencyLoop(
     }
 }
 
+/// Queues `s` to be run by a worker, once its dependencies have finished and
+/// enough resources are available.
+fn scheduleStep(
+    wg: *std.Thread.WaitGroup,
+    b: *std.Build,
+    s: *Step,
+    prog_node: std.Progress.Node,
+    run: *Run,
+) void {
+    {
+        run.scheduler_mutex.lock();
+        defer run.scheduler_mutex.unlock();
+        run.ready_steps.add(@intCast(run.step_stack.getIndex(s).?)) catch @panic("OOM");
+    }
+    run.thread_pool.spawnWg(wg, workerMakeNextStep, .{ wg, b, prog_node, run });
+}
+
+/// Each worker is spawned for one queued step, but takes the queued step with
+/// the longest critical path at the time it starts.
+fn workerMakeNextStep(
+    wg: *std.Thread.WaitGroup,
+    b: *std.Build,
+    prog_node: std.Progress.Node,
+    run: *Run,
+) void {
+    const s = s: {
+        run.scheduler_mutex.lock();
+        defer run.scheduler_mutex.unlock();
+        break :s run.step_stack.keys()[run.ready_steps.remove()];
+    };
+    workerMakeOneStep(wg, b, s, prog_node, run);
+}
+
 fn workerMakeOneStep(
     wg: *std.Thread.WaitGroup,
     b: *std.Build,
@@ -1346,9 +1598,10 @@ fn workerMakeOneStep(
         }
     }
 
-    if (s.max_rss != 0) {
-        run.max_rss_mutex.lock();
-        defer run.max_rss_mutex.unlock();
+    const cpu_weight = @min(s.cpu_weight, run.max_cpu);
+    {
+        run.scheduler_mutex.lock();
+        defer run.scheduler_mutex.unlock();
 
         // Avoid running steps twice.
         if (s.state != .precheck_done) {
@@ -1357,21 +1610,19 @@ fn workerMakeOneStep(
         }
 
         const new_claimed_rss = run.claimed_rss + s.max_rss;
-        if (new_claimed_rss > run.max_rss) {
-            // Running this step right now could possibly exceed the allotted RSS.
-            // Add this step to the queue of memory-blocked steps.
-            run.memory_blocked_steps.append(run.gpa, s) catch @panic("OOM");
+        const new_claimed_cpu = run.claimed_cpu + cpu_weight;
+        if (new_claimed_rss > run.max_rss or new_claimed_cpu > run.max_cpu) {
+            // Running this step right now could possibly exceed the allotted RSS,
+            // or oversubscribe the CPU. Add this step to the queue of blocked steps.
+            run.blocked_steps.append(run.gpa, s) catch @panic("OOM");
             return;
         }
 
         run.claimed_rss = new_claimed_rss;
-        s.state = .running;
-    } else {
-        // Avoid running steps twice.
-        if (@cmpxchgStrong(Step.State, &s.state, .precheck_done, .running, .seq_cst, .seq_cst) != null) {
-            // Another worker got the job.
-            return;
-        }
+        run.claimed_cpu = new_claimed_cpu;
+        run.running_steps += 1;
+        @atomicStore(Step.State, &s.state, .running, .seq_cst);
+        if (b.graph.trace) |trace| traceRunningSteps(trace, run);
     }
 
     const sub_prog_node = prog_node.start(s.name, 0);
@@ -1379,6 +1630,8 @@ fn workerMakeOneStep(
 
     if (run.web_server) |*ws| ws.updateStepStatus(s, .wip);
 
+    var timer = std.time.Timer.start() catch null;
+    const trace_start_ns = if (b.graph.trace) |trace| trace.now() else 0;
     const make_result = s.make(.{
         .progress_node = sub_prog_node,
         .thread_pool = thread_pool,
@@ -1386,8 +1639,62 @@ fn workerMakeOneStep(
         .web_server = if (run.web_server) |*ws| ws else null,
         .ttyconf = run.ttyconf,
         .unit_test_timeout_ns = run.unit_test_timeout_ns,
+        .unit_test_jobs = run.unit_test_jobs,
         .gpa = run.gpa,
     });
+    const duration_ns = if (timer) |*t| t.read() else null;
+    if (b.graph.trace) |trace| {
+        trace.complete(s.name, @tagName(s.id), trace_start_ns, trace.now(), .{
+            .package = s.owner.dep_prefix,
+            .result = if (make_result) |_| "success" else |err| @errorName(err),
+            .cached = s.result_cached,
+        });
+    }
+
+    // Give the resources back to the scheduler, and queue up other steps
+    // that are waiting for resources.
+    {
+        var unblocked: usize = 0;
+        {
+            run.scheduler_mutex.lock();
+            defer run.scheduler_mutex.unlock();
+
+            run.claimed_rss -= s.max_rss;
+            run.claimed_cpu -= cpu_weight;
+            run.running_steps -= 1;
+            if (b.graph.trace) |trace| traceRunningSteps(trace, run);
+
+            const ran = if (make_result) |_| !s.result_cached else |err| err == error.MakeFailed;
+            if (duration_ns) |ns| if (ran) {
+                run.step_durations.put(run.gpa, stepKey(s), ns) catch @panic("OOM");
+                run.step_durations_changed = true;
+            };
+
+            // Avoid kicking off too many tasks that we already know will not have
+            // enough resources.
+            var remaining_rss = run.max_rss - run.claimed_rss;
+            var remaining_cpu = run.max_cpu - run.claimed_cpu;
+            var i: usize = 0;
+            var j: usize = 0;
+            while (j < run.blocked_steps.items.len) : (j += 1) {
+                const dep = run.blocked_steps.items[j];
+                const dep_cpu_weight = @min(dep.cpu_weight, run.max_cpu);
+                if (dep.max_rss <= remaining_rss and dep_cpu_weight <= remaining_cpu) {
+                    remaining_rss -= dep.max_rss;
+                    remaining_cpu -= dep_cpu_weight;
+                    run.ready_steps.add(@intCast(run.step_stack.getIndex(dep).?)) catch @panic("OOM");
+                    unblocked += 1;
+                } else {
+                    run.blocked_steps.items[i] = dep;
+                    i += 1;
+                }
+            }
+            run.blocked_steps.shrinkRetainingCapacity(i);
+        }
+        for (0..unblocked) |_| {
+            thread_pool.spawnWg(wg, workerMakeNextStep, .{ wg, b, prog_node, run });
+        }
+    }
 
     // No matter the result, we want to display error/warning messages.
     const show_compile_errors = s.result_error_bundle.errorMessageCount() > 0;
@@ -1419,41 +1726,101 @@ fn workerMakeOneStep(
 
         // Successful completion of a step, so we queue up its dependants as well.
         for (s.dependants.items) |dep| {
-            thread_pool.spawnWg(wg, workerMakeOneStep, .{
-                wg, b, dep, prog_node, run,
-            });
+            scheduleStep(wg, b, dep, prog_node, run);
         }
     }
+}
 
-    // If this is a step that claims resources, we must now queue up other
-    // steps that are waiting for resources.
-    if (s.max_rss != 0) {
-        run.max_rss_mutex.lock();
-        defer run.max_rss_mutex.unlock();
-
-        // Give the memory back to the scheduler.
-        run.claimed_rss -= s.max_rss;
-        // Avoid kicking off too many tasks that we already know will not have
-        // enough resources.
-        var remaining = run.max_rss - run.claimed_rss;
-        var i: usize = 0;
-        var j: usize = 0;
-        while (j < run.memory_blocked_steps.items.len) : (j += 1) {
-            const dep = run.memory_blocked_steps.items[j];
-            assert(dep.max_rss != 0);
-            if (dep.max_rss <= remaining) {
-                remaining -= dep.max_rss;
-
-                thread_pool.spawnWg(wg, workerMakeOneStep, .{
-                    wg, b, dep, prog_node, run,
-                });
-            } else {
-                run.memory_blocked_steps.items[i] = dep;
-                i += 1;
-            }
-        }
-        run.memory_blocked_steps.shrinkRetainingCapacity(i);
+/// Records how many workers are busy, and how much of the CPU they claim.
+/// Asserts that `run.scheduler_mutex` is held.
+fn traceRunningSteps(trace: *std.Build.Trace, run: *const Run) void {
+    trace.counter("Running Steps", trace.now(), .{
+        .steps = run.running_steps,
+        .cpu_weight = run.claimed_cpu,
+    });
+}
+
+fn compareCriticalPaths(critical_path_ns: []const u64, a: u32, b: u32) std.math.Order {
+    // Longest critical path first, and then the step which is later in the
+    // step stack, as it tends to be a dependency of earlier ones.
+    return switch (std.math.order(critical_path_ns[b], critical_path_ns[a])) {
+        .eq => std.math.order(b, a),
+        else => |order| order,
+    };
+}
+
+fn computeCriticalPaths(run: *Run) void {
+    @memset(run.critical_path_ns, unknown_critical_path);
+    for (0..run.step_stack.count()) |i| _ = criticalPath(run, i);
+}
+
+const unknown_critical_path = std.math.maxInt(u64);
+
+fn criticalPath(run: *Run, step_index: usize) u64 {
+    const cp = &run.critical_path_ns[step_index];
+    if (cp.* != unknown_critical_path) return cp.*;
+    const s = run.step_stack.keys()[step_index];
+    var longest_dependant_ns: u64 = 0;
+    for (s.dependants.items) |dep| {
+        longest_dependant_ns = @max(longest_dependant_ns, criticalPath(run, run.step_stack.getIndex(dep).?));
+    }
+    // Steps which never ran before count as taking no time, so that their
+    // order only depends on their dependants.
+    const duration_ns = run.step_durations.get(stepKey(s)) orelse 0;
+    cp.* = @min(duration_ns +| longest_dependant_ns, unknown_critical_path - 1);
+    return cp.*;
+}
+
+/// Identifies a step across runs of the build runner. Steps with the same name
+/// in the same package share a duration, which is good enough for scheduling.
+fn stepKey(s: *const Step) u64 {
+    var hasher: std.hash.Wyhash = .init(0);
+    hasher.update(s.owner.dep_prefix);
+    hasher.update(s.name);
+    std.hash.autoHash(&hasher, s.id);
+    return hasher.final();
+}
+
+const step_durations_basename = "durations";
+/// A file larger than this is discarded, which starts over with no durations.
+const max_step_durations_len = 1024 * 1024;
+
+/// The file is a sequence of little-endian `u64` pairs of a step key and a
+/// duration in nanoseconds. Without it, steps are scheduled in dependency
+/// order only, so errors are ignored.
+fn loadStepDurations(run: *Run, cache_root: std.Build.Cache.Directory) void {
+    const gpa = run.gpa;
+    const bytes = cache_root.handle.readFileAlloc(
+        step_durations_basename,
+        gpa,
+        .limited(max_step_durations_len),
+    ) catch return;
+    defer gpa.free(bytes);
+    if (bytes.len % 16 != 0) return;
+    run.step_durations.ensureTotalCapacity(gpa, @intCast(bytes.len / 16)) catch return;
+    var i: usize = 0;
+    while (i < bytes.len) : (i += 16) {
+        run.step_durations.putAssumeCapacity(
+            mem.readInt(u64, bytes[i..][0..8], .little),
+            mem.readInt(u64, bytes[i + 8 ..][0..8], .little),
+        );
+    }
+}
+
+fn saveStepDurations(run: *Run, cache_root: std.Build.Cache.Directory) void {
+    const gpa = run.gpa;
+    const bytes = gpa.alloc(u8, run.step_durations.count() * 16) catch return;
+    defer gpa.free(bytes);
+    var it = run.step_durations.iterator();
+    var i: usize = 0;
+    while (it.next()) |entry| : (i += 16) {
+        mem.writeInt(u64, bytes[i..][0..8], entry.key_ptr.*, .little);
+        mem.writeInt(u64, bytes[i + 8 ..][0..8], entry.value_ptr.*, .little);
     }
+    var af = cache_root.handle.atomicFile(step_durations_basename, .{ .write_buffer = &.{} }) catch return;
+    defer af.deinit();
+    af.file_writer.interface.writeAll(bytes) catch return;
+    af.finish() catch return;
 }
 
 pub fn printErrorMessages(
@@ -1614,10 +1981,14 @@ fn printUsage(b: *std.Build, w: *Writer) !void {
         \\  --skip-oom-steps             Instead of failing, skip steps that would exceed --maxrss
         \\  --test-timeout <timeout>     Limit execution time of unit tests, terminating if exceeded.
         \\                               The timeout must include a unit: ns, us, ms, s, m, h
+        \\  --test-jobs <n>              Split the tests of each unit test binary between n processes
         \\  --fetch[=mode]               Fetch dependency tree (optionally choose laziness) and exit
         \\    needed                     (Default) Lazy dependencies are fetched as needed
         \\    all                        Lazy dependencies are always fetched
         \\  --watch                      Continuously rebuild when source files are modified
+        \\  --daemon                     Stay resident in the foreground and run later 'zig build'
+        \\                               invocations with the same options, instead of them
+        \\                               starting over
         \\  --debounce <ms>              Delay before rebuilding after changed file detected
         \\  --webui[=ip]                 Enable the web interface on the given IP address
         \\  --fuzz[=limit]               Continuously search for unit test failures with an optional 
@@ -1626,6 +1997,12 @@ fn printUsage(b: *std.Build, w: *Writer) !void {
         \\                               '--webui' when no limit is specified.
         \\  --time-report                Force full rebuild and provide detailed information on
         \\                               compilation time of Zig source code (implies '--webui')
+        \\  --trace=[file]               Write a timeline of the steps and of the compilation
+        \\                               phases of Zig source code in Chrome trace event format.
+        \\                               Unlike '--time-report', cached steps stay cached
+        \\  --mem-report                 Force full rebuild and provide detailed information on
+        \\                               the memory used by each declaration of Zig source code
+        \\                               (implies '--webui')
         \\     -fincremental             Enable incremental compilation
         \\  -fno-incremental             Disable incremental compilation
         \\
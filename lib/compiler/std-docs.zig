@@ -71,12 +71,18 @@ pub fn main() !void {
         };
     }
 
+    var thread_pool: std.Thread.Pool = undefined;
+    try thread_pool.init(.{ .allocator = gpa });
+    defer thread_pool.deinit();
+
     var context: Context = .{
         .gpa = gpa,
+        .thread_pool = &thread_pool,
         .zig_exe_path = zig_exe_path,
         .global_cache_path = global_cache_path,
         .lib_dir = lib_dir,
         .zig_lib_directory = zig_lib_directory,
+        .sources = .{},
     };
 
     while (true) {
@@ -124,10 +130,35 @@ fn accept(context: *Context, connection: std.net.Server.Connection) void {
 
 const Context = struct {
     gpa: Allocator,
+    thread_pool: *std.Thread.Pool,
     lib_dir: std.fs.Dir,
     zig_lib_directory: []const u8,
     zig_exe_path: []const u8,
     global_cache_path: []const u8,
+    sources: Sources,
+};
+
+/// The files of `sources.tar` in order, along with their records of the search
+/// index. Refreshed for every request of `sources.tar`, which only reads and
+/// indexes the files that changed since the previous one.
+const Sources = struct {
+    mutex: std.Thread.Mutex = .{},
+    files: std.StringArrayHashMapUnmanaged(SourceFile) = .empty,
+};
+
+const SourceFile = struct {
+    mtime: std.Io.Timestamp,
+    size: u64,
+    bytes: [:0]const u8,
+    /// A record of `std.zig.docs_index`.
+    index_record: []const u8,
+    /// Whether the file was found by the current refresh.
+    seen: bool,
+
+    fn deinit(file: *SourceFile, gpa: Allocator) void {
+        gpa.free(file.bytes);
+        gpa.free(file.index_record);
+    }
 };
 
 fn serveRequest(request: *std.http.Server.Request, context: *Context) !void {
@@ -148,6 +179,8 @@ fn serveRequest(request: *std.http.Server.Request, context: *Context) !void {
         std.mem.eql(u8, request.head.target, "/debug/sources.tar"))
     {
         try serveSourcesTar(request, context);
+    } else if (searchShardIndex(request.head.target)) |shard_index| {
+        try serveSearchShard(request, context, shard_index);
     } else {
         try request.respond("not found", .{
             .status = .not_found,
@@ -184,7 +217,11 @@ fn serveDocsFile(
 }
 
 fn serveSourcesTar(request: *std.http.Server.Request, context: *Context) !void {
-    const gpa = context.gpa;
+    const sources = &context.sources;
+
+    sources.mutex.lock();
+    defer sources.mutex.unlock();
+    try refreshSources(context);
 
     var send_buffer: [0x4000]u8 = undefined;
     var response = try request.respondStreaming(&send_buffer, .{
@@ -196,15 +233,57 @@ fn serveSourcesTar(request: *std.http.Server.Request, context: *Context) !void {
         },
     });
 
+    var archiver: std.tar.Writer = .{ .underlying_writer = &response.writer };
+    for (sources.files.keys(), sources.files.values()) |path, file| {
+        try archiver.writeFileBytes(path, file.bytes, .{ .mtime = @intCast(file.mtime.toSeconds()) });
+    }
+
+    // intentionally omitting the pointless trailer
+    //try archiver.finish();
+    try response.end();
+}
+
+fn refreshSources(context: *Context) !void {
+    const gpa = context.gpa;
+    const sources = &context.sources;
+
+    var arena_instance = std.heap.ArenaAllocator.init(gpa);
+    defer arena_instance.deinit();
+    const arena = arena_instance.allocator();
+
+    for (sources.files.values()) |*file| file.seen = false;
+
+    if (sources.files.getPtr("builtin/builtin.zig")) |file| {
+        file.seen = true;
+    } else {
+        // Since this command is JIT compiled, the builtin module available in
+        // this source file corresponds to the user's host system.
+        const bytes: [:0]const u8 = @embedFile("builtin");
+        var index_record: std.ArrayList(u8) = .empty;
+        defer index_record.deinit(gpa);
+        try std.zig.docs_index.appendFile(gpa, &index_record, "builtin/builtin.zig", bytes);
+        try sources.files.ensureUnusedCapacity(gpa, 1);
+        const owned_bytes = try gpa.dupeZ(u8, bytes);
+        errdefer gpa.free(owned_bytes);
+        const owned_path = try gpa.dupe(u8, "builtin/builtin.zig");
+        errdefer gpa.free(owned_path);
+        sources.files.putAssumeCapacity(owned_path, .{
+            .mtime = .zero,
+            .size = bytes.len,
+            .bytes = owned_bytes,
+            .index_record = try index_record.toOwnedSlice(gpa),
+            .seen = true,
+        });
+    }
+
+    var changed: std.ArrayList(SourceUpdate) = .empty;
+
     var std_dir = try context.lib_dir.openDir("std", .{ .iterate = true });
     defer std_dir.close();
 
     var walker = try std_dir.walk(gpa);
     defer walker.deinit();
 
-    var archiver: std.tar.Writer = .{ .underlying_writer = &response.writer };
-    archiver.prefix = "std";
-
     while (try walker.next()) |entry| {
         switch (entry.kind) {
             .file => {
@@ -215,28 +294,122 @@ fn serveSourcesTar(request: *std.http.Server.Request, context: *Context) !void {
             },
             else => continue,
         }
-        var file = try entry.dir.openFile(entry.basename, .{});
-        defer file.close();
-        const stat = try file.stat();
-        var file_reader: std.fs.File.Reader = .{
-            .file = file,
-            .interface = std.fs.File.Reader.initInterface(&.{}),
-            .size = stat.size,
-        };
-        try archiver.writeFile(entry.path, &file_reader, stat.mtime);
+        const stat = try entry.dir.statFile(entry.basename);
+        const path = try std.fmt.allocPrint(arena, "std/{s}", .{entry.path});
+        if (sources.files.getPtr(path)) |file| {
+            if (file.size == stat.size and file.mtime.nanoseconds == stat.mtime.nanoseconds) {
+                file.seen = true;
+                continue;
+            }
+        }
+        try changed.append(arena, .{
+            .path = path,
+            .sub_path = try arena.dupe(u8, entry.path),
+            .stat = stat,
+            .result = undefined,
+        });
     }
 
     {
-        // Since this command is JIT compiled, the builtin module available in
-        // this source file corresponds to the user's host system.
-        const builtin_zig = @embedFile("builtin");
-        archiver.prefix = "builtin";
-        try archiver.writeFileBytes("builtin.zig", builtin_zig, .{});
+        var wait_group: std.Thread.WaitGroup = .{};
+        defer context.thread_pool.waitAndWork(&wait_group);
+        for (changed.items) |*update| {
+            context.thread_pool.spawnWg(&wait_group, loadSourceFile, .{ gpa, std_dir, update });
+        }
     }
 
-    // intentionally omitting the pointless trailer
-    //try archiver.finish();
-    try response.end();
+    var i: usize = 0;
+    while (i < sources.files.count()) {
+        const file = &sources.files.values()[i];
+        if (file.seen) {
+            i += 1;
+            continue;
+        }
+        const path = sources.files.keys()[i];
+        file.deinit(gpa);
+        // Keep the order of the remaining files, which determines the shards.
+        sources.files.orderedRemoveAt(i);
+        gpa.free(path);
+    }
+
+    // Changed files were not marked as seen, so they are new to the table.
+    try sources.files.ensureUnusedCapacity(gpa, changed.items.len);
+    for (changed.items) |*update| {
+        var file = update.result catch |err| {
+            std.log.err("unable to load {s}: {s}", .{ update.path, @errorName(err) });
+            continue;
+        };
+        errdefer file.deinit(gpa);
+        sources.files.putAssumeCapacityNoClobber(try gpa.dupe(u8, update.path), file);
+    }
+}
+
+const SourceUpdate = struct {
+    /// Path in `sources.tar`.
+    path: []const u8,
+    sub_path: []const u8,
+    stat: std.fs.File.Stat,
+    result: anyerror!SourceFile,
+};
+
+fn loadSourceFile(gpa: Allocator, std_dir: std.fs.Dir, update: *SourceUpdate) void {
+    update.result = loadSourceFileFallible(gpa, std_dir, update);
+}
+
+fn loadSourceFileFallible(gpa: Allocator, std_dir: std.fs.Dir, update: *const SourceUpdate) !SourceFile {
+    const bytes = try std_dir.readFileAllocOptions(update.sub_path, gpa, .unlimited, .of(u8), 0);
+    errdefer gpa.free(bytes);
+    var index_record: std.ArrayList(u8) = .empty;
+    defer index_record.deinit(gpa);
+    try std.zig.docs_index.appendFile(gpa, &index_record, update.path, bytes);
+    return .{
+        .mtime = update.stat.mtime,
+        .size = update.stat.size,
+        .bytes = bytes,
+        .index_record = try index_record.toOwnedSlice(gpa),
+        .seen = true,
+    };
+}
+
+/// Parses targets of the form `/search/{n}.bin`, relative to the page.
+fn searchShardIndex(target: []const u8) ?usize {
+    const prefix = if (std.mem.startsWith(u8, target, "/debug/")) "/debug/search/" else "/search/";
+    if (!std.mem.startsWith(u8, target, prefix) or !std.mem.endsWith(u8, target, ".bin")) return null;
+    return std.fmt.parseInt(usize, target[prefix.len .. target.len - ".bin".len], 10) catch null;
+}
+
+fn serveSearchShard(request: *std.http.Server.Request, context: *Context, shard_index: usize) !void {
+    const gpa = context.gpa;
+    const sources = &context.sources;
+    const files_per_shard = std.zig.docs_index.files_per_shard;
+
+    // Served from the files of the most recent `sources.tar`, which the
+    // frontend requested before searching.
+    sources.mutex.lock();
+    defer sources.mutex.unlock();
+
+    const records = sources.files.values();
+    if (shard_index >= std.zig.docs_index.shardCount(records.len)) {
+        return request.respond("not found", .{
+            .status = .not_found,
+            .extra_headers = &.{
+                .{ .name = "content-type", .value = "text/plain" },
+            },
+        });
+    }
+
+    var shard: std.ArrayList(u8) = .empty;
+    defer shard.deinit(gpa);
+    const start = shard_index * files_per_shard;
+    for (records[start..@min(start + files_per_shard, records.len)]) |file| {
+        try shard.appendSlice(gpa, file.index_record);
+    }
+    try request.respond(shard.items, .{
+        .extra_headers = &.{
+            .{ .name = "content-type", .value = "application/octet-stream" },
+            cache_control_header,
+        },
+    });
 }
 
 fn serveWasm(
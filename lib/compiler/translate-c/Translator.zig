@@ -172,6 +172,9 @@ pub const Options = struct {
     comp: *aro.Compilation,
     pp: *const aro.Preprocessor,
     tree: *const aro.Tree,
+    /// The most threads used to render the output. If null, the number of
+    /// CPUs is used.
+    n_jobs: ?u32 = null,
 };
 
 pub fn translate(options: Options) mem.Allocator.Error![]u8 {
@@ -230,13 +233,81 @@ pub fn translate(options: Options) mem.Allocator.Error![]u8 {
         \\
     ) catch return error.OutOfMemory;
 
-    var zig_ast = try ast.render(gpa, translator.global_scope.nodes.items);
+    const max_chunks = options.n_jobs orelse std.Thread.getCpuCount() catch 1;
+    try renderParallel(gpa, translator.global_scope.nodes.items, max_chunks, &allocating);
+    return allocating.toOwnedSlice();
+}
+
+/// Chunks of fewer top level nodes are not worth rendering on another thread.
+const min_nodes_per_chunk = 1024;
+
+/// Top level nodes are independent of each other once translated, so large
+/// headers are rendered in at most `max_chunks` chunks on separate threads,
+/// which are then concatenated in order.
+fn renderParallel(
+    gpa: mem.Allocator,
+    nodes: []const ZigNode,
+    max_chunks: usize,
+    out: *std.Io.Writer.Allocating,
+) Error!void {
+    if (@import("builtin").single_threaded) return renderNodes(gpa, nodes, &out.writer);
+    const chunk_count = @max(1, @min(max_chunks, nodes.len / min_nodes_per_chunk));
+    if (chunk_count == 1) return renderNodes(gpa, nodes, &out.writer);
+
+    const chunks = try gpa.alloc(RenderChunk, chunk_count - 1);
+    defer gpa.free(chunks);
+    const nodes_per_chunk = nodes.len / chunk_count;
+    var end = nodes.len;
+    var i = chunks.len;
+    while (i > 0) {
+        i -= 1;
+        // Warnings are rendered as comments and blank lines around the
+        // declarations next to them, which the renderer would misplace or
+        // drop at the start and end of a chunk.
+        var start = (i + 1) * nodes_per_chunk;
+        while (start < end and (nodes[start].tag() == .warning or nodes[start - 1].tag() == .warning)) start += 1;
+        chunks[i] = .{
+            .nodes = nodes[@min(start, end)..end],
+            .output = .init(gpa),
+        };
+        end = @min(start, end);
+    }
+    for (chunks) |*chunk| {
+        if (chunk.nodes.len == 0) continue;
+        chunk.thread = std.Thread.spawn(.{}, RenderChunk.run, .{chunk}) catch null;
+    }
+    defer for (chunks) |*chunk| chunk.output.deinit();
+
+    const first_result = renderNodes(gpa, nodes[0..end], &out.writer);
+    for (chunks) |*chunk| {
+        if (chunk.thread) |thread| thread.join() else if (chunk.nodes.len != 0) chunk.run();
+    }
+    try first_result;
+    for (chunks) |*chunk| {
+        try chunk.result;
+        out.writer.writeAll(chunk.output.written()) catch return error.OutOfMemory;
+    }
+}
+
+const RenderChunk = struct {
+    nodes: []const ZigNode,
+    output: std.Io.Writer.Allocating,
+    thread: ?std.Thread = null,
+    result: Error!void = {},
+
+    fn run(chunk: *RenderChunk) void {
+        chunk.result = renderNodes(chunk.output.allocator, chunk.nodes, &chunk.output.writer);
+    }
+};
+
+fn renderNodes(gpa: mem.Allocator, nodes: []const ZigNode, w: *std.Io.Writer) Error!void {
+    var zig_ast = try ast.render(gpa, nodes);
     defer {
         gpa.free(zig_ast.source);
         zig_ast.deinit(gpa);
     }
-    zig_ast.render(gpa, &allocating.writer, .{}) catch return error.OutOfMemory;
-    return allocating.toOwnedSlice();
+    // `w` is always backed by an allocating writer.
+    zig_ast.render(gpa, w, .{}) catch return error.OutOfMemory;
 }
 
 fn prepopulateGlobalNameTable(t: *Translator) !void {
@@ -115,6 +115,10 @@ pub const usage =
     \\  --version           Print translate-c version
     \\  -fmodule-libs       Import libraries as modules
     \\  -fno-module-libs    (default) Install libraries next to output file
+    \\  -j<N>               Limit the threads used to render the output
+    \\                      (default is to use all CPU cores)
+    \\  -emit-pch <file>    Also write a precompiled header of the input to <file>
+    \\  -include-pch <file> Resume from a precompiled header of the start of the input
     \\
     \\
 ;
@@ -122,9 +126,14 @@ pub const usage =
 fn translate(d: *aro.Driver, tc: *aro.Toolchain, args: [][:0]u8, zig_integration: bool) !void {
     const gpa = d.comp.gpa;
 
+    var n_jobs: ?u32 = null;
+    var emit_pch: ?[]const u8 = null;
+    var include_pch: ?[]const u8 = null;
     const aro_args = args: {
         var i: usize = 0;
-        for (args) |arg| {
+        var arg_i: usize = 0;
+        while (arg_i < args.len) : (arg_i += 1) {
+            const arg = args[arg_i];
             args[i] = arg;
             if (mem.eql(u8, arg, "--help")) {
                 var stdout_buf: [512]u8 = undefined;
@@ -142,6 +151,15 @@ fn translate(d: *aro.Driver, tc: *aro.Toolchain, args: [][:0]u8, zig_integration
             } else if (mem.eql(u8, arg, "--zig-integration")) {
                 if (i != 1 or !zig_integration)
                     return d.fatal("--zig-integration must be the first argument", .{});
+            } else if (mem.cutPrefix(u8, arg, "-j")) |str| {
+                const num = std.fmt.parseUnsigned(u32, str, 10) catch
+                    return d.fatal("unable to parse jobs count '{s}'", .{str});
+                if (num < 1) return d.fatal("number of jobs must be at least 1", .{});
+                n_jobs = num;
+            } else if (mem.eql(u8, arg, "-emit-pch") or mem.eql(u8, arg, "-include-pch")) {
+                arg_i += 1;
+                if (arg_i == args.len) return d.fatal("expected argument after {s}", .{arg});
+                if (arg[1] == 'e') emit_pch = args[arg_i] else include_pch = args[arg_i];
             } else {
                 i += 1;
             }
@@ -203,15 +221,29 @@ fn translate(d: *aro.Driver, tc: *aro.Toolchain, args: [][:0]u8, zig_integration
 
     if (opt_dep_file) |*dep_file| pp.dep_file = dep_file;
 
+    var pch: ?aro.Pch = if (include_pch) |path| pch: {
+        const file = d.comp.cwd.openFile(path, .{}) catch |err|
+            return d.fatal("unable to open precompiled header '{s}': {s}", .{ path, aro.Driver.errorDescription(err) });
+        defer file.close();
+        break :pch try aro.Pch.load(&pp, file, path);
+    } else null;
+    defer if (pch) |*loaded| loaded.deinit(gpa);
+
     try pp.preprocessSources(.{
         .main = source,
         .builtin = builtin_macros,
         .command_line = user_macros,
         .imacros = d.imacros.items,
         .implicit_includes = d.implicit_includes.items,
+        .pch = pch != null,
     });
 
-    var c_tree = try pp.parse();
+    var pch_out: std.Io.Writer.Allocating = .init(gpa);
+    defer pch_out.deinit();
+    var c_tree = try pp.parseExtra(.{
+        .pch = if (pch) |*loaded| loaded else null,
+        .emit_pch = if (emit_pch != null) &pch_out else null,
+    });
     defer c_tree.deinit();
 
     if (d.diagnostics.errors != 0) {
@@ -219,6 +251,11 @@ fn translate(d: *aro.Driver, tc: *aro.Toolchain, args: [][:0]u8, zig_integration
         return error.FatalError;
     }
 
+    if (emit_pch) |path| {
+        d.comp.cwd.writeFile(.{ .sub_path = path, .data = pch_out.written() }) catch |err|
+            return d.fatal("unable to write precompiled header '{s}': {s}", .{ path, aro.Driver.errorDescription(err) });
+    }
+
     var out_buf: [4096]u8 = undefined;
     if (opt_dep_file) |dep_file| {
         const dep_file_name = try d.getDepFileName(source, out_buf[0..std.fs.max_name_bytes]);
@@ -240,6 +277,7 @@ fn translate(d: *aro.Driver, tc: *aro.Toolchain, args: [][:0]u8, zig_integration
         .comp = d.comp,
         .pp = &pp,
         .tree = &c_tree,
+        .n_jobs = n_jobs,
     });
     defer gpa.free(rendered_zig);
 
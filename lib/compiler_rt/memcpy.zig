@@ -1,6 +1,7 @@
 const std = @import("std");
 const assert = std.debug.assert;
 const common = @import("./common.zig");
+const rep_string = @import("rep_string.zig");
 const builtin = @import("builtin");
 
 comptime {
@@ -41,6 +42,11 @@ fn memcpyFast(noalias dest: ?[*]u8, noalias src: ?[*]const u8, len: usize) callc
 
     if (copySmallLength(small_limit, dest.?, src.?, len)) return dest;
 
+    if (rep_string.wanted(len)) {
+        rep_string.movsb(dest.?, src.?, len);
+        return dest;
+    }
+
     copyForwards(dest.?, src.?, len);
 
     return dest;
@@ -227,3 +233,17 @@ test memcpyFast {
     if (builtin.zig_backend == .stage2_aarch64) return error.SkipZigTest;
     try testMemcpyImpl(memcpyFast);
 }
+test "memcpyFast at rep_string.threshold" {
+    if (builtin.zig_backend == .stage2_aarch64) return error.SkipZigTest;
+    var src: [rep_string.threshold + 64]u8 = undefined;
+    for (&src, 0..) |*b, i| b.* = @intCast(i % 251);
+    var dest: [src.len + 1]u8 = undefined;
+    for (rep_string.threshold - 1..rep_string.threshold + 2) |copy_len| {
+        for ([_]usize{ 0, 1 }) |offset| {
+            @memset(&dest, 0xff);
+            _ = memcpyFast(dest[offset..].ptr, src[0..].ptr, copy_len);
+            try std.testing.expectEqualSlices(u8, src[0..copy_len], dest[offset..][0..copy_len]);
+            try std.testing.expectEqual(0xff, dest[offset + copy_len]);
+        }
+    }
+}
@@ -3,6 +3,7 @@ const common = @import("./common.zig");
 const builtin = @import("builtin");
 const assert = std.debug.assert;
 const memcpy = @import("memcpy.zig");
+const rep_string = @import("rep_string.zig");
 
 const Element = common.PreferredLoadStoreElement;
 
@@ -47,6 +48,13 @@ fn memmoveFast(dest: ?[*]u8, src: ?[*]u8, len: usize) callconv(.c) ?[*]u8 {
     const dest_address = @intFromPtr(dest);
     const src_address = @intFromPtr(src);
 
+    // Overlapping copies would disable the fast microcode.
+    const distance = if (src_address < dest_address) dest_address - src_address else src_address - dest_address;
+    if (distance >= len and rep_string.wanted(len)) {
+        rep_string.movsb(dest.?, src.?, len);
+        return dest;
+    }
+
     if (src_address < dest_address) {
         copyBackwards(dest.?, src.?, len);
     } else {
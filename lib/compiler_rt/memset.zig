@@ -1,6 +1,7 @@
 const std = @import("std");
 const common = @import("./common.zig");
 const builtin = @import("builtin");
+const rep_string = @import("rep_string.zig");
 
 comptime {
     if (builtin.object_format != .c) {
@@ -12,6 +13,11 @@ comptime {
 pub fn memset(dest: ?[*]u8, c: u8, len: usize) callconv(.c) ?[*]u8 {
     @setRuntimeSafety(false);
 
+    if (rep_string.wanted(len)) {
+        rep_string.stosb(dest.?, c, len);
+        return dest;
+    }
+
     if (len != 0) {
         var d = dest.?;
         var n = len;
@@ -0,0 +1,92 @@
+//! `rep movsb` and `rep stosb` for large copies and fills on x86_64.
+//!
+//! On CPUs with Enhanced REP MOVSB/STOSB (ERMS), these instructions are implemented in microcode
+//! which moves whole cache lines and avoids read-for-ownership of the destination, outperforming
+//! vector loops once the length reaches a few KiB. Without ERMS they are much slower, so unless the
+//! target guarantees the feature, it is detected with `cpuid` the first time a large enough length
+//! is seen, allowing binaries built for a baseline CPU to benefit.
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+/// Lengths below this are handled by the vector loops, which have less startup overhead.
+pub const threshold = 2048;
+
+/// ReleaseSmall builds keep using the byte loops, like memcpy and memmove always have.
+const support: enum { none, always, runtime } = if (builtin.cpu.arch != .x86_64 or builtin.mode == .ReleaseSmall)
+    .none
+else if (builtin.cpu.has(.x86, .ermsb))
+    .always
+else
+    .runtime;
+
+/// 0 until probed, then 1 without ERMS, 2 with ERMS.
+var detected: std.atomic.Value(u8) = .init(0);
+
+/// Whether `len` bytes should be handled by `movsb` or `stosb`.
+pub inline fn wanted(len: usize) bool {
+    return switch (support) {
+        .none => false,
+        .always => len >= threshold,
+        .runtime => len >= threshold and hasErms(),
+    };
+}
+
+fn hasErms() bool {
+    const state = detected.load(.monotonic);
+    if (state != 0) return state == 2;
+    return probe();
+}
+
+fn probe() bool {
+    @branchHint(.cold);
+    const cpuid = std.zig.system.x86.cpuid;
+    const max_leaf = cpuid(0, 0).eax;
+    const erms = max_leaf >= 7 and cpuid(7, 0).ebx & (1 << 9) != 0;
+    // Racing threads store the same value.
+    detected.store(if (erms) 2 else 1, .monotonic);
+    return erms;
+}
+
+/// Copies `len` bytes forwards. The direction flag is clear on function entry per the ABI.
+pub inline fn movsb(dest: [*]u8, src: [*]const u8, len: usize) void {
+    var d = @intFromPtr(dest);
+    var s = @intFromPtr(src);
+    var n = len;
+    asm volatile ("rep movsb"
+        : [_] "={rdi}" (d),
+          [_] "={rsi}" (s),
+          [_] "={rcx}" (n),
+        : [_] "0" (d),
+          [_] "1" (s),
+          [_] "2" (n),
+        : .{ .memory = true });
+}
+
+pub inline fn stosb(dest: [*]u8, c: u8, len: usize) void {
+    var d = @intFromPtr(dest);
+    var n = len;
+    asm volatile ("rep stosb"
+        : [_] "={rdi}" (d),
+          [_] "={rcx}" (n),
+        : [_] "0" (d),
+          [_] "1" (n),
+          [_] "{al}" (c),
+        : .{ .memory = true });
+}
+
+test "movsb and stosb" {
+    if (support == .none) return error.SkipZigTest;
+    var src: [threshold + 67]u8 = undefined;
+    for (&src, 0..) |*b, i| b.* = @truncate(i *% 31);
+    var dest: [src.len + 2]u8 = @splat(0xaa);
+    movsb(dest[1..].ptr, src[0..].ptr, src.len);
+    try std.testing.expectEqualSlices(u8, &src, dest[1..][0..src.len]);
+    try std.testing.expectEqual(0xaa, dest[0]);
+    try std.testing.expectEqual(0xaa, dest[dest.len - 1]);
+
+    stosb(dest[1..].ptr, 0x5c, src.len);
+    for (dest[1..][0..src.len]) |b| try std.testing.expectEqual(0x5c, b);
+    try std.testing.expectEqual(0xaa, dest[0]);
+    try std.testing.expectEqual(0xaa, dest[dest.len - 1]);
+}
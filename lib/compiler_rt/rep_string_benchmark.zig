@@ -0,0 +1,186 @@
+// zig run -O ReleaseFast -fno-builtin --zig-lib-dir .. rep_string_benchmark.zig
+//
+// Compares `rep movsb` and `rep stosb` with vector loops like those of memcpy and memset, for
+// lengths around `rep_string.threshold` and beyond the cache sizes, and for source and destination
+// addresses at various offsets from a page boundary. `-fno-builtin` keeps the loops from being
+// turned back into calls to memcpy and memset.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const Timer = std.time.Timer;
+const common = @import("common.zig");
+const rep_string = @import("rep_string.zig");
+
+const KiB = 1024;
+const MiB = 1024 * KiB;
+
+const Element = common.PreferredLoadStoreElement;
+
+/// Offsets of the source and the destination from a page boundary. With equal offsets, the
+/// destination is at the same address as the source modulo 4 KiB, so loads may be falsely
+/// detected as depending on earlier stores (4K aliasing). `rep movsb` is known to slow down when
+/// the destination is slightly ahead of the source modulo 4 KiB, as in `.{ 4095, 0 }` and
+/// `.{ 0, 33 }`.
+const copy_offsets = [_][2]usize{
+    .{ 0, 0 },
+    .{ 1, 1 },
+    .{ 33, 33 },
+    .{ 0, 1 },
+    .{ 1, 0 },
+    .{ 7, 33 },
+    .{ 0, 33 },
+    .{ 33, 7 },
+    .{ 0, 4095 },
+    .{ 4095, 0 },
+};
+
+/// Offsets of the destination from a page boundary.
+const fill_offsets = [_]usize{ 0, 1, 7, 33, 4095 };
+
+comptime {
+    if (builtin.cpu.arch != .x86_64) @compileError("rep movsb and rep stosb are x86_64 only");
+}
+
+fn copyLoop(dest: [*]u8, src: [*]const u8, len: usize) void {
+    const d: [*]align(1) Element = @ptrCast(dest);
+    const s: [*]align(1) const Element = @ptrCast(src);
+    for (0..len / @sizeOf(Element)) |i| d[i] = s[i];
+}
+
+fn fillLoop(dest: [*]u8, c: u8, len: usize) void {
+    const d: [*]align(1) Element = @ptrCast(dest);
+    const v: Element = @bitCast(@as([@sizeOf(Element)]u8, @splat(c)));
+    for (0..len / @sizeOf(Element)) |i| d[i] = v;
+}
+
+fn copyMovsb(dest: [*]u8, src: [*]const u8, len: usize) void {
+    rep_string.movsb(dest, src, len);
+}
+
+fn fillStosb(dest: [*]u8, c: u8, len: usize) void {
+    rep_string.stosb(dest, c, len);
+}
+
+/// Returns the throughput in MiB/s of repeatedly copying `len` bytes.
+fn benchmarkCopy(comptime copy: anytype, dest: []u8, src: []const u8, len: usize, total: usize) !u64 {
+    const iterations = @max(total / len, 1);
+    var timer = try Timer.start();
+    for (0..iterations) |_| {
+        copy(dest.ptr, src.ptr, len);
+        std.mem.doNotOptimizeAway(dest[len - 1]);
+    }
+    return throughput(iterations * len, timer.read());
+}
+
+/// Returns the throughput in MiB/s of repeatedly filling `len` bytes.
+fn benchmarkFill(comptime fill: anytype, dest: []u8, len: usize, total: usize) !u64 {
+    const iterations = @max(total / len, 1);
+    var timer = try Timer.start();
+    for (0..iterations) |i| {
+        fill(dest.ptr, @truncate(i), len);
+        std.mem.doNotOptimizeAway(dest[len - 1]);
+    }
+    return throughput(iterations * len, timer.read());
+}
+
+fn throughput(bytes: usize, elapsed_ns: u64) u64 {
+    return @as(u64, bytes) * std.time.ns_per_s / @max(elapsed_ns, 1) / MiB;
+}
+
+pub fn main() !void {
+    var stdout_buffer: [0x100]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const stdout = &stdout_writer.interface;
+
+    var buffer: [1024]u8 = undefined;
+    var fixed = std.heap.FixedBufferAllocator.init(buffer[0..]);
+    const args = try std.process.argsAlloc(fixed.allocator());
+
+    var total: usize = 256 * MiB;
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        if (std.mem.eql(u8, args[i], "--total")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            total = try std.fmt.parseUnsigned(usize, args[i], 10) * MiB;
+        } else if (std.mem.eql(u8, args[i], "--help")) {
+            usage();
+            return;
+        } else {
+            usage();
+            std.process.exit(1);
+        }
+    }
+    if (total == 0) {
+        usage();
+        std.process.exit(1);
+    }
+
+    const sizes = [_]usize{
+        512,
+        1 * KiB,
+        rep_string.threshold / 2 + rep_string.threshold / 4,
+        rep_string.threshold,
+        rep_string.threshold + rep_string.threshold / 2,
+        4 * KiB,
+        16 * KiB,
+        256 * KiB,
+        4 * MiB,
+        64 * MiB,
+    };
+    const max_size = sizes[sizes.len - 1] + 4 * KiB;
+
+    const gpa = std.heap.page_allocator;
+    const src = try gpa.alloc(u8, max_size);
+    defer gpa.free(src);
+    const dest = try gpa.alloc(u8, max_size);
+    defer gpa.free(dest);
+    @memset(src, 0x5c);
+    @memset(dest, 0);
+
+    try stdout.print("{s: >10} {s: >8} {s: >8} {s: >14} {s: >14}\n", .{
+        "bytes", "src off", "dest off", "copy MiB/s", "movsb MiB/s",
+    });
+    try stdout.flush();
+    for (sizes) |len| {
+        for (copy_offsets) |offsets| {
+            const src_offset, const dest_offset = offsets;
+            const copy_loop = try benchmarkCopy(copyLoop, dest[dest_offset..], src[src_offset..], len, total);
+            const copy_movsb = try benchmarkCopy(copyMovsb, dest[dest_offset..], src[src_offset..], len, total);
+            try stdout.print("{d: >10} {d: >8} {d: >8} {d: >14} {d: >14}\n", .{
+                len, src_offset, dest_offset, copy_loop, copy_movsb,
+            });
+            try stdout.flush();
+        }
+    }
+
+    try stdout.print("\n{s: >10} {s: >8} {s: >14} {s: >14}\n", .{
+        "bytes", "dest off", "fill MiB/s", "stosb MiB/s",
+    });
+    try stdout.flush();
+    for (sizes) |len| {
+        for (fill_offsets) |dest_offset| {
+            const fill_loop = try benchmarkFill(fillLoop, dest[dest_offset..], len, total);
+            const fill_stosb = try benchmarkFill(fillStosb, dest[dest_offset..], len, total);
+            try stdout.print("{d: >10} {d: >8} {d: >14} {d: >14}\n", .{
+                len, dest_offset, fill_loop, fill_stosb,
+            });
+            try stdout.flush();
+        }
+    }
+}
+
+fn usage() void {
+    std.debug.print(
+        \\rep_string_benchmark [options]
+        \\
+        \\options:
+        \\ --total [int]  MiB processed per measurement
+        \\ --help
+        \\
+    , .{});
+}
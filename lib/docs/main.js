@@ -16,6 +16,10 @@
     const LOG_info = 2;
     const LOG_debug = 3;
 
+    const SEARCH_INDEX_none = 0;
+    const SEARCH_INDEX_loading = 1;
+    const SEARCH_INDEX_loaded = 2;
+
     const domDocTestsCode = document.getElementById("docTestsCode");
     const domFnErrorsAnyError = document.getElementById("fnErrorsAnyError");
     const domFnProto = document.getElementById("fnProto");
@@ -73,6 +77,7 @@
       viewSourceHash: null,
     };
     var curNavSearch = "";
+    var searchIndexState = SEARCH_INDEX_none;
     var curSearchIndex = -1;
     var imFeelingLucky = false;
 
@@ -833,6 +838,13 @@
     function renderSearch() {
         renderNav(curNav.decl);
 
+        if (searchIndexState !== SEARCH_INDEX_loaded) {
+          if (searchIndexState === SEARCH_INDEX_none) loadSearchIndex();
+          domStatus.textContent = "Loading search index...";
+          domStatus.classList.remove("hidden");
+          return;
+        }
+
         const ignoreCase = (curNavSearch.toLowerCase() === curNavSearch);
         const results = executeQuery(curNavSearch, ignoreCase);
 
@@ -855,6 +867,35 @@
         }
     }
 
+    // The search index lets the wasm module skip parsing files which cannot
+    // match a query. It is only downloaded once the user first searches.
+    function loadSearchIndex() {
+      searchIndexState = SEARCH_INDEX_loading;
+      const shard_promises = [];
+      const shard_count = wasm_exports.search_index_shard_count();
+      for (let i = 0; i < shard_count; i += 1) {
+        shard_promises.push(fetch("search/" + i + ".bin").then(function(response) {
+          // Files without an index entry are parsed for every search instead.
+          if (!response.ok) return null;
+          return response.arrayBuffer();
+        }).catch(function() {
+          return null;
+        }));
+      }
+      Promise.all(shard_promises).then(function(buffers) {
+        for (const buffer of buffers) {
+          if (buffer == null) continue;
+          const js_array = new Uint8Array(buffer);
+          const ptr = wasm_exports.alloc(js_array.length);
+          const wasm_array = new Uint8Array(wasm_exports.memory.buffer, ptr, js_array.length);
+          wasm_array.set(js_array);
+          wasm_exports.search_index_add(ptr, js_array.length);
+        }
+        searchIndexState = SEARCH_INDEX_loaded;
+        if (curNavSearch !== "") render();
+      });
+    }
+
     function renderSearchCursor() {
         for (let i = 0; i < domListSearchResults.children.length; i += 1) {
             var liDom = domListSearchResults.children[i];
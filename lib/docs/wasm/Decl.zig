@@ -24,7 +24,7 @@ pub const Index = enum(u32) {
     _,
 
     pub fn get(i: Index) *Decl {
-        return &Walk.decls.items[@intFromEnum(i)];
+        return Walk.decls.items[@intFromEnum(i)];
     }
 };
 
@@ -128,7 +128,7 @@ pub fn get_child(decl: *const Decl, name: []const u8) ?Decl.Index {
         },
         .type_function => {
             // Find a decl with this function as the parent, with a name matching `name`
-            for (Walk.decls.items, 0..) |*candidate, i| {
+            for (Walk.decls.items, 0..) |candidate, i| {
                 if (candidate.parent != .none and candidate.parent.get() == decl and std.mem.eql(u8, candidate.extra_info().name, name)) {
                     return @enumFromInt(i);
                 }
@@ -206,29 +206,7 @@ pub fn reset_with_path(decl: *const Decl, list: *ArrayList(u8)) Oom!void {
 }
 
 pub fn append_path(decl: *const Decl, list: *ArrayList(u8)) Oom!void {
-    const start = list.items.len;
-    // Prefer the module name alias.
-    for (Walk.modules.keys(), Walk.modules.values()) |pkg_name, pkg_file| {
-        if (pkg_file == decl.file) {
-            try list.ensureUnusedCapacity(gpa, pkg_name.len + 1);
-            list.appendSliceAssumeCapacity(pkg_name);
-            list.appendAssumeCapacity('.');
-            return;
-        }
-    }
-
-    const file_path = decl.file.path();
-    try list.ensureUnusedCapacity(gpa, file_path.len + 1);
-    list.appendSliceAssumeCapacity(file_path);
-    for (list.items[start..]) |*byte| switch (byte.*) {
-        '/' => byte.* = '.',
-        else => continue,
-    };
-    if (std.mem.endsWith(u8, list.items, ".zig")) {
-        list.items.len -= 3;
-    } else {
-        list.appendAssumeCapacity('.');
-    }
+    return decl.file.append_path(list);
 }
 
 pub fn append_parent_ns(list: *ArrayList(u8), parent: Decl.Index) Oom!void {
@@ -10,8 +10,11 @@ const Oom = error{OutOfMemory};
 
 pub const Decl = @import("Decl.zig");
 
+/// All files are added before any is walked, so pointers to elements are stable.
 pub var files: std.StringArrayHashMapUnmanaged(File) = .empty;
-pub var decls: std.ArrayList(Decl) = .empty;
+/// Files are walked on demand while pointers to decls of other files may be
+/// held, so each decl is allocated separately.
+pub var decls: std.ArrayList(*Decl) = .empty;
 pub var modules: std.StringArrayHashMapUnmanaged(File.Index) = .empty;
 
 file: File.Index,
@@ -40,7 +43,10 @@ pub const Category = union(enum(u8)) {
 };
 
 pub const File = struct {
-    ast: Ast,
+    /// The source bytes until the file is first accessed, at which point it
+    /// is parsed and walked. See `Index.get`.
+    source: ?[]u8,
+    ast: Ast = undefined,
     /// Maps identifiers to the declarations they point to.
     ident_decls: std.AutoArrayHashMapUnmanaged(Ast.TokenIndex, Ast.Node.Index) = .empty,
     /// Maps field access identifiers to the containing field access node.
@@ -63,18 +69,29 @@ pub const File = struct {
         _,
 
         fn add_decl(i: Index, node: Ast.Node.Index, parent_decl: Decl.Index) Oom!Decl.Index {
-            try decls.append(gpa, .{
+            const decl = try gpa.create(Decl);
+            decl.* = .{
                 .ast_node = node,
                 .file = i,
                 .parent = parent_decl,
-            });
+            };
+            try decls.append(gpa, decl);
             const decl_index: Decl.Index = @enumFromInt(decls.items.len - 1);
             try i.get().node_decls.put(gpa, node, decl_index);
             return decl_index;
         }
 
         pub fn get(i: File.Index) *File {
-            return &files.values()[@intFromEnum(i)];
+            const file = &files.values()[@intFromEnum(i)];
+            if (file.source) |source| {
+                file.source = null;
+                walk_file(i, file, source) catch @panic("OOM");
+            }
+            return file;
+        }
+
+        pub fn is_walked(i: File.Index) bool {
+            return files.values()[@intFromEnum(i)].source == null;
         }
 
         pub fn get_ast(i: File.Index) *Ast {
@@ -85,6 +102,34 @@ pub const File = struct {
             return files.keys()[@intFromEnum(i)];
         }
 
+        /// Appends the prefix of the fully qualified names of decls in the
+        /// file, including the trailing '.'.
+        pub fn append_path(i: File.Index, list: *std.ArrayList(u8)) Oom!void {
+            const start = list.items.len;
+            // Prefer the module name alias.
+            for (modules.keys(), modules.values()) |pkg_name, pkg_file| {
+                if (pkg_file == i) {
+                    try list.ensureUnusedCapacity(gpa, pkg_name.len + 1);
+                    list.appendSliceAssumeCapacity(pkg_name);
+                    list.appendAssumeCapacity('.');
+                    return;
+                }
+            }
+
+            const file_path = i.path();
+            try list.ensureUnusedCapacity(gpa, file_path.len + 1);
+            list.appendSliceAssumeCapacity(file_path);
+            for (list.items[start..]) |*byte| switch (byte.*) {
+                '/' => byte.* = '.',
+                else => continue,
+            };
+            if (std.mem.endsWith(u8, list.items, ".zig")) {
+                list.items.len -= 3;
+            } else {
+                list.appendAssumeCapacity('.');
+            }
+        }
+
         pub fn findRootDecl(file_index: File.Index) Decl.Index {
             return file_index.get().node_decls.values()[0];
         }
@@ -385,11 +430,18 @@ pub const ModuleIndex = enum(u32) {
     _,
 };
 
+/// The file is only parsed and walked once it is accessed, so that loading
+/// the documentation does not require parsing every file.
 pub fn add_file(file_name: []const u8, bytes: []u8) !File.Index {
-    const ast = try parse(file_name, bytes);
-    assert(ast.errors.len == 0);
     const file_index: File.Index = @enumFromInt(files.entries.len);
-    try files.put(gpa, file_name, .{ .ast = ast });
+    try files.put(gpa, file_name, .{ .source = bytes });
+    return file_index;
+}
+
+fn walk_file(file_index: File.Index, file: *File, bytes: []u8) Oom!void {
+    const ast = try parse(file_index.path(), bytes);
+    assert(ast.errors.len == 0);
+    file.ast = ast;
 
     var w: Walk = .{
         .file = file_index,
@@ -400,14 +452,11 @@ pub fn add_file(file_name: []const u8, bytes: []u8) !File.Index {
     const decl_index = try file_index.add_decl(.root, .none);
     try struct_decl(&w, scope, decl_index, .root, ast.containerDeclRoot());
 
-    const file = file_index.get();
     shrinkToFit(&file.ident_decls);
     shrinkToFit(&file.token_parents);
     shrinkToFit(&file.node_decls);
     shrinkToFit(&file.doctests);
     shrinkToFit(&file.scopes);
-
-    return file_index;
 }
 
 /// Parses a file and returns its `Ast`. If the file cannot be parsed, returns
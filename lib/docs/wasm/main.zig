@@ -5,6 +5,7 @@ const Ast = std.zig.Ast;
 const Walk = @import("Walk");
 const markdown = @import("markdown.zig");
 const Decl = Walk.Decl;
+const docs_index = std.zig.docs_index;
 const ArrayList = std.ArrayList;
 const Writer = std.Io.Writer;
 
@@ -68,6 +69,25 @@ export fn unpack(tar_ptr: [*]u8, tar_len: usize) void {
     };
 }
 
+/// The number of search index shards to be passed to `search_index_add`.
+export fn search_index_shard_count() usize {
+    return docs_index.shardCount(Walk.files.count());
+}
+
+/// Indexed by `Walk.File.Index`. Files without a record are walked for every
+/// search.
+var search_index: ArrayList(?docs_index.Record) = .empty;
+
+/// Takes ownership of a shard of the search index, allocated with `alloc`.
+export fn search_index_add(shard_ptr: [*]u8, shard_len: usize) void {
+    search_index.appendNTimes(gpa, null, Walk.files.count() - search_index.items.len) catch @panic("OOM");
+    var it: docs_index.Iterator = .{ .bytes = shard_ptr[0..shard_len] };
+    while (it.next()) |record| {
+        const file_index = Walk.files.getIndex(record.path) orelse continue;
+        search_index.items[file_index] = record;
+    }
+}
+
 var query_string: ArrayList(u8) = .empty;
 var query_results: ArrayList(Decl.Index) = .empty;
 
@@ -113,7 +133,17 @@ fn query_exec_fallible(query: []const u8, ignore_case: bool) !void {
     // Corresponding point value is meaningless and therefore undefined.
     try g.scores.resize(gpa, 1);
 
-    decl_loop: for (Walk.decls.items, 0..) |*decl, decl_index| {
+    // Only the decls of walked files are searched, so walk all files which
+    // may contain a match.
+    for (0..Walk.files.count()) |i| {
+        const file: Walk.File.Index = @enumFromInt(i);
+        if (file.is_walked()) continue;
+        const record = if (i < search_index.items.len) search_index.items[i] else null;
+        if (record != null and !docs_index.mayMatch(record.?, query)) continue;
+        _ = file.get();
+    }
+
+    decl_loop: for (Walk.decls.items, 0..) |decl, decl_index| {
         const info = decl.extra_info();
         if (!info.is_pub) continue;
 
@@ -857,7 +887,15 @@ export fn find_decl() Decl.Index {
     const g = struct {
         var match_fqn: ArrayList(u8) = .empty;
     };
-    for (Walk.decls.items, 0..) |*decl, decl_index| {
+    for (0..Walk.files.count()) |i| {
+        const file: Walk.File.Index = @enumFromInt(i);
+        if (file.is_walked()) continue;
+        g.match_fqn.clearRetainingCapacity();
+        file.append_path(&g.match_fqn) catch @panic("OOM");
+        const prefix = g.match_fqn.items[0 .. g.match_fqn.items.len - 1];
+        if (std.mem.startsWith(u8, input_string.items, prefix)) _ = file.get();
+    }
+    for (Walk.decls.items, 0..) |decl, decl_index| {
         g.match_fqn.clearRetainingCapacity();
         decl.fqn(&g.match_fqn) catch @panic("OOM");
         if (std.mem.eql(u8, g.match_fqn.items, input_string.items)) {
@@ -916,7 +954,7 @@ export fn namespace_members(parent: Decl.Index, include_private: bool) Slice(Dec
 
     g.members.clearRetainingCapacity();
 
-    for (Walk.decls.items, 0..) |*decl, i| {
+    for (Walk.decls.items, 0..) |decl, i| {
         if (decl.parent == parent) {
             if (include_private or decl.is_pub()) {
                 g.members.append(gpa, @enumFromInt(i)) catch @panic("OOM");
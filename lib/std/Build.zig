@@ -22,6 +22,8 @@ pub const Cache = @import("Build/Cache.zig");
 pub const Step = @import("Build/Step.zig");
 pub const Module = @import("Build/Module.zig");
 pub const Watch = @import("Build/Watch.zig");
+pub const Daemon = @import("Build/Daemon.zig");
+pub const Trace = @import("Build/Trace.zig");
 pub const Fuzz = @import("Build/Fuzz.zig");
 pub const WebServer = @import("Build/WebServer.zig");
 pub const abi = @import("Build/abi.zig");
@@ -123,6 +125,9 @@ pub const Graph = struct {
     global_cache_root: Cache.Directory,
     zig_lib_directory: Cache.Directory,
     needed_lazy_dependencies: std.StringArrayHashMapUnmanaged(void) = .empty,
+    /// Lazy dependencies which have not been fetched, each of which is only
+    /// needed if the step it is paired with is run. See `lazyDependencyForStep`.
+    step_lazy_dependencies: std.ArrayList(struct { *Step, []const u8 }) = .empty,
     /// Information about the native target. Computed before build() is invoked.
     host: ResolvedTarget,
     incremental: ?bool = null,
@@ -130,6 +135,10 @@ pub const Graph = struct {
     dependency_cache: InitializedDepMap = .empty,
     allow_so_scripts: ?bool = null,
     time_report: bool,
+    /// Set by the build runner with `--mem-report`. See `Step.Compile.mem_report`.
+    mem_report: bool = false,
+    /// Set by the build runner with `--trace`.
+    trace: ?*Trace = null,
 };
 
 const AvailableDeps = []const struct { []const u8, []const u8 };
@@ -776,6 +785,7 @@ pub const ExecutableOptions = struct {
     version: ?std.SemanticVersion = null,
     linkage: ?std.builtin.LinkMode = null,
     max_rss: usize = 0,
+    cpu_weight: u32 = 1,
     use_llvm: ?bool = null,
     use_lld: ?bool = null,
     zig_lib_dir: ?LazyPath = null,
@@ -795,6 +805,7 @@ pub fn addExecutable(b: *Build, options: ExecutableOptions) *Step.Compile {
         .kind = .exe,
         .linkage = options.linkage,
         .max_rss = options.max_rss,
+        .cpu_weight = options.cpu_weight,
         .use_llvm = options.use_llvm,
         .use_lld = options.use_lld,
         .zig_lib_dir = options.zig_lib_dir,
@@ -806,6 +817,7 @@ pub const ObjectOptions = struct {
     name: []const u8,
     root_module: *Module,
     max_rss: usize = 0,
+    cpu_weight: u32 = 1,
     use_llvm: ?bool = null,
     use_lld: ?bool = null,
     zig_lib_dir: ?LazyPath = null,
@@ -817,6 +829,7 @@ pub fn addObject(b: *Build, options: ObjectOptions) *Step.Compile {
         .root_module = options.root_module,
         .kind = .obj,
         .max_rss = options.max_rss,
+        .cpu_weight = options.cpu_weight,
         .use_llvm = options.use_llvm,
         .use_lld = options.use_lld,
         .zig_lib_dir = options.zig_lib_dir,
@@ -829,6 +842,7 @@ pub const LibraryOptions = struct {
     root_module: *Module,
     version: ?std.SemanticVersion = null,
     max_rss: usize = 0,
+    cpu_weight: u32 = 1,
     use_llvm: ?bool = null,
     use_lld: ?bool = null,
     zig_lib_dir: ?LazyPath = null,
@@ -848,6 +862,7 @@ pub fn addLibrary(b: *Build, options: LibraryOptions) *Step.Compile {
         .linkage = options.linkage,
         .version = options.version,
         .max_rss = options.max_rss,
+        .cpu_weight = options.cpu_weight,
         .use_llvm = options.use_llvm,
         .use_lld = options.use_lld,
         .zig_lib_dir = options.zig_lib_dir,
@@ -859,6 +874,7 @@ pub const TestOptions = struct {
     name: []const u8 = "test",
     root_module: *Module,
     max_rss: usize = 0,
+    cpu_weight: u32 = 1,
     filters: []const []const u8 = &.{},
     test_runner: ?Step.Compile.TestRunner = null,
     use_llvm: ?bool = null,
@@ -884,6 +900,7 @@ pub fn addTest(b: *Build, options: TestOptions) *Step.Compile {
         .kind = if (options.emit_object) .test_obj else .@"test",
         .root_module = options.root_module,
         .max_rss = options.max_rss,
+        .cpu_weight = options.cpu_weight,
         .filters = b.dupeStrings(options.filters),
         .test_runner = options.test_runner,
         .use_llvm = options.use_llvm,
@@ -2004,6 +2021,29 @@ fn markNeededLazyDep(b: *Build, pkg_hash: []const u8) void {
 /// it will never return `null`. This allows toggling laziness via
 /// build.zig.zon without changing build.zig logic.
 pub fn lazyDependency(b: *Build, name: []const u8, args: anytype) ?*Dependency {
+    return lazyDependencyInner(b, null, name, args);
+}
+
+/// Like `lazyDependency`, except that the dependency is only required when
+/// `needed_by` is run. If the dependency was not fetched, this returns `null`
+/// and configuring the build proceeds as usual. Only if `needed_by` is then
+/// among the steps selected to run, or one of their dependencies, the parent
+/// process fetches the dependency, rebuilds the build script, and runs it
+/// again. Otherwise, the build runs without ever fetching it.
+///
+/// This allows large optional dependencies, such as an SDK that only one
+/// step uses, to not be fetched by builds which do not need them. `zig build
+/// --help` and `zig build --list-steps` never fetch such dependencies.
+///
+/// The step must be named by the caller. It cannot be derived from the steps
+/// which use the dependency's artifacts, since those only exist once the
+/// dependency is fetched and its build script has run. Dependencies not marked
+/// `.lazy` in build.zig.zon are still fetched before the build script runs.
+pub fn lazyDependencyForStep(b: *Build, needed_by: *Step, name: []const u8, args: anytype) ?*Dependency {
+    return lazyDependencyInner(b, needed_by, name, args);
+}
+
+fn lazyDependencyInner(b: *Build, needed_by: ?*Step, name: []const u8, args: anytype) ?*Dependency {
     const build_runner = @import("root");
     const deps = build_runner.dependencies;
     const pkg_hash = findPkgHashOrFatal(b, name);
@@ -2013,7 +2053,11 @@ pub fn lazyDependency(b: *Build, name: []const u8, args: anytype) ?*Dependency {
             const pkg = @field(deps.packages, decl.name);
             const available = !@hasDecl(pkg, "available") or pkg.available;
             if (!available) {
-                markNeededLazyDep(b, pkg_hash);
+                if (needed_by) |s| {
+                    b.graph.step_lazy_dependencies.append(b.graph.arena, .{ s, pkg_hash }) catch @panic("OOM");
+                } else {
+                    markNeededLazyDep(b, pkg_hash);
+                }
                 return null;
             }
             return dependencyInner(b, name, pkg.build_root, if (@hasDecl(pkg, "build_zig")) pkg.build_zig else null, pkg_hash, pkg.deps, args);
@@ -2717,5 +2761,7 @@ pub fn systemIntegrationOption(
 
 test {
     _ = Cache;
+    _ = Daemon;
     _ = Step;
+    _ = Trace;
 }
@@ -0,0 +1,395 @@
+//! A resident build runner, started with `zig build --daemon`, which keeps the configured step
+//! graph, the file system watch state and the compiler processes of one project between builds.
+//!
+//! Later `zig build` invocations connect to it through a Unix domain socket in the local cache
+//! directory once they have the build runner executable, instead of running it. The client sends
+//! a request describing the build, along with its stdin, stdout and stderr as `SCM_RIGHTS`
+//! ancillary data. If the request matches the configuration of the daemon, the daemon runs the
+//! build with those as its standard streams and replies with the exit code. Otherwise the client
+//! runs the build runner itself.
+//!
+//! The daemon stays in the foreground of the terminal which started it, where it logs errors;
+//! use the shell to run it in the background. Only processes of the same user are served.
+//!
+//! A request is the little-endian `u32` length of the rest, followed by the working directory,
+//! the arguments of the build runner, an empty string, and the environment variables as
+//! `KEY=VALUE`, each terminated by a zero byte.
+
+const builtin = @import("builtin");
+const std = @import("../std.zig");
+const Io = std.Io;
+const posix = std.posix;
+const mem = std.mem;
+const Allocator = std.mem.Allocator;
+const EnvMap = std.process.EnvMap;
+const Daemon = @This();
+
+server: Io.net.Server,
+socket_path: []const u8,
+/// Duplicates of the standard streams of the daemon, restored after each request.
+own_stdio: [3]posix.fd_t,
+
+/// Passing file descriptors is only implemented for Linux so far.
+pub const have_impl = std.Build.Watch.have_impl and builtin.os.tag == .linux;
+
+const socket_basename = "daemon";
+const max_request_len = 16 * 1024 * 1024;
+
+pub const Reply = extern struct {
+    status: Status,
+    /// Only meaningful with `Status.exited`.
+    exit_code: u8,
+
+    pub const Status = enum(u8) {
+        /// The build ran, with the given exit code.
+        exited,
+        /// The daemon was started with other arguments, environment or working directory.
+        mismatch,
+        /// The build runner executable changed, which means that the build scripts or the compiler
+        /// changed since the daemon started. The daemon exits.
+        stale,
+        _,
+    };
+};
+
+const Rights = extern struct {
+    header: posix.system.cmsghdr,
+    fds: [3]posix.fd_t,
+
+    const len = @offsetOf(Rights, "fds") + @sizeOf([3]posix.fd_t);
+
+    /// Closes the file descriptors of a malformed `SCM_RIGHTS` message, such as one with fewer
+    /// than three, which the kernel installed in this process regardless.
+    fn closeReceived(rights: *const Rights, controllen: usize) void {
+        const fds_offset = @offsetOf(Rights, "fds");
+        if (controllen < fds_offset) return;
+        if (rights.header.level != posix.SOL.SOCKET or rights.header.type != posix.SCM.RIGHTS) return;
+        const received_len = @min(rights.header.len, controllen);
+        if (received_len < fds_offset) return;
+        const count = @min((received_len - fds_offset) / @sizeOf(posix.fd_t), rights.fds.len);
+        for (rights.fds[0..count]) |fd| posix.close(fd);
+    }
+};
+
+/// `struct ucred`, as returned by `SO_PEERCRED`.
+const PeerCredentials = extern struct {
+    pid: posix.pid_t,
+    uid: posix.uid_t,
+    gid: posix.gid_t,
+};
+
+/// Returns `null` if the path does not fit in a Unix domain socket address.
+fn socketPath(arena: Allocator, cache_root: []const u8) Allocator.Error!?[]const u8 {
+    const path = try std.fs.path.join(arena, &.{ cache_root, socket_basename });
+    if (path.len > Io.net.UnixAddress.max_len) return null;
+    return path;
+}
+
+/// Returns the number of arguments at the start of `args` which need not match between a
+/// request and the daemon: the random seed, the temporary file nonce and `--daemon` itself.
+fn ignoredArgsLen(args: []const []const u8) usize {
+    const arg = args[0];
+    if (mem.eql(u8, arg, "--seed")) return @min(2, args.len);
+    if (mem.startsWith(u8, arg, "-Z")) return 1;
+    if (mem.eql(u8, arg, "--daemon")) return 1;
+    return 0;
+}
+
+/// The arguments of the build runner which determine the build. Arguments after `--` are passed
+/// to the build script, and kept verbatim.
+fn configurationArgs(arena: Allocator, args: []const []const u8) Allocator.Error![]const []const u8 {
+    var result: std.ArrayList([]const u8) = try .initCapacity(arena, args.len);
+    var i: usize = 0;
+    while (i < args.len) {
+        if (mem.eql(u8, args[i], "--")) {
+            result.appendSliceAssumeCapacity(args[i..]);
+            break;
+        }
+        const skip = ignoredArgsLen(args[i..]);
+        if (skip == 0) {
+            result.appendAssumeCapacity(args[i]);
+            i += 1;
+        } else {
+            i += skip;
+        }
+    }
+    return result.items;
+}
+
+fn stringsEql(a: []const []const u8, b: []const []const u8) bool {
+    if (a.len != b.len) return false;
+    for (a, b) |a_str, b_str| {
+        if (!mem.eql(u8, a_str, b_str)) return false;
+    }
+    return true;
+}
+
+/// Environment variables which need not match between a request and the daemon. Shells set `_`
+/// to the path of the program they run, and `SHLVL` to their nesting depth.
+const ignored_env_vars: []const []const u8 = &.{ "_", "SHLVL" };
+
+fn envMapsEql(a: *const EnvMap, b: *const EnvMap) bool {
+    if (envVarsLen(a) != envVarsLen(b)) return false;
+    var it = a.iterator();
+    while (it.next()) |entry| {
+        if (isIgnoredEnvVar(entry.key_ptr.*)) continue;
+        const b_value = b.get(entry.key_ptr.*) orelse return false;
+        if (!mem.eql(u8, entry.value_ptr.*, b_value)) return false;
+    }
+    return true;
+}
+
+fn envVarsLen(env_map: *const EnvMap) usize {
+    var len = env_map.count();
+    for (ignored_env_vars) |name| {
+        if (env_map.get(name) != null) len -= 1;
+    }
+    return len;
+}
+
+fn isIgnoredEnvVar(name: []const u8) bool {
+    for (ignored_env_vars) |ignored| {
+        if (mem.eql(u8, name, ignored)) return true;
+    }
+    return false;
+}
+
+/// Runs the build in the daemon for `cache_root`, if there is one and it was started with the
+/// same `args`, environment and working directory. `args` starts with the path of the build
+/// runner. Returns the exit code of the build, or `null` if the caller needs to run the build
+/// runner itself.
+pub fn request(
+    io: Io,
+    arena: Allocator,
+    cache_root: []const u8,
+    args: []const []const u8,
+    env_map: *const EnvMap,
+) ?u8 {
+    if (!have_impl) return null;
+    const path = (socketPath(arena, cache_root) catch return null) orelse return null;
+    const address = Io.net.UnixAddress.init(path) catch return null;
+    const stream = address.connect(io) catch return null;
+    defer stream.close(io);
+
+    const bytes = serializeRequest(arena, args, env_map) catch return null;
+    sendWithStdio(stream.socket.handle, bytes) catch return null;
+
+    var reply: Reply = undefined;
+    var reader = stream.reader(io, &.{});
+    reader.interface.readSliceAll(mem.asBytes(&reply)) catch return null;
+    return switch (reply.status) {
+        .exited => reply.exit_code,
+        .mismatch, .stale, _ => null,
+    };
+}
+
+fn serializeRequest(arena: Allocator, args: []const []const u8, env_map: *const EnvMap) ![]const u8 {
+    var bytes: std.ArrayList(u8) = .empty;
+    try bytes.appendNTimes(arena, 0, 4);
+    try bytes.appendSlice(arena, try std.process.getCwdAlloc(arena));
+    try bytes.append(arena, 0);
+    for (args) |arg| {
+        try bytes.appendSlice(arena, arg);
+        try bytes.append(arena, 0);
+    }
+    try bytes.append(arena, 0);
+    var it = env_map.iterator();
+    while (it.next()) |entry| {
+        try bytes.print(arena, "{s}={s}\x00", .{ entry.key_ptr.*, entry.value_ptr.* });
+    }
+    const len = bytes.items.len - 4;
+    if (len > max_request_len) return error.RequestTooLarge;
+    mem.writeInt(u32, bytes.items[0..4], @intCast(len), .little);
+    return bytes.items;
+}
+
+fn sendWithStdio(fd: posix.socket_t, bytes: []const u8) !void {
+    const rights: Rights = .{
+        .header = .{
+            .len = Rights.len,
+            .level = posix.SOL.SOCKET,
+            .type = posix.SCM.RIGHTS,
+        },
+        .fds = .{ posix.STDIN_FILENO, posix.STDOUT_FILENO, posix.STDERR_FILENO },
+    };
+    const iov: [1]posix.iovec_const = .{.{ .base = bytes.ptr, .len = bytes.len }};
+    const msg: posix.msghdr_const = .{
+        .name = null,
+        .namelen = 0,
+        .iov = &iov,
+        .iovlen = iov.len,
+        .control = &rights,
+        .controllen = @sizeOf(Rights),
+        .flags = 0,
+    };
+    var sent = try posix.sendmsg(fd, &msg, 0);
+    while (sent < bytes.len) sent += try posix.send(fd, bytes[sent..], 0);
+}
+
+/// Starts listening for requests for `cache_root`.
+pub fn init(io: Io, arena: Allocator, cache_root: []const u8) !Daemon {
+    const path = try socketPath(arena, cache_root) orelse return error.NameTooLong;
+    const address = Io.net.UnixAddress.init(path) catch unreachable;
+    if (address.connect(io)) |stream| {
+        stream.close(io);
+        return error.AlreadyRunning;
+    } else |_| {
+        // A daemon which did not exit cleanly leaves the socket file behind.
+        std.fs.cwd().deleteFile(path) catch {};
+    }
+
+    var own_stdio: [3]posix.fd_t = undefined;
+    for (&own_stdio, 0..) |*fd, i| fd.* = try posix.dup(@intCast(i));
+
+    return .{
+        .server = try address.listen(io, .{}),
+        .socket_path = path,
+        .own_stdio = own_stdio,
+    };
+}
+
+pub fn deinit(d: *Daemon, io: Io) void {
+    d.server.deinit(io);
+    std.fs.cwd().deleteFile(d.socket_path) catch {};
+    for (d.own_stdio) |fd| posix.close(fd);
+    d.* = undefined;
+}
+
+pub const Request = struct {
+    stream: Io.net.Stream,
+    stdio: [3]posix.fd_t,
+    cwd: []const u8,
+    args: []const []const u8,
+    env_map: EnvMap,
+
+    /// Compares the request with the configuration of the daemon. `args` starts with the path of
+    /// the build runner.
+    pub fn check(
+        req: *const Request,
+        arena: Allocator,
+        args: []const []const u8,
+        env_map: *const EnvMap,
+    ) Allocator.Error!Reply.Status {
+        if (req.args.len == 0 or !mem.eql(u8, req.args[0], args[0])) return .stale;
+        const cwd = std.process.getCwdAlloc(arena) catch return .mismatch;
+        if (!mem.eql(u8, req.cwd, cwd)) return .mismatch;
+        const req_config = try configurationArgs(arena, req.args[1..]);
+        const config = try configurationArgs(arena, args[1..]);
+        if (!stringsEql(req_config, config)) return .mismatch;
+        if (!envMapsEql(&req.env_map, env_map)) return .mismatch;
+        return .exited;
+    }
+
+    /// Makes the standard streams of the request those of the daemon, until `Daemon.finish`.
+    pub fn redirect(req: *const Request) !void {
+        for (req.stdio, 0..) |fd, i| try posix.dup2(fd, @intCast(i));
+    }
+};
+
+/// Waits for the next request. The file descriptors of the request belong to the caller, who
+/// must pass it to `finish`.
+pub fn accept(d: *Daemon, io: Io, arena: Allocator) !Request {
+    const stream = try d.server.accept(io);
+    errdefer stream.close(io);
+
+    // The build runs with the privileges of the daemon, so other users must not request one, even
+    // if the permissions of the cache directory let them connect.
+    var peer: PeerCredentials = undefined;
+    try posix.getsockopt(stream.socket.handle, posix.SOL.SOCKET, posix.SO.PEERCRED, mem.asBytes(&peer));
+    if (peer.uid != posix.geteuid()) return error.AccessDenied;
+
+    var len_bytes: [4]u8 = undefined;
+    var rights: Rights = undefined;
+    var iov: [1]posix.iovec = .{.{ .base = &len_bytes, .len = len_bytes.len }};
+    var msg: posix.msghdr = .{
+        .name = null,
+        .namelen = 0,
+        .iov = &iov,
+        .iovlen = iov.len,
+        .control = &rights,
+        .controllen = @sizeOf(Rights),
+        .flags = 0,
+    };
+    const received = try posix.recvmsg(stream.socket.handle, &msg, posix.MSG.CMSG_CLOEXEC | posix.MSG.WAITALL);
+    if (msg.controllen < Rights.len or
+        rights.header.level != posix.SOL.SOCKET or
+        rights.header.type != posix.SCM.RIGHTS or
+        rights.header.len != Rights.len)
+    {
+        rights.closeReceived(msg.controllen);
+        return error.InvalidRequest;
+    }
+    const stdio = rights.fds;
+    errdefer for (stdio) |fd| posix.close(fd);
+    if (received != len_bytes.len) return error.InvalidRequest;
+
+    const len = mem.readInt(u32, &len_bytes, .little);
+    if (len > max_request_len) return error.InvalidRequest;
+    const bytes = try arena.alloc(u8, len);
+    var reader = stream.reader(io, &.{});
+    reader.interface.readSliceAll(bytes) catch return error.InvalidRequest;
+    if (len == 0 or bytes[len - 1] != 0) return error.InvalidRequest;
+
+    var it = mem.splitScalar(u8, bytes[0 .. len - 1], 0);
+    const cwd = it.next().?;
+    var args: std.ArrayList([]const u8) = .empty;
+    while (it.next()) |arg| {
+        if (arg.len == 0) break;
+        try args.append(arena, arg);
+    }
+    var env_map: EnvMap = .init(arena);
+    while (it.next()) |pair| {
+        const eq = mem.indexOfScalar(u8, pair, '=') orelse return error.InvalidRequest;
+        try env_map.put(pair[0..eq], pair[eq + 1 ..]);
+    }
+
+    return .{
+        .stream = stream,
+        .stdio = stdio,
+        .cwd = cwd,
+        .args = args.items,
+        .env_map = env_map,
+    };
+}
+
+/// Restores the standard streams of the daemon, sends `reply` and closes the connection.
+pub fn finish(d: *Daemon, io: Io, req: *Request, reply: Reply) void {
+    for (d.own_stdio, 0..) |fd, i| posix.dup2(fd, @intCast(i)) catch {};
+    for (req.stdio) |fd| posix.close(fd);
+    var writer = req.stream.writer(io, &.{});
+    writer.interface.writeAll(mem.asBytes(&reply)) catch {};
+    req.stream.close(io);
+}
+
+test envMapsEql {
+    var a: EnvMap = .init(std.testing.allocator);
+    defer a.deinit();
+    var b: EnvMap = .init(std.testing.allocator);
+    defer b.deinit();
+    try a.put("PATH", "/bin");
+    try a.put("_", "/usr/bin/timeout");
+    try b.put("PATH", "/bin");
+    try std.testing.expect(envMapsEql(&a, &b));
+    try b.put("_", "/usr/bin/zig");
+    try std.testing.expect(envMapsEql(&a, &b));
+    try b.put("CC", "gcc");
+    try std.testing.expect(!envMapsEql(&a, &b));
+}
+
+test configurationArgs {
+    var arena_instance: std.heap.ArenaAllocator = .init(std.testing.allocator);
+    defer arena_instance.deinit();
+    const arena = arena_instance.allocator();
+
+    const daemon_args = try configurationArgs(arena, &.{
+        "zig", "--seed", "0x1", "-Zabcd", "--daemon", "test", "-Doptimize=ReleaseFast", "--", "--daemon",
+    });
+    const client_args = try configurationArgs(arena, &.{
+        "zig", "--seed", "0x2", "-Zef01", "test", "-Doptimize=ReleaseFast", "--", "--daemon",
+    });
+    try std.testing.expect(stringsEql(daemon_args, client_args));
+    try std.testing.expectEqual(5, client_args.len);
+
+    const other_args = try configurationArgs(arena, &.{ "zig", "--seed", "0x2", "-Zef01", "test" });
+    try std.testing.expect(!stringsEql(daemon_args, other_args));
+}
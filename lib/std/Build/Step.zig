@@ -50,6 +50,14 @@ state: State,
 /// runner. This value is configurable on the command line, and defaults to the
 /// total system memory available.
 max_rss: usize,
+/// Set this field to declare how many CPU cores the step keeps busy while it
+/// runs, for example a compilation which uses the LLVM backend with many
+/// threads.
+///
+/// The build runner does not run steps concurrently whose weights add up to
+/// more than the number of jobs. A weight greater than the number of jobs
+/// counts as the number of jobs.
+cpu_weight: u32,
 
 result_error_msgs: ArrayList([]const u8),
 result_error_bundle: std.zig.ErrorBundle,
@@ -121,6 +129,8 @@ pub const MakeOptions = struct {
     ttyconf: std.Io.tty.Config,
     /// If set, this is a timeout to enforce on all individual unit tests, in nanoseconds.
     unit_test_timeout_ns: ?u64,
+    /// The maximum number of test runner processes to split the tests of one `Step.Run` between.
+    unit_test_jobs: u32,
     /// Not to be confused with `Build.allocator`, which is an alias of `Build.graph.arena`.
     gpa: Allocator,
 };
@@ -237,6 +247,7 @@ pub const StepOptions = struct {
     makeFn: MakeFn = makeNoOp,
     first_ret_addr: ?usize = null,
     max_rss: usize = 0,
+    cpu_weight: u32 = 1,
 };
 
 pub fn init(options: StepOptions) Step {
@@ -252,6 +263,7 @@ pub fn init(options: StepOptions) Step {
         .inputs = Inputs.init,
         .state = .precheck_unstarted,
         .max_rss = options.max_rss,
+        .cpu_weight = options.cpu_weight,
         .debug_stack_trace = blk: {
             const addr_buf = arena.alloc(usize, options.owner.debug_stack_frames_count) catch @panic("OOM");
             const first_ret_addr = options.first_ret_addr orelse @returnAddress();
@@ -536,6 +548,7 @@ fn zigProcessUpdate(s: *Step, zp: *ZigProcess, watch: bool, web_server: ?*Build.
     const arena = b.allocator;
 
     var timer = try std.time.Timer.start();
+    const trace_start_ns = if (b.graph.trace) |trace| trace.now() else 0;
 
     try sendMessage(zp.child.stdin.?, .update);
     if (!watch) try sendMessage(zp.child.stdin.?, .exit);
@@ -620,10 +633,12 @@ fn zigProcessUpdate(s: *Step, zp: *ZigProcess, watch: bool, web_server: ?*Build.
                     }
                 }
             },
-            .time_report => if (web_server) |ws| {
+            .time_report => {
                 const TimeReport = std.zig.Server.Message.TimeReport;
                 const tr: *align(1) const TimeReport = @ptrCast(body[0..@sizeOf(TimeReport)]);
-                ws.updateTimeReportCompile(.{
+                // Under `--trace` alone, the compiler only reports whole phases, which are not
+                // enough for the web interface's time report.
+                if (b.graph.time_report) if (web_server) |ws| ws.updateTimeReportCompile(.{
                     .compile = s.cast(Step.Compile).?,
                     .use_llvm = tr.flags.use_llvm,
                     .stats = tr.stats,
@@ -631,8 +646,24 @@ fn zigProcessUpdate(s: *Step, zp: *ZigProcess, watch: bool, web_server: ?*Build.
                     .llvm_pass_timings_len = tr.llvm_pass_timings_len,
                     .files_len = tr.files_len,
                     .decls_len = tr.decls_len,
+                    .fns_len = tr.fns_len,
                     .trailing = body[@sizeOf(TimeReport)..],
                 });
+                if (b.graph.trace) |trace| {
+                    traceCompilePhases(trace, trace_start_ns, tr, body[@sizeOf(TimeReport)..]);
+                }
+            },
+            .mem_report => {
+                const MemReport = std.zig.Server.Message.MemReport;
+                const mr: *align(1) const MemReport = @ptrCast(body[0..@sizeOf(MemReport)]);
+                if (web_server) |ws| ws.updateMemReportCompile(.{
+                    .compile = s.cast(Step.Compile).?,
+                    .stats = mr.stats,
+                    .files_len = mr.files_len,
+                    .tags_len = mr.tags_len,
+                    .decls_len = mr.decls_len,
+                    .trailing = body[@sizeOf(MemReport)..],
+                });
             },
             else => {}, // ignore other messages
         }
@@ -648,6 +679,47 @@ fn zigProcessUpdate(s: *Step, zp: *ZigProcess, watch: bool, web_server: ?*Build.
     return result;
 }
 
+/// The compiler only reports how long each phase of an update took, so the
+/// phases are laid out one after the other from the start of the update, in
+/// the order in which the compiler runs them.
+fn traceCompilePhases(
+    trace: *Build.Trace,
+    start_ns: u64,
+    tr: *align(1) const std.zig.Server.Message.TimeReport,
+    trailing: []const u8,
+) void {
+    const stats = tr.stats;
+    var phase_start_ns = start_ns;
+    if (stats.real_ns_files != 0) {
+        trace.complete("AST Lowering", "compile", phase_start_ns, phase_start_ns + stats.real_ns_files, .{
+            .cpu_ns_parse = stats.cpu_ns_parse,
+            .cpu_ns_astgen = stats.cpu_ns_astgen,
+            .reachable_files = stats.n_reachable_files,
+            .imported_files = stats.n_imported_files,
+        });
+        phase_start_ns += stats.real_ns_files;
+    }
+    if (stats.real_ns_decls != 0) {
+        trace.complete("Semantic Analysis and Code Generation", "compile", phase_start_ns, phase_start_ns + stats.real_ns_decls, .{
+            .cpu_ns_sema = stats.cpu_ns_sema,
+            .cpu_ns_codegen = stats.cpu_ns_codegen,
+            .cpu_ns_link = stats.cpu_ns_link,
+            .generic_instances = stats.n_generic_instances,
+            .inline_calls = stats.n_inline_calls,
+        });
+        phase_start_ns += stats.real_ns_decls;
+    }
+    if (stats.real_ns_llvm_emit != 0) {
+        trace.complete("LLVM Emit Object", "compile", phase_start_ns, phase_start_ns + stats.real_ns_llvm_emit, .{
+            .pass_timings = trailing[0..tr.llvm_pass_timings_len],
+        });
+        phase_start_ns += stats.real_ns_llvm_emit;
+    }
+    if (stats.real_ns_link_flush != 0) {
+        trace.complete("Link Flush", "compile", phase_start_ns, phase_start_ns + stats.real_ns_link_flush, .{});
+    }
+}
+
 pub fn getZigProcess(s: *Step) ?*ZigProcess {
     return switch (s.id) {
         .compile => s.cast(Compile).?.zig_process,
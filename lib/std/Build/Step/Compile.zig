@@ -37,6 +37,10 @@ formatted_panics: ?bool = null,
 compress_debug_sections: std.zig.CompressDebugSections = .none,
 verbose_link: bool,
 verbose_cc: bool,
+/// Report the memory used by the analysis, code generation and linking of each declaration
+/// (`--mem-report`) to the build system web interface, where it is shown for this step. Like
+/// `--time-report`, this forces the compilation to not be a cache hit.
+mem_report: bool = false,
 bundle_compiler_rt: ?bool = null,
 bundle_ubsan_rt: ?bool = null,
 rdynamic: bool,
@@ -188,6 +192,11 @@ force_undefined_symbols: std.StringHashMap(void),
 /// Overrides the default stack size
 stack_size: ?u64 = null,
 
+/// When emitting C source code, also write the output as this many translation units. Together
+/// they are an alternative to the emitted `.c` file which can be compiled in parallel. Given
+/// `foo.c`, they are written and installed next to it as `foo.0.c` through `foo.{N-1}.c`.
+c_shards: ?u32 = null,
+
 /// Deprecated; prefer using `lto`.
 want_lto: ?bool = null,
 
@@ -274,6 +283,7 @@ pub const Options = struct {
     linkage: ?std.builtin.LinkMode = null,
     version: ?std.SemanticVersion = null,
     max_rss: usize = 0,
+    cpu_weight: u32 = 1,
     filters: []const []const u8 = &.{},
     test_runner: ?TestRunner = null,
     use_llvm: ?bool = null,
@@ -416,6 +426,7 @@ pub fn create(owner: *std.Build, options: Options) *Compile {
             .owner = owner,
             .makeFn = make,
             .max_rss = options.max_rss,
+            .cpu_weight = options.cpu_weight,
         }),
         .version = options.version,
         .out_filename = out_filename,
@@ -1127,6 +1138,11 @@ fn getZigArgs(compile: *Compile, fuzz: bool) ![][]const u8 {
         try zig_args.append(try std.fmt.allocPrint(arena, "{}", .{stack_size}));
     }
 
+    if (compile.c_shards) |c_shards| {
+        try zig_args.append("--c-shards");
+        try zig_args.append(try std.fmt.allocPrint(arena, "{d}", .{c_shards}));
+    }
+
     if (fuzz) {
         try zig_args.append("-ffuzz");
     }
@@ -1494,7 +1510,12 @@ fn getZigArgs(compile: *Compile, fuzz: bool) ![][]const u8 {
     if (b.verbose_link or compile.verbose_link) try zig_args.append("--verbose-link");
     if (b.verbose_cc or compile.verbose_cc) try zig_args.append("--verbose-cc");
     if (b.verbose_llvm_cpu_features) try zig_args.append("--verbose-llvm-cpu-features");
-    if (b.graph.time_report) try zig_args.append("--time-report");
+    if (b.graph.time_report) {
+        try zig_args.append("--time-report");
+    } else if (b.graph.trace != null) {
+        try zig_args.append("--time-report-phases");
+    }
+    if (b.graph.mem_report or compile.mem_report) try zig_args.append("--mem-report");
 
     if (compile.generated_asm != null) try zig_args.append("-femit-asm");
     if (compile.generated_bin == null) try zig_args.append("-fno-emit-bin");
@@ -127,6 +127,24 @@ fn make(step: *Step, options: Step.MakeOptions) !void {
         const p = try step.installFile(install_artifact.emitted_bin.?, full_dest_path);
         all_cached = all_cached and p == .fresh;
 
+        if (install_artifact.artifact.c_shards) |c_shards| if (c_shards > 1 and
+            install_artifact.artifact.rootModuleTarget().ofmt == .c)
+        {
+            // The shards keep the names they were emitted with, next to the main file.
+            const emitted_bin = install_artifact.emitted_bin.?;
+            const basename = emitted_bin.basename(b, step);
+            const stem = basename[0 .. basename.len - fs.path.extension(basename).len];
+            const dest_dir_path = fs.path.dirname(full_dest_path).?;
+            for (0..c_shards) |shard| {
+                const shard_basename = b.fmt("{s}.{d}.c", .{ stem, shard });
+                const shard_p = try step.installFile(
+                    emitted_bin.dirname().path(b, shard_basename),
+                    b.pathJoin(&.{ dest_dir_path, shard_basename }),
+                );
+                all_cached = all_cached and shard_p == .fresh;
+            }
+        };
+
         if (install_artifact.dylib_symlinks) |dls| {
             try Step.Compile.doAtomicSymLinks(step, full_dest_path, dls.major_only_filename, dls.name_only_filename);
         }
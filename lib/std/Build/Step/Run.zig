@@ -696,7 +696,7 @@ pub fn addFileInput(self: *Run, file_input: std.Build.LazyPath) void {
 }
 
 /// Returns whether the Run step has side effects *other than* updating the output arguments.
-fn hasSideEffects(run: Run) bool {
+pub fn hasSideEffects(run: Run) bool {
     if (run.has_side_effects) return true;
     return switch (run.stdio) {
         .infer_from_args => !run.hasAnyOutputArgs(),
@@ -1156,6 +1156,7 @@ pub fn rerunInFuzzMode(
         .web_server = null, // only needed for time reports
         .ttyconf = fuzz.ttyconf,
         .unit_test_timeout_ns = null, // don't time out fuzz tests for now
+        .unit_test_jobs = 1, // each fuzz test has its own process
         .gpa = fuzz.gpa,
     }, .{
         .unit_test_index = unit_test_index,
@@ -1676,12 +1677,26 @@ fn evalZigTest(
     options: Step.MakeOptions,
     fuzz_context: ?FuzzContext,
 ) !EvalZigTestResult {
-    const gpa = run.step.owner.allocator;
     const arena = run.step.owner.allocator;
 
     // We will update this every time a child runs.
     run.step.result_peak_rss = 0;
 
+    const max_shards: u32 = if (fuzz_context != null or builtin.single_threaded)
+        1
+    else
+        @max(1, options.unit_test_jobs);
+    var split: ZigTestSplit = .{
+        .shards = try arena.alloc(ZigTestShard, max_shards),
+        .len = 1,
+        .threads = try arena.alloc(std.Thread, max_shards - 1),
+    };
+    for (split.shards, 0..) |*shard, i| shard.* = .init(@intCast(i), child.*);
+
+    const first_result = runZigTestShard(run, &split.shards[0], options, fuzz_context, &split);
+    for (split.threads[0 .. split.len - 1]) |thread| thread.join();
+    const shards = split.shards[0..split.len];
+
     var result: EvalZigTestResult = .{
         .test_results = .{
             .test_count = 0,
@@ -1692,8 +1707,228 @@ fn evalZigTest(
             .leak_count = 0,
             .log_err_count = 0,
         },
-        .test_metadata = null,
+        .test_metadata = shards[0].metadata,
     };
+    if (fuzz_context == null) run.fuzz_tests.clearRetainingCapacity();
+    var errors: std.ArrayList(ZigTestShard.Error) = .empty;
+    var stderr: std.ArrayList(u8) = .empty;
+    for (shards) |*shard| {
+        const tr = &result.test_results;
+        tr.test_count += shard.results.test_count;
+        tr.skip_count +|= shard.results.skip_count;
+        tr.fail_count +|= shard.results.fail_count;
+        tr.crash_count +|= shard.results.crash_count;
+        tr.timeout_count +|= shard.results.timeout_count;
+        tr.leak_count +|= shard.results.leak_count;
+        tr.log_err_count +|= shard.results.log_err_count;
+        run.step.result_peak_rss = @max(run.step.result_peak_rss, shard.peak_rss);
+        try run.fuzz_tests.appendSlice(arena, shard.fuzz_tests.items);
+        try errors.appendSlice(arena, shard.errors.items);
+        if (shard.stderr.len != 0) {
+            if (stderr.items.len != 0) try stderr.append(arena, '\n');
+            try stderr.appendSlice(arena, shard.stderr);
+        }
+    }
+    // Each shard reports its tests in order, so this only matters when there are several.
+    if (shards.len > 1) {
+        std.mem.sort(u32, run.fuzz_tests.items, {}, std.sort.asc(u32));
+        std.mem.sort(ZigTestShard.Error, errors.items, {}, ZigTestShard.Error.lessThan);
+    }
+    for (errors.items) |err| try run.step.result_error_msgs.append(arena, err.msg);
+    run.step.result_stderr = stderr.items;
+
+    try first_result;
+    for (shards[1..]) |shard| try shard.result;
+    return result;
+}
+
+/// A test runner process, restarted whenever it crashes, together with the tests it runs and
+/// what it reported about them.
+const ZigTestShard = struct {
+    index: u32,
+    child: std.process.Child,
+    /// For all but the first shard, this is set before the shard starts, with `indices` selecting
+    /// its tests.
+    metadata: ?TestMetadata,
+    results: Step.TestResults,
+    /// Added to the step once all shards are done, so that they appear in the same order
+    /// regardless of how the tests were split.
+    errors: std.ArrayList(Error),
+    fuzz_tests: std.ArrayList(u32),
+    stderr: []const u8,
+    peak_rss: usize,
+    /// Only used for shards running on their own thread.
+    result: anyerror!void,
+
+    const Error = struct {
+        /// `null` if the error is not about a specific test, in which case it is reported after
+        /// the test errors.
+        test_index: ?u32,
+        shard_index: u32,
+        msg: []const u8,
+
+        fn lessThan(_: void, a: Error, b: Error) bool {
+            const a_test = a.test_index orelse std.math.maxInt(u32);
+            const b_test = b.test_index orelse std.math.maxInt(u32);
+            if (a_test != b_test) return a_test < b_test;
+            return a.shard_index < b.shard_index;
+        }
+    };
+
+    fn init(index: u32, child: std.process.Child) ZigTestShard {
+        return .{
+            .index = index,
+            .child = child,
+            .metadata = null,
+            .results = .{
+                .test_count = 0,
+                .skip_count = 0,
+                .fail_count = 0,
+                .crash_count = 0,
+                .timeout_count = 0,
+                .leak_count = 0,
+                .log_err_count = 0,
+            },
+            .errors = .empty,
+            .fuzz_tests = .empty,
+            .stderr = "",
+            .peak_rss = 0,
+            .result = {},
+        };
+    }
+
+    fn addError(
+        shard: *ZigTestShard,
+        run: *Run,
+        test_index: ?u32,
+        comptime fmt: []const u8,
+        args: anytype,
+    ) error{OutOfMemory}!void {
+        const arena = run.step.owner.allocator;
+        try shard.errors.append(arena, .{
+            .test_index = test_index,
+            .shard_index = shard.index,
+            .msg = try std.fmt.allocPrint(arena, fmt, args),
+        });
+    }
+};
+
+/// When `Step.MakeOptions.unit_test_jobs` is more than 1, the tests are split between several
+/// shards once the first one has received the test metadata. The other shards each run on their
+/// own thread.
+const ZigTestSplit = struct {
+    shards: []ZigTestShard,
+    /// The number of `shards` which were started.
+    len: u32,
+    /// `threads[i]` runs `shards[i + 1]`.
+    threads: []std.Thread,
+
+    /// Splits the tests of `metadata`, which belongs to the first shard, and starts the other
+    /// shards. Tests are assigned longest first to the shard with the least work, using the
+    /// durations of the previous run of the same tests when available.
+    fn start(split: *ZigTestSplit, run: *Run, options: Step.MakeOptions, metadata: *TestMetadata) !void {
+        const arena = run.step.owner.allocator;
+        const gpa = options.gpa;
+        const tests_len: u32 = @intCast(metadata.names.len);
+        const shards_len: u32 = @intCast(@min(split.shards.len, tests_len));
+        if (shards_len <= 1) return;
+
+        const prev_ns_per_test: ?[]const u64 = if (run.cached_test_metadata) |prev| ns: {
+            if (!mem.eql(u32, prev.names, metadata.names)) break :ns null;
+            if (!mem.eql(u8, prev.string_bytes, metadata.string_bytes)) break :ns null;
+            break :ns prev.ns_per_test;
+        } else null;
+
+        const costs = try gpa.alloc(u64, tests_len);
+        defer gpa.free(costs);
+        {
+            // Tests which did not finish last time, and all tests on the first run, are assumed
+            // to take the average time.
+            var known_ns: u64 = 0;
+            var known_len: u64 = 0;
+            if (prev_ns_per_test) |ns_per_test| for (ns_per_test) |ns| {
+                if (ns == std.math.maxInt(u64)) continue;
+                known_ns +|= ns;
+                known_len += 1;
+            };
+            const default_ns = if (known_len == 0) 1 else known_ns / known_len;
+            for (costs, 0..) |*cost, i| cost.* = ns: {
+                const ns_per_test = prev_ns_per_test orelse break :ns default_ns;
+                if (ns_per_test[i] == std.math.maxInt(u64)) break :ns default_ns;
+                break :ns ns_per_test[i];
+            };
+        }
+
+        const order = try gpa.alloc(u32, tests_len);
+        defer gpa.free(order);
+        for (order, 0..) |*index, i| index.* = @intCast(i);
+        const SortContext = struct {
+            costs: []const u64,
+            fn lessThan(ctx: @This(), a: u32, b: u32) bool {
+                if (ctx.costs[a] != ctx.costs[b]) return ctx.costs[a] > ctx.costs[b];
+                return a < b;
+            }
+        };
+        std.mem.sort(u32, order, SortContext{ .costs = costs }, SortContext.lessThan);
+
+        const shard_of_test = try gpa.alloc(u32, tests_len);
+        defer gpa.free(shard_of_test);
+        const loads = try gpa.alloc(u64, shards_len);
+        defer gpa.free(loads);
+        @memset(loads, 0);
+        const lens = try gpa.alloc(u32, shards_len);
+        defer gpa.free(lens);
+        @memset(lens, 0);
+        for (order) |test_index| {
+            const shard_index: u32 = @intCast(mem.findMin(u64, loads));
+            loads[shard_index] +|= costs[test_index];
+            lens[shard_index] += 1;
+            shard_of_test[test_index] = shard_index;
+        }
+
+        // Each shard runs its tests in order of index.
+        const indices = try arena.alloc([]u32, shards_len);
+        for (indices, lens) |*list, len| {
+            list.* = try arena.alloc(u32, len);
+            list.len = 0;
+        }
+        for (shard_of_test, 0..) |shard_index, test_index| {
+            const list = &indices[shard_index];
+            list.len += 1;
+            list.*[list.len - 1] = @intCast(test_index);
+        }
+
+        metadata.indices = indices[0];
+        for (
+            split.shards[1..shards_len],
+            indices[1..],
+            split.threads[0 .. shards_len - 1],
+        ) |*shard, shard_indices, *thread| {
+            shard.metadata = metadata.*;
+            shard.metadata.?.indices = shard_indices;
+            shard.metadata.?.next_index = 0;
+            thread.* = try std.Thread.spawn(.{}, runZigTestShardThread, .{ run, shard, options });
+            split.len += 1;
+        }
+    }
+};
+
+fn runZigTestShardThread(run: *Run, shard: *ZigTestShard, options: Step.MakeOptions) void {
+    shard.result = runZigTestShard(run, shard, options, null, null);
+}
+
+/// Runs the tests of `shard`, spawning a new test runner process whenever one crashes or times
+/// out in a test. `split` is only provided for the first shard.
+fn runZigTestShard(
+    run: *Run,
+    shard: *ZigTestShard,
+    options: Step.MakeOptions,
+    fuzz_context: ?FuzzContext,
+    split: ?*ZigTestSplit,
+) !void {
+    const gpa = run.step.owner.allocator;
+    const arena = run.step.owner.allocator;
+    const child = &shard.child;
 
     while (true) {
         try child.spawn();
@@ -1705,8 +1940,8 @@ fn evalZigTest(
         defer if (!child_killed) {
             _ = child.kill() catch {};
             poller.deinit();
-            run.step.result_peak_rss = @max(
-                run.step.result_peak_rss,
+            shard.peak_rss = @max(
+                shard.peak_rss,
                 child.resource_usage_statistics.getMaxRss() orelse 0,
             );
         };
@@ -1715,18 +1950,17 @@ fn evalZigTest(
 
         switch (try pollZigTest(
             run,
-            child,
+            shard,
             options,
             fuzz_context,
             &poller,
-            &result.test_metadata,
-            &result.test_results,
+            split,
         )) {
             .write_failed => |err| {
                 // The runner unexpectedly closed a stdio pipe, which means a crash. Make sure we've captured
                 // all available stderr to make our error output as useful as possible.
                 while (try poller.poll()) {}
-                run.step.result_stderr = try arena.dupe(u8, poller.reader(.stderr).buffered());
+                shard.stderr = try arena.dupe(u8, poller.reader(.stderr).buffered());
 
                 // Clean up everything and wait for the child to exit.
                 child.stdin.?.close();
@@ -1734,13 +1968,13 @@ fn evalZigTest(
                 poller.deinit();
                 child_killed = true;
                 const term = try child.wait();
-                run.step.result_peak_rss = @max(
-                    run.step.result_peak_rss,
+                shard.peak_rss = @max(
+                    shard.peak_rss,
                     child.resource_usage_statistics.getMaxRss() orelse 0,
                 );
 
-                try run.step.addError("unable to write stdin ({t}); test process unexpectedly {f}", .{ err, fmtTerm(term) });
-                return result;
+                try shard.addError(run, null, "unable to write stdin ({t}); test process unexpectedly {f}", .{ err, fmtTerm(term) });
+                return;
             },
             .no_poll => |no_poll| {
                 // This might be a success (we requested exit and the child dutifully closed stdout) or
@@ -1754,18 +1988,18 @@ fn evalZigTest(
                 poller.deinit();
                 child_killed = true;
                 const term = try child.wait();
-                run.step.result_peak_rss = @max(
-                    run.step.result_peak_rss,
+                shard.peak_rss = @max(
+                    shard.peak_rss,
                     child.resource_usage_statistics.getMaxRss() orelse 0,
                 );
 
                 if (no_poll.active_test_index) |test_index| {
                     // A test was running, so this is definitely a crash. Report it against that
                     // test, and continue to the next test.
-                    result.test_metadata.?.ns_per_test[test_index] = no_poll.ns_elapsed;
-                    result.test_results.crash_count += 1;
-                    try run.step.addError("'{s}' {f}{s}{s}", .{
-                        result.test_metadata.?.testName(test_index),
+                    shard.metadata.?.ns_per_test[test_index] = no_poll.ns_elapsed;
+                    shard.results.crash_count += 1;
+                    try shard.addError(run, test_index, "'{s}' {f}{s}{s}", .{
+                        shard.metadata.?.testName(test_index),
                         fmtTerm(term),
                         if (stderr_owned.len != 0) " with stderr:\n" else "",
                         std.mem.trim(u8, stderr_owned, "\n"),
@@ -1774,12 +2008,12 @@ fn evalZigTest(
                 }
 
                 // Report an error if the child terminated uncleanly or if we were still trying to run more tests.
-                run.step.result_stderr = stderr_owned;
-                const tests_done = result.test_metadata != null and result.test_metadata.?.next_index == std.math.maxInt(u32);
+                shard.stderr = stderr_owned;
+                const tests_done = shard.metadata != null and shard.metadata.?.next_index == std.math.maxInt(u32);
                 if (!tests_done or !termMatches(.{ .Exited = 0 }, term)) {
-                    try run.step.addError("test process unexpectedly {f}", .{fmtTerm(term)});
+                    try shard.addError(run, null, "test process unexpectedly {f}", .{fmtTerm(term)});
                 }
-                return result;
+                return;
             },
             .timeout => |timeout| {
                 const stderr = poller.reader(.stderr).buffered();
@@ -1787,10 +2021,10 @@ fn evalZigTest(
                 if (timeout.active_test_index) |test_index| {
                     // A test was running. Report the timeout against that test, and continue on to
                     // the next test.
-                    result.test_metadata.?.ns_per_test[test_index] = timeout.ns_elapsed;
-                    result.test_results.timeout_count += 1;
-                    try run.step.addError("'{s}' timed out after {D}{s}{s}", .{
-                        result.test_metadata.?.testName(test_index),
+                    shard.metadata.?.ns_per_test[test_index] = timeout.ns_elapsed;
+                    shard.results.timeout_count += 1;
+                    try shard.addError(run, test_index, "'{s}' timed out after {D}{s}{s}", .{
+                        shard.metadata.?.testName(test_index),
                         timeout.ns_elapsed,
                         if (stderr.len != 0) " with stderr:\n" else "",
                         std.mem.trim(u8, stderr, "\n"),
@@ -1798,8 +2032,9 @@ fn evalZigTest(
                     continue;
                 }
                 // Just log an error and let the child be killed.
-                run.step.result_stderr = try arena.dupe(u8, stderr);
-                return run.step.fail("test runner failed to respond for {D}", .{timeout.ns_elapsed});
+                shard.stderr = try arena.dupe(u8, stderr);
+                try shard.addError(run, null, "test runner failed to respond for {D}", .{timeout.ns_elapsed});
+                return error.MakeFailed;
             },
         }
         comptime unreachable;
@@ -1812,12 +2047,11 @@ fn evalZigTest(
 /// * `poll` fails, indicating the child closed stdout and stderr
 fn pollZigTest(
     run: *Run,
-    child: *std.process.Child,
+    shard: *ZigTestShard,
     options: Step.MakeOptions,
     fuzz_context: ?FuzzContext,
     poller: *std.Io.Poller(StdioPollEnum),
-    opt_metadata: *?TestMetadata,
-    results: *Step.TestResults,
+    split: ?*ZigTestSplit,
 ) !union(enum) {
     write_failed: anyerror,
     no_poll: struct {
@@ -1831,6 +2065,9 @@ fn pollZigTest(
 } {
     const gpa = run.step.owner.allocator;
     const arena = run.step.owner.allocator;
+    const child = &shard.child;
+    const opt_metadata = &shard.metadata;
+    const results = &shard.results;
 
     var sub_prog_node: ?std.Progress.Node = null;
     defer if (sub_prog_node) |n| n.end();
@@ -1856,11 +2093,11 @@ fn pollZigTest(
             },
         }
     } else if (opt_metadata.*) |*md| {
-        // Previous unit test process died or was killed; we're continuing where it left off
+        // Previous unit test process died or was killed, or this shard was given its tests when
+        // they were split; we're continuing where it left off
         requestNextTest(child.stdin.?, md, &sub_prog_node) catch |err| return .{ .write_failed = err };
     } else {
         // Running unit tests normally
-        run.fuzz_tests.clearRetainingCapacity();
         sendMessage(child.stdin.?, .query_test_metadata) catch |err| return .{ .write_failed = err };
     }
 
@@ -1939,10 +2176,15 @@ fn pollZigTest(
         var body_r: std.Io.Reader = .fixed(body);
         switch (header.tag) {
             .zig_version => {
-                if (!std.mem.eql(u8, builtin.zig_version_string, body)) return run.step.fail(
-                    "zig version mismatch build runner vs compiler: '{s}' vs '{s}'",
-                    .{ builtin.zig_version_string, body },
-                );
+                if (!std.mem.eql(u8, builtin.zig_version_string, body)) {
+                    try shard.addError(
+                        run,
+                        null,
+                        "zig version mismatch build runner vs compiler: '{s}' vs '{s}'",
+                        .{ builtin.zig_version_string, body },
+                    );
+                    return error.MakeFailed;
+                }
             },
             .test_metadata => {
                 assert(fuzz_context == null);
@@ -1969,10 +2211,12 @@ fn pollZigTest(
                     .ns_per_test = try arena.alloc(u64, results.test_count),
                     .names = names,
                     .expected_panic_msgs = expected_panic_msgs,
+                    .indices = null,
                     .next_index = 0,
                     .prog_node = options.progress_node,
                 };
                 @memset(opt_metadata.*.?.ns_per_test, std.math.maxInt(u64));
+                if (split) |sp| try sp.start(run, options, &opt_metadata.*.?);
 
                 active_test_index = null;
                 if (timer) |*t| t.reset();
@@ -1980,7 +2224,8 @@ fn pollZigTest(
                 requestNextTest(child.stdin.?, &opt_metadata.*.?, &sub_prog_node) catch |err| return .{ .write_failed = err };
             },
             .test_started => {
-                active_test_index = opt_metadata.*.?.next_index - 1;
+                const md = &opt_metadata.*.?;
+                active_test_index = md.testIndex(md.next_index - 1);
                 if (timer) |*t| t.reset();
             },
             .test_results => {
@@ -2000,27 +2245,27 @@ fn pollZigTest(
                 results.leak_count +|= leak_count;
                 results.log_err_count +|= log_err_count;
 
-                if (tr_hdr.flags.fuzz) try run.fuzz_tests.append(gpa, tr_hdr.index);
+                if (tr_hdr.flags.fuzz) try shard.fuzz_tests.append(gpa, tr_hdr.index);
 
                 if (tr_hdr.flags.status == .fail) {
                     const name = std.mem.sliceTo(md.testName(tr_hdr.index), 0);
                     const stderr_bytes = std.mem.trim(u8, stderr.buffered(), "\n");
                     stderr.tossBuffered();
                     if (stderr_bytes.len == 0) {
-                        try run.step.addError("'{s}' failed without output", .{name});
+                        try shard.addError(run, tr_hdr.index, "'{s}' failed without output", .{name});
                     } else {
-                        try run.step.addError("'{s}' failed:\n{s}", .{ name, stderr_bytes });
+                        try shard.addError(run, tr_hdr.index, "'{s}' failed:\n{s}", .{ name, stderr_bytes });
                     }
                 } else if (leak_count > 0) {
                     const name = std.mem.sliceTo(md.testName(tr_hdr.index), 0);
                     const stderr_bytes = std.mem.trim(u8, stderr.buffered(), "\n");
                     stderr.tossBuffered();
-                    try run.step.addError("'{s}' leaked {d} allocations:\n{s}", .{ name, leak_count, stderr_bytes });
+                    try shard.addError(run, tr_hdr.index, "'{s}' leaked {d} allocations:\n{s}", .{ name, leak_count, stderr_bytes });
                 } else if (log_err_count > 0) {
                     const name = std.mem.sliceTo(md.testName(tr_hdr.index), 0);
                     const stderr_bytes = std.mem.trim(u8, stderr.buffered(), "\n");
                     stderr.tossBuffered();
-                    try run.step.addError("'{s}' logged {d} errors:\n{s}", .{ name, log_err_count, stderr_bytes });
+                    try shard.addError(run, tr_hdr.index, "'{s}' logged {d} errors:\n{s}", .{ name, log_err_count, stderr_bytes });
                 }
 
                 active_test_index = null;
@@ -2070,9 +2315,13 @@ fn pollZigTest(
 
 const TestMetadata = struct {
     names: []const u32,
+    /// Shared by all shards, each of which only writes the entries of its own tests.
     ns_per_test: []u64,
     expected_panic_msgs: []const u32,
     string_bytes: []const u8,
+    /// The tests to run, in order, when they are split between shards. `null` means all tests.
+    indices: ?[]const u32,
+    /// Position in `indices`, or a test index if `indices` is `null`.
     next_index: u32,
     prog_node: std.Progress.Node,
 
@@ -2080,9 +2329,18 @@ const TestMetadata = struct {
         return .{
             .names = tm.names,
             .string_bytes = tm.string_bytes,
+            .ns_per_test = tm.ns_per_test,
         };
     }
 
+    fn testsLen(tm: TestMetadata) u32 {
+        return @intCast(if (tm.indices) |indices| indices.len else tm.names.len);
+    }
+
+    fn testIndex(tm: TestMetadata, position: u32) u32 {
+        return if (tm.indices) |indices| indices[position] else position;
+    }
+
     fn testName(tm: TestMetadata, index: u32) []const u8 {
         return tm.toCachedTestMetadata().testName(index);
     }
@@ -2091,6 +2349,9 @@ const TestMetadata = struct {
 pub const CachedTestMetadata = struct {
     names: []const u32,
     string_bytes: []const u8,
+    /// Duration of each test in the last run, or `maxInt(u64)` if it did not finish. Used to
+    /// balance the tests between shards on the next run.
+    ns_per_test: []const u64,
 
     pub fn testName(tm: CachedTestMetadata, index: u32) []const u8 {
         return std.mem.sliceTo(tm.string_bytes[tm.names[index]..], 0);
@@ -2098,8 +2359,8 @@ pub const CachedTestMetadata = struct {
 };
 
 fn requestNextTest(in: fs.File, metadata: *TestMetadata, sub_prog_node: *?std.Progress.Node) !void {
-    while (metadata.next_index < metadata.names.len) {
-        const i = metadata.next_index;
+    while (metadata.next_index < metadata.testsLen()) {
+        const i = metadata.testIndex(metadata.next_index);
         metadata.next_index += 1;
 
         if (metadata.expected_panic_msgs[i] != 0) continue;
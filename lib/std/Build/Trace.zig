@@ -0,0 +1,162 @@
+//! Records the timeline of a build in the trace event format of Chrome, which
+//! can be opened with Perfetto or `chrome://tracing`. Enabled with
+//! `zig build --trace=<file>`.
+//!
+//! Every thread which records events gets its own track, so the steps run by
+//! the workers of the build runner show how the thread pool is occupied, and
+//! the phases of each compilation are nested under the step which ran it.
+
+const std = @import("../std.zig");
+const Allocator = std.mem.Allocator;
+const Io = std.Io;
+const Trace = @This();
+
+gpa: Allocator,
+io: Io,
+/// Guards `events` and `named_threads`.
+mutex: std.Thread.Mutex,
+/// On the `base_clock`.
+start: Io.Timestamp,
+main_thread: std.Thread.Id,
+/// The JSON objects of the recorded events, separated by commas.
+events: std.ArrayList(u8),
+named_threads: std.AutoHashMapUnmanaged(std.Thread.Id, void),
+
+pub const base_clock: Io.Clock = .awake;
+
+/// Time zero of the trace is when this is called, on the thread which is
+/// named the main thread.
+pub fn init(gpa: Allocator, io: Io) Io.Clock.Error!Trace {
+    return .{
+        .gpa = gpa,
+        .io = io,
+        .mutex = .{},
+        .start = try base_clock.now(io),
+        .main_thread = std.Thread.getCurrentId(),
+        .events = .empty,
+        .named_threads = .empty,
+    };
+}
+
+pub fn deinit(t: *Trace) void {
+    t.events.deinit(t.gpa);
+    t.named_threads.deinit(t.gpa);
+    t.* = undefined;
+}
+
+/// Returns the number of nanoseconds since the trace started.
+pub fn now(t: *const Trace) u64 {
+    const now_ts = base_clock.now(t.io) catch unreachable; // checked by `init`
+    return @intCast(t.start.durationTo(now_ts).nanoseconds);
+}
+
+/// Records a span of time on the track of the calling thread. `args` is an
+/// anonymous struct of extra information which is shown for the span.
+pub fn complete(
+    t: *Trace,
+    name: []const u8,
+    category: []const u8,
+    start_ns: u64,
+    end_ns: u64,
+    args: anytype,
+) void {
+    const tid = std.Thread.getCurrentId();
+    t.mutex.lock();
+    defer t.mutex.unlock();
+    t.nameThread(tid);
+    t.beginEvent();
+    t.events.print(t.gpa, "{{\"name\":{f},\"cat\":{f},\"ph\":\"X\",\"pid\":1,\"tid\":{d},\"ts\":{f},\"dur\":{f}", .{
+        std.json.fmt(name, .{}),
+        std.json.fmt(category, .{}),
+        tid,
+        fmtMicroseconds(start_ns),
+        fmtMicroseconds(end_ns -| start_ns),
+    }) catch @panic("OOM");
+    // An empty anonymous struct is a tuple, which would be written as an array.
+    if (@typeInfo(@TypeOf(args)).@"struct".fields.len != 0) {
+        t.events.print(t.gpa, ",\"args\":{f}", .{std.json.fmt(args, .{})}) catch @panic("OOM");
+    }
+    t.events.append(t.gpa, '}') catch @panic("OOM");
+}
+
+/// Records the values of a counter at `ts_ns`. `values` is an anonymous struct
+/// with a number for each series of the counter.
+pub fn counter(t: *Trace, name: []const u8, ts_ns: u64, values: anytype) void {
+    t.mutex.lock();
+    defer t.mutex.unlock();
+    t.beginEvent();
+    t.events.print(t.gpa, "{{\"name\":{f},\"ph\":\"C\",\"pid\":1,\"ts\":{f},\"args\":{f}}}", .{
+        std.json.fmt(name, .{}),
+        fmtMicroseconds(ts_ns),
+        std.json.fmt(values, .{}),
+    }) catch @panic("OOM");
+}
+
+fn nameThread(t: *Trace, tid: std.Thread.Id) void {
+    const gop = t.named_threads.getOrPut(t.gpa, tid) catch @panic("OOM");
+    if (gop.found_existing) return;
+    const name = if (tid == t.main_thread) "main" else "worker";
+    t.beginEvent();
+    t.events.print(t.gpa, "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{d},\"args\":{{\"name\":\"{s}\"}}}}", .{
+        tid, name,
+    }) catch @panic("OOM");
+}
+
+fn beginEvent(t: *Trace) void {
+    if (t.events.items.len != 0) t.events.appendSlice(t.gpa, ",\n") catch @panic("OOM");
+}
+
+/// Writes the trace recorded so far to `sub_path`, replacing the file.
+pub fn write(t: *Trace, dir: std.fs.Dir, sub_path: []const u8) !void {
+    t.mutex.lock();
+    defer t.mutex.unlock();
+    var buffer: [4096]u8 = undefined;
+    var af = try dir.atomicFile(sub_path, .{ .write_buffer = &buffer });
+    defer af.deinit();
+    const w = &af.file_writer.interface;
+    try w.writeAll("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    try w.writeAll(t.events.items);
+    try w.writeAll("\n]}\n");
+    try af.finish();
+}
+
+fn fmtMicroseconds(ns: u64) std.fmt.Alt(u64, formatMicroseconds) {
+    return .{ .data = ns };
+}
+
+fn formatMicroseconds(ns: u64, w: *std.Io.Writer) std.Io.Writer.Error!void {
+    try w.print("{d}.{d:0>3}", .{ ns / std.time.ns_per_us, ns % std.time.ns_per_us });
+}
+
+test Trace {
+    const gpa = std.testing.allocator;
+    var t = try Trace.init(gpa, std.testing.io);
+    defer t.deinit();
+
+    t.complete("compile \"exe\"", "compile", 1_500, 1_002_250, .{ .cached = false });
+    t.counter("steps", 2_000, .{ .running = 3 });
+
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    try t.write(tmp.dir, "trace.json");
+    const bytes = try tmp.dir.readFileAlloc("trace.json", gpa, .limited(4096));
+    defer gpa.free(bytes);
+
+    const parsed = try std.json.parseFromSlice(std.json.Value, gpa, bytes, .{});
+    defer parsed.deinit();
+    const events = parsed.value.object.get("traceEvents").?.array.items;
+    try std.testing.expectEqual(3, events.len);
+    try std.testing.expectEqualStrings("thread_name", events[0].object.get("name").?.string);
+    try std.testing.expectEqualStrings("main", events[0].object.get("args").?.object.get("name").?.string);
+
+    const span = events[1].object;
+    try std.testing.expectEqualStrings("compile \"exe\"", span.get("name").?.string);
+    try std.testing.expectEqualStrings("X", span.get("ph").?.string);
+    try std.testing.expectEqual(1.5, span.get("ts").?.float);
+    try std.testing.expectEqual(1000.75, span.get("dur").?.float);
+    try std.testing.expectEqual(false, span.get("args").?.object.get("cached").?.bool);
+
+    const sample = events[2].object;
+    try std.testing.expectEqualStrings("C", sample.get("ph").?.string);
+    try std.testing.expectEqual(3, sample.get("args").?.object.get("running").?.integer);
+}
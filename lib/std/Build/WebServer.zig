@@ -23,6 +23,11 @@ fuzz: ?Fuzz,
 time_report_mutex: std.Thread.Mutex,
 time_report_msgs: [][]u8,
 time_report_update_times: []i64,
+/// Like `time_report_msgs`, but for the `abi.mem_report.CompileResult` of each step. Since any
+/// `Step.Compile` may request a memory report, these are allocated regardless of the build options.
+mem_report_mutex: std.Thread.Mutex,
+mem_report_msgs: [][]u8,
+mem_report_update_times: []i64,
 
 build_status: std.atomic.Value(abi.BuildStatus),
 /// When an event occurs which means WebSocket clients should be sent updates, call `notifyUpdate`
@@ -98,6 +103,11 @@ pub fn init(opts: Options) WebServer {
     @memset(time_report_msgs, &.{});
     @memset(time_report_update_times, std.math.minInt(i64));
 
+    const mem_report_msgs = opts.gpa.alloc([]u8, all_steps.len) catch @panic("out of memory");
+    const mem_report_update_times = opts.gpa.alloc(i64, all_steps.len) catch @panic("out of memory");
+    @memset(mem_report_msgs, &.{});
+    @memset(mem_report_update_times, std.math.minInt(i64));
+
     return .{
         .gpa = opts.gpa,
         .thread_pool = opts.thread_pool,
@@ -120,6 +130,9 @@ pub fn init(opts: Options) WebServer {
         .time_report_mutex = .{},
         .time_report_msgs = time_report_msgs,
         .time_report_update_times = time_report_update_times,
+        .mem_report_mutex = .{},
+        .mem_report_msgs = mem_report_msgs,
+        .mem_report_update_times = mem_report_update_times,
 
         .build_status = .init(.idle),
         .update_id = .init(0),
@@ -140,6 +153,9 @@ pub fn deinit(ws: *WebServer) void {
     for (ws.time_report_msgs) |msg| gpa.free(msg);
     gpa.free(ws.time_report_msgs);
     gpa.free(ws.time_report_update_times);
+    for (ws.mem_report_msgs) |msg| gpa.free(msg);
+    gpa.free(ws.mem_report_msgs);
+    gpa.free(ws.mem_report_update_times);
 
     if (ws.serve_thread) |t| {
         if (ws.tcp_server) |*s| s.stream.close();
@@ -350,6 +366,20 @@ fn serveWebSocket(ws: *WebServer, sock: *http.Server.WebSocket) !noreturn {
             }
         }
 
+        {
+            ws.mem_report_mutex.lock();
+            defer ws.mem_report_mutex.unlock();
+            for (ws.mem_report_msgs, ws.mem_report_update_times) |msg, update_time| {
+                if (update_time <= prev_time) continue;
+                // As above, don't hold `ws.mem_report_mutex` while sending.
+                const owned_msg = try ws.gpa.dupe(u8, msg);
+                defer ws.gpa.free(owned_msg);
+                ws.mem_report_mutex.unlock();
+                defer ws.mem_report_mutex.lock();
+                try sock.writeMessage(owned_msg, .binary);
+            }
+        }
+
         {
             const build_status = ws.build_status.load(.monotonic);
             if (build_status != prev_build_status) {
@@ -420,6 +450,7 @@ fn serveRequest(ws: *WebServer, req: *http.Server.Request) !void {
     if (mem.eql(u8, target, "/main.js")) return serveLibFile(ws, req, "build-web/main.js", "application/javascript");
     if (mem.eql(u8, target, "/style.css")) return serveLibFile(ws, req, "build-web/style.css", "text/css");
     if (mem.eql(u8, target, "/time_report.css")) return serveLibFile(ws, req, "build-web/time_report.css", "text/css");
+    if (mem.eql(u8, target, "/mem_report.css")) return serveLibFile(ws, req, "build-web/mem_report.css", "text/css");
     if (mem.eql(u8, target, "/main.wasm")) return serveClientWasm(ws, req, if (debug) .Debug else .ReleaseFast);
 
     if (ws.fuzz) |*fuzz| {
@@ -465,16 +496,17 @@ pub fn serveFile(
     path: Cache.Path,
     content_type: []const u8,
 ) !void {
-    const gpa = ws.gpa;
-    // The desired API is actually sendfile, which will require enhancing http.Server.
-    // We load the file with every request so that the user can make changes to the file
+    const io = ws.graph.io;
+    // We open the file with every request so that the user can make changes to the file
     // and refresh the HTML page without restarting this server.
-    const file_contents = path.root_dir.handle.readFileAlloc(path.sub_path, gpa, .limited(10 * 1024 * 1024)) catch |err| {
-        log.err("failed to read '{f}': {s}", .{ path, @errorName(err) });
+    var file = path.root_dir.handle.openFile(path.sub_path, .{}) catch |err| {
+        log.err("failed to open '{f}': {s}", .{ path, @errorName(err) });
         return error.AlreadyReported;
     };
-    defer gpa.free(file_contents);
-    try request.respond(file_contents, .{
+    defer file.close();
+    var file_reader = file.reader(io, &.{});
+    var send_buffer: [4096]u8 = undefined;
+    try request.respondFile(&send_buffer, &file_reader, .{
         .extra_headers = &.{
             .{ .name = "Content-Type", .value = content_type },
             cache_control_header,
@@ -690,6 +722,7 @@ pub fn updateTimeReportCompile(ws: *WebServer, opts: struct {
     llvm_pass_timings_len: u32,
     files_len: u32,
     decls_len: u32,
+    fns_len: u32,
 
     /// The trailing data of `abi.time_report.CompileResult`, except the step name.
     trailing: []const u8,
@@ -720,6 +753,7 @@ pub fn updateTimeReportCompile(ws: *WebServer, opts: struct {
         .llvm_pass_timings_len = opts.llvm_pass_timings_len,
         .files_len = opts.files_len,
         .decls_len = opts.decls_len,
+        .fns_len = opts.fns_len,
     };
     @memcpy(buf[@sizeOf(abi.time_report.CompileResult)..], opts.trailing);
 
@@ -821,6 +855,53 @@ pub fn updateTimeReportRunTest(
     ws.notifyUpdate();
 }
 
+pub fn updateMemReportCompile(ws: *WebServer, opts: struct {
+    compile: *Build.Step.Compile,
+
+    stats: abi.mem_report.CompileResult.Stats,
+
+    files_len: u32,
+    tags_len: u32,
+    decls_len: u32,
+
+    /// The trailing data of `abi.mem_report.CompileResult`.
+    trailing: []const u8,
+}) void {
+    const gpa = ws.gpa;
+
+    const step_idx: u32 = for (ws.all_steps, 0..) |s, i| {
+        if (s == &opts.compile.step) break @intCast(i);
+    } else unreachable;
+
+    const old_buf = old: {
+        ws.mem_report_mutex.lock();
+        defer ws.mem_report_mutex.unlock();
+        const old = ws.mem_report_msgs[step_idx];
+        ws.mem_report_msgs[step_idx] = &.{};
+        break :old old;
+    };
+    const buf = gpa.realloc(old_buf, @sizeOf(abi.mem_report.CompileResult) + opts.trailing.len) catch @panic("out of memory");
+
+    const out_header: *align(1) abi.mem_report.CompileResult = @ptrCast(buf[0..@sizeOf(abi.mem_report.CompileResult)]);
+    out_header.* = .{
+        .step_idx = step_idx,
+        .stats = opts.stats,
+        .files_len = opts.files_len,
+        .tags_len = opts.tags_len,
+        .decls_len = opts.decls_len,
+    };
+    @memcpy(buf[@sizeOf(abi.mem_report.CompileResult)..], opts.trailing);
+
+    {
+        ws.mem_report_mutex.lock();
+        defer ws.mem_report_mutex.unlock();
+        assert(ws.mem_report_msgs[step_idx].len == 0);
+        ws.mem_report_msgs[step_idx] = buf;
+        ws.mem_report_update_times[step_idx] = ws.now();
+    }
+    ws.notifyUpdate();
+}
+
 const RunnerRequest = union(enum) {
     rebuild,
 };
@@ -29,6 +29,7 @@ comptime {
     check(fuzz.EntryPointHeader);
     check(time_report.GenericResult);
     check(time_report.CompileResult);
+    check(mem_report.CompileResult);
 
     // client->server
     check(Rebuild);
@@ -58,6 +59,9 @@ pub const ToClientTag = enum(u8) {
     time_report_compile_result,
     time_report_run_test_result,
 
+    // `--mem-report`
+    mem_report_compile_result,
+
     _,
 };
 
@@ -292,6 +296,15 @@ pub const time_report = struct {
     ///   * `sema_ns: u64` (nanoseconds spent semantically analyzing this decl)
     ///   * `codegen_ns: u64` (nanoseconds spent semantically analyzing this decl)
     ///   * `link_ns: u64` (nanoseconds spent semantically analyzing this decl)
+    /// * for each `fns_len`:
+    ///   * `name` (null-terminated UTF-8 string)
+    ///   * `file: u32` (index of file this function is in)
+    ///   * `comptime_count: u32` (number of `comptime` calls of this function)
+    ///   * `comptime_memoized_count: u32` (number of those calls answered by memoization)
+    ///   * `generic_count: u32` (number of runtime calls of this generic function)
+    ///   * `generic_instances: u32` (number of those calls which created a new instance)
+    ///   * `comptime_branches: u64` (backwards branches evaluated by `comptime` calls)
+    ///   * `comptime_ns: u64` (nanoseconds spent evaluating `comptime` calls)
     pub const CompileResult = extern struct {
         tag: ToClientTag = .time_report_compile_result,
 
@@ -304,6 +317,7 @@ pub const time_report = struct {
         llvm_pass_timings_len: u32 align(1),
         files_len: u32 align(1),
         decls_len: u32 align(1),
+        fns_len: u32 align(1),
 
         pub const Flags = packed struct(u8) {
             use_llvm: bool,
@@ -360,3 +374,69 @@ pub const time_report = struct {
         tests_len: u32 align(1),
     };
 };
+
+/// ABI bits specifically relating to the memory report interface.
+pub const mem_report = struct {
+    /// WebSocket server->client.
+    ///
+    /// Sent after a `Step.Compile` finishes, providing the memory report of its last update.
+    ///
+    /// Trailing:
+    /// * for each `files_len`:
+    ///   * `name` (null-terminated UTF-8 string)
+    /// * for each `tags_len`:
+    ///   * `name` (null-terminated UTF-8 string; the name of an `InternPool` item tag)
+    ///   * `count: u32` (number of items with this tag)
+    ///   * `bytes: u64` (bytes occupied by those items and their extra data)
+    /// * for each `decls_len`:
+    ///   * `name` (null-terminated UTF-8 string)
+    ///   * `file: u32` (index of file this decl is in)
+    ///   * `sema_count: u32` (number of times this decl was analyzed)
+    ///   * `max_air_bytes: u32` (size of the largest single AIR in `air_bytes`)
+    ///   * `ip_bytes: u64` (bytes added to the `InternPool` while analyzing this decl)
+    ///   * `air_bytes: u64` (bytes of AIR produced for function bodies of this decl)
+    ///   * `link_bytes: u64` (bytes the linker holds for this decl)
+    pub const CompileResult = extern struct {
+        tag: ToClientTag = .mem_report_compile_result,
+
+        step_idx: u32 align(1),
+
+        stats: Stats align(1),
+
+        files_len: u32 align(1),
+        tags_len: u32 align(1),
+        decls_len: u32 align(1),
+
+        pub const Stats = extern struct {
+            /// Total size of the `InternPool`.
+            ip_bytes: u64,
+            /// The most AIR held at once between code generation and linking. Only meaningful
+            /// if `flags.separate_codegen`.
+            air_peak_bytes: u64,
+            /// Sum of `link_bytes` across all decls.
+            link_bytes: u64,
+            /// Only meaningful if `flags.dependency_gc`.
+            dependency_gc_bytes_before: u64,
+            /// Only meaningful if `flags.dependency_gc`.
+            dependency_gc_bytes_after: u64,
+
+            dep_entries: u32,
+            free_dep_entries: u32,
+            /// Only meaningful if `flags.dependency_gc`.
+            dependency_gc_entries_reclaimed: u32,
+            /// Only meaningful if `flags.dependency_gc`.
+            dependency_gc_dependees_removed: u32,
+            removed_items: u32,
+
+            flags: Flags,
+
+            pub const Flags = packed struct(u32) {
+                /// Code generation ran on threads separate from linking.
+                separate_codegen: bool,
+                /// The dependency tables were compacted at the end of the update.
+                dependency_gc: bool,
+                _: u30 = 0,
+            };
+        };
+    };
+};
@@ -165,7 +165,9 @@ pub const UpdateFileError = File.OpenError;
 /// they are equal, does nothing. Otherwise, atomically copies `source_path` to
 /// `dest_path`, creating the parent directory hierarchy as needed. The
 /// destination file gains the mtime, atime, and mode of the source file so
-/// that the next call to `updateFile` will not need a copy.
+/// that the next call to `updateFile` will not need a copy. On Linux, if both
+/// files are on a filesystem with reflink support, the copy shares the data of
+/// the source file.
 ///
 /// Returns the previous status of the file before updating.
 ///
@@ -3,7 +3,7 @@
 //! The source of an `error.WriteFailed` is always the backing writer. After an
 //! `error.WriteFailed`, the `.writer` becomes `.failing` and is unrecoverable.
 //! After a `flush`, the writer also becomes `.failing` since the stream has
-//! been finished. This behavior also applies to `Raw` and `Huffman`.
+//! been finished. This behavior also applies to `Raw`, `Huffman` and `Parallel`.
 
 // Implementation details:
 //   A chained hash table is used to find matches. `drain` always preserves `flate.history_len`
@@ -198,7 +198,7 @@ fn outputMatch(c: *Compress, dist: u15, len: u8) Writer.Error!void {
     // draining it is defered to allow end of stream to be indicated.
     if (c.buffered_tokens.n == block_tokens) {
         @branchHint(.unlikely); // LLVM 21 optimizes this branch as the more likely without
-        try c.writeBlock(false);
+        try c.writeBlock(false, false);
     }
     const header: TokenBufferEntryHeader = .{ .kind = .match, .data = dist };
     c.buffered_tokens.list[c.buffered_tokens.pos..][0..2].* = @bitCast(header);
@@ -215,7 +215,7 @@ fn outputBytes(c: *Compress, bytes: []const u8) Writer.Error!void {
     while (remaining.len != 0) {
         if (c.buffered_tokens.n == block_tokens) {
             @branchHint(.unlikely); // LLVM 21 optimizes this branch as the more likely without
-            try c.writeBlock(false);
+            try c.writeBlock(false, false);
         }
 
         const n = @min(remaining.len, block_tokens - c.buffered_tokens.n, math.maxInt(u15));
@@ -250,6 +250,12 @@ pub const Options = struct {
     lazy: u16,
     /// Check this many previous locations with the same hash for longer matches.
     chain: u16,
+    /// The number of bytes compressed at once by each task of `Parallel`. Larger blocks compress
+    /// slightly better since matches do not cross blocks. Must be at least `flate.history_len`.
+    block_size: u32 = 128 * 1024,
+    /// The number of blocks `Parallel` compresses at once, as tasks of an `Io.Group`. How many of
+    /// them run in parallel is up to the `Io` implementation. If null, the number of CPUs is used.
+    threads: ?u16 = null,
 
     // zig fmt: off
     pub const level_1: Options = .{ .good =  4, .nice =   8, .lazy =   0, .chain =    4 };
@@ -327,10 +333,41 @@ fn drain(w: *Writer, data: []const []const u8, splat: usize) Writer.Error!usize
 fn flush(w: *Writer) Writer.Error!void {
     defer w.* = .failing;
     const c: *Compress = @fieldParentPtr("writer", w);
-    try rebaseInner(w, 0, w.buffer.len - flate.history_len, true);
+    try c.finish(true);
+    try c.hasher.writeFooter(c.bit_writer.output);
+}
+
+/// Compresses all of the buffered bytes and byte-aligns the output. If not `final`, the last block
+/// is followed by an empty stored block, like `Z_SYNC_FLUSH` of zlib, so that another deflate
+/// stream can be appended to the output. `Parallel` does this to concatenate its blocks.
+fn finish(c: *Compress, final: bool) Writer.Error!void {
+    try rebaseInner(&c.writer, 0, c.writer.buffer.len - flate.history_len, true);
+    if (final or c.buffered_tokens.n != 0) try c.writeBlock(true, final);
+    if (!final) {
+        try c.bit_writer.write(BlockHeader.int(.{ .kind = .stored, .final = false }), 3);
+        try c.bit_writer.output.rebase(0, 5);
+        c.bit_writer.byteAlign();
+        c.bit_writer.output.writeAll(&.{ 0x00, 0x00, 0xff, 0xff }) catch unreachable;
+        return;
+    }
     try c.bit_writer.output.rebase(0, 1);
     c.bit_writer.byteAlign();
-    try c.hasher.writeFooter(c.bit_writer.output);
+}
+
+/// Makes `history` the preceding bytes of the stream, so matches can refer to them without them
+/// being written. Asserts nothing has been written yet.
+fn setHistory(c: *Compress, history: *const [flate.history_len]u8) void {
+    assert(!c.has_history and c.writer.end == 0);
+    @memcpy(c.writer.buffer[0..flate.history_len], history);
+    c.writer.end = flate.history_len;
+    c.has_history = true;
+
+    // The sequences of the last bytes include bytes which have not been written yet. They are
+    // skipped, but still take their places in the chain so positions stay in sync.
+    for (0..flate.history_len - (seq_bytes - 1)) |i| {
+        c.addHash(i, hash(mem.readInt(Seq, history[i..][0..seq_bytes], .big)));
+    }
+    c.lookup.chain_pos +%= seq_bytes - 1;
 }
 
 fn rebase(w: *Writer, preserve: usize, capacity: usize) Writer.Error!void {
@@ -445,7 +482,6 @@ fn rebaseInner(w: *Writer, preserve: usize, capacity: usize, eos: bool) Writer.E
         i = undefined; // (from match hashing logic)
         try c.outputBytes(buffered[last_unmatched..]);
         c.hasher.update(buffered[start..]);
-        try c.writeBlock(true);
         return;
     }
 
@@ -806,9 +842,11 @@ test buildClen {
     }, &out_freqs);
 }
 
-fn writeBlock(c: *Compress, eos: bool) Writer.Error!void {
+/// `final` sets the final flag of the block, which is only allowed at `eos`.
+fn writeBlock(c: *Compress, eos: bool, final: bool) Writer.Error!void {
     const toks = &c.buffered_tokens;
     if (!eos) assert(toks.n == block_tokens);
+    assert(eos or !final);
     assert(toks.lit_freqs[256] == 0);
     toks.lit_freqs[256] = 1;
 
@@ -886,7 +924,7 @@ fn writeBlock(c: *Compress, eos: bool) Writer.Error!void {
         const stored_bitsize = stored_align_bits + @as(u32, 32) + @as(u32, toks.n) * 8;
         if (@min(dynamic_bitsize, fixed_bitsize) < stored_bitsize) break :stored;
 
-        try c.bit_writer.write(BlockHeader.int(.{ .kind = .stored, .final = eos }), 3);
+        try c.bit_writer.write(BlockHeader.int(.{ .kind = .stored, .final = final }), 3);
         try c.bit_writer.output.rebase(0, 5);
         c.bit_writer.byteAlign();
         c.bit_writer.output.writeInt(u16, c.buffered_tokens.n, .little) catch unreachable;
@@ -921,7 +959,7 @@ fn writeBlock(c: *Compress, eos: bool) Writer.Error!void {
     const lit_codes, const lit_bits, const dist_codes, const dist_bits =
         if (dynamic_bitsize < fixed_bitsize) codes: {
             try c.bit_writer.write(BlockHeader.Dynamic.int(.{
-                .regular = .{ .final = eos, .kind = .dynamic },
+                .regular = .{ .final = final, .kind = .dynamic },
                 .hlit = @intCast(dyn_lit_len - 257),
                 .hdist = @intCast(dyn_dist_len - 1),
                 .hclen = hclen,
@@ -940,7 +978,7 @@ fn writeBlock(c: *Compress, eos: bool) Writer.Error!void {
                 dyn_bits_buf[dyn_lit_len..][0..dyn_dist_len],
             };
         } else codes: {
-            try c.bit_writer.write(BlockHeader.int(.{ .final = eos, .kind = .fixed }), 3);
+            try c.bit_writer.write(BlockHeader.int(.{ .final = final, .kind = .fixed }), 3);
             break :codes .{
                 &token.fixed_lit_codes,
                 &token.fixed_lit_bits,
@@ -1547,6 +1585,285 @@ fn testFuzzedCompressInput(fbufs: *const [2][65536]u8, input: []const u8) !void
     try testingCheckDecompressedMatches(flate_w.buffered(), expected_size, expected_hash);
 }
 
+/// Compresses `Options.threads` blocks of `Options.block_size` bytes at once as tasks of an
+/// `Io.Group`, in the manner of pigz. Each block is compressed on its own with the `flate.history_len` bytes before
+/// it as the history, and all but the last block end with an empty stored block to byte-align
+/// them, so the blocks concatenate into a single standard stream. The output does not depend on
+/// the number of threads, but is slightly larger than that of `Compress` since matches are not
+/// made across blocks and each block has its own block headers.
+///
+/// The compressed blocks are buffered with `gpa`, which must be thread-safe. A failure to allocate
+/// them also results in `error.WriteFailed`.
+pub const Parallel = struct {
+    /// After `flush` is called, all vtable calls with result in `error.WriteFailed.`
+    writer: Writer,
+    gpa: std.mem.Allocator,
+    output: *Writer,
+    /// Has room for `flate.history_len` bytes of history followed by a block for each thread. Until
+    /// there is a history, the buffer of `writer` excludes its room.
+    buffer: []u8,
+    has_history: bool,
+    hasher: flate.Container.Hasher,
+    opts: Options,
+    io: Io,
+    /// One for each task.
+    blocks: []Block,
+
+    const Block = struct {
+        compress: Compress,
+        buffer: [flate.max_window_len]u8,
+        output: Writer.Allocating,
+        failed: bool,
+    };
+
+    pub const InitError = std.mem.Allocator.Error || Writer.Error;
+
+    /// Asserts `opts.block_size` is at least `flate.history_len`, `opts.threads` is not zero, and
+    /// together they make room for more than `flate.history_len` bytes, which is needed to buffer
+    /// anything besides the history.
+    pub fn init(
+        gpa: std.mem.Allocator,
+        io: Io,
+        output: *Writer,
+        container: flate.Container,
+        opts: Options,
+    ) InitError!Parallel {
+        assert(opts.block_size >= flate.history_len);
+        const threads: u16 = opts.threads orelse
+            math.lossyCast(u16, std.Thread.getCpuCount() catch 1);
+        assert(threads != 0);
+        assert(@as(usize, opts.block_size) * threads > flate.history_len);
+
+        const buffer = try gpa.alloc(u8, flate.history_len + @as(usize, opts.block_size) * threads);
+        errdefer gpa.free(buffer);
+        const blocks = try gpa.alloc(Block, threads);
+        errdefer gpa.free(blocks);
+        for (blocks) |*block| block.output = .init(gpa);
+
+        try output.writeAll(container.header());
+        return .{
+            .writer = .{
+                .buffer = buffer[0 .. buffer.len - flate.history_len],
+                .vtable = &.{
+                    .drain = Parallel.drain,
+                    .flush = Parallel.flush,
+                    .rebase = Parallel.rebase,
+                },
+            },
+            .gpa = gpa,
+            .output = output,
+            .buffer = buffer,
+            .has_history = false,
+            .hasher = .init(container),
+            .opts = opts,
+            .io = io,
+            .blocks = blocks,
+        };
+    }
+
+    pub fn deinit(p: *Parallel) void {
+        for (p.blocks) |*block| block.output.deinit();
+        p.gpa.free(p.blocks);
+        p.gpa.free(p.buffer);
+        p.* = undefined;
+    }
+
+    fn drain(w: *Writer, data: []const []const u8, splat: usize) Writer.Error!usize {
+        errdefer w.* = .failing;
+        const p: *Parallel = @fieldParentPtr("writer", w);
+        // Filling the buffer first keeps the blocks at `Options.block_size`.
+        const data_n = w.buffer.len - w.end;
+        _ = w.fixedDrain(data, splat) catch {};
+        assert(w.end == w.buffer.len);
+        try p.compressBuffered(false);
+        return data_n;
+    }
+
+    fn flush(w: *Writer) Writer.Error!void {
+        defer w.* = .failing;
+        const p: *Parallel = @fieldParentPtr("writer", w);
+        try p.compressBuffered(true);
+        try p.hasher.writeFooter(p.output);
+    }
+
+    fn rebase(w: *Writer, preserve: usize, capacity: usize) Writer.Error!void {
+        errdefer w.* = .failing;
+        const p: *Parallel = @fieldParentPtr("writer", w);
+        // Before there is a history, the buffer of `writer` has room for this many bytes after
+        // `flate.history_len` of them, so when a rebase is needed there are enough bytes buffered
+        // to keep a history. `init` ensures this is not zero.
+        assert(preserve <= flate.history_len and capacity <= p.buffer.len - flate.max_window_len);
+        if (w.buffer.len - w.end >= capacity) return;
+        try p.compressBuffered(false);
+    }
+
+    /// Unless `final`, asserts at least `flate.history_len` bytes are buffered. The last of those
+    /// are kept as the history of the next blocks.
+    fn compressBuffered(p: *Parallel, final: bool) Writer.Error!void {
+        const w = &p.writer;
+        const start = @as(usize, flate.history_len) * @intFromBool(p.has_history);
+        if (!final) assert(w.end >= flate.history_len);
+
+        var group: Io.Group = .init;
+        var blocks_n: usize = 0;
+        var block_start = start;
+        while (true) {
+            const block_end = @min(block_start + p.opts.block_size, w.end);
+            const last = block_end == w.end;
+            const history = if (block_start == 0)
+                null
+            else
+                w.buffer[block_start - flate.history_len ..][0..flate.history_len];
+            group.async(p.io, compressBlock, .{
+                &p.blocks[blocks_n],
+                history,
+                w.buffer[block_start..block_end],
+                final and last,
+                p.opts,
+            });
+            blocks_n += 1;
+            block_start = block_end;
+            if (last) break;
+        }
+        // The checksum is computed while the blocks are compressed.
+        p.hasher.update(w.buffer[start..w.end]);
+        group.wait(p.io);
+
+        for (p.blocks[0..blocks_n]) |*block| {
+            if (block.failed) return error.WriteFailed;
+            try p.output.writeAll(block.output.written());
+        }
+        if (final) return;
+
+        @memmove(p.buffer[0..flate.history_len], w.buffer[w.end - flate.history_len .. w.end]);
+        w.buffer = p.buffer;
+        w.end = flate.history_len;
+        p.has_history = true;
+    }
+
+    fn compressBlock(
+        block: *Block,
+        history: ?*const [flate.history_len]u8,
+        bytes: []const u8,
+        final: bool,
+        opts: Options,
+    ) void {
+        block.output.clearRetainingCapacity();
+        block.failed = false;
+        compressBlockInner(block, history, bytes, final, opts) catch {
+            block.failed = true;
+        };
+    }
+
+    fn compressBlockInner(
+        block: *Block,
+        history: ?*const [flate.history_len]u8,
+        bytes: []const u8,
+        final: bool,
+        opts: Options,
+    ) (Writer.Error || std.mem.Allocator.Error)!void {
+        // Most blocks are compressed without growing the output.
+        try block.output.ensureTotalCapacity(@max(bytes.len / 2, 64));
+        block.compress = Compress.init(&block.output.writer, &block.buffer, .raw, opts) catch
+            unreachable; // a raw container has no header
+        if (history) |h| block.compress.setHistory(h);
+        try block.compress.writer.writeAll(bytes);
+        try block.compress.finish(final);
+    }
+};
+
+test Parallel {
+    const gpa = std.testing.allocator;
+    const io = std.testing.io;
+    const fbufs = try testingFreqBufs();
+    defer gpa.destroy(fbufs);
+
+    // The data repeats more often than `flate.history_len`, so that there are matches with the
+    // history of each block.
+    const input = try gpa.alloc(u8, 5 * 65536 + 1234);
+    defer gpa.free(input);
+    for (input, 0..) |*b, i| b.* = fbufs[(i / 100_000) % 2][i % 30_000];
+
+    for ([_]flate.Container{ .raw, .gzip, .zlib }) |container| {
+        var single: Writer.Allocating = .init(gpa);
+        defer single.deinit();
+
+        for ([_]u16{ 1, 3 }) |threads| {
+            var out: Writer.Allocating = .init(gpa);
+            defer out.deinit();
+            var opts: Options = .default;
+            // One block of this size is enough to buffer more than the history.
+            opts.block_size = flate.history_len + 100;
+            opts.threads = threads;
+
+            var p: Parallel = try .init(gpa, io, &out.writer, container, opts);
+            defer p.deinit();
+            // Writes of odd sizes go through both the buffer and `drain`.
+            var rest = input;
+            while (rest.len != 0) {
+                const n = @min(rest.len, 12345);
+                try p.writer.writeAll(rest[0..n]);
+                rest = rest[n..];
+            }
+            try p.writer.flush();
+
+            var expected_hash: flate.Container.Hasher = .init(container);
+            expected_hash.update(input);
+            try testingCheckDecompressedMatches(out.written(), @intCast(input.len), expected_hash);
+
+            var in: Io.Reader = .fixed(out.written());
+            var window: [flate.max_window_len]u8 = undefined;
+            var decompress: flate.Decompress = .init(&in, container, &window);
+            const decompressed = try decompress.reader.allocRemaining(gpa, .unlimited);
+            defer gpa.free(decompressed);
+            try std.testing.expectEqualSlices(u8, input, decompressed);
+            try std.testing.expect(out.written().len < input.len / 2);
+
+            if (threads == 1) {
+                try single.writer.writeAll(out.written());
+            } else {
+                try std.testing.expectEqualSlices(u8, single.written(), out.written());
+            }
+        }
+
+        {
+            // Writing through `writableSlice` rebases, including before there is a history, with
+            // the smallest buffer allowed.
+            var out: Writer.Allocating = .init(gpa);
+            defer out.deinit();
+            var opts: Options = .default;
+            opts.block_size = flate.history_len + 100;
+            opts.threads = 1;
+            var p: Parallel = try .init(gpa, io, &out.writer, container, opts);
+            defer p.deinit();
+            var rest = input;
+            while (rest.len != 0) {
+                const n = @min(rest.len, 64);
+                @memcpy(try p.writer.writableSlice(n), rest[0..n]);
+                rest = rest[n..];
+            }
+            try p.writer.flush();
+
+            var expected_hash: flate.Container.Hasher = .init(container);
+            expected_hash.update(input);
+            try testingCheckDecompressedMatches(out.written(), @intCast(input.len), expected_hash);
+        }
+
+        var empty: Writer.Allocating = .init(gpa);
+        defer empty.deinit();
+        var p: Parallel = try .init(gpa, io, &empty.writer, container, .{
+            .good = 8,
+            .nice = 128,
+            .lazy = 16,
+            .chain = 128,
+            .threads = 2,
+        });
+        defer p.deinit();
+        try p.writer.flush();
+        try testingCheckDecompressedMatches(empty.written(), 0, .init(container));
+    }
+}
+
 /// Does not compress data
 pub const Raw = struct {
     /// After `flush` is called, all vtable calls with result in `error.WriteFailed.`
@@ -18,6 +18,8 @@ container_metadata: Container.Metadata,
 
 lit_dec: LiteralDecoder,
 dst_dec: DistanceDecoder,
+/// Generated from `lit_dec` for each dynamic block, used by `decodeDynamicFast`.
+lit_pairs: LiteralPairs,
 
 final_block: bool,
 state: State,
@@ -90,6 +92,7 @@ pub fn init(input: *Reader, container: Container, buffer: []u8) Decompress {
         .container_metadata = .init(container),
         .lit_dec = .{},
         .dst_dec = .{},
+        .lit_pairs = undefined,
         .final_block = false,
         .state = .protocol_header,
         .err = null,
@@ -359,6 +362,7 @@ fn streamInner(d: *Decompress, w: *Writer, limit: std.Io.Limit) (Error || Reader
 
                     // literal code lengths to literal decoder
                     try d.lit_dec.generate(dec_lens[0..hlit]);
+                    d.lit_pairs.generate(&d.lit_dec);
 
                     // distance code lengths to distance decoder
                     try d.dst_dec.generate(dec_lens[hlit..][0..hdist]);
@@ -434,15 +438,15 @@ fn streamInner(d: *Decompress, w: *Writer, limit: std.Io.Limit) (Error || Reader
         .dynamic_block => {
             // In larger archives most blocks are usually dynamic, so
             // decompression performance depends on this logic.
-            var sym = try d.decodeSymbol(&d.lit_dec);
-            sym: switch (sym.kind) {
+            remaining -= d.decodeDynamicFast(w, remaining);
+            const sym = try d.decodeSymbol(&d.lit_dec);
+            switch (sym.kind) {
                 .literal => {
                     if (remaining != 0) {
                         @branchHint(.likely);
                         remaining -= 1;
                         try w.writeBytePreserve(flate.history_len, sym.symbol);
-                        sym = try d.decodeSymbol(&d.lit_dec);
-                        continue :sym sym.kind;
+                        continue :sw .dynamic_block;
                     } else {
                         d.state = .{ .dynamic_block_literal = sym.symbol };
                         return @intFromEnum(limit) - remaining;
@@ -497,6 +501,112 @@ fn streamInner(d: *Decompress, w: *Writer, limit: std.Io.Limit) (Error || Reader
     }
 }
 
+/// Decodes the literals and matches of a dynamic block for as long as the input
+/// has enough bytes buffered for any symbol with its extra bits, and `w` has
+/// enough unused capacity for the longest match, so that neither needs to be
+/// checked for each symbol. Returns the number of bytes written to `w`.
+///
+/// Stops before the end of the block, and before any symbol which is invalid;
+/// these are left to `streamInner`, which reports errors in the usual way.
+fn decodeDynamicFast(d: *Decompress, w: *Writer, limit: usize) usize {
+    const in = d.input;
+    const out_start = w.end;
+    // `copyMatch` may write up to `match_copy_len - 1` bytes past a match.
+    const out_end = @min(out_start +| limit, w.buffer.len -| (match_copy_len - 1));
+    var out = out_start;
+    var bit_pos: usize = in.seek * 8 + d.consumed_bits;
+    defer {
+        in.seek = bit_pos / 8;
+        d.consumed_bits = @intCast(bit_pos % 8);
+        w.end = out;
+    }
+
+    refill: while (bit_pos / 8 + 8 <= in.end and out + token.max_length <= out_end) {
+        // After a refill at least 57 bits are available. A length code with
+        // its extra bits, distance code, and extra bits takes at most 48.
+        var bits = std.mem.readInt(u64, in.buffer[bit_pos / 8 ..][0..8], .little) >> @intCast(bit_pos % 8);
+        var used: u6 = 0;
+        while (true) {
+            const pair = d.lit_pairs.entries[@as(LiteralPairs.Index, @truncate(bits))];
+            if (pair.count != 0) {
+                // The second byte is written even if it is not part of the
+                // pair, which the capacity reserved for a match allows.
+                w.buffer[out..][0..2].* = .{ pair.first, pair.second };
+                out += pair.count;
+                bits >>= pair.code_bits;
+                bit_pos += pair.code_bits;
+                used += pair.code_bits;
+                if (used > 57 - 15) continue :refill;
+                continue;
+            }
+            const sym = d.lit_dec.find(@bitReverse(@as(u15, @truncate(bits)))) catch break :refill;
+            switch (sym.kind) {
+                .literal => {
+                    // Decode as many literals as the bits allow before refilling.
+                    w.buffer[out] = sym.symbol;
+                    out += 1;
+                    bits >>= sym.code_bits;
+                    bit_pos += sym.code_bits;
+                    used += sym.code_bits;
+                    if (used > 57 - 15) continue :refill;
+                },
+                .match => {
+                    if (used != 0) continue :refill;
+                    if (sym.symbol > 28) break :refill;
+                    var n: u6 = sym.code_bits;
+
+                    const lc: token.LenCode = .fromInt(@intCast(sym.symbol));
+                    const length = token.min_length + (lc.base() | extraBitsAt(bits, n, lc.extraBits()));
+                    n += lc.extraBits();
+
+                    const dsym = d.dst_dec.find(@bitReverse(@as(u15, @truncate(bits >> n)))) catch break :refill;
+                    if (dsym.symbol > 29) break :refill;
+                    n += dsym.code_bits;
+                    const dc: token.DistCode = .fromInt(@intCast(dsym.symbol));
+                    const distance = token.min_distance + (dc.base() | extraBitsAt(bits, n, dc.extraBits()));
+                    n += dc.extraBits();
+
+                    if (distance > out) break :refill;
+                    copyMatch(w.buffer, out, length, distance);
+                    out += length;
+                    bit_pos += n;
+                    continue :refill;
+                },
+                .end_of_block => break :refill,
+            }
+        }
+    }
+    return out - out_start;
+}
+
+fn extraBitsAt(bits: u64, shift: u6, n: u4) u16 {
+    const mask = @shlExact(@as(u16, 1), n) - 1;
+    return @as(u16, @truncate(bits >> shift)) & mask;
+}
+
+/// Number of bytes copied at once by `copyMatch`.
+const match_copy_len = 16;
+
+/// Copies the match ending at `buffer[out..][0..length]` from `distance` bytes
+/// back. Asserts that `buffer` has `match_copy_len - 1` bytes of capacity after
+/// the match, which may be overwritten.
+fn copyMatch(buffer: []u8, out: usize, length: u16, distance: u16) void {
+    assert(out + length + match_copy_len - 1 <= buffer.len);
+    if (distance >= match_copy_len) {
+        // Each chunk is read entirely from before the chunk being written, so
+        // repeated patterns come out the same as copying one byte at a time.
+        var i: usize = 0;
+        while (i < length) : (i += match_copy_len) {
+            const chunk: @Vector(match_copy_len, u8) = buffer[out + i - distance ..][0..match_copy_len].*;
+            buffer[out + i ..][0..match_copy_len].* = chunk;
+        }
+    } else if (distance == 1) {
+        @memset(buffer[out..][0..length], buffer[out - 1]);
+    } else {
+        for (buffer[out..][0..length], buffer[out - distance ..][0..length]) |*dest, src| dest.* = src;
+    }
+}
+
 /// Write match (back-reference to the same data slice) starting at `distance`
 /// back from current write position, and `length` of bytes.
 fn writeMatch(w: *Writer, length: u16, distance: u16) !void {
@@ -634,6 +744,56 @@ pub const LiteralDecoder = HuffmanDecoder(286, 15, 9);
 pub const DistanceDecoder = HuffmanDecoder(30, 15, 9);
 pub const CodegenDecoder = HuffmanDecoder(19, 7, 7);
 
+/// Maps the next `lookup_bits` bits of the input to the one or two literals
+/// whose codes they begin with, so that runs of short literal codes can be
+/// decoded with one lookup per pair.
+pub const LiteralPairs = struct {
+    entries: [1 << lookup_bits]Entry,
+
+    const lookup_bits = 10;
+    pub const Index = std.meta.Int(.unsigned, lookup_bits);
+
+    pub const Entry = packed struct(u32) {
+        first: u8,
+        second: u8,
+        /// Total length of the codes of the literals.
+        code_bits: u4,
+        /// 0 if the bits do not begin with a literal code of at most
+        /// `lookup_bits` bits.
+        count: u2,
+        _: u10 = 0,
+    };
+
+    pub fn generate(p: *LiteralPairs, dec: *const LiteralDecoder) void {
+        // The entries of single literals are filled first.
+        @memset(&p.entries, .{ .first = 0, .second = 0, .code_bits = 0, .count = 0 });
+        for (dec.symbols) |sym| {
+            if (sym.kind != .literal or sym.code_bits == 0 or sym.code_bits > lookup_bits) continue;
+            // Codes are stored starting with their most significant bit,
+            // whereas they are read from the input least significant bit first.
+            const bits: Index = @truncate(@bitReverse(sym.code) >> 1);
+            const step = @as(usize, 1) << sym.code_bits;
+            var i: usize = bits & (step - 1);
+            while (i < p.entries.len) : (i += step) {
+                p.entries[i] = .{ .first = sym.symbol, .second = 0, .code_bits = sym.code_bits, .count = 1 };
+            }
+        }
+        // Then, each is paired with the literal in its remaining bits, if any.
+        // Those are at a lower index, so going backwards they are still single.
+        var i: usize = p.entries.len;
+        while (i > 0) {
+            i -= 1;
+            const e = &p.entries[i];
+            if (e.count != 1) continue;
+            const next = p.entries[i >> e.code_bits];
+            if (next.count == 0 or @as(u5, e.code_bits) + next.code_bits > lookup_bits) continue;
+            e.second = next.first;
+            e.code_bits += next.code_bits;
+            e.count = 2;
+        }
+    }
+};
+
 /// Creates huffman tree codes from list of code lengths (in `build`).
 ///
 /// `find` then finds symbol for code bits. Code can be any length between 1 and
@@ -874,6 +1034,40 @@ test "encode/decode literals" {
     }
 }
 
+test LiteralPairs {
+    // The fixed literal/length code, including the two unused length codes.
+    var dec: LiteralDecoder = .{};
+    try dec.generate(&[_]u4{8} ** 144 ++ [_]u4{9} ** 112 ++ [_]u4{7} ** 24 ++ [_]u4{8} ** 8);
+    var pairs: LiteralPairs = undefined;
+    pairs.generate(&dec);
+
+    // Literals 0 - 143 have 8 bit codes, so no pairs fit into 10 bits.
+    const a = pairs.entries[@bitReverse(@as(u8, 0b00110000 + 'a'))];
+    try testing.expectEqual(1, a.count);
+    try testing.expectEqual('a', a.first);
+    try testing.expectEqual(8, a.code_bits);
+
+    // Literals 144 - 255 have 9 bit codes, longer ones are not in the table.
+    try testing.expectEqual(1, pairs.entries[@bitReverse(@as(u9, 0b110010000))].count);
+    try testing.expectEqual(0, pairs.entries[@bitReverse(@as(u7, 0b0000000))].count);
+
+    // Literals 3 - 8 have codes 000 through 101, and literals 0 - 2 and the
+    // end of the block have codes 1100 through 1111.
+    try dec.generate(&[_]u4{ 4, 4, 4, 3, 3, 3, 3, 3, 3 } ++ [_]u4{0} ** 247 ++ [_]u4{4});
+    pairs.generate(&dec);
+    // Literal 5 followed by literal 1, each code starting from its lowest bit.
+    const pair = pairs.entries[0b1011_010];
+    try testing.expectEqual(2, pair.count);
+    try testing.expectEqual(5, pair.first);
+    try testing.expectEqual(1, pair.second);
+    try testing.expectEqual(7, pair.code_bits);
+    // Literal 2 followed by the end of the block.
+    const single = pairs.entries[0b1111_0111];
+    try testing.expectEqual(1, single.count);
+    try testing.expectEqual(2, single.first);
+    try testing.expectEqual(4, single.code_bits);
+}
+
 test "non compressed block (type 0)" {
     try testDecompress(.raw, &[_]u8{
         0b0000_0001, 0b0000_1100, 0x00, 0b1111_0011, 0xff, // deflate fixed buffer header len, nlen
@@ -0,0 +1,102 @@
+// zig run -O ReleaseFast --zig-lib-dir ../../.. benchmark.zig -- [file]...
+//
+// Measures the decompression throughput of `std.compress.flate.Decompress` on each input, compressed
+// at several levels with `std.compress.flate.Compress`. Without arguments, the input is
+// `testdata/rfc1951.txt`. Inputs ending in `.gz` are measured as they are, so that the same streams
+// can be timed with other implementations, such as `minigzip -d` of zlib-ng.
+
+const std = @import("std");
+const flate = std.compress.flate;
+const Timer = std.time.Timer;
+
+const MiB = 1024 * 1024;
+
+/// Each measurement decompresses for at least this long.
+const min_ns = std.time.ns_per_s;
+
+const levels = [_]struct { name: []const u8, opts: flate.Compress.Options }{
+    .{ .name = "fastest", .opts = .fastest },
+    .{ .name = "default", .opts = .default },
+    .{ .name = "best", .opts = .best },
+};
+
+fn compress(gpa: std.mem.Allocator, input: []const u8, opts: flate.Compress.Options) ![]u8 {
+    var out: std.Io.Writer.Allocating = .init(gpa);
+    defer out.deinit();
+    const buffer = try gpa.alloc(u8, flate.max_window_len);
+    defer gpa.free(buffer);
+    var c = try flate.Compress.init(&out.writer, buffer, .gzip, opts);
+    try c.writer.writeAll(input);
+    try c.writer.flush();
+    return out.toOwnedSlice();
+}
+
+fn decompress(gz: []const u8, w: *std.Io.Writer) !usize {
+    var in: std.Io.Reader = .fixed(gz);
+    var buffer: [flate.max_window_len]u8 = undefined;
+    var d: flate.Decompress = .init(&in, .gzip, &buffer);
+    return d.reader.streamRemaining(w) catch |err| switch (err) {
+        error.ReadFailed => return d.err.?,
+        else => |e| return e,
+    };
+}
+
+fn benchmark(gpa: std.mem.Allocator, stdout: *std.Io.Writer, path: []const u8, input: []const u8) !void {
+    if (std.mem.endsWith(u8, path, ".gz")) {
+        return measure(stdout, path, "-", input);
+    }
+    for (levels) |level| {
+        const gz = try compress(gpa, input, level.opts);
+        defer gpa.free(gz);
+
+        var out: std.Io.Writer.Allocating = .init(gpa);
+        defer out.deinit();
+        _ = try decompress(gz, &out.writer);
+        if (!std.mem.eql(u8, input, out.written())) return error.Mismatch;
+
+        try measure(stdout, path, level.name, gz);
+    }
+}
+
+fn measure(stdout: *std.Io.Writer, path: []const u8, level: []const u8, gz: []const u8) !void {
+    var discarding: std.Io.Writer.Discarding = .init(&.{});
+    var len: usize = 0;
+    var count: u64 = 0;
+    var timer = try Timer.start();
+    while (timer.read() < min_ns) : (count += 1) {
+        len = try decompress(gz, &discarding.writer);
+    }
+    const elapsed_s = @as(f64, @floatFromInt(timer.read())) / std.time.ns_per_s;
+    try stdout.print("{s: <40} {s: >8} {d: >6.2}% {d: >10.1} MiB/s\n", .{
+        std.fs.path.basename(path),
+        level,
+        @as(f64, @floatFromInt(gz.len)) * 100 / @as(f64, @floatFromInt(len)),
+        @as(f64, @floatFromInt(len * count)) / MiB / elapsed_s,
+    });
+    try stdout.flush();
+}
+
+pub fn main() !void {
+    var stdout_buffer: [0x100]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const stdout = &stdout_writer.interface;
+
+    var gpa_state: std.heap.DebugAllocator(.{}) = .init;
+    defer _ = gpa_state.deinit();
+    const gpa = gpa_state.allocator();
+
+    const args = try std.process.argsAlloc(gpa);
+    defer std.process.argsFree(gpa, args);
+
+    try stdout.print("{s: <40} {s: >8} {s: >7} {s: >16}\n", .{ "input", "level", "ratio", "throughput" });
+    if (args.len <= 1) {
+        const path = "testdata/rfc1951.txt";
+        try benchmark(gpa, stdout, path, @embedFile(path));
+        return;
+    }
+    for (args[1..]) |path| {
+        const input = try std.fs.cwd().readFileAlloc(path, gpa, .unlimited);
+        defer gpa.free(input);
+        try benchmark(gpa, stdout, path, input);
+    }
+}
@@ -366,8 +366,10 @@ test {
     _ = random;
     _ = errors;
     _ = tls;
+    _ = tls.Server;
     _ = Certificate;
     _ = codecs;
+    _ = @import("crypto/runtime_features.zig");
 }
 
 test "CSPRNG" {
@@ -28,6 +28,10 @@ pub const AesDecryptCtx = impl.AesDecryptCtx;
 pub const Aes128 = impl.Aes128;
 pub const Aes256 = impl.Aes256;
 
+test {
+    _ = @import("aes/soft.zig");
+}
+
 test "encrypt" {
     // Appendix B
     {
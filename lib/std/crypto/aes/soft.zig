@@ -1,6 +1,8 @@
 const std = @import("../../std.zig");
+const builtin = @import("builtin");
 const math = std.math;
 const mem = std.mem;
+const runtime_features = @import("../runtime_features.zig");
 
 const side_channels_mitigations = std.options.side_channels_mitigations;
 
@@ -531,6 +533,10 @@ pub fn AesEncryptCtx(comptime Aes: type) type {
 
         /// Encrypt a single block.
         pub fn encrypt(ctx: Self, dst: *[16]u8, src: *const [16]u8) void {
+            if (runtime_features.enabled and runtime_features.has(.aes)) {
+                dst.* = aesni_runtime.encrypt(rounds, &ctx.key_schedule.round_keys, src.*);
+                return;
+            }
             const round_keys = ctx.key_schedule.round_keys;
             var t = Block.fromBytes(src).xorBlocks(round_keys[0]);
             comptime var i = 1;
@@ -553,6 +559,11 @@ pub fn AesEncryptCtx(comptime Aes: type) type {
 
         /// Encrypt+XOR a single block.
         pub fn xor(ctx: Self, dst: *[16]u8, src: *const [16]u8, counter: [16]u8) void {
+            if (runtime_features.enabled and runtime_features.has(.aes)) {
+                const keystream = aesni_runtime.encrypt(rounds, &ctx.key_schedule.round_keys, counter);
+                for (dst, src, keystream) |*d, s, k| d.* = s ^ k;
+                return;
+            }
             const round_keys = ctx.key_schedule.round_keys;
             var t = Block.fromBytes(&counter).xorBlocks(round_keys[0]);
             comptime var i = 1;
@@ -617,6 +628,10 @@ pub fn AesDecryptCtx(comptime Aes: type) type {
 
         /// Decrypt a single block.
         pub fn decrypt(ctx: Self, dst: *[16]u8, src: *const [16]u8) void {
+            if (runtime_features.enabled and runtime_features.has(.aes)) {
+                dst.* = aesni_runtime.decrypt(rounds, &ctx.key_schedule.round_keys, src.*);
+                return;
+            }
             const inv_round_keys = ctx.key_schedule.round_keys;
             var t = Block.fromBytes(src).xorBlocks(inv_round_keys[0]);
             comptime var i = 1;
@@ -647,6 +662,50 @@ pub fn AesDecryptCtx(comptime Aes: type) type {
     };
 }
 
+/// AES-NI, when it is only detected at runtime. Uses the legacy SSE encoding, which requires no
+/// other extension on x86_64. On little-endian targets, the round keys of a `KeySchedule` have
+/// the byte layout expected by `aesenc`, and those of an inverted one are the equivalent inverse
+/// cipher keys expected by `aesdec`.
+const aesni_runtime = struct {
+    const Vec = @Vector(2, u64);
+
+    fn encrypt(comptime rounds: usize, round_keys: *const [rounds + 1]Block, src: [16]u8) [16]u8 {
+        var t = @as(Vec, @bitCast(src)) ^ @as(Vec, @bitCast(round_keys[0].repr));
+        comptime var i = 1;
+        inline while (i < rounds) : (i += 1) {
+            t = asm ("aesenc %[rk], %[out]"
+                : [out] "=x" (-> Vec),
+                : [_] "0" (t),
+                  [rk] "x" (@as(Vec, @bitCast(round_keys[i].repr))),
+            );
+        }
+        t = asm ("aesenclast %[rk], %[out]"
+            : [out] "=x" (-> Vec),
+            : [_] "0" (t),
+              [rk] "x" (@as(Vec, @bitCast(round_keys[rounds].repr))),
+        );
+        return @bitCast(t);
+    }
+
+    fn decrypt(comptime rounds: usize, inv_round_keys: *const [rounds + 1]Block, src: [16]u8) [16]u8 {
+        var t = @as(Vec, @bitCast(src)) ^ @as(Vec, @bitCast(inv_round_keys[0].repr));
+        comptime var i = 1;
+        inline while (i < rounds) : (i += 1) {
+            t = asm ("aesdec %[rk], %[out]"
+                : [out] "=x" (-> Vec),
+                : [_] "0" (t),
+                  [rk] "x" (@as(Vec, @bitCast(inv_round_keys[i].repr))),
+            );
+        }
+        t = asm ("aesdeclast %[rk], %[out]"
+            : [out] "=x" (-> Vec),
+            : [_] "0" (t),
+              [rk] "x" (@as(Vec, @bitCast(inv_round_keys[rounds].repr))),
+        );
+        return @bitCast(t);
+    }
+};
+
 /// AES-128 with the standard key schedule.
 pub const Aes128 = struct {
     pub const key_bits: usize = 128;
@@ -859,3 +918,30 @@ fn table_lookup(table: *align(64) const [4][256]u32, idx0: u8, idx1: u8, idx2: u
         };
     }
 }
+
+test "AES-NI detected at runtime matches the table-based implementation" {
+    if (builtin.cpu.arch != .x86_64 or builtin.zig_backend == .stage2_c) return error.SkipZigTest;
+    if (std.zig.system.x86.cpuid(1, 0).ecx & (1 << 25) == 0) return error.SkipZigTest;
+
+    inline for (.{ Aes128, Aes256 }) |Aes| {
+        var key: [Aes.key_bits / 8]u8 = undefined;
+        for (&key, 0..) |*b, i| b.* = @truncate(i *% 37 +% 11);
+        const enc = Aes.initEnc(key);
+        const dec = Aes.initDec(key);
+
+        var block: [16]u8 = "0123456789abcdef".*;
+        for (0..8) |_| {
+            var expected: [16]u8 = undefined;
+            var out: [16]u8 = undefined;
+            enc.encrypt(&expected, &block);
+            out = aesni_runtime.encrypt(Aes.rounds, &enc.key_schedule.round_keys, block);
+            try std.testing.expectEqualSlices(u8, &expected, &out);
+
+            dec.decrypt(&expected, &block);
+            out = aesni_runtime.decrypt(Aes.rounds, &dec.key_schedule.round_keys, block);
+            try std.testing.expectEqualSlices(u8, &expected, &out);
+
+            block = out;
+        }
+    }
+}
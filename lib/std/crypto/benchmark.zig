@@ -7,6 +7,10 @@ const time = std.time;
 const Timer = time.Timer;
 const crypto = std.crypto;
 
+// With -mcpu=baseline, this measures the implementations selected by detecting CPU features at
+// runtime. It has no effect on primitives whose features are enabled at compile time.
+pub const std_options: std.Options = .{ .crypto_runtime_cpu_features = true };
+
 const KiB = 1024;
 const MiB = 1024 * KiB;
 
@@ -3,6 +3,7 @@ const builtin = @import("builtin");
 const assert = std.debug.assert;
 const math = std.math;
 const mem = std.mem;
+const runtime_features = @import("runtime_features.zig");
 
 const Precomp = u128;
 
@@ -121,6 +122,45 @@ fn Hash(comptime endian: std.builtin.Endian, comptime shift_key: bool) type {
             }
         }
 
+        // Same as `clmulPclmul`, using the legacy SSE encoding, which does not require AVX.
+        fn clmulPclmulSse(x: u128, y: u128, comptime half: Selector) u128 {
+            switch (half) {
+                .hi => {
+                    const product = asm (
+                        \\ pclmulqdq $0x11, %[x], %[out]
+                        : [out] "=x" (-> @Vector(2, u64)),
+                        : [x] "x" (@as(@Vector(2, u64), @bitCast(x))),
+                          [_] "0" (@as(@Vector(2, u64), @bitCast(y))),
+                    );
+                    return @as(u128, @bitCast(product));
+                },
+                .lo => {
+                    const product = asm (
+                        \\ pclmulqdq $0x00, %[x], %[out]
+                        : [out] "=x" (-> @Vector(2, u64)),
+                        : [x] "x" (@as(@Vector(2, u64), @bitCast(x))),
+                          [_] "0" (@as(@Vector(2, u64), @bitCast(y))),
+                    );
+                    return @as(u128, @bitCast(product));
+                },
+                .hi_lo => {
+                    const product = asm (
+                        \\ pclmulqdq $0x10, %[x], %[out]
+                        : [out] "=x" (-> @Vector(2, u64)),
+                        : [x] "x" (@as(@Vector(2, u64), @bitCast(x))),
+                          [_] "0" (@as(@Vector(2, u64), @bitCast(y))),
+                    );
+                    return @as(u128, @bitCast(product));
+                },
+            }
+        }
+
+        // Uses PCLMULQDQ if the CPU supports it, as detected at runtime.
+        fn clmulRuntime(x: u128, y: u128, comptime half: Selector) u128 {
+            if (runtime_features.has(.pclmul)) return clmulPclmulSse(x, y, half);
+            return clmulSoft(x, y, half);
+        }
+
         // Carryless multiplication of two 64-bit integers for ARM crypto.
         fn clmulPmull(x: u128, y: u128, comptime half: Selector) u128 {
             switch (half) {
@@ -290,8 +330,12 @@ fn Hash(comptime endian: std.builtin.Endian, comptime shift_key: bool) type {
         // C backend doesn't currently support passing vectors to inline asm.
         const clmul = if (builtin.cpu.arch == .x86_64 and builtin.zig_backend != .stage2_c and has_pclmul and has_avx) impl: {
             break :impl clmulPclmul;
+        } else if (builtin.cpu.arch == .x86_64 and builtin.zig_backend != .stage2_c and has_pclmul) impl: {
+            break :impl clmulPclmulSse;
         } else if (builtin.cpu.arch == .aarch64 and builtin.zig_backend != .stage2_c and has_armaes) impl: {
             break :impl clmulPmull;
+        } else if (runtime_features.enabled) impl: {
+            break :impl clmulRuntime;
         } else impl: {
             break :impl clmulSoft;
         };
@@ -0,0 +1,68 @@
+//! Detection of CPU features at runtime, allowing primitives to use instructions that the
+//! compilation target does not guarantee, such as AES-NI or SHA-NI when targeting baseline x86_64.
+//! Opt-in with `std.Options.crypto_runtime_cpu_features`.
+//!
+//! Features enabled at compile time are always used directly, without consulting this file.
+
+const std = @import("../std.zig");
+const builtin = @import("builtin");
+
+pub const Feature = enum {
+    aes,
+    pclmul,
+    sha,
+    ssse3,
+};
+
+/// Whether primitives may check for features at runtime. The C backend does not support passing
+/// vectors to inline assembly, so it cannot use the instructions anyway.
+pub const enabled = std.options.crypto_runtime_cpu_features and
+    builtin.cpu.arch == .x86_64 and
+    builtin.zig_backend != .stage2_c;
+
+/// Bit set of detected `Feature`s, with `probed` set once populated. Concurrent first calls to
+/// `has` may both probe; they store the same value.
+var detected: std.atomic.Value(u32) = .init(0);
+const probed: u32 = 1 << @typeInfo(Feature).@"enum".fields.len;
+
+/// Returns whether the CPU supports `feature`. Always false if not `enabled`.
+pub fn has(feature: Feature) bool {
+    if (!enabled) return false;
+    var bits = detected.load(.monotonic);
+    if (bits == 0) {
+        bits = probe();
+        detected.store(bits, .monotonic);
+    }
+    return bits & bit(feature) != 0;
+}
+
+fn bit(feature: Feature) u32 {
+    return @as(u32, 1) << @intFromEnum(feature);
+}
+
+fn probe() u32 {
+    var bits = probed;
+    switch (builtin.cpu.arch) {
+        .x86_64 => {
+            const cpuid = std.zig.system.x86.cpuid;
+            const max_leaf = cpuid(0, 0).eax;
+            const leaf1 = cpuid(1, 0);
+            if (leaf1.ecx & (1 << 1) != 0) bits |= bit(.pclmul);
+            if (leaf1.ecx & (1 << 9) != 0) bits |= bit(.ssse3);
+            if (leaf1.ecx & (1 << 25) != 0) bits |= bit(.aes);
+            if (max_leaf >= 7 and cpuid(7, 0).ebx & (1 << 29) != 0) bits |= bit(.sha);
+        },
+        else => {},
+    }
+    return bits;
+}
+
+test "features enabled at compile time are detected" {
+    if (builtin.cpu.arch != .x86_64) return error.SkipZigTest;
+    const bits = probe();
+    try std.testing.expect(bits & probed != 0);
+    if (builtin.cpu.has(.x86, .aes)) try std.testing.expect(bits & bit(.aes) != 0);
+    if (builtin.cpu.has(.x86, .pclmul)) try std.testing.expect(bits & bit(.pclmul) != 0);
+    if (builtin.cpu.has(.x86, .sha)) try std.testing.expect(bits & bit(.sha) != 0);
+    if (builtin.cpu.has(.x86, .ssse3)) try std.testing.expect(bits & bit(.ssse3) != 0);
+}
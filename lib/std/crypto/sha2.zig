@@ -18,6 +18,7 @@ const builtin = @import("builtin");
 const mem = std.mem;
 const math = std.math;
 const htest = @import("test.zig");
+const runtime_features = @import("runtime_features.zig");
 
 pub const Sha224 = Sha2x32(iv224, 224);
 pub const Sha256 = Sha2x32(iv256, 256);
@@ -238,52 +239,10 @@ fn Sha2x32(comptime iv: Iv32, digest_bits: comptime_int) type {
                     },
                     // C backend doesn't currently support passing vectors to inline asm.
                     .x86_64 => if (builtin.zig_backend != .stage2_c and comptime builtin.cpu.hasAll(.x86, &.{ .sha, .avx2 })) {
-                        var x: V4u32 = [_]u32{ d.s[5], d.s[4], d.s[1], d.s[0] };
-                        var y: V4u32 = [_]u32{ d.s[7], d.s[6], d.s[3], d.s[2] };
-                        const s_v = @as(*[16]V4u32, @ptrCast(&s));
-
-                        comptime var k: u8 = 0;
-                        inline while (k < 16) : (k += 1) {
-                            if (k < 12) {
-                                var tmp = s_v[k];
-                                s_v[k + 4] = asm (
-                                    \\ sha256msg1 %[w4_7], %[tmp]
-                                    \\ vpalignr $0x4, %[w8_11], %[w12_15], %[result]
-                                    \\ paddd %[tmp], %[result]
-                                    \\ sha256msg2 %[w12_15], %[result]
-                                    : [tmp] "=&x" (tmp),
-                                      [result] "=&x" (-> V4u32),
-                                    : [_] "0" (tmp),
-                                      [w4_7] "x" (s_v[k + 1]),
-                                      [w8_11] "x" (s_v[k + 2]),
-                                      [w12_15] "x" (s_v[k + 3]),
-                                );
-                            }
-
-                            const w: V4u32 = s_v[k] +% @as(V4u32, W[4 * k ..][0..4].*);
-                            y = asm ("sha256rnds2 %[x], %[y]"
-                                : [y] "=x" (-> V4u32),
-                                : [_] "0" (y),
-                                  [x] "x" (x),
-                                  [_] "{xmm0}" (w),
-                            );
-
-                            x = asm ("sha256rnds2 %[y], %[x]"
-                                : [x] "=x" (-> V4u32),
-                                : [_] "0" (x),
-                                  [y] "x" (y),
-                                  [_] "{xmm0}" (@as(V4u32, @bitCast(@as(u128, @bitCast(w)) >> 64))),
-                            );
-                        }
-
-                        d.s[0] +%= x[3];
-                        d.s[1] +%= x[2];
-                        d.s[4] +%= x[1];
-                        d.s[5] +%= x[0];
-                        d.s[2] +%= y[3];
-                        d.s[3] +%= y[2];
-                        d.s[6] +%= y[1];
-                        d.s[7] +%= y[0];
+                        d.roundShaNi(&s, .vex);
+                        return;
+                    } else if (runtime_features.enabled and runtime_features.has(.sha) and runtime_features.has(.ssse3)) {
+                        d.roundShaNi(&s, .sse);
                         return;
                     },
                     else => {},
@@ -373,6 +332,63 @@ fn Sha2x32(comptime iv: Iv32, digest_bits: comptime_int) type {
 
             for (&d.s, v) |*dv, vv| dv.* +%= vv;
         }
+
+        /// Compresses the block already expanded into `s[0..16]` using SHA-NI. The `.sse` encoding
+        /// only requires SSSE3, which is available on all CPUs that support SHA-NI.
+        fn roundShaNi(d: *Self, s: *align(16) [64]u32, comptime encoding: enum { vex, sse }) void {
+            const V4u32 = @Vector(4, u32);
+            var x: V4u32 = [_]u32{ d.s[5], d.s[4], d.s[1], d.s[0] };
+            var y: V4u32 = [_]u32{ d.s[7], d.s[6], d.s[3], d.s[2] };
+            const s_v = @as(*[16]V4u32, @ptrCast(s));
+            // `result` starts out as a copy of `w12_15`, which the legacy encoding shifts in place.
+            const palignr = switch (encoding) {
+                .vex => "vpalignr $0x4, %[w8_11], %[w12_15], %[result]",
+                .sse => "palignr $0x4, %[w8_11], %[result]",
+            };
+
+            comptime var k: u8 = 0;
+            inline while (k < 16) : (k += 1) {
+                if (k < 12) {
+                    var tmp = s_v[k];
+                    s_v[k + 4] = asm ("sha256msg1 %[w4_7], %[tmp]\n" ++
+                            palignr ++ "\n" ++
+                            \\paddd %[tmp], %[result]
+                            \\sha256msg2 %[w12_15], %[result]
+                        : [tmp] "=&x" (tmp),
+                          [result] "=&x" (-> V4u32),
+                        : [_] "0" (tmp),
+                          [w4_7] "x" (s_v[k + 1]),
+                          [w8_11] "x" (s_v[k + 2]),
+                          [w12_15] "x" (s_v[k + 3]),
+                          [_] "1" (s_v[k + 3]),
+                    );
+                }
+
+                const w: V4u32 = s_v[k] +% @as(V4u32, W[4 * k ..][0..4].*);
+                y = asm ("sha256rnds2 %[x], %[y]"
+                    : [y] "=x" (-> V4u32),
+                    : [_] "0" (y),
+                      [x] "x" (x),
+                      [_] "{xmm0}" (w),
+                );
+
+                x = asm ("sha256rnds2 %[y], %[x]"
+                    : [x] "=x" (-> V4u32),
+                    : [_] "0" (x),
+                      [y] "x" (y),
+                      [_] "{xmm0}" (@as(V4u32, @bitCast(@as(u128, @bitCast(w)) >> 64))),
+                );
+            }
+
+            d.s[0] +%= x[3];
+            d.s[1] +%= x[2];
+            d.s[4] +%= x[1];
+            d.s[5] +%= x[0];
+            d.s[2] +%= y[3];
+            d.s[3] +%= y[2];
+            d.s[6] +%= y[1];
+            d.s[7] +%= y[0];
+        }
     };
 }
 
@@ -38,6 +38,7 @@ const crypto = std.crypto;
 const assert = std.debug.assert;
 
 pub const Client = @import("tls/Client.zig");
+pub const Server = @import("tls/Server.zig");
 
 pub const record_header_len = 5;
 pub const max_ciphertext_inner_record_len = 1 << 14;
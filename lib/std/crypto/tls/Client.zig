@@ -49,6 +49,13 @@ application_cipher: tls.ApplicationCipher,
 /// allows other programs with access to that file to decrypt all traffic over
 /// this connection.
 ssl_key_log: ?*SslKeyLog,
+/// Receives session tickets sent by the server. See `Options.session`.
+session: ?*Session,
+/// Tickets received are timestamped with the time of the handshake.
+handshake_seconds: i64,
+/// Derives the pre-shared key of each session ticket, zero-padded beyond the
+/// length of the negotiated hash.
+resumption_secret: [Session.psk_max_len]u8,
 
 pub const ReadError = error{
     /// The alert description will be stored in `alert`.
@@ -84,6 +91,91 @@ pub const SslKeyLog = struct {
 /// at least this amount.
 pub const min_buffer_len = tls.max_ciphertext_record_len;
 
+/// A TLS 1.3 session ticket, which allows a later connection to the same
+/// server to skip certificate verification by authenticating with a key
+/// derived from this connection. See `Options.session`.
+pub const Session = struct {
+    cipher_suite: tls.CipherSuite,
+    psk_buf: [psk_max_len]u8,
+    psk_len: u8,
+    ticket_buf: [max_ticket_len]u8,
+    /// Zero when no ticket has been received.
+    ticket_len: u16,
+    age_add: u32,
+    lifetime_seconds: u32,
+    received_seconds: i64,
+
+    pub const empty: Session = .{
+        .cipher_suite = undefined,
+        .psk_buf = undefined,
+        .psk_len = 0,
+        .ticket_buf = undefined,
+        .ticket_len = 0,
+        .age_add = undefined,
+        .lifetime_seconds = undefined,
+        .received_seconds = undefined,
+    };
+
+    const psk_max_len = crypto.hash.sha2.Sha512.digest_length;
+    /// Tickets which are larger are ignored.
+    pub const max_ticket_len = 1024;
+    /// TLS 1.3 forbids using tickets for longer than this.
+    const max_lifetime_seconds = 7 * 24 * 60 * 60;
+    const extension_max_len = 2 + 2 + 2 + 2 + max_ticket_len + 4 + 2 + 1 + psk_max_len;
+
+    /// Whether a ticket is stored which has not yet expired.
+    pub fn isResumable(s: *const Session, now_seconds: i64) bool {
+        if (s.ticket_len == 0) return false;
+        const age = now_seconds -| s.received_seconds;
+        return age >= 0 and age < s.lifetime_seconds;
+    }
+
+    /// Writes the pre_shared_key extension offering the ticket, leaving the
+    /// binder to be filled in by `writeBinder`.
+    fn writeExtension(s: *const Session, buf: *[extension_max_len]u8, now_seconds: i64) []u8 {
+        const ticket = s.ticket_buf[0..s.ticket_len];
+        const age_ms: u32 = @truncate(@as(u64, @intCast(now_seconds - s.received_seconds)) * 1000);
+        var w: Writer = .fixed(buf);
+        const identities_len = 2 + ticket.len + 4;
+        const binders_len = 1 + s.psk_len;
+        w.writeInt(u16, @intFromEnum(tls.ExtensionType.pre_shared_key), .big) catch unreachable;
+        w.writeInt(u16, @intCast(2 + identities_len + 2 + binders_len), .big) catch unreachable;
+        w.writeInt(u16, @intCast(identities_len), .big) catch unreachable;
+        w.writeInt(u16, @intCast(ticket.len), .big) catch unreachable;
+        w.writeAll(ticket) catch unreachable;
+        w.writeInt(u32, age_ms +% s.age_add, .big) catch unreachable;
+        w.writeInt(u16, @intCast(binders_len), .big) catch unreachable;
+        w.writeByte(s.psk_len) catch unreachable;
+        w.splatByteAll(0, s.psk_len) catch unreachable;
+        return w.buffered();
+    }
+
+    /// Computes the binder over the ClientHello, which ends with `extension`,
+    /// and stores it at the end of `extension`.
+    fn writeBinder(s: *const Session, client_hello_prefix: []const []const u8, extension: []u8) void {
+        switch (s.cipher_suite) {
+            inline .AES_128_GCM_SHA256,
+            .AES_256_GCM_SHA384,
+            .CHACHA20_POLY1305_SHA256,
+            .AEGIS_256_SHA512,
+            .AEGIS_128L_SHA256,
+            => |tag| {
+                const P = @FieldType(tls.ApplicationCipher, @tagName(tag.with()));
+                const early_secret = P.Hkdf.extract(&[1]u8{0}, s.psk_buf[0..P.Hash.digest_length]);
+                const binder_key = hkdfExpandLabel(P.Hkdf, early_secret, "res binder", &tls.emptyHash(P.Hash), P.Hash.digest_length);
+                const finished_key = hkdfExpandLabel(P.Hkdf, binder_key, "finished", "", P.Hmac.key_length);
+                const binders_len = 2 + 1 + P.Hash.digest_length;
+                var truncated_hash: P.Hash = .init(.{});
+                for (client_hello_prefix) |part| truncated_hash.update(part);
+                truncated_hash.update(extension[0 .. extension.len - binders_len]);
+                const binder: [P.Hmac.mac_length]u8 = tls.hmac(P.Hmac, &truncated_hash.finalResult(), finished_key);
+                extension[extension.len - binder.len ..][0..binder.len].* = binder;
+            },
+            else => unreachable,
+        }
+    }
+};
+
 pub const Options = struct {
     /// How to perform host verification of server certificates.
     host: union(enum) {
@@ -130,6 +222,14 @@ pub const Options = struct {
     allow_truncation_attacks: bool = false,
     /// Populated when `error.TlsAlert` is returned from `init`.
     alert: ?*tls.Alert = null,
+    /// If non-null, and holding a ticket received by a previous connection
+    /// which has not expired, the ticket is offered to the server to resume
+    /// that session. Afterwards, tickets sent by the server over this
+    /// connection replace it. The pointer is captured.
+    ///
+    /// The server certificate is not verified again when resuming, so the
+    /// session must only be reused for the same host and `ca` options.
+    session: ?*Session = null,
 };
 
 const InitError = error{
@@ -251,8 +351,19 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
         .explicit => server_name_extension.len + host_len,
     };
 
+    const session: ?*const Session = if (options.session) |s|
+        if (s.isResumable(options.realtime_now_seconds)) s else null
+    else
+        null;
+    var psk_extension_buf: [Session.extension_max_len]u8 = undefined;
+    // Must be the last extension, so it is sent after the host name.
+    const psk_extension: []u8 = if (session) |s|
+        s.writeExtension(&psk_extension_buf, options.realtime_now_seconds)
+    else
+        &.{};
+
     const extensions_header =
-        int(u16, @intCast(extensions_payload.len + server_name_extension_len)) ++
+        int(u16, @intCast(extensions_payload.len + server_name_extension_len + psk_extension.len)) ++
         extensions_payload ++
         server_name_extension;
 
@@ -265,21 +376,23 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
         extensions_header;
 
     const out_handshake = .{@intFromEnum(tls.HandshakeType.client_hello)} ++
-        int(u24, @intCast(client_hello.len - server_name_extension.len + server_name_extension_len)) ++
+        int(u24, @intCast(client_hello.len - server_name_extension.len + server_name_extension_len + psk_extension.len)) ++
         client_hello;
 
     const cleartext_header_buf = .{@intFromEnum(tls.ContentType.handshake)} ++
         int(u16, @intFromEnum(tls.ProtocolVersion.tls_1_0)) ++
-        int(u16, @intCast(out_handshake.len - server_name_extension.len + server_name_extension_len)) ++
+        int(u16, @intCast(out_handshake.len - server_name_extension.len + server_name_extension_len + psk_extension.len)) ++
         out_handshake;
     const cleartext_header = switch (options.host) {
         .no_verification => cleartext_header_buf[0 .. cleartext_header_buf.len - server_name_extension.len],
         .explicit => &cleartext_header_buf,
     };
 
+    if (session) |s| s.writeBinder(&.{ cleartext_header[tls.record_header_len..], host }, psk_extension);
+
     {
-        var iovecs: [2][]const u8 = .{ cleartext_header, host };
-        try output.writeVecAll(iovecs[0..if (host.len == 0) 1 else 2]);
+        var iovecs: [3][]const u8 = .{ cleartext_header, host, psk_extension };
+        try output.writeVecAll(&iovecs);
         try output.flush();
     }
 
@@ -325,6 +438,8 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
     var handshake_cipher: tls.HandshakeCipher = undefined;
     var main_cert_pub_key: CertificatePublicKey = undefined;
     var tls12_negotiated_group: ?tls.NamedGroup = null;
+    var psk_accepted = false;
+    var resumption_secret: [Session.psk_max_len]u8 = @splat(0);
     const now_sec = options.realtime_now_seconds;
 
     var cleartext_fragment_start: usize = 0;
@@ -480,6 +595,13 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                                         try extd.ensure(key_size);
                                         try key_share.exchange(named_group, extd.slice(key_size));
                                     },
+                                    .pre_shared_key => {
+                                        if (session == null or psk_accepted) return error.TlsIllegalParameter;
+                                        try extd.ensure(2);
+                                        // Only one identity is offered.
+                                        if (extd.decode(u16) != 0) return error.TlsIllegalParameter;
+                                        psk_accepted = true;
+                                    },
                                     else => {},
                                 }
                             }
@@ -488,7 +610,7 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                         tls_version = @enumFromInt(supported_version orelse legacy_version);
                         switch (tls_version) {
                             .tls_1_3 => if (!mem.eql(u8, legacy_session_id_echo, &legacy_session_id)) return error.TlsIllegalParameter,
-                            .tls_1_2 => if (mem.eql(u8, server_hello_rand[24..31], "DOWNGRD") and
+                            .tls_1_2 => if (psk_accepted or mem.eql(u8, server_hello_rand[24..31], "DOWNGRD") and
                                 server_hello_rand[31] >> 1 == 0x00) return error.TlsIllegalParameter,
                             else => return error.TlsIllegalParameter,
                         }
@@ -511,6 +633,7 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                                 const p = &@field(handshake_cipher, @tagName(tag.with()));
                                 p.transcript_hash.update(cleartext_header[tls.record_header_len..]); // Client Hello part 1
                                 p.transcript_hash.update(host); // Client Hello part 2
+                                p.transcript_hash.update(psk_extension); // Client Hello part 3
                                 p.transcript_hash.update(wrapped_handshake);
                             },
 
@@ -530,7 +653,13 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                                         const P = @TypeOf(p.*).A;
                                         const hello_hash = p.transcript_hash.peek();
                                         const zeroes = [1]u8{0} ** P.Hash.digest_length;
-                                        const early_secret = P.Hkdf.extract(&[1]u8{0}, &zeroes);
+                                        const psk: []const u8 = if (psk_accepted) psk: {
+                                            // The ticket is only usable with the hash it was issued for.
+                                            const s = session.?;
+                                            if (s.psk_len != P.Hash.digest_length) return error.TlsIllegalParameter;
+                                            break :psk s.psk_buf[0..s.psk_len];
+                                        } else &zeroes;
+                                        const early_secret = P.Hkdf.extract(&[1]u8{0}, psk);
                                         const empty_hash = tls.emptyHash(P.Hash);
                                         p.version = .{ .tls_1_3 = undefined };
                                         const pv = &p.version.tls_1_3;
@@ -589,7 +718,8 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                                 else => {},
                             }
                         }
-                        handshake_state = .certificate;
+                        // The server authenticated by knowing the pre-shared key.
+                        handshake_state = if (psk_accepted) .finished else .certificate;
                     },
                     .certificate => cert: {
                         if (cipher_state == .application) return error.TlsUnexpectedMessage;
@@ -823,7 +953,7 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                                     p.transcript_hash.update(wrapped_handshake);
                                     const expected_server_verify_data = tls.hmac(P.Hmac, &finished_digest, pv.server_finished_key);
                                     if (!std.crypto.timing_safe.eql([P.Hmac.mac_length]u8, expected_server_verify_data, hsd.array(P.Hmac.mac_length).*)) return error.TlsDecryptError;
-                                    const handshake_hash = p.transcript_hash.finalResult();
+                                    const handshake_hash = p.transcript_hash.peek();
                                     const verify_data = tls.hmac(P.Hmac, &handshake_hash, pv.client_finished_key);
                                     const out_cleartext = .{@intFromEnum(tls.HandshakeType.finished)} ++
                                         array(u24, u8, verify_data) ++
@@ -848,6 +978,17 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                                     try output.writeVecAll(&all_msgs_vec);
                                     try output.flush();
 
+                                    if (options.session != null) {
+                                        p.transcript_hash.update(out_cleartext[0 .. out_cleartext.len - 1]);
+                                        resumption_secret[0..P.Hash.digest_length].* = hkdfExpandLabel(
+                                            P.Hkdf,
+                                            pv.master_secret,
+                                            "res master",
+                                            &p.transcript_hash.peek(),
+                                            P.Hash.digest_length,
+                                        );
+                                    }
+
                                     const client_secret = hkdfExpandLabel(P.Hkdf, pv.master_secret, "c ap traffic", &handshake_hash, P.Hash.digest_length);
                                     const server_secret = hkdfExpandLabel(P.Hkdf, pv.master_secret, "s ap traffic", &handshake_hash, P.Hash.digest_length);
                                     if (options.ssl_key_log) |key_log| logSecrets(key_log.writer, .{
@@ -917,6 +1058,9 @@ pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Client
                             .allow_truncation_attacks = options.allow_truncation_attacks,
                             .application_cipher = app_cipher,
                             .ssl_key_log = options.ssl_key_log,
+                            .session = options.session,
+                            .handshake_seconds = now_sec,
+                            .resumption_secret = resumption_secret,
                         };
                     },
                     else => return error.TlsUnexpectedMessage,
@@ -1224,8 +1368,8 @@ fn readIndirect(c: *Client) Reader.Error!usize {
                 if (next_handshake_i > cleartext.len) return failRead(c, error.TlsBadLength);
                 const handshake = cleartext[ct_i..next_handshake_i];
                 switch (handshake_type) {
-                    .new_session_ticket => {
-                        // This client implementation ignores new session tickets.
+                    .new_session_ticket => if (c.session) |session| {
+                        c.storeSessionTicket(session, handshake) catch |err| return failRead(c, err);
                     },
                     .key_update => {
                         switch (c.application_cipher) {
@@ -1285,6 +1429,46 @@ fn readIndirect(c: *Client) Reader.Error!usize {
     }
 }
 
+fn storeSessionTicket(c: *Client, session: *Session, message: []u8) error{TlsDecodeError}!void {
+    // TLS 1.2 tickets are not supported.
+    if (c.tls_version != .tls_1_3) return;
+    var d: tls.Decoder = .fromTheirSlice(message);
+    try d.ensure(4 + 4 + 1);
+    const lifetime_seconds = mem.readInt(u32, d.array(4), .big);
+    const age_add = mem.readInt(u32, d.array(4), .big);
+    const nonce_len = d.decode(u8);
+    try d.ensure(nonce_len + 2);
+    const ticket_nonce = d.slice(nonce_len);
+    const ticket_len = d.decode(u16);
+    if (ticket_len == 0) return error.TlsDecodeError;
+    try d.ensure(ticket_len + 2);
+    const ticket = d.slice(ticket_len);
+    const extensions = try d.sub(d.decode(u16));
+    // Early data is never sent, so no extensions are of interest.
+    _ = extensions;
+    if (!d.eof()) return error.TlsDecodeError;
+    if (ticket.len > Session.max_ticket_len) return;
+    switch (c.application_cipher) {
+        inline else => |*p, tag| {
+            const P = @TypeOf(p.*);
+            session.cipher_suite = @field(tls.CipherSuite, @tagName(tag));
+            session.psk_buf[0..P.Hash.digest_length].* = hkdfExpandLabel(
+                P.Hkdf,
+                c.resumption_secret[0..P.Hash.digest_length].*,
+                "resumption",
+                ticket_nonce,
+                P.Hash.digest_length,
+            );
+            session.psk_len = P.Hash.digest_length;
+        },
+    }
+    @memcpy(session.ticket_buf[0..ticket.len], ticket);
+    session.ticket_len = ticket_len;
+    session.age_add = age_add;
+    session.lifetime_seconds = @min(lifetime_seconds, Session.max_lifetime_seconds);
+    session.received_seconds = c.handshake_seconds;
+}
+
 fn rebase(r: *Reader, capacity: usize) void {
     if (r.buffer.len - r.end >= capacity) return;
     const data = r.buffer[r.seek..r.end];
@@ -0,0 +1,1485 @@
+//! TLS 1.3 server.
+//!
+//! Negotiates any of the TLS 1.3 cipher suites in `tls.ApplicationCipher`, key
+//! exchange with X25519MLKEM768, X25519 or secp256r1, and authenticates with an
+//! ECDSA P-256 or Ed25519 certificate. Clients offering only TLS 1.2, or none
+//! of these key shares, are rejected; HelloRetryRequest is not implemented.
+//!
+//! When `Options.ticket_key` is provided, a stateless session ticket is sent
+//! after the handshake, and tickets issued with the same key are accepted for
+//! resumption with a fresh key exchange (`psk_dhe_ke`), which skips sending
+//! and signing the certificate chain. Early data (0-RTT) is never accepted,
+//! since doing so safely requires replay protection that is outside the scope
+//! of a single connection.
+
+const builtin = @import("builtin");
+const native_endian = builtin.cpu.arch.endian();
+
+const std = @import("../../std.zig");
+const tls = std.crypto.tls;
+const Server = @This();
+const mem = std.mem;
+const crypto = std.crypto;
+const assert = std.debug.assert;
+const Reader = std.Io.Reader;
+const Writer = std.Io.Writer;
+const Aes256Gcm = crypto.aead.aes_gcm.Aes256Gcm;
+
+const max_ciphertext_len = tls.max_ciphertext_len;
+const hkdfExpandLabel = tls.hkdfExpandLabel;
+const int = tls.int;
+
+/// The encrypted stream from the client to the server. Bytes are pulled from
+/// here via `reader`.
+///
+/// The buffer is asserted to have capacity at least `min_buffer_len`.
+input: *Reader,
+/// Decrypted stream from the client to the server.
+reader: Reader,
+
+/// The encrypted stream from the server to the client. Bytes are pushed here
+/// via `writer`.
+///
+/// The buffer is asserted to have capacity at least `min_buffer_len`.
+output: *Writer,
+/// The plaintext stream from the server to the client.
+writer: Writer,
+
+/// Populated when `error.TlsAlert` is returned.
+alert: ?tls.Alert = null,
+read_err: ?ReadError = null,
+read_seq: u64,
+write_seq: u64,
+/// When this is true, the stream may still not be at the end because there
+/// may be data in the input buffer.
+received_close_notify: bool,
+allow_truncation_attacks: bool,
+/// The client asked for the server's traffic keys to be updated. This is done
+/// before the next record is written.
+key_update_requested: bool,
+application_cipher: tls.ApplicationCipher,
+/// Whether the handshake resumed a session using a ticket from
+/// `Options.ticket_key`, rather than authenticating with the certificate.
+resumed: bool,
+
+pub const ReadError = error{
+    /// The alert description will be stored in `alert`.
+    TlsAlert,
+    TlsBadLength,
+    TlsBadRecordMac,
+    TlsConnectionTruncated,
+    TlsDecodeError,
+    TlsRecordOverflow,
+    TlsUnexpectedMessage,
+    TlsIllegalParameter,
+    TlsSequenceOverflow,
+};
+
+/// The `Reader` and `Writer` supplied to `init` require a buffer capacity
+/// at least this amount.
+pub const min_buffer_len = tls.max_ciphertext_record_len;
+
+/// Encrypts and authenticates session tickets. Must be generated with a
+/// cryptographically secure random number generator and kept secret; anyone
+/// with the key can impersonate the server to clients holding its tickets.
+pub const TicketKey = [Aes256Gcm.key_length]u8;
+
+pub const PrivateKey = union(enum) {
+    ecdsa_secp256r1_sha256: crypto.sign.ecdsa.EcdsaP256Sha256.KeyPair,
+    ed25519: crypto.sign.Ed25519.KeyPair,
+
+    fn scheme(key: PrivateKey) tls.SignatureScheme {
+        return switch (key) {
+            .ecdsa_secp256r1_sha256 => .ecdsa_secp256r1_sha256,
+            .ed25519 => .ed25519,
+        };
+    }
+};
+
+pub const Options = struct {
+    /// DER-encoded certificates, starting with the server's own, followed by
+    /// any intermediate certificates needed to reach a trusted root.
+    certificate_chain: []const []const u8,
+    /// Must match the public key of the first certificate in the chain.
+    private_key: PrivateKey,
+    write_buffer: []u8,
+    read_buffer: []u8,
+    /// Cryptographically secure random bytes. The pointer is not captured; data is only
+    /// read during `init`.
+    entropy: *const [176]u8,
+    /// Current time according to the wall clock / calendar, in seconds.
+    realtime_now_seconds: i64,
+    /// If non-null, a session ticket is issued after the handshake, and tickets
+    /// previously issued with this key are accepted for resumption. The pointer
+    /// is not captured.
+    ticket_key: ?*const TicketKey = null,
+    /// How long issued tickets may be used for resumption. TLS 1.3 limits this
+    /// to 7 days.
+    ticket_lifetime_seconds: u32 = 2 * 60 * 60,
+    /// By default, reaching the end-of-stream when reading from the client will
+    /// cause `error.TlsConnectionTruncated` to be returned, unless a close_notify
+    /// message has been received. By setting this flag to `true`, instead, the
+    /// end-of-stream will be forwarded to the application layer above TLS.
+    ///
+    /// This makes the application vulnerable to truncation attacks unless the
+    /// application layer itself verifies that the amount of data received equals
+    /// the amount of data expected, such as HTTP with the Content-Length header.
+    allow_truncation_attacks: bool = false,
+    /// Populated when `error.TlsAlert` is returned from `init`.
+    alert: ?*tls.Alert = null,
+};
+
+const InitError = error{
+    WriteFailed,
+    ReadFailed,
+    InsufficientEntropy,
+    /// The alert description will be stored in `alert`.
+    TlsAlert,
+    TlsUnexpectedMessage,
+    TlsIllegalParameter,
+    TlsDecryptFailure,
+    TlsRecordOverflow,
+    TlsBadRecordMac,
+    TlsDecryptError,
+    TlsConnectionTruncated,
+    TlsDecodeError,
+    /// The client does not support TLS 1.3.
+    TlsProtocolVersionUnsupported,
+    /// The client supports none of the cipher suites, key exchange groups or
+    /// signature schemes offered by this implementation.
+    TlsHandshakeFailure,
+    IdentityElement,
+    NonCanonical,
+    KeyMismatch,
+    WeakPublicKey,
+};
+
+/// Reads the client's hello and completes a TLSv1.3 handshake.
+///
+/// `input` and `output` are asserted to have buffer capacity at least
+/// `min_buffer_len`.
+pub fn init(input: *Reader, output: *Writer, options: Options) InitError!Server {
+    assert(input.buffer.len >= min_buffer_len);
+    assert(output.buffer.len >= min_buffer_len);
+    assert(options.certificate_chain.len > 0);
+    assert(options.ticket_lifetime_seconds <= max_ticket_lifetime_seconds);
+
+    var hello_buf: [tls.max_ciphertext_inner_record_len]u8 = undefined;
+    const hello = try readClientHello(input, &hello_buf, options);
+
+    // Resume with the first offered ticket if it is valid, otherwise fall
+    // back to a full handshake.
+    const ticket = acceptTicket(&hello, options);
+    if (ticket == null and !hello.signature_scheme_supported) return error.TlsHandshakeFailure;
+    const cipher_suite = if (ticket) |t| t.cipher_suite else hello.cipher_suite orelse
+        return error.TlsHandshakeFailure;
+
+    var key_share: KeyShare = try .init(hello.key_share_group, hello.key_share, options.entropy[32..160]);
+
+    switch (cipher_suite) {
+        inline .AES_128_GCM_SHA256,
+        .AES_256_GCM_SHA384,
+        .CHACHA20_POLY1305_SHA256,
+        .AEGIS_256_SHA512,
+        .AEGIS_128L_SHA256,
+        => |tag| return handshake(tag, input, output, options, &hello, if (ticket) |*t| t else null, &key_share),
+        else => unreachable,
+    }
+}
+
+const max_ticket_lifetime_seconds = 7 * 24 * 60 * 60;
+
+const ClientHello = struct {
+    /// The entire handshake message.
+    message: []const u8,
+    legacy_session_id: []const u8,
+    cipher_suites: []const u8,
+    /// The first cipher suite offered by the client which is supported.
+    cipher_suite: ?tls.CipherSuite,
+    key_share_group: tls.NamedGroup,
+    key_share: []const u8,
+    signature_scheme_supported: bool,
+    psk_dhe_ke: bool,
+    psk: ?struct {
+        identity: []const u8,
+        binder: []const u8,
+        /// `message` up to, but not including, the binders.
+        truncated: []const u8,
+    },
+};
+
+fn readClientHello(input: *Reader, hello_buf: *[tls.max_ciphertext_inner_record_len]u8, options: Options) InitError!ClientHello {
+    var hello_len: usize = 0;
+    const message = while (true) {
+        const ct, const fragment = try readPlaintextRecord(input);
+        switch (ct) {
+            .handshake => {},
+            .alert => return handshakeAlert(fragment, options),
+            else => return error.TlsUnexpectedMessage,
+        }
+        if (fragment.len > hello_buf.len - hello_len) return error.TlsRecordOverflow;
+        @memcpy(hello_buf[hello_len..][0..fragment.len], fragment);
+        hello_len += fragment.len;
+        if (hello_len < 4) continue;
+        const message_len = 4 + mem.readInt(u24, hello_buf[1..4], .big);
+        if (message_len > hello_buf.len) return error.TlsRecordOverflow;
+        if (hello_len < message_len) continue;
+        // Nothing may follow the ClientHello before the server responds.
+        if (hello_len > message_len) return error.TlsUnexpectedMessage;
+        break hello_buf[0..message_len];
+    };
+    if (message[0] != @intFromEnum(tls.HandshakeType.client_hello)) return error.TlsUnexpectedMessage;
+
+    var hello: ClientHello = .{
+        .message = message,
+        .legacy_session_id = undefined,
+        .cipher_suites = undefined,
+        .cipher_suite = null,
+        .key_share_group = undefined,
+        .key_share = &.{},
+        .signature_scheme_supported = false,
+        .psk_dhe_ke = false,
+        .psk = null,
+    };
+
+    var hd: tls.Decoder = .fromTheirSlice(message[4..]);
+    try hd.ensure(2 + 32 + 1);
+    hd.skip(2 + 32); // legacy_version, random
+    const legacy_session_id_len = hd.decode(u8);
+    if (legacy_session_id_len > 32) return error.TlsIllegalParameter;
+    try hd.ensure(legacy_session_id_len + 2);
+    hello.legacy_session_id = hd.slice(legacy_session_id_len);
+    const cipher_suites_len = hd.decode(u16);
+    if (cipher_suites_len % 2 != 0) return error.TlsDecodeError;
+    var csd = try hd.sub(cipher_suites_len);
+    hello.cipher_suites = csd.buf;
+    while (!csd.eof()) {
+        try csd.ensure(2);
+        switch (csd.decode(tls.CipherSuite)) {
+            inline .AES_128_GCM_SHA256,
+            .AES_256_GCM_SHA384,
+            .CHACHA20_POLY1305_SHA256,
+            .AEGIS_256_SHA512,
+            .AEGIS_128L_SHA256,
+            => |tag| if (hello.cipher_suite == null) {
+                hello.cipher_suite = tag;
+            },
+            else => {},
+        }
+    }
+    try hd.ensure(1);
+    const compression_methods_len = hd.decode(u8);
+    try hd.ensure(compression_methods_len + 2);
+    hd.skip(compression_methods_len);
+    const extensions_len = hd.decode(u16);
+    var all_extd = try hd.sub(extensions_len);
+    if (!hd.eof()) return error.TlsDecodeError;
+
+    var supports_tls_1_3 = false;
+    var key_share_rank: u8 = 0;
+    while (!all_extd.eof()) {
+        try all_extd.ensure(2 + 2);
+        const et = all_extd.decode(tls.ExtensionType);
+        const ext_size = all_extd.decode(u16);
+        var extd = try all_extd.sub(ext_size);
+        switch (et) {
+            .supported_versions => {
+                try extd.ensure(1);
+                var versions = try extd.sub(extd.decode(u8));
+                while (!versions.eof()) {
+                    try versions.ensure(2);
+                    if (versions.decode(tls.ProtocolVersion) == .tls_1_3) supports_tls_1_3 = true;
+                }
+            },
+            .signature_algorithms => {
+                try extd.ensure(2);
+                var schemes = try extd.sub(extd.decode(u16));
+                while (!schemes.eof()) {
+                    try schemes.ensure(2);
+                    if (schemes.decode(tls.SignatureScheme) == options.private_key.scheme())
+                        hello.signature_scheme_supported = true;
+                }
+            },
+            .key_share => {
+                try extd.ensure(2);
+                var shares = try extd.sub(extd.decode(u16));
+                while (!shares.eof()) {
+                    try shares.ensure(2 + 2);
+                    const named_group = shares.decode(tls.NamedGroup);
+                    const key_len = shares.decode(u16);
+                    try shares.ensure(key_len);
+                    const key = shares.slice(key_len);
+                    const rank: u8 = switch (named_group) {
+                        .x25519_ml_kem768 => 3,
+                        .x25519 => 2,
+                        .secp256r1 => 1,
+                        else => 0,
+                    };
+                    if (rank > key_share_rank) {
+                        key_share_rank = rank;
+                        hello.key_share_group = named_group;
+                        hello.key_share = key;
+                    }
+                }
+            },
+            .psk_key_exchange_modes => {
+                try extd.ensure(1);
+                const modes_len = extd.decode(u8);
+                try extd.ensure(modes_len);
+                for (extd.slice(modes_len)) |mode| {
+                    if (mode == @intFromEnum(tls.PskKeyExchangeMode.psk_dhe_ke)) hello.psk_dhe_ke = true;
+                }
+            },
+            .pre_shared_key => {
+                // This extension must be the last one, which places the
+                // binders at the end of the message.
+                if (!all_extd.eof()) return error.TlsIllegalParameter;
+                try extd.ensure(2);
+                var identities = try extd.sub(extd.decode(u16));
+                try identities.ensure(2);
+                const identity_len = identities.decode(u16);
+                try identities.ensure(identity_len + 4);
+                const identity = identities.slice(identity_len);
+                identities.skip(4); // obfuscated_ticket_age
+                try extd.ensure(2);
+                const binders_len = extd.decode(u16);
+                var binders = try extd.sub(binders_len);
+                if (!extd.eof()) return error.TlsDecodeError;
+                try binders.ensure(1);
+                const binder_len = binders.decode(u8);
+                try binders.ensure(binder_len);
+                hello.psk = .{
+                    .identity = identity,
+                    .binder = binders.slice(binder_len),
+                    .truncated = message[0 .. message.len - 2 - binders_len],
+                };
+            },
+            else => {},
+        }
+    }
+
+    if (!supports_tls_1_3) return error.TlsProtocolVersionUnsupported;
+    if (key_share_rank == 0) return error.TlsHandshakeFailure;
+    return hello;
+}
+
+/// Returns the ticket the client offered for resumption, unless it was not
+/// issued with `Options.ticket_key`, has expired, or cannot be used with the
+/// cipher suites offered in this hello.
+fn acceptTicket(hello: *const ClientHello, options: Options) ?Ticket {
+    const ticket_key = options.ticket_key orelse return null;
+    const psk = hello.psk orelse return null;
+    if (!hello.psk_dhe_ke) return null;
+    const ticket = Ticket.open(ticket_key, psk.identity) orelse return null;
+    const age = options.realtime_now_seconds -% ticket.issued_seconds;
+    if (age < 0 or age > ticket.lifetime_seconds) return null;
+    if (!offersCipherSuite(hello.cipher_suites, ticket.cipher_suite)) return null;
+    return ticket;
+}
+
+fn offersCipherSuite(cipher_suites: []const u8, cipher_suite: tls.CipherSuite) bool {
+    var i: usize = 0;
+    while (i + 2 <= cipher_suites.len) : (i += 2) {
+        if (mem.readInt(u16, cipher_suites[i..][0..2], .big) == @intFromEnum(cipher_suite)) return true;
+    }
+    return false;
+}
+
+fn handshake(
+    comptime cipher_suite: tls.CipherSuite,
+    input: *Reader,
+    output: *Writer,
+    options: Options,
+    hello: *const ClientHello,
+    ticket: ?*const Ticket,
+    key_share: *const KeyShare,
+) InitError!Server {
+    const P = @FieldType(tls.ApplicationCipher, @tagName(cipher_suite.with()));
+    const zeroes = [1]u8{0} ** P.Hash.digest_length;
+    const empty_hash = tls.emptyHash(P.Hash);
+
+    const early_secret = P.Hkdf.extract(&[1]u8{0}, if (ticket) |t| t.psk[0..P.Hash.digest_length] else &zeroes);
+    if (ticket != null) {
+        const psk = hello.psk.?;
+        const binder_key = hkdfExpandLabel(P.Hkdf, early_secret, "res binder", &empty_hash, P.Hash.digest_length);
+        const binder_finished_key = hkdfExpandLabel(P.Hkdf, binder_key, "finished", "", P.Hmac.key_length);
+        var truncated_hash: [P.Hash.digest_length]u8 = undefined;
+        P.Hash.hash(psk.truncated, &truncated_hash, .{});
+        const expected_binder = tls.hmac(P.Hmac, &truncated_hash, binder_finished_key);
+        if (psk.binder.len != expected_binder.len or
+            !crypto.timing_safe.eql([P.Hmac.mac_length]u8, expected_binder, psk.binder[0..P.Hmac.mac_length].*))
+            return error.TlsDecryptError;
+    }
+
+    var transcript_hash: P.Hash = .init(.{});
+    transcript_hash.update(hello.message);
+
+    {
+        const server_share = key_share.public();
+        var server_hello_buf: [server_hello_max_len]u8 = undefined;
+        var shw: Writer = .fixed(&server_hello_buf);
+        const extensions_len = 6 + 8 + server_share.len + @as(usize, if (ticket != null) 6 else 0);
+        const body_len = 2 + 32 + 1 + hello.legacy_session_id.len + 2 + 1 + 2 + extensions_len;
+        shw.writeAll(&.{@intFromEnum(tls.HandshakeType.server_hello)}) catch unreachable;
+        shw.writeInt(u24, @intCast(body_len), .big) catch unreachable;
+        shw.writeInt(u16, @intFromEnum(tls.ProtocolVersion.tls_1_2), .big) catch unreachable;
+        shw.writeAll(options.entropy[0..32]) catch unreachable;
+        shw.writeByte(@intCast(hello.legacy_session_id.len)) catch unreachable;
+        shw.writeAll(hello.legacy_session_id) catch unreachable;
+        shw.writeInt(u16, @intFromEnum(cipher_suite), .big) catch unreachable;
+        shw.writeByte(@intFromEnum(tls.CompressionMethod.null)) catch unreachable;
+        shw.writeInt(u16, @intCast(extensions_len), .big) catch unreachable;
+        shw.writeAll(&tls.extension(.supported_versions, int(u16, @intFromEnum(tls.ProtocolVersion.tls_1_3)))) catch unreachable;
+        shw.writeInt(u16, @intFromEnum(tls.ExtensionType.key_share), .big) catch unreachable;
+        shw.writeInt(u16, @intCast(4 + server_share.len), .big) catch unreachable;
+        shw.writeInt(u16, @intFromEnum(key_share.group), .big) catch unreachable;
+        shw.writeInt(u16, @intCast(server_share.len), .big) catch unreachable;
+        shw.writeAll(server_share) catch unreachable;
+        // Select the first, and only considered, identity.
+        if (ticket != null) shw.writeAll(&tls.extension(.pre_shared_key, int(u16, 0))) catch unreachable;
+        const server_hello = shw.buffered();
+        transcript_hash.update(server_hello);
+
+        const record_header = .{@intFromEnum(tls.ContentType.handshake)} ++
+            int(u16, @intFromEnum(tls.ProtocolVersion.tls_1_2));
+        try output.writeAll(&record_header);
+        try output.writeInt(u16, @intCast(server_hello.len), .big);
+        try output.writeAll(server_hello);
+        // A client in middlebox compatibility mode, indicated by a nonempty
+        // session ID, expects this message.
+        if (hello.legacy_session_id.len != 0) try output.writeAll(&change_cipher_spec_msg);
+    }
+
+    const hello_hash = transcript_hash.peek();
+    const hs_derived_secret = hkdfExpandLabel(P.Hkdf, early_secret, "derived", &empty_hash, P.Hash.digest_length);
+    const handshake_secret = P.Hkdf.extract(&hs_derived_secret, key_share.sharedSecret());
+    const ap_derived_secret = hkdfExpandLabel(P.Hkdf, handshake_secret, "derived", &empty_hash, P.Hash.digest_length);
+    const master_secret = P.Hkdf.extract(&ap_derived_secret, &zeroes);
+    const client_handshake_secret = hkdfExpandLabel(P.Hkdf, handshake_secret, "c hs traffic", &hello_hash, P.Hash.digest_length);
+    const server_handshake_secret = hkdfExpandLabel(P.Hkdf, handshake_secret, "s hs traffic", &hello_hash, P.Hash.digest_length);
+
+    {
+        var flight: HandshakeFlight(P) = .{
+            .output = output,
+            .key = hkdfExpandLabel(P.Hkdf, server_handshake_secret, "key", "", P.AEAD.key_length),
+            .iv = hkdfExpandLabel(P.Hkdf, server_handshake_secret, "iv", "", P.AEAD.nonce_length),
+            .seq = 0,
+            .buf = undefined,
+            .len = 0,
+        };
+        const encrypted_extensions = .{@intFromEnum(tls.HandshakeType.encrypted_extensions)} ++
+            int(u24, 2) ++ int(u16, 0);
+        transcript_hash.update(&encrypted_extensions);
+        try flight.write(&encrypted_extensions);
+
+        if (ticket == null) {
+            var certs_len: usize = 0;
+            for (options.certificate_chain) |cert| certs_len += 3 + cert.len + 2;
+            const certificate_header = .{@intFromEnum(tls.HandshakeType.certificate)} ++
+                int(u24, @intCast(1 + 3 + certs_len)) ++
+                .{0} ++ // certificate_request_context
+                int(u24, @intCast(certs_len));
+            transcript_hash.update(&certificate_header);
+            try flight.write(&certificate_header);
+            for (options.certificate_chain) |cert| {
+                const parts: [3][]const u8 = .{ &int(u24, @intCast(cert.len)), cert, &int(u16, 0) };
+                for (parts) |part| {
+                    transcript_hash.update(part);
+                    try flight.write(part);
+                }
+            }
+
+            const verify_context = " " ** 64 ++ "TLS 1.3, server CertificateVerify\x00";
+            const verify_hash = transcript_hash.peek();
+            const noise = options.entropy[128..160].*;
+            var signature_buf: [signature_max_len]u8 = undefined;
+            const signature: []const u8 = switch (options.private_key) {
+                .ecdsa_secp256r1_sha256 => |key_pair| signature: {
+                    var signer = try key_pair.signer(noise);
+                    signer.update(verify_context);
+                    signer.update(&verify_hash);
+                    const signature = try signer.finalize();
+                    break :signature signature.toDer(signature_buf[0..@TypeOf(signature).der_encoded_length_max]);
+                },
+                .ed25519 => |key_pair| signature: {
+                    var signer = try key_pair.signer(noise);
+                    signer.update(verify_context);
+                    signer.update(&verify_hash);
+                    const signature = signer.finalize().toBytes();
+                    @memcpy(signature_buf[0..signature.len], &signature);
+                    break :signature signature_buf[0..signature.len];
+                },
+            };
+            const certificate_verify_header = .{@intFromEnum(tls.HandshakeType.certificate_verify)} ++
+                int(u24, @intCast(2 + 2 + signature.len)) ++
+                int(u16, @intFromEnum(options.private_key.scheme())) ++
+                int(u16, @intCast(signature.len));
+            transcript_hash.update(&certificate_verify_header);
+            try flight.write(&certificate_verify_header);
+            transcript_hash.update(signature);
+            try flight.write(signature);
+        }
+
+        const server_finished_key = hkdfExpandLabel(P.Hkdf, server_handshake_secret, "finished", "", P.Hmac.key_length);
+        const finished = .{@intFromEnum(tls.HandshakeType.finished)} ++
+            tls.array(u24, u8, tls.hmac(P.Hmac, &transcript_hash.peek(), server_finished_key));
+        transcript_hash.update(&finished);
+        try flight.write(&finished);
+        try flight.flushRecord();
+        try output.flush();
+    }
+
+    const handshake_hash = transcript_hash.peek();
+    const client_secret = hkdfExpandLabel(P.Hkdf, master_secret, "c ap traffic", &handshake_hash, P.Hash.digest_length);
+    const server_secret = hkdfExpandLabel(P.Hkdf, master_secret, "s ap traffic", &handshake_hash, P.Hash.digest_length);
+
+    // Receive the client's Finished message.
+    const client_handshake_key = hkdfExpandLabel(P.Hkdf, client_handshake_secret, "key", "", P.AEAD.key_length);
+    const client_handshake_iv = hkdfExpandLabel(P.Hkdf, client_handshake_secret, "iv", "", P.AEAD.nonce_length);
+    const client_finished_key = hkdfExpandLabel(P.Hkdf, client_handshake_secret, "finished", "", P.Hmac.key_length);
+    var received_change_cipher_spec = false;
+    while (true) {
+        input.rebase(tls.max_ciphertext_record_len) catch |err| switch (err) {
+            error.EndOfStream => {}, // We have assurance the remainder of stream can be buffered.
+        };
+        const record_header = input.peek(tls.record_header_len) catch |err| switch (err) {
+            error.EndOfStream => return error.TlsConnectionTruncated,
+            error.ReadFailed => return error.ReadFailed,
+        };
+        const record_ct: tls.ContentType = @enumFromInt(record_header[0]);
+        if (record_ct != .application_data) {
+            const ct, const fragment = try readPlaintextRecord(input);
+            switch (ct) {
+                .change_cipher_spec => {
+                    if (received_change_cipher_spec) return error.TlsUnexpectedMessage;
+                    if (fragment.len != 1 or fragment[0] != @intFromEnum(tls.ChangeCipherSpecType.change_cipher_spec))
+                        return error.TlsIllegalParameter;
+                    received_change_cipher_spec = true;
+                    continue;
+                },
+                .alert => return handshakeAlert(fragment, options),
+                else => return error.TlsUnexpectedMessage,
+            }
+        }
+        const record_len = mem.readInt(u16, record_header[3..5], .big);
+        if (record_len > tls.max_ciphertext_len) return error.TlsRecordOverflow;
+        if (record_len < P.AEAD.tag_length) return error.TlsRecordOverflow;
+        const record = input.take(tls.record_header_len + record_len) catch |err| switch (err) {
+            error.EndOfStream => return error.TlsConnectionTruncated,
+            error.ReadFailed => return error.ReadFailed,
+        };
+        const ciphertext = record[tls.record_header_len .. record.len - P.AEAD.tag_length];
+        var cleartext_buf: [max_ciphertext_len]u8 = undefined;
+        const cleartext = cleartext_buf[0..ciphertext.len];
+        P.AEAD.decrypt(
+            cleartext,
+            ciphertext,
+            record[record.len - P.AEAD.tag_length ..][0..P.AEAD.tag_length].*,
+            record[0..tls.record_header_len],
+            client_handshake_iv,
+            client_handshake_key,
+        ) catch return error.TlsBadRecordMac;
+        const inner = mem.trimEnd(u8, cleartext, "\x00");
+        if (inner.len == 0) return error.TlsDecodeError;
+        const content = inner[0 .. inner.len - 1];
+        switch (@as(tls.ContentType, @enumFromInt(inner[inner.len - 1]))) {
+            .handshake => {},
+            .alert => return handshakeAlert(content, options),
+            else => return error.TlsUnexpectedMessage,
+        }
+        // Only the Finished message is expected, in a single record.
+        const expected_verify_data = tls.hmac(P.Hmac, &handshake_hash, client_finished_key);
+        if (content.len != 4 + expected_verify_data.len or
+            content[0] != @intFromEnum(tls.HandshakeType.finished) or
+            mem.readInt(u24, content[1..4], .big) != expected_verify_data.len)
+            return error.TlsUnexpectedMessage;
+        if (!crypto.timing_safe.eql([P.Hmac.mac_length]u8, expected_verify_data, content[4..][0..P.Hmac.mac_length].*))
+            return error.TlsDecryptError;
+        transcript_hash.update(content);
+        break;
+    }
+
+    var server: Server = .{
+        .input = input,
+        .reader = .{
+            .buffer = options.read_buffer,
+            .vtable = &.{
+                .stream = stream,
+                .readVec = readVec,
+            },
+            .seek = 0,
+            .end = 0,
+        },
+        .output = output,
+        .writer = .{
+            .buffer = options.write_buffer,
+            .vtable = &.{
+                .drain = drain,
+                .flush = flush,
+            },
+        },
+        .read_seq = 0,
+        .write_seq = 0,
+        .received_close_notify = false,
+        .allow_truncation_attacks = options.allow_truncation_attacks,
+        .key_update_requested = false,
+        .application_cipher = @unionInit(tls.ApplicationCipher, @tagName(cipher_suite.with()), .{ .tls_1_3 = .{
+            .client_secret = client_secret,
+            .server_secret = server_secret,
+            .client_key = hkdfExpandLabel(P.Hkdf, client_secret, "key", "", P.AEAD.key_length),
+            .server_key = hkdfExpandLabel(P.Hkdf, server_secret, "key", "", P.AEAD.key_length),
+            .client_iv = hkdfExpandLabel(P.Hkdf, client_secret, "iv", "", P.AEAD.nonce_length),
+            .server_iv = hkdfExpandLabel(P.Hkdf, server_secret, "iv", "", P.AEAD.nonce_length),
+        } }),
+        .resumed = ticket != null,
+    };
+
+    if (options.ticket_key) |ticket_key| {
+        const resumption_secret = hkdfExpandLabel(P.Hkdf, master_secret, "res master", &transcript_hash.peek(), P.Hash.digest_length);
+        // Only one ticket is issued per connection, so its nonce need not vary.
+        const ticket_nonce = [1]u8{0};
+        var new_ticket: Ticket = .{
+            .cipher_suite = cipher_suite,
+            .issued_seconds = options.realtime_now_seconds,
+            .lifetime_seconds = options.ticket_lifetime_seconds,
+            .psk = undefined,
+        };
+        @memset(&new_ticket.psk, 0);
+        new_ticket.psk[0..P.Hash.digest_length].* =
+            hkdfExpandLabel(P.Hkdf, resumption_secret, "resumption", &ticket_nonce, P.Hash.digest_length);
+        const new_session_ticket = .{@intFromEnum(tls.HandshakeType.new_session_ticket)} ++
+            int(u24, 4 + 4 + 1 + ticket_nonce.len + 2 + Ticket.sealed_len + 2) ++
+            int(u32, options.ticket_lifetime_seconds) ++
+            options.entropy[172..176].* ++ // ticket_age_add
+            tls.array(u8, u8, ticket_nonce) ++
+            tls.array(u16, u8, new_ticket.seal(ticket_key, options.entropy[160..172].*)) ++
+            int(u16, 0); // extensions
+        const ciphertext_buf = try output.writableSliceGreedy(min_buffer_len);
+        const prepared = prepareCiphertextRecord(&server, ciphertext_buf, &new_session_ticket, .handshake);
+        output.advance(prepared.ciphertext_end);
+        try output.flush();
+    }
+
+    return server;
+}
+
+const server_hello_max_len = 4 + 2 + 32 + 1 + 32 + 2 + 1 + 2 + 6 + 8 + KeyShare.public_max_len + 6;
+const signature_max_len = @max(
+    crypto.sign.ecdsa.EcdsaP256Sha256.Signature.der_encoded_length_max,
+    crypto.sign.Ed25519.Signature.encoded_length,
+);
+
+const change_cipher_spec_msg = .{@intFromEnum(tls.ContentType.change_cipher_spec)} ++
+    int(u16, @intFromEnum(tls.ProtocolVersion.tls_1_2)) ++
+    tls.array(u16, tls.ChangeCipherSpecType, .{.change_cipher_spec});
+
+/// Returns the content type and fragment of a record that is not encrypted.
+/// The fragment is valid until the next read from `input`.
+fn readPlaintextRecord(input: *Reader) InitError!struct { tls.ContentType, []u8 } {
+    // Ensure the input buffer pointer is stable in this scope.
+    input.rebase(tls.max_ciphertext_record_len) catch |err| switch (err) {
+        error.EndOfStream => {}, // We have assurance the remainder of stream can be buffered.
+    };
+    _ = input.peek(tls.record_header_len) catch |err| switch (err) {
+        error.EndOfStream => return error.TlsConnectionTruncated,
+        error.ReadFailed => return error.ReadFailed,
+    };
+    const record_ct = input.takeEnumNonexhaustive(tls.ContentType, .big) catch unreachable; // already peeked
+    input.toss(2); // legacy_version
+    const record_len = input.takeInt(u16, .big) catch unreachable; // already peeked
+    if (record_len > tls.max_ciphertext_inner_record_len) return error.TlsRecordOverflow;
+    const fragment = input.take(record_len) catch |err| switch (err) {
+        error.EndOfStream => return error.TlsConnectionTruncated,
+        error.ReadFailed => return error.ReadFailed,
+    };
+    return .{ record_ct, fragment };
+}
+
+fn handshakeAlert(fragment: []const u8, options: Options) InitError {
+    if (fragment.len != 2) return error.TlsDecodeError;
+    if (options.alert) |a| a.* = .{
+        .level = @enumFromInt(fragment[0]),
+        .description = @enumFromInt(fragment[1]),
+    };
+    return error.TlsAlert;
+}
+
+/// Encrypts handshake messages with the server handshake traffic key,
+/// coalescing them into as few records as possible.
+fn HandshakeFlight(comptime P: type) type {
+    return struct {
+        output: *Writer,
+        key: [P.AEAD.key_length]u8,
+        iv: [P.AEAD.nonce_length]u8,
+        seq: u64,
+        buf: [tls.max_ciphertext_inner_record_len + 1]u8,
+        len: usize,
+
+        const Flight = @This();
+
+        fn write(f: *Flight, bytes: []const u8) Writer.Error!void {
+            var i: usize = 0;
+            while (i < bytes.len) {
+                if (f.len == tls.max_ciphertext_inner_record_len) try f.flushRecord();
+                const n = @min(bytes.len - i, tls.max_ciphertext_inner_record_len - f.len);
+                @memcpy(f.buf[f.len..][0..n], bytes[i..][0..n]);
+                f.len += n;
+                i += n;
+            }
+        }
+
+        fn flushRecord(f: *Flight) Writer.Error!void {
+            if (f.len == 0) return;
+            f.buf[f.len] = @intFromEnum(tls.ContentType.handshake);
+            const cleartext = f.buf[0 .. f.len + 1];
+            const record = try f.output.writableSlice(tls.record_header_len + cleartext.len + P.AEAD.tag_length);
+            const ad = record[0..tls.record_header_len];
+            ad.* = .{@intFromEnum(tls.ContentType.application_data)} ++
+                int(u16, @intFromEnum(tls.ProtocolVersion.tls_1_2)) ++
+                int(u16, @intCast(cleartext.len + P.AEAD.tag_length));
+            P.AEAD.encrypt(
+                record[tls.record_header_len..][0..cleartext.len],
+                record[tls.record_header_len + cleartext.len ..][0..P.AEAD.tag_length],
+                cleartext,
+                ad,
+                nonce(P, f.iv, f.seq),
+                f.key,
+            );
+            f.seq += 1;
+            f.len = 0;
+        }
+    };
+}
+
+/// The state carried by a session ticket, encrypted and authenticated with the
+/// `TicketKey`, so that the server does not have to store it.
+const Ticket = struct {
+    cipher_suite: tls.CipherSuite,
+    issued_seconds: i64,
+    lifetime_seconds: u32,
+    /// The resumption PSK, zero-padded to the longest hash.
+    psk: [psk_max_len]u8,
+
+    const psk_max_len = crypto.hash.sha2.Sha512.digest_length;
+    const plaintext_len = 2 + 8 + 4 + psk_max_len;
+    const sealed_len = Aes256Gcm.nonce_length + plaintext_len + Aes256Gcm.tag_length;
+    const ad = "zig tls ticket";
+
+    fn seal(t: *const Ticket, key: *const TicketKey, nonce_bytes: [Aes256Gcm.nonce_length]u8) [sealed_len]u8 {
+        const plaintext = int(u16, @intFromEnum(t.cipher_suite)) ++
+            int(i64, t.issued_seconds) ++
+            int(u32, t.lifetime_seconds) ++
+            t.psk;
+        var sealed: [sealed_len]u8 = undefined;
+        sealed[0..Aes256Gcm.nonce_length].* = nonce_bytes;
+        Aes256Gcm.encrypt(
+            sealed[Aes256Gcm.nonce_length..][0..plaintext_len],
+            sealed[Aes256Gcm.nonce_length + plaintext_len ..][0..Aes256Gcm.tag_length],
+            &plaintext,
+            ad,
+            nonce_bytes,
+            key.*,
+        );
+        return sealed;
+    }
+
+    fn open(key: *const TicketKey, sealed: []const u8) ?Ticket {
+        if (sealed.len != sealed_len) return null;
+        var plaintext: [plaintext_len]u8 = undefined;
+        Aes256Gcm.decrypt(
+            &plaintext,
+            sealed[Aes256Gcm.nonce_length..][0..plaintext_len],
+            sealed[Aes256Gcm.nonce_length + plaintext_len ..][0..Aes256Gcm.tag_length].*,
+            ad,
+            sealed[0..Aes256Gcm.nonce_length].*,
+            key.*,
+        ) catch return null;
+        return .{
+            .cipher_suite = @enumFromInt(mem.readInt(u16, plaintext[0..2], .big)),
+            .issued_seconds = mem.readInt(i64, plaintext[2..10], .big),
+            .lifetime_seconds = mem.readInt(u32, plaintext[10..14], .big),
+            .psk = plaintext[14..][0..psk_max_len].*,
+        };
+    }
+};
+
+const KeyShare = struct {
+    group: tls.NamedGroup,
+    public_buf: [public_max_len]u8,
+    public_len: u16,
+    shared_buf: [shared_max_len]u8,
+    shared_len: u8,
+
+    const MLKem768 = crypto.kem.ml_kem.MLKem768;
+    const X25519 = crypto.dh.X25519;
+    const P256 = crypto.sign.ecdsa.EcdsaP256Sha256;
+
+    const public_max_len = MLKem768.ciphertext_length + X25519.public_length;
+    const shared_max_len = MLKem768.shared_length + X25519.shared_length;
+
+    /// Performs the key exchange with the client's share.
+    fn init(
+        group: tls.NamedGroup,
+        client_public: []const u8,
+        seed: *const [128]u8,
+    ) error{ TlsIllegalParameter, TlsDecryptFailure, InsufficientEntropy }!KeyShare {
+        var ks: KeyShare = .{
+            .group = group,
+            .public_buf = undefined,
+            .public_len = 0,
+            .shared_buf = undefined,
+            .shared_len = 0,
+        };
+        switch (group) {
+            .x25519_ml_kem768 => {
+                const pk_len = MLKem768.PublicKey.encoded_length;
+                if (client_public.len != pk_len + X25519.public_length) return error.TlsIllegalParameter;
+                const pk = MLKem768.PublicKey.fromBytes(client_public[0..pk_len]) catch
+                    return error.TlsIllegalParameter;
+                const encapsulated = pk.encaps(seed[64..96].*);
+                const xsk = try x25519(client_public[pk_len..][0..X25519.public_length].*, seed[0..32].*);
+                ks.append(.public, &encapsulated.ciphertext);
+                ks.append(.public, &xsk.public);
+                ks.append(.shared, &encapsulated.shared_secret);
+                ks.append(.shared, &xsk.shared);
+            },
+            .x25519 => {
+                if (client_public.len != X25519.public_length) return error.TlsIllegalParameter;
+                const xsk = try x25519(client_public[0..X25519.public_length].*, seed[0..32].*);
+                ks.append(.public, &xsk.public);
+                ks.append(.shared, &xsk.shared);
+            },
+            .secp256r1 => {
+                const kp = P256.KeyPair.generateDeterministic(seed[32..64].*) catch
+                    return error.InsufficientEntropy;
+                const pk = P256.PublicKey.fromSec1(client_public) catch return error.TlsDecryptFailure;
+                const mul = pk.p.mulPublic(kp.secret_key.bytes, .big) catch return error.TlsDecryptFailure;
+                ks.append(.public, &kp.public_key.toUncompressedSec1());
+                ks.append(.shared, &mul.affineCoordinates().x.toBytes(.big));
+            },
+            else => return error.TlsIllegalParameter,
+        }
+        return ks;
+    }
+
+    fn x25519(
+        client_public: [X25519.public_length]u8,
+        seed: [X25519.seed_length]u8,
+    ) error{ InsufficientEntropy, TlsDecryptFailure }!struct {
+        public: [X25519.public_length]u8,
+        shared: [X25519.shared_length]u8,
+    } {
+        const kp = X25519.KeyPair.generateDeterministic(seed) catch return error.InsufficientEntropy;
+        return .{
+            .public = kp.public_key,
+            .shared = X25519.scalarmult(kp.secret_key, client_public) catch return error.TlsDecryptFailure,
+        };
+    }
+
+    fn append(ks: *KeyShare, comptime which: enum { public, shared }, bytes: []const u8) void {
+        switch (which) {
+            .public => {
+                @memcpy(ks.public_buf[ks.public_len..][0..bytes.len], bytes);
+                ks.public_len += @intCast(bytes.len);
+            },
+            .shared => {
+                @memcpy(ks.shared_buf[ks.shared_len..][0..bytes.len], bytes);
+                ks.shared_len += @intCast(bytes.len);
+            },
+        }
+    }
+
+    fn public(ks: *const KeyShare) []const u8 {
+        return ks.public_buf[0..ks.public_len];
+    }
+
+    fn sharedSecret(ks: *const KeyShare) []const u8 {
+        return ks.shared_buf[0..ks.shared_len];
+    }
+};
+
+fn drain(w: *Writer, data: []const []const u8, splat: usize) Writer.Error!usize {
+    const s: *Server = @alignCast(@fieldParentPtr("writer", w));
+    const output = s.output;
+    const ciphertext_buf = try output.writableSliceGreedy(min_buffer_len);
+    var ciphertext_end: usize = s.writeKeyUpdate(ciphertext_buf);
+    var total_clear: usize = 0;
+    done: {
+        {
+            const buf = w.buffered();
+            const prepared = prepareCiphertextRecord(s, ciphertext_buf[ciphertext_end..], buf, .application_data);
+            total_clear += prepared.cleartext_len;
+            ciphertext_end += prepared.ciphertext_end;
+            if (prepared.cleartext_len < buf.len) break :done;
+        }
+        for (data[0 .. data.len - 1]) |buf| {
+            const prepared = prepareCiphertextRecord(s, ciphertext_buf[ciphertext_end..], buf, .application_data);
+            total_clear += prepared.cleartext_len;
+            ciphertext_end += prepared.ciphertext_end;
+            if (prepared.cleartext_len < buf.len) break :done;
+        }
+        const buf = data[data.len - 1];
+        for (0..splat) |_| {
+            const prepared = prepareCiphertextRecord(s, ciphertext_buf[ciphertext_end..], buf, .application_data);
+            total_clear += prepared.cleartext_len;
+            ciphertext_end += prepared.ciphertext_end;
+            if (prepared.cleartext_len < buf.len) break :done;
+        }
+    }
+    output.advance(ciphertext_end);
+    return w.consume(total_clear);
+}
+
+fn flush(w: *Writer) Writer.Error!void {
+    const s: *Server = @alignCast(@fieldParentPtr("writer", w));
+    const output = s.output;
+    const ciphertext_buf = try output.writableSliceGreedy(min_buffer_len);
+    const key_update_end = s.writeKeyUpdate(ciphertext_buf);
+    const prepared = prepareCiphertextRecord(s, ciphertext_buf[key_update_end..], w.buffered(), .application_data);
+    output.advance(key_update_end + prepared.ciphertext_end);
+    w.end = 0;
+}
+
+/// Sends a `close_notify` alert, which is necessary for the client to
+/// distinguish between a properly finished TLS session, or a truncation
+/// attack.
+pub fn end(s: *Server) Writer.Error!void {
+    try flush(&s.writer);
+    const output = s.output;
+    const ciphertext_buf = try output.writableSliceGreedy(min_buffer_len);
+    const prepared = prepareCiphertextRecord(s, ciphertext_buf, &tls.close_notify_alert, .alert);
+    output.advance(prepared.ciphertext_end);
+}
+
+/// If the client requested it, writes a KeyUpdate message into
+/// `ciphertext_buf` and switches to the next server traffic secret. Returns
+/// the number of bytes written.
+fn writeKeyUpdate(s: *Server, ciphertext_buf: []u8) usize {
+    if (!s.key_update_requested) return 0;
+    const prepared = prepareCiphertextRecord(s, ciphertext_buf, &key_update_msg, .handshake);
+    s.updateWriteKeys();
+    s.key_update_requested = false;
+    return prepared.ciphertext_end;
+}
+
+const key_update_msg = .{@intFromEnum(tls.HandshakeType.key_update)} ++
+    tls.array(u24, tls.KeyUpdateRequest, .{.update_not_requested});
+const key_update_record_len = tls.record_header_len + key_update_msg.len + 1 + max_tag_len;
+const max_tag_len = 16;
+
+/// The number of records encrypted with one server traffic key before it is
+/// replaced with a KeyUpdate, which is sent with the last of them. This stays
+/// within the limit RFC 8446 section 5.5 gives for AES-GCM, and therefore far
+/// from the end of the 64-bit sequence number, after which nonces would repeat.
+const max_records_per_key = 1 << 24;
+
+fn updateWriteKeys(s: *Server) void {
+    switch (s.application_cipher) {
+        inline else => |*p| {
+            const pv = &p.tls_1_3;
+            const P = @TypeOf(p.*);
+            pv.server_secret = hkdfExpandLabel(P.Hkdf, pv.server_secret, "traffic upd", "", P.Hash.digest_length);
+            pv.server_key = hkdfExpandLabel(P.Hkdf, pv.server_secret, "key", "", P.AEAD.key_length);
+            pv.server_iv = hkdfExpandLabel(P.Hkdf, pv.server_secret, "iv", "", P.AEAD.nonce_length);
+        },
+    }
+    s.write_seq = 0;
+}
+
+fn prepareCiphertextRecord(
+    s: *Server,
+    ciphertext_buf: []u8,
+    bytes: []const u8,
+    inner_content_type: tls.ContentType,
+) struct {
+    ciphertext_end: usize,
+    cleartext_len: usize,
+} {
+    var ciphertext_end: usize = 0;
+    var bytes_i: usize = 0;
+    while (true) {
+        const key_update_len: usize = if (s.write_seq == max_records_per_key - 1) key_update_record_len else 0;
+        const encrypted_content_len: u16 = @min(
+            bytes.len - bytes_i,
+            tls.max_ciphertext_inner_record_len,
+            ciphertext_buf.len -| (record_overhead_len + key_update_len + ciphertext_end),
+        );
+        if (encrypted_content_len == 0) return .{
+            .ciphertext_end = ciphertext_end,
+            .cleartext_len = bytes_i,
+        };
+        if (key_update_len != 0) {
+            ciphertext_end += s.sealRecord(ciphertext_buf[ciphertext_end..], &key_update_msg, .handshake);
+            s.updateWriteKeys();
+        }
+        ciphertext_end += s.sealRecord(
+            ciphertext_buf[ciphertext_end..],
+            bytes[bytes_i..][0..encrypted_content_len],
+            inner_content_type,
+        );
+        bytes_i += encrypted_content_len;
+    }
+}
+
+const record_overhead_len = tls.record_header_len + max_tag_len + 1;
+
+/// Encrypts `content` as one record at the start of `ciphertext_buf`, which
+/// must have room for it, and returns the length of the record.
+fn sealRecord(s: *Server, ciphertext_buf: []u8, content: []const u8, inner_content_type: tls.ContentType) usize {
+    // Due to the trailing inner content type byte in the ciphertext, we need
+    // an additional buffer for storing the cleartext into before encrypting.
+    var cleartext_buf: [max_ciphertext_len]u8 = undefined;
+    switch (s.application_cipher) {
+        inline else => |*p| {
+            const pv = &p.tls_1_3;
+            const P = @TypeOf(p.*);
+            comptime assert(P.AEAD.tag_length <= max_tag_len);
+            @memcpy(cleartext_buf[0..content.len], content);
+            cleartext_buf[content.len] = @intFromEnum(inner_content_type);
+            const ciphertext_len = content.len + 1;
+            const cleartext = cleartext_buf[0..ciphertext_len];
+
+            const ad = ciphertext_buf[0..tls.record_header_len];
+            ad.* = .{@intFromEnum(tls.ContentType.application_data)} ++
+                int(u16, @intFromEnum(tls.ProtocolVersion.tls_1_2)) ++
+                int(u16, @intCast(ciphertext_len + P.AEAD.tag_length));
+            const ciphertext = ciphertext_buf[ad.len..][0..ciphertext_len];
+            const auth_tag = ciphertext_buf[ad.len + ciphertext_len ..][0..P.AEAD.tag_length];
+            P.AEAD.encrypt(ciphertext, auth_tag, cleartext, ad, nonce(P, pv.server_iv, s.write_seq), pv.server_key);
+            s.write_seq += 1;
+            return ad.len + ciphertext_len + auth_tag.len;
+        },
+    }
+}
+
+pub fn eof(s: Server) bool {
+    return s.received_close_notify;
+}
+
+fn stream(r: *Reader, w: *Writer, limit: std.Io.Limit) Reader.StreamError!usize {
+    // This function writes exclusively to the buffer.
+    _ = w;
+    _ = limit;
+    const s: *Server = @alignCast(@fieldParentPtr("reader", r));
+    return readIndirect(s);
+}
+
+fn readVec(r: *Reader, data: [][]u8) Reader.Error!usize {
+    // This function writes exclusively to the buffer.
+    _ = data;
+    const s: *Server = @alignCast(@fieldParentPtr("reader", r));
+    return readIndirect(s);
+}
+
+fn readIndirect(s: *Server) Reader.Error!usize {
+    const r = &s.reader;
+    if (s.eof()) return error.EndOfStream;
+    const input = s.input;
+    // If at least one full encrypted record is not buffered, read once.
+    const record_header = input.peek(tls.record_header_len) catch |err| switch (err) {
+        error.EndOfStream => {
+            // This is either a truncation attack, a bug in the client, or an
+            // intentional omission of the close_notify message due to truncation
+            // detection handled above the TLS layer.
+            if (s.allow_truncation_attacks) {
+                s.received_close_notify = true;
+                return error.EndOfStream;
+            } else {
+                return failRead(s, error.TlsConnectionTruncated);
+            }
+        },
+        error.ReadFailed => return error.ReadFailed,
+    };
+    const ct: tls.ContentType = @enumFromInt(record_header[0]);
+    if (ct != .application_data) return failRead(s, error.TlsUnexpectedMessage);
+    const record_len = mem.readInt(u16, record_header[3..][0..2], .big);
+    if (record_len > max_ciphertext_len) return failRead(s, error.TlsRecordOverflow);
+    const record_end = 5 + record_len;
+    if (record_end > input.buffered().len) {
+        input.fillMore() catch |err| switch (err) {
+            error.EndOfStream => return failRead(s, error.TlsConnectionTruncated),
+            error.ReadFailed => return error.ReadFailed,
+        };
+        if (record_end > input.buffered().len) return 0;
+    }
+
+    const cleartext_len, const inner_ct: tls.ContentType = cleartext: switch (s.application_cipher) {
+        inline else => |*p| {
+            const pv = &p.tls_1_3;
+            const P = @TypeOf(p.*);
+            if (record_len < P.AEAD.tag_length) return failRead(s, error.TlsBadLength);
+            const ad = input.take(tls.record_header_len) catch unreachable; // already peeked
+            const ciphertext_len = record_len - P.AEAD.tag_length;
+            const ciphertext = input.take(ciphertext_len) catch unreachable; // already peeked
+            const auth_tag = (input.takeArray(P.AEAD.tag_length) catch unreachable).*; // already peeked
+            rebase(r, ciphertext.len);
+            const cleartext = r.buffer[r.end..][0..ciphertext.len];
+            P.AEAD.decrypt(cleartext, ciphertext, auth_tag, ad, nonce(P, pv.client_iv, s.read_seq), pv.client_key) catch
+                return failRead(s, error.TlsBadRecordMac);
+            const msg = mem.trimEnd(u8, cleartext, "\x00");
+            if (msg.len == 0) return failRead(s, error.TlsDecodeError);
+            break :cleartext .{ msg.len - 1, @enumFromInt(msg[msg.len - 1]) };
+        },
+    };
+    const cleartext = r.buffer[r.end..][0..cleartext_len];
+    s.read_seq = std.math.add(u64, s.read_seq, 1) catch return failRead(s, error.TlsSequenceOverflow);
+    switch (inner_ct) {
+        .alert => {
+            if (cleartext.len != 2) return failRead(s, error.TlsDecodeError);
+            const alert: tls.Alert = .{
+                .level = @enumFromInt(cleartext[0]),
+                .description = @enumFromInt(cleartext[1]),
+            };
+            switch (alert.description) {
+                .close_notify => {
+                    s.received_close_notify = true;
+                    return 0;
+                },
+                else => {
+                    s.alert = alert;
+                    return failRead(s, error.TlsAlert);
+                },
+            }
+        },
+        .handshake => {
+            var ct_i: usize = 0;
+            while (ct_i < cleartext.len) {
+                if (cleartext.len - ct_i < 4) return failRead(s, error.TlsBadLength);
+                const handshake_type: tls.HandshakeType = @enumFromInt(cleartext[ct_i]);
+                const handshake_len = mem.readInt(u24, cleartext[ct_i + 1 ..][0..3], .big);
+                ct_i += 4;
+                const next_handshake_i = ct_i + handshake_len;
+                if (next_handshake_i > cleartext.len) return failRead(s, error.TlsBadLength);
+                const handshake_msg = cleartext[ct_i..next_handshake_i];
+                switch (handshake_type) {
+                    .key_update => {
+                        if (handshake_msg.len != 1) return failRead(s, error.TlsDecodeError);
+                        switch (s.application_cipher) {
+                            inline else => |*p| {
+                                const pv = &p.tls_1_3;
+                                const P = @TypeOf(p.*);
+                                pv.client_secret = hkdfExpandLabel(P.Hkdf, pv.client_secret, "traffic upd", "", P.Hash.digest_length);
+                                pv.client_key = hkdfExpandLabel(P.Hkdf, pv.client_secret, "key", "", P.AEAD.key_length);
+                                pv.client_iv = hkdfExpandLabel(P.Hkdf, pv.client_secret, "iv", "", P.AEAD.nonce_length);
+                            },
+                        }
+                        s.read_seq = 0;
+                        switch (@as(tls.KeyUpdateRequest, @enumFromInt(handshake_msg[0]))) {
+                            .update_requested => s.key_update_requested = true,
+                            .update_not_requested => {},
+                            _ => return failRead(s, error.TlsIllegalParameter),
+                        }
+                    },
+                    else => return failRead(s, error.TlsUnexpectedMessage),
+                }
+                ct_i = next_handshake_i;
+            }
+            return 0;
+        },
+        .application_data => {
+            r.end += cleartext.len;
+            return 0;
+        },
+        else => return failRead(s, error.TlsUnexpectedMessage),
+    }
+}
+
+fn rebase(r: *Reader, capacity: usize) void {
+    if (r.buffer.len - r.end >= capacity) return;
+    const data = r.buffer[r.seek..r.end];
+    @memmove(r.buffer[0..data.len], data);
+    r.seek = 0;
+    r.end = data.len;
+    assert(r.buffer.len - r.end >= capacity);
+}
+
+fn failRead(s: *Server, err: ReadError) error{ReadFailed} {
+    s.read_err = err;
+    return error.ReadFailed;
+}
+
+fn nonce(comptime P: type, iv: [P.AEAD.nonce_length]u8, seq: u64) [P.AEAD.nonce_length]u8 {
+    const V = @Vector(P.AEAD.nonce_length, u8);
+    const pad = [1]u8{0} ** (P.AEAD.nonce_length - 8);
+    const operand: V = pad ++ @as([8]u8, @bitCast(big(seq)));
+    return @as(V, iv) ^ operand;
+}
+
+fn big(x: anytype) @TypeOf(x) {
+    return switch (native_endian) {
+        .big => x,
+        .little => @byteSwap(x),
+    };
+}
+
+/// The private key of "testdata/cert.der", a self-signed certificate for
+/// "localhost", valid from 2026 to 2126.
+const test_secret_key = "59e220d07fd8b5b77cd19182e1c7228fca1ee7ddc5e41b85485cd63be4a0e6ba";
+const test_now_seconds = 1_900_000_000;
+const test_ticket_key: TicketKey = @splat(0x5a);
+
+fn testOptions(
+    key_pair: *const crypto.sign.ecdsa.EcdsaP256Sha256.KeyPair,
+    read_buffer: []u8,
+    write_buffer: []u8,
+    entropy: *const [176]u8,
+) Options {
+    return .{
+        .certificate_chain = &.{@embedFile("testdata/cert.der")},
+        .private_key = .{ .ecdsa_secp256r1_sha256 = key_pair.* },
+        .read_buffer = read_buffer,
+        .write_buffer = write_buffer,
+        .entropy = entropy,
+        .realtime_now_seconds = test_now_seconds,
+    };
+}
+
+fn testKeyPair() !crypto.sign.ecdsa.EcdsaP256Sha256.KeyPair {
+    const EcdsaP256Sha256 = crypto.sign.ecdsa.EcdsaP256Sha256;
+    var secret_key_bytes: [EcdsaP256Sha256.SecretKey.encoded_length]u8 = undefined;
+    _ = try std.fmt.hexToBytes(&secret_key_bytes, test_secret_key);
+    return .fromSecretKey(try .fromBytes(secret_key_bytes));
+}
+
+/// Accepts a connection for each of `results`, and echoes one line back to
+/// the client. Stores whether the session was resumed, or why the handshake
+/// failed.
+fn testServe(listener: *std.Io.net.Server, results: []InitError!bool) !void {
+    const io = std.testing.io;
+    const key_pair = try testKeyPair();
+
+    for (results, 0..) |*result, i| {
+        var connection = try listener.accept(io);
+        defer connection.close(io);
+        var recv_buffer: [min_buffer_len]u8 = undefined;
+        var send_buffer: [min_buffer_len]u8 = undefined;
+        var read_buffer: [min_buffer_len]u8 = undefined;
+        var write_buffer: [64]u8 = undefined;
+        var stream_reader = connection.reader(io, &recv_buffer);
+        var stream_writer = connection.writer(io, &send_buffer);
+        var entropy: [176]u8 = undefined;
+        @memset(&entropy, @intCast(i + 1));
+
+        var options = testOptions(&key_pair, &read_buffer, &write_buffer, &entropy);
+        options.realtime_now_seconds += @intCast(i);
+        options.ticket_key = &test_ticket_key;
+        var server: Server = Server.init(&stream_reader.interface, &stream_writer.interface, options) catch |err| {
+            result.* = err;
+            continue;
+        };
+        result.* = server.resumed;
+        const line = try server.reader.takeDelimiterInclusive('\n');
+        try server.writer.writeAll(line);
+        try server.end();
+        try stream_writer.interface.flush();
+    }
+}
+
+/// Performs the handshake as connection number `i`, and expects a line to be
+/// echoed back.
+fn testConnect(listener: *std.Io.net.Server, session: *tls.Client.Session, i: usize) !void {
+    const io = std.testing.io;
+    var connection = try listener.socket.address.connect(io, .{ .mode = .stream });
+    defer connection.close(io);
+    var recv_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+    var send_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+    var read_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+    var write_buffer: [64]u8 = undefined;
+    var stream_reader = connection.reader(io, &recv_buffer);
+    var stream_writer = connection.writer(io, &send_buffer);
+    var entropy: [176]u8 = undefined;
+    @memset(&entropy, @intCast(0x80 + i));
+
+    var client: tls.Client = try .init(&stream_reader.interface, &stream_writer.interface, .{
+        .host = .{ .explicit = "localhost" },
+        .ca = .self_signed,
+        .read_buffer = &read_buffer,
+        .write_buffer = &write_buffer,
+        .entropy = &entropy,
+        .realtime_now_seconds = test_now_seconds + @as(i64, @intCast(i)),
+        .session = session,
+    });
+    try client.writer.writeAll("hello\n");
+    try client.writer.flush();
+    try stream_writer.interface.flush();
+    try std.testing.expectEqualStrings("hello\n", try client.reader.takeDelimiterInclusive('\n'));
+    try std.testing.expectError(error.EndOfStream, client.reader.takeByte());
+}
+
+test "handshake and resumption with Client" {
+    if (builtin.single_threaded) return error.SkipZigTest;
+    const io = std.testing.io;
+
+    const address = try std.Io.net.IpAddress.parse("127.0.0.1", 0);
+    var listener = try address.listen(io, .{ .reuse_address = true });
+    defer listener.deinit(io);
+    var results: [2]InitError!bool = undefined;
+    const server_thread = try std.Thread.spawn(.{}, testServe, .{ &listener, &results });
+
+    var session: tls.Client.Session = .empty;
+    for (0..2) |i| {
+        try testConnect(&listener, &session, i);
+        try std.testing.expect(session.isResumable(test_now_seconds + 2));
+    }
+
+    server_thread.join();
+    try std.testing.expectEqual(false, try results[0]);
+    try std.testing.expectEqual(true, try results[1]);
+}
+
+test "resumption with a bad PSK binder fails" {
+    if (builtin.single_threaded) return error.SkipZigTest;
+    const io = std.testing.io;
+
+    const address = try std.Io.net.IpAddress.parse("127.0.0.1", 0);
+    var listener = try address.listen(io, .{ .reuse_address = true });
+    defer listener.deinit(io);
+    var results: [2]InitError!bool = undefined;
+    const server_thread = try std.Thread.spawn(.{}, testServe, .{ &listener, &results });
+
+    var session: tls.Client.Session = .empty;
+    try testConnect(&listener, &session, 0);
+    // The ticket is still valid, but the client no longer knows its key, so
+    // the binder does not match.
+    session.psk_buf[0] ^= 1;
+    if (testConnect(&listener, &session, 1)) |_| {
+        return error.TestUnexpectedResult;
+    } else |_| {}
+
+    server_thread.join();
+    try std.testing.expectEqual(false, try results[0]);
+    try std.testing.expectError(error.TlsDecryptError, results[1]);
+}
+
+test "tickets which cannot be used for resumption" {
+    const ticket: Ticket = .{
+        .cipher_suite = .AES_128_GCM_SHA256,
+        .issued_seconds = test_now_seconds,
+        .lifetime_seconds = 60,
+        .psk = @splat(0x11),
+    };
+    var sealed = ticket.seal(&test_ticket_key, @splat(0x22));
+    const aes_128_gcm = int(u16, @intFromEnum(tls.CipherSuite.AES_128_GCM_SHA256));
+    const chacha20_poly1305 = int(u16, @intFromEnum(tls.CipherSuite.CHACHA20_POLY1305_SHA256));
+    var hello: ClientHello = .{
+        .message = &.{},
+        .legacy_session_id = &.{},
+        .cipher_suites = &(chacha20_poly1305 ++ aes_128_gcm),
+        .cipher_suite = .CHACHA20_POLY1305_SHA256,
+        .key_share_group = .x25519,
+        .key_share = &.{},
+        .signature_scheme_supported = true,
+        .psk_dhe_ke = true,
+        .psk = .{ .identity = &sealed, .binder = &.{}, .truncated = &.{} },
+    };
+    var options: Options = .{
+        .certificate_chain = &.{},
+        .private_key = undefined,
+        .read_buffer = &.{},
+        .write_buffer = &.{},
+        .entropy = undefined,
+        .realtime_now_seconds = test_now_seconds + 30,
+        .ticket_key = &test_ticket_key,
+    };
+    try std.testing.expectEqual(ticket.psk, acceptTicket(&hello, options).?.psk);
+
+    // Expired, or issued in the future.
+    options.realtime_now_seconds = test_now_seconds + 61;
+    try std.testing.expectEqual(null, acceptTicket(&hello, options));
+    options.realtime_now_seconds = test_now_seconds - 1;
+    try std.testing.expectEqual(null, acceptTicket(&hello, options));
+    options.realtime_now_seconds = test_now_seconds + 30;
+
+    // The cipher suite of the ticket is not offered.
+    hello.cipher_suites = &chacha20_poly1305;
+    try std.testing.expectEqual(null, acceptTicket(&hello, options));
+    hello.cipher_suites = &aes_128_gcm;
+
+    // Without `psk_dhe_ke`, resumption would skip the key exchange.
+    hello.psk_dhe_ke = false;
+    try std.testing.expectEqual(null, acceptTicket(&hello, options));
+    hello.psk_dhe_ke = true;
+
+    // Issued with another key.
+    const other_key: TicketKey = @splat(0xa5);
+    options.ticket_key = &other_key;
+    try std.testing.expectEqual(null, acceptTicket(&hello, options));
+    options.ticket_key = &test_ticket_key;
+
+    // Tampered with.
+    for ([_]usize{ 0, Aes256Gcm.nonce_length, sealed.len - 1 }) |i| {
+        sealed[i] ^= 1;
+        try std.testing.expectEqual(null, acceptTicket(&hello, options));
+        sealed[i] ^= 1;
+    }
+    try std.testing.expect(acceptTicket(&hello, options) != null);
+}
+
+fn testServeKeyUpdate(listener: *std.Io.net.Server, write_seq: *u64) !void {
+    const io = std.testing.io;
+    const key_pair = try testKeyPair();
+
+    var connection = try listener.accept(io);
+    defer connection.close(io);
+    var recv_buffer: [min_buffer_len]u8 = undefined;
+    var send_buffer: [min_buffer_len]u8 = undefined;
+    var read_buffer: [min_buffer_len]u8 = undefined;
+    var write_buffer: [64]u8 = undefined;
+    var stream_reader = connection.reader(io, &recv_buffer);
+    var stream_writer = connection.writer(io, &send_buffer);
+    var entropy: [176]u8 = @splat(1);
+
+    var server: Server = try .init(
+        &stream_reader.interface,
+        &stream_writer.interface,
+        testOptions(&key_pair, &read_buffer, &write_buffer, &entropy),
+    );
+    server.write_seq = max_records_per_key - 2;
+    try server.writer.writeAll("a\n");
+    try server.writer.flush();
+    try server.writer.writeAll("b\n");
+    try server.end();
+    try stream_writer.interface.flush();
+    write_seq.* = server.write_seq;
+}
+
+test "keys are updated before too many records are written" {
+    if (builtin.single_threaded) return error.SkipZigTest;
+    const io = std.testing.io;
+
+    const address = try std.Io.net.IpAddress.parse("127.0.0.1", 0);
+    var listener = try address.listen(io, .{ .reuse_address = true });
+    defer listener.deinit(io);
+    var write_seq: u64 = undefined;
+    const server_thread = try std.Thread.spawn(.{}, testServeKeyUpdate, .{ &listener, &write_seq });
+
+    {
+        var connection = try listener.socket.address.connect(io, .{ .mode = .stream });
+        defer connection.close(io);
+        var recv_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+        var send_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+        var read_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+        var write_buffer: [64]u8 = undefined;
+        var stream_reader = connection.reader(io, &recv_buffer);
+        var stream_writer = connection.writer(io, &send_buffer);
+        var entropy: [176]u8 = @splat(0x80);
+
+        var client: tls.Client = try .init(&stream_reader.interface, &stream_writer.interface, .{
+            .host = .{ .explicit = "localhost" },
+            .ca = .self_signed,
+            .read_buffer = &read_buffer,
+            .write_buffer = &write_buffer,
+            .entropy = &entropy,
+            .realtime_now_seconds = test_now_seconds,
+        });
+        client.read_seq = max_records_per_key - 2;
+        try std.testing.expectEqualStrings("a\n", try client.reader.takeDelimiterInclusive('\n'));
+        try std.testing.expectEqualStrings("b\n", try client.reader.takeDelimiterInclusive('\n'));
+        try std.testing.expectError(error.EndOfStream, client.reader.takeByte());
+    }
+
+    server_thread.join();
+    // "a" used the second to last sequence number of the first key, and the
+    // KeyUpdate the last, so "b" and close_notify were sent with the next key.
+    try std.testing.expectEqual(2, write_seq);
+}
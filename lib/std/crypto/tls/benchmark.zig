@@ -0,0 +1,260 @@
+// zig run -O ReleaseFast --zig-lib-dir ../../.. benchmark.zig
+//
+// Measures the rate of TLS 1.3 handshakes between `tls.Client` and `tls.Server` on the loopback
+// interface, for full handshakes and for handshakes resuming a session with a ticket (psk_dhe_ke).
+// Each connection exchanges one line, which is also how the client receives the ticket.
+//
+// Then measures the throughput of application data sent by the server over one connection, with
+// the cipher suite the client prefers on this machine.
+
+const std = @import("std");
+const tls = std.crypto.tls;
+const Io = std.Io;
+const net = std.Io.net;
+const Timer = std.time.Timer;
+const EcdsaP256Sha256 = std.crypto.sign.ecdsa.EcdsaP256Sha256;
+
+/// The private key of "testdata/cert.der", a self-signed certificate for "localhost", valid from
+/// 2026 to 2126.
+const secret_key = "59e220d07fd8b5b77cd19182e1c7228fca1ee7ddc5e41b85485cd63be4a0e6ba";
+
+const Mode = enum { full, resumed };
+
+const ServerContext = struct {
+    io: Io,
+    listener: *net.Server,
+    key_pair: EcdsaP256Sha256.KeyPair,
+    ticket_key: tls.Server.TicketKey,
+    connections: usize,
+    /// After echoing the line, each connection sends this many more bytes.
+    bulk_bytes: usize = 0,
+    resumed: usize = 0,
+    cipher_suite: ?std.meta.Tag(tls.ApplicationCipher) = null,
+    err: ?anyerror = null,
+
+    fn run(s: *ServerContext) void {
+        s.runInner() catch |err| {
+            s.err = err;
+        };
+    }
+
+    fn runInner(s: *ServerContext) !void {
+        const io = s.io;
+        for (0..s.connections) |_| {
+            var connection = try s.listener.accept(io);
+            defer connection.close(io);
+            var recv_buffer: [tls.Server.min_buffer_len]u8 = undefined;
+            var send_buffer: [tls.Server.min_buffer_len]u8 = undefined;
+            var read_buffer: [tls.Server.min_buffer_len]u8 = undefined;
+            var write_buffer: [64]u8 = undefined;
+            var stream_reader = connection.reader(io, &recv_buffer);
+            var stream_writer = connection.writer(io, &send_buffer);
+            var entropy: [176]u8 = undefined;
+            std.crypto.random.bytes(&entropy);
+
+            var server: tls.Server = try .init(&stream_reader.interface, &stream_writer.interface, .{
+                .certificate_chain = &.{@embedFile("testdata/cert.der")},
+                .private_key = .{ .ecdsa_secp256r1_sha256 = s.key_pair },
+                .read_buffer = &read_buffer,
+                .write_buffer = &write_buffer,
+                .entropy = &entropy,
+                .realtime_now_seconds = (try Io.Clock.real.now(io)).toSeconds(),
+                .ticket_key = &s.ticket_key,
+            });
+            if (server.resumed) s.resumed += 1;
+            s.cipher_suite = server.application_cipher;
+            const line = try server.reader.takeDelimiterInclusive('\n');
+            try server.writer.writeAll(line);
+            var remaining = s.bulk_bytes;
+            while (remaining > 0) {
+                const n = @min(remaining, bulk_data.len);
+                try server.writer.writeAll(bulk_data[0..n]);
+                remaining -= n;
+            }
+            try server.end();
+            try stream_writer.interface.flush();
+        }
+    }
+};
+
+const bulk_data: [1 << 16]u8 = @splat('x');
+
+/// Returns the number of bytes received after the echoed line.
+fn connect(io: Io, address: net.IpAddress, session: ?*tls.Client.Session) !u64 {
+    var connection = try address.connect(io, .{ .mode = .stream });
+    defer connection.close(io);
+    var recv_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+    var send_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+    var read_buffer: [tls.Client.min_buffer_len]u8 = undefined;
+    var write_buffer: [64]u8 = undefined;
+    var stream_reader = connection.reader(io, &recv_buffer);
+    var stream_writer = connection.writer(io, &send_buffer);
+    var entropy: [176]u8 = undefined;
+    std.crypto.random.bytes(&entropy);
+
+    var client: tls.Client = try .init(&stream_reader.interface, &stream_writer.interface, .{
+        .host = .{ .explicit = "localhost" },
+        .ca = .self_signed,
+        .read_buffer = &read_buffer,
+        .write_buffer = &write_buffer,
+        .entropy = &entropy,
+        .realtime_now_seconds = (try Io.Clock.real.now(io)).toSeconds(),
+        .session = session,
+    });
+    try client.writer.writeAll("hello\n");
+    try client.writer.flush();
+    try stream_writer.interface.flush();
+    _ = try client.reader.takeDelimiterInclusive('\n');
+    return client.reader.discardRemaining();
+}
+
+/// Returns the number of handshakes per second.
+fn benchmarkHandshakes(io: Io, mode: Mode, connections: usize) !u64 {
+    var secret_key_bytes: [EcdsaP256Sha256.SecretKey.encoded_length]u8 = undefined;
+    _ = try std.fmt.hexToBytes(&secret_key_bytes, secret_key);
+
+    const address = try net.IpAddress.parse("127.0.0.1", 0);
+    var listener = try address.listen(io, .{ .reuse_address = true });
+    defer listener.deinit(io);
+
+    // The extra connection obtains the first ticket, and is not measured.
+    var server: ServerContext = .{
+        .io = io,
+        .listener = &listener,
+        .key_pair = try .fromSecretKey(try .fromBytes(secret_key_bytes)),
+        .ticket_key = undefined,
+        .connections = connections + 1,
+    };
+    std.crypto.random.bytes(&server.ticket_key);
+    const server_thread = try std.Thread.spawn(.{}, ServerContext.run, .{&server});
+
+    var session: tls.Client.Session = .empty;
+    const result: anyerror!u64 = run: {
+        _ = connect(io, listener.socket.address, &session) catch |err| break :run err;
+        var timer = Timer.start() catch |err| break :run err;
+        for (0..connections) |_| {
+            const client_session = switch (mode) {
+                .full => null,
+                .resumed => &session,
+            };
+            _ = connect(io, listener.socket.address, client_session) catch |err| break :run err;
+        }
+        break :run timer.read();
+    };
+    server_thread.join();
+
+    const elapsed_ns = try result;
+    if (server.err) |err| return err;
+    const expected_resumed: usize = switch (mode) {
+        .full => 0,
+        .resumed => connections,
+    };
+    if (server.resumed != expected_resumed) return error.UnexpectedResumption;
+    return @as(u64, connections) * std.time.ns_per_s / @max(elapsed_ns, 1);
+}
+
+/// Returns the number of bytes per second received by the client, and the cipher suite used.
+fn benchmarkBulk(io: Io, bytes: usize) !struct { u64, std.meta.Tag(tls.ApplicationCipher) } {
+    var secret_key_bytes: [EcdsaP256Sha256.SecretKey.encoded_length]u8 = undefined;
+    _ = try std.fmt.hexToBytes(&secret_key_bytes, secret_key);
+
+    const address = try net.IpAddress.parse("127.0.0.1", 0);
+    var listener = try address.listen(io, .{ .reuse_address = true });
+    defer listener.deinit(io);
+
+    var server: ServerContext = .{
+        .io = io,
+        .listener = &listener,
+        .key_pair = try .fromSecretKey(try .fromBytes(secret_key_bytes)),
+        .ticket_key = undefined,
+        .connections = 1,
+        .bulk_bytes = bytes,
+    };
+    std.crypto.random.bytes(&server.ticket_key);
+    const server_thread = try std.Thread.spawn(.{}, ServerContext.run, .{&server});
+
+    const result: anyerror!struct { u64, u64 } = run: {
+        var timer = Timer.start() catch |err| break :run err;
+        const received = connect(io, listener.socket.address, null) catch |err| break :run err;
+        break :run .{ received, timer.read() };
+    };
+    server_thread.join();
+
+    const received, const elapsed_ns = try result;
+    if (server.err) |err| return err;
+    if (received != bytes) return error.UnexpectedLength;
+    return .{ received * std.time.ns_per_s / @max(elapsed_ns, 1), server.cipher_suite.? };
+}
+
+pub fn main() !void {
+    var stdout_buffer: [0x100]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const stdout = &stdout_writer.interface;
+
+    var buffer: [1024]u8 = undefined;
+    var fixed = std.heap.FixedBufferAllocator.init(buffer[0..]);
+    const args = try std.process.argsAlloc(fixed.allocator());
+
+    var connections: usize = 1000;
+    var mib: usize = 1024;
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        if (std.mem.eql(u8, args[i], "--connections")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            connections = try std.fmt.parseUnsigned(usize, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--mib")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            mib = try std.fmt.parseUnsigned(usize, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--help")) {
+            usage();
+            return;
+        } else {
+            usage();
+            std.process.exit(1);
+        }
+    }
+    if (connections == 0 or mib == 0) {
+        usage();
+        std.process.exit(1);
+    }
+
+    const gpa = std.heap.smp_allocator;
+    var threaded: Io.Threaded = .init(gpa);
+    defer threaded.deinit();
+    const io = threaded.io();
+
+    try stdout.print("{s: >10} {s: >14}\n", .{ "handshake", "handshakes/s" });
+    try stdout.flush();
+
+    for ([_]Mode{ .full, .resumed }) |mode| {
+        const rate = try benchmarkHandshakes(io, mode, connections);
+        try stdout.print("{s: >10} {d: >14}\n", .{ @tagName(mode), rate });
+        try stdout.flush();
+    }
+
+    const rate, const cipher_suite = try benchmarkBulk(io, mib * 1024 * 1024);
+    try stdout.print("\n{s: >24} {s: >10}\n", .{ "cipher suite", "MiB/s" });
+    try stdout.print("{s: >24} {d: >10}\n", .{ @tagName(cipher_suite), rate / (1024 * 1024) });
+    try stdout.flush();
+}
+
+fn usage() void {
+    std.debug.print(
+        \\benchmark [options]
+        \\
+        \\options:
+        \\ --connections [int]  per handshake measurement
+        \\ --mib [int]          sent for the throughput measurement
+        \\ --help
+        \\
+    , .{});
+}
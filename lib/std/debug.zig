@@ -24,6 +24,7 @@ pub const ElfFile = @import("debug/ElfFile.zig");
 pub const MachOFile = @import("debug/MachOFile.zig");
 pub const Info = @import("debug/Info.zig");
 pub const Coverage = @import("debug/Coverage.zig");
+pub const Profiler = @import("debug/Profiler.zig");
 pub const cpu_context = @import("debug/cpu_context.zig");
 
 /// This type abstracts the target-specific implementation of accessing this process' own debug
@@ -650,6 +651,44 @@ pub noinline fn captureCurrentStackTrace(options: StackUnwindOptions, addr_buf:
         .instruction_addresses = addr_buf[0..index],
     };
 }
+/// The address range `[low, high)` of a thread's stack.
+pub const StackBounds = struct {
+    low: usize,
+    high: usize,
+};
+/// Capture the stack trace of the code interrupted by a signal, given the `cpu_context.Native` the
+/// kernel provided to the handler and the bounds of the interrupted thread's stack. Unlike
+/// `captureCurrentStackTrace`, this only ever unwinds using frame pointers, so it does not allocate,
+/// take locks, or read debug info, and is therefore safe to call from a signal handler.
+///
+/// A frame is only read if it is aligned and lies within `stack`, and each frame must be closer to
+/// the base of the stack than the one before it. Frame pointers could still be omitted from some
+/// linked object, in which case the trace may end early or contain bogus addresses, but unwinding
+/// never reads outside of `stack`. If frame pointers are omitted from this compilation, only the
+/// interrupted PC is captured.
+pub fn captureSignalStackTrace(context: CpuContextPtr, stack: StackBounds, addr_buf: []usize) StackTrace {
+    if (!std.options.allow_stack_tracing or addr_buf.len == 0) return .{ .index = 0, .instruction_addresses = &.{} };
+    // The caller expects *return* addresses, where they will subtract 1 to find the address of the call.
+    // However, we have the actual current PC, which should not be adjusted. Compensate by adding 1.
+    addr_buf[0] = context.getPc() +| 1;
+    var index: usize = 1;
+    // Since every frame is checked against `stack`, FP unwinding is safe even where `stratOk`
+    // would only allow it as a last resort.
+    var fp = context.getFp();
+    if (StackIterator.fp_usability == .ideal or
+        (StackIterator.fp_usability != .useless and !builtin.omit_frame_pointer))
+    {
+        while (index < addr_buf.len) : (index += 1) {
+            const frame = StackIterator.unwindFp(fp, stack) orelse break;
+            fp = frame.bp;
+            addr_buf[index] = frame.ra;
+        }
+    }
+    return .{
+        .index = index,
+        .instruction_addresses = addr_buf[0..index],
+    };
+}
 /// Write the current stack trace to `writer`, annotated with source locations.
 ///
 /// See `captureCurrentStackTrace` to capture the trace addresses into a buffer instead of printing.
@@ -989,38 +1028,49 @@ const StackIterator = union(enum) {
                 return .{ .frame = ret_addr };
             },
             .fp => |fp| {
-                if (fp == 0) return .end; // we reached the "sentinel" base pointer
+                const frame = unwindFp(fp, null) orelse return .end;
+                it.fp = frame.bp;
+                return .{ .frame = frame.ra };
+            },
+        }
+    }
 
-                const bp_addr = applyOffset(fp, fp_to_bp_offset) orelse return .end;
-                const ra_addr = applyOffset(fp, fp_to_ra_offset) orelse return .end;
+    /// Reads the saved base pointer and return address of the frame at `fp`, or returns `null` if
+    /// the end of the stack was reached. If `stack` is not `null`, the frame must lie within it.
+    fn unwindFp(fp: usize, stack: ?StackBounds) ?struct { bp: usize, ra: usize } {
+        if (fp == 0) return null; // we reached the "sentinel" base pointer
 
-                if (bp_addr == 0 or !mem.isAligned(bp_addr, @alignOf(usize)) or
-                    ra_addr == 0 or !mem.isAligned(ra_addr, @alignOf(usize)))
-                {
-                    // This isn't valid, but it most likely indicates end of stack.
-                    return .end;
-                }
+        const bp_addr = applyOffset(fp, fp_to_bp_offset) orelse return null;
+        const ra_addr = applyOffset(fp, fp_to_ra_offset) orelse return null;
 
-                const bp_ptr: *const usize = @ptrFromInt(bp_addr);
-                const ra_ptr: *const usize = @ptrFromInt(ra_addr);
-                const bp = applyOffset(bp_ptr.*, stack_bias) orelse return .end;
-
-                // If the stack grows downwards, `bp > fp` should always hold; conversely, if it
-                // grows upwards, `bp < fp` should always hold. If that is not the case, this
-                // frame is invalid, so we'll treat it as though we reached end of stack. The
-                // exception is address 0, which is a graceful end-of-stack signal, in which case
-                // *this* return address is valid and the *next* iteration will be the last.
-                if (bp != 0 and switch (comptime builtin.target.stackGrowth()) {
-                    .down => bp <= fp,
-                    .up => bp >= fp,
-                }) return .end;
-
-                it.fp = bp;
-                const ra = stripInstructionPtrAuthCode(ra_ptr.*);
-                if (ra <= 1) return .end;
-                return .{ .frame = ra };
-            },
+        if (bp_addr == 0 or !mem.isAligned(bp_addr, @alignOf(usize)) or
+            ra_addr == 0 or !mem.isAligned(ra_addr, @alignOf(usize)))
+        {
+            // This isn't valid, but it most likely indicates end of stack.
+            return null;
         }
+        if (stack) |bounds| {
+            const last = bounds.high -| @sizeOf(usize);
+            if (bp_addr < bounds.low or bp_addr > last or ra_addr < bounds.low or ra_addr > last) return null;
+        }
+
+        const bp_ptr: *const usize = @ptrFromInt(bp_addr);
+        const ra_ptr: *const usize = @ptrFromInt(ra_addr);
+        const bp = applyOffset(bp_ptr.*, stack_bias) orelse return null;
+
+        // If the stack grows downwards, `bp > fp` should always hold; conversely, if it
+        // grows upwards, `bp < fp` should always hold. If that is not the case, this
+        // frame is invalid, so we'll treat it as though we reached end of stack. The
+        // exception is address 0, which is a graceful end-of-stack signal, in which case
+        // *this* return address is valid and the *next* iteration will be the last.
+        if (bp != 0 and switch (comptime builtin.target.stackGrowth()) {
+            .down => bp <= fp,
+            .up => bp >= fp,
+        }) return null;
+
+        const ra = stripInstructionPtrAuthCode(ra_ptr.*);
+        if (ra <= 1) return null;
+        return .{ .bp = bp, .ra = ra };
     }
 
     /// Offset of the saved base pointer (previous frame pointer) wrt the frame pointer.
@@ -1772,6 +1822,7 @@ pub inline fn inValgrind() bool {
 test {
     _ = &Dwarf;
     _ = &Pdb;
+    _ = &Profiler;
     _ = &SelfInfo;
     _ = &dumpHex;
 }
@@ -42,14 +42,37 @@ compile_unit_list: ArrayList(CompileUnit) = .empty,
 /// Filled later by the initializer
 func_list: ArrayList(Func) = .empty,
 
-/// Populated by `populateRanges`.
+/// Populated by `populateRanges`, which `open` calls.
 ranges: ArrayList(Range) = .empty,
+/// Populated by `open`. Sorted by `FuncRange.start`; used by `getSymbolName`.
+func_ranges: ArrayList(FuncRange) = .empty,
 
 pub const Range = struct {
     start: u64,
     end: u64,
+    /// The greatest `end` of this and every preceding range. Compile unit ranges may overlap, so
+    /// lookups scan backwards in the same way as for `FuncRange`.
+    max_end: u64,
     /// Index into `compile_unit_list`.
     compile_unit_index: usize,
+
+    fn orderStart(address: u64, range: Range) std.math.Order {
+        return std.math.order(address, range.start);
+    }
+};
+
+pub const FuncRange = struct {
+    start: u64,
+    end: u64,
+    /// The greatest `end` of this and every preceding range. Lookups scan backwards from the last
+    /// range starting at or before the address, and stop once no earlier range can contain it.
+    max_end: u64,
+    /// Index into `func_list`.
+    func_index: usize,
+
+    fn orderStart(address: u64, range: FuncRange) std.math.Order {
+        return std.math.order(address, range.start);
+    }
 };
 
 pub const Section = struct {
@@ -308,6 +331,8 @@ pub const OpenError = ScanError;
 pub fn open(d: *Dwarf, gpa: Allocator, endian: Endian) OpenError!void {
     try d.scanAllFunctions(gpa, endian);
     try d.scanAllCompileUnits(gpa, endian);
+    try d.populateRanges(gpa, endian);
+    try d.populateFuncRanges(gpa);
 }
 
 const PcRange = struct {
@@ -343,13 +368,27 @@ pub fn deinit(di: *Dwarf, gpa: Allocator) void {
     di.compile_unit_list.deinit(gpa);
     di.func_list.deinit(gpa);
     di.ranges.deinit(gpa);
+    di.func_ranges.deinit(gpa);
     di.* = undefined;
 }
 
 pub fn getSymbolName(di: *const Dwarf, address: u64) ?[]const u8 {
-    // Iterate the function list backwards so that we see child DIEs before their parents. This is
-    // important because `DW_TAG_inlined_subroutine` DIEs will have a range which is a sub-range of
-    // their caller, and we want to return the callee's name, not the caller's.
+    // `DW_TAG_inlined_subroutine` DIEs will have a range which is a sub-range of their caller, and
+    // we want to return the callee's name, not the caller's. Child DIEs come after their parents in
+    // `func_list`, so the containing function with the greatest index is the innermost one.
+    if (di.func_ranges.items.len != 0) {
+        var best: ?usize = null;
+        var i = std.sort.upperBound(FuncRange, di.func_ranges.items, address, FuncRange.orderStart);
+        while (i > 0) {
+            i -= 1;
+            const range = &di.func_ranges.items[i];
+            if (range.max_end <= address) break;
+            if (address < range.end and (best == null or range.func_index > best.?)) best = range.func_index;
+        }
+        return di.func_list.items[best orelse return null].name;
+    }
+
+    // Iterate the function list backwards so that we see child DIEs before their parents.
     var i: usize = di.func_list.items.len;
     while (i > 0) {
         i -= 1;
@@ -656,27 +695,35 @@ fn scanAllCompileUnits(di: *Dwarf, gpa: Allocator, endian: Endian) ScanError!voi
     }
 }
 
+/// Compile units whose `DW_AT_ranges` cannot be decoded are left out of the index, so that one
+/// malformed unit does not prevent symbolizing addresses in the others.
 pub fn populateRanges(d: *Dwarf, gpa: Allocator, endian: Endian) ScanError!void {
     assert(d.ranges.items.len == 0);
 
-    for (d.compile_unit_list.items, 0..) |*cu, cu_index| {
+    next_cu: for (d.compile_unit_list.items, 0..) |*cu, cu_index| {
         if (cu.pc_range) |range| {
             try d.ranges.append(gpa, .{
                 .start = range.start,
                 .end = range.end,
+                .max_end = undefined,
                 .compile_unit_index = cu_index,
             });
             continue;
         }
         const ranges_value = cu.die.getAttr(AT.ranges) orelse continue;
         var iter = DebugRangeIterator.init(ranges_value, d, endian, cu) catch continue;
-        while (try iter.next()) |range| {
+        const cu_ranges_start = d.ranges.items.len;
+        while (iter.next() catch {
+            d.ranges.shrinkRetainingCapacity(cu_ranges_start);
+            continue :next_cu;
+        }) |range| {
             // Not sure why LLVM thinks it's OK to emit these...
             if (range.start == range.end) continue;
 
             try d.ranges.append(gpa, .{
                 .start = range.start,
                 .end = range.end,
+                .max_end = undefined,
                 .compile_unit_index = cu_index,
             });
         }
@@ -688,6 +735,41 @@ pub fn populateRanges(d: *Dwarf, gpa: Allocator, endian: Endian) ScanError!void
             return a.start < b.start;
         }
     }.lessThan);
+
+    var max_end: u64 = 0;
+    for (d.ranges.items) |*range| {
+        max_end = @max(max_end, range.end);
+        range.max_end = max_end;
+    }
+}
+
+/// Builds the address index used by `getSymbolName` from `func_list`.
+fn populateFuncRanges(d: *Dwarf, gpa: Allocator) Allocator.Error!void {
+    assert(d.func_ranges.items.len == 0);
+
+    for (d.func_list.items, 0..) |func, func_index| {
+        const range = func.pc_range orelse continue;
+        if (range.start >= range.end) continue;
+        try d.func_ranges.append(gpa, .{
+            .start = range.start,
+            .end = range.end,
+            .max_end = undefined,
+            .func_index = func_index,
+        });
+    }
+
+    std.mem.sortUnstable(FuncRange, d.func_ranges.items, {}, struct {
+        pub fn lessThan(ctx: void, a: FuncRange, b: FuncRange) bool {
+            _ = ctx;
+            return a.start < b.start;
+        }
+    }.lessThan);
+
+    var max_end: u64 = 0;
+    for (d.func_ranges.items) |*range| {
+        max_end = @max(max_end, range.end);
+        range.max_end = max_end;
+    }
 }
 
 const DebugRangeIterator = struct {
@@ -841,8 +923,12 @@ const DebugRangeIterator = struct {
     }
 };
 
-/// TODO: change this to binary searching the sorted compile unit list
 pub fn findCompileUnit(di: *const Dwarf, endian: Endian, target_address: u64) !*CompileUnit {
+    if (di.ranges.items.len != 0) {
+        const range = findRange(di.ranges.items, target_address) orelse return missing();
+        return &di.compile_unit_list.items[range.compile_unit_index];
+    }
+
     for (di.compile_unit_list.items) |*compile_unit| {
         if (compile_unit.pc_range) |range| {
             if (target_address >= range.start and target_address < range.end) return compile_unit;
@@ -858,6 +944,47 @@ pub fn findCompileUnit(di: *const Dwarf, endian: Endian, target_address: u64) !*
     return missing();
 }
 
+/// Returns the range in `ranges`, which is sorted by `Range.start`, containing `address`. When
+/// several do, the one of the earliest compile unit wins, matching the linear scan.
+fn findRange(ranges: []const Range, address: u64) ?*const Range {
+    var found: ?*const Range = null;
+    var i = std.sort.upperBound(Range, ranges, address, Range.orderStart);
+    while (i > 0) {
+        i -= 1;
+        const range = &ranges[i];
+        if (range.max_end <= address) break;
+        if (address >= range.end) continue;
+        if (found == null or range.compile_unit_index < found.?.compile_unit_index) found = range;
+    }
+    return found;
+}
+
+test findRange {
+    // The second unit is nested inside the first, and the third overlaps the end of the second.
+    var ranges = [_]Range{
+        .{ .start = 0x1000, .end = 0x5000, .max_end = undefined, .compile_unit_index = 0 },
+        .{ .start = 0x2000, .end = 0x3000, .max_end = undefined, .compile_unit_index = 1 },
+        .{ .start = 0x2800, .end = 0x3800, .max_end = undefined, .compile_unit_index = 2 },
+        .{ .start = 0x6000, .end = 0x7000, .max_end = undefined, .compile_unit_index = 3 },
+    };
+    var max_end: u64 = 0;
+    for (&ranges) |*range| {
+        max_end = @max(max_end, range.end);
+        range.max_end = max_end;
+    }
+
+    try std.testing.expectEqual(null, findRange(&ranges, 0x0fff));
+    try std.testing.expectEqual(0, findRange(&ranges, 0x1000).?.compile_unit_index);
+    try std.testing.expectEqual(0, findRange(&ranges, 0x1fff).?.compile_unit_index);
+    try std.testing.expectEqual(0, findRange(&ranges, 0x2000).?.compile_unit_index);
+    try std.testing.expectEqual(0, findRange(&ranges, 0x2900).?.compile_unit_index);
+    // Past the end of the last range starting before it, but still inside the first unit.
+    try std.testing.expectEqual(0, findRange(&ranges, 0x4000).?.compile_unit_index);
+    try std.testing.expectEqual(null, findRange(&ranges, 0x5000));
+    try std.testing.expectEqual(3, findRange(&ranges, 0x6fff).?.compile_unit_index);
+    try std.testing.expectEqual(null, findRange(&ranges, 0x7000));
+}
+
 /// Gets an already existing AbbrevTable given the abbrev_offset, or if not found,
 /// seeks in the stream and parses it.
 fn getAbbrevTable(di: *Dwarf, gpa: Allocator, abbrev_offset: u64) !*const Abbrev.Table {
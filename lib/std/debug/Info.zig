@@ -38,7 +38,6 @@ pub fn load(gpa: Allocator, path: Path, coverage: *Coverage, format: std.Target.
 
             if (elf_file.dwarf == null) return error.MissingDebugInfo;
             try elf_file.dwarf.?.open(gpa, elf_file.endian);
-            try elf_file.dwarf.?.populateRanges(gpa, elf_file.endian);
 
             return .{
                 .impl = .{ .elf = elf_file },
@@ -0,0 +1,340 @@
+//! A sampling CPU profiler for the current process.
+//!
+//! While the profiler is running, the kernel delivers `SIGPROF` to the process each time it has
+//! consumed another `1 / Options.frequency` seconds of CPU time, to whichever thread is running at
+//! the time. The signal handler unwinds the interrupted thread with frame pointers (see
+//! `std.debug.captureSignalStackTrace`), never reading outside of that thread's stack mapping, and
+//! counts the stack in a fixed-size hash table. The handler never allocates or takes locks;
+//! concurrent samples from different threads claim table slots with atomic compare-and-swap. Stacks
+//! are only symbolized when the profile is written, so the process being profiled pays just the
+//! cost of walking its frame pointers.
+//!
+//! Only one `Profiler` may be running at a time, since the signal handler is process-wide.
+
+const std = @import("../std.zig");
+const builtin = @import("builtin");
+const native_arch = builtin.cpu.arch;
+const native_os = builtin.os.tag;
+const Allocator = std.mem.Allocator;
+const Writer = std.Io.Writer;
+const assert = std.debug.assert;
+const linux = std.os.linux;
+const posix = std.posix;
+
+const Profiler = @This();
+
+/// The table of distinct stacks, indexed by hash with linear probing.
+stacks: []Stack,
+/// The number of samples which did not fit in `stacks`.
+dropped: std.atomic.Value(usize),
+
+/// Frames beyond this depth are discarded, keeping the innermost ones.
+pub const max_depth = 64;
+
+/// Whether the profiler is supported on the target.
+pub const supported = native_os == .linux and std.debug.cpu_context.Native != noreturn;
+
+pub const Stack = struct {
+    /// Hash of `addresses[0..len]`, or 0 if this slot is unused. Stacks with equal hashes are
+    /// considered equal, which avoids having to compare addresses in the signal handler while
+    /// another thread may still be writing them.
+    hash: std.atomic.Value(usize),
+    count: std.atomic.Value(usize),
+    len: usize,
+    /// Return addresses, innermost first.
+    addresses: [max_depth]usize,
+
+    const empty: Stack = .{
+        .hash = .init(0),
+        .count = .init(0),
+        .len = 0,
+        .addresses = undefined,
+    };
+};
+
+pub const Options = struct {
+    /// Samples per second of CPU time consumed by the process.
+    frequency: u32 = 99,
+};
+
+/// The profiler currently receiving samples, if any.
+var active: std.atomic.Value(?*Profiler) = .init(null);
+/// The number of signal handlers currently recording a sample. `stop` waits for this to reach zero,
+/// after which no handler accesses the profiler.
+var handlers_running: std.atomic.Value(usize) = .init(0);
+/// The `SIGPROF` disposition before `start`, which `stop` restores.
+var prev_action: posix.Sigaction = undefined;
+/// The mapping containing this thread's stack, as last found by `findMapping`.
+threadlocal var stack_mapping: std.debug.StackBounds = .{ .low = 0, .high = 0 };
+
+/// `capacity` is the maximum number of distinct stacks recorded.
+pub fn init(gpa: Allocator, capacity: usize) Allocator.Error!Profiler {
+    const stacks = try gpa.alloc(Stack, capacity);
+    @memset(stacks, .empty);
+    return .{
+        .stacks = stacks,
+        .dropped = .init(0),
+    };
+}
+
+pub fn deinit(p: *Profiler, gpa: Allocator) void {
+    assert(active.load(.monotonic) != p);
+    gpa.free(p.stacks);
+    p.* = undefined;
+}
+
+pub const StartError = error{
+    /// Another profiler is already running.
+    AlreadyRunning,
+    Unexpected,
+};
+
+/// Installs the `SIGPROF` handler and starts the profiling timer. Samples accumulate across
+/// multiple `start`/`stop` pairs until `reset` is called.
+pub fn start(p: *Profiler, options: Options) StartError!void {
+    if (!supported) @compileError("Profiler is not supported on this target");
+    assert(options.frequency != 0);
+    if (active.cmpxchgStrong(null, p, .acq_rel, .monotonic) != null) return error.AlreadyRunning;
+    errdefer active.store(null, .release);
+
+    const act: posix.Sigaction = .{
+        .handler = .{ .sigaction = handleSigprof },
+        .mask = posix.sigemptyset(),
+        .flags = posix.SA.SIGINFO | posix.SA.RESTART,
+    };
+    posix.sigaction(.PROF, &act, &prev_action);
+    errdefer posix.sigaction(.PROF, &prev_action, null);
+
+    const interval_us = @max(1, std.time.us_per_s / options.frequency);
+    try setTimer(.{
+        .sec = @intCast(interval_us / std.time.us_per_s),
+        .usec = @intCast(interval_us % std.time.us_per_s),
+    });
+}
+
+/// Stops the profiling timer, waits for any in-flight samples to be recorded, and restores the
+/// previous `SIGPROF` disposition. Afterwards, the profile may be written with `writeFolded`.
+pub fn stop(p: *Profiler) void {
+    assert(active.load(.monotonic) == p);
+    setTimer(.{ .sec = 0, .usec = 0 }) catch {};
+    // This store and the load of `handlers_running` pair with the increment and the load of
+    // `active` in `handleSigprof`. Both sides store and then load the other's variable, so they
+    // must be sequentially consistent for at least one side to observe the other.
+    active.store(null, .seq_cst);
+    while (handlers_running.load(.seq_cst) != 0) std.atomic.spinLoopHint();
+    // The handler stays installed until now so that a signal which was already pending is not
+    // delivered to the previous disposition, whose default action terminates the process.
+    posix.sigaction(.PROF, &prev_action, null);
+}
+
+/// Discards all recorded samples. The profiler must not be running.
+pub fn reset(p: *Profiler) void {
+    assert(active.load(.monotonic) != p);
+    @memset(p.stacks, .empty);
+    p.dropped.store(0, .monotonic);
+}
+
+/// Returns the total number of samples recorded, not counting dropped samples.
+pub fn sampleCount(p: *const Profiler) usize {
+    var total: usize = 0;
+    for (p.stacks) |*stack| total += stack.count.load(.monotonic);
+    return total;
+}
+
+/// Writes the profile in the "folded stacks" format understood by flame graph tools: one line per
+/// distinct stack, with the frames' function names from outermost to innermost separated by `;`,
+/// followed by a space and the number of samples. Frames without debug info are written as their
+/// address in hexadecimal. Samples are aggregated by address, so the same functions may appear on
+/// several lines; consumers of this format sum such lines. The profiler must not be running.
+pub fn writeFolded(p: *const Profiler, writer: *Writer) Writer.Error!void {
+    assert(active.load(.monotonic) != p);
+    var threaded: std.Io.Threaded = .init_single_threaded;
+    const io = threaded.ioBasic();
+    const di_gpa = std.debug.getDebugInfoAllocator();
+    const di: ?*std.debug.SelfInfo = std.debug.getSelfDebugInfo() catch null;
+
+    for (p.stacks) |*stack| {
+        const count = stack.count.load(.monotonic);
+        if (count == 0) continue;
+        var i = stack.len;
+        while (i > 0) {
+            i -= 1;
+            // Return addresses point *after* the call. Subtract `ra_call_offset` to get an address
+            // *in* the call for a better symbol.
+            const address = stack.addresses[i] -| ra_call_offset;
+            const symbol: std.debug.Symbol = if (di) |d|
+                d.getSymbol(di_gpa, io, address) catch .unknown
+            else
+                .unknown;
+            defer if (symbol.source_location) |sl| di_gpa.free(sl.file_name);
+            if (symbol.name) |name| {
+                try writer.writeAll(name);
+            } else {
+                try writer.print("0x{x}", .{address});
+            }
+            if (i != 0) try writer.writeByte(';');
+        }
+        try writer.print(" {d}\n", .{count});
+    }
+}
+
+/// Matches `StackIterator.ra_call_offset` in `std.debug`.
+const ra_call_offset: usize = if (native_arch.isSPARC()) 0 else 1;
+
+fn setTimer(interval: linux.itimerval.Timeval) error{Unexpected}!void {
+    const value: linux.itimerval = .{ .interval = interval, .value = interval };
+    switch (linux.errno(linux.setitimer(@intFromEnum(linux.ITIMER.PROF), &value, null))) {
+        .SUCCESS => {},
+        else => |err| return posix.unexpectedErrno(err),
+    }
+}
+
+fn handleSigprof(sig: posix.SIG, info: *const posix.siginfo_t, ctx_ptr: ?*anyopaque) callconv(.c) void {
+    _ = sig;
+    _ = info;
+    _ = handlers_running.fetchAdd(1, .seq_cst);
+    defer _ = handlers_running.fetchSub(1, .release);
+    const p = active.load(.seq_cst) orelse return;
+    const context = std.debug.cpu_context.fromPosixSignalContext(ctx_ptr) orelse return;
+    var addr_buf: [max_depth]usize = undefined;
+    const trace = std.debug.captureSignalStackTrace(&context, interruptedStack(), &addr_buf);
+    if (trace.index == 0) return;
+    p.record(trace.instruction_addresses);
+}
+
+/// Returns the part of the current thread's stack which holds the interrupted frames. The handler is
+/// installed without `SA.ONSTACK`, so it runs on the interrupted thread's stack, and every frame of
+/// the interrupted code lies between the handler's own frame and the end of the stack mapping.
+fn interruptedStack() std.debug.StackBounds {
+    const frame = @frameAddress();
+    if (frame < stack_mapping.low or frame >= stack_mapping.high) {
+        // First sample on this thread, or the main thread's stack has grown since.
+        stack_mapping = findMapping(frame) orelse return .{ .low = 0, .high = 0 };
+    }
+    return switch (comptime builtin.target.stackGrowth()) {
+        .down => .{ .low = frame, .high = stack_mapping.high },
+        .up => .{ .low = stack_mapping.low, .high = frame },
+    };
+}
+
+/// Returns the bounds of the memory mapping containing `address`, as listed in `/proc/self/maps`.
+/// Only uses system calls which are async-signal-safe.
+fn findMapping(address: usize) ?std.debug.StackBounds {
+    const fd = while (true) {
+        const rc = linux.open("/proc/self/maps", .{ .CLOEXEC = true }, 0);
+        switch (linux.errno(rc)) {
+            .SUCCESS => break @as(i32, @intCast(rc)),
+            .INTR => continue,
+            else => return null,
+        }
+    };
+    defer _ = linux.close(fd);
+
+    // Each line starts with `low-high `, which is all we need; the rest of the line is skipped.
+    var field: enum { low, high, rest } = .low;
+    var low: usize = 0;
+    var high: usize = 0;
+    var buf: [4096]u8 = undefined;
+    while (true) {
+        const rc = linux.read(fd, &buf, buf.len);
+        const n = switch (linux.errno(rc)) {
+            .SUCCESS => rc,
+            .INTR => continue,
+            else => return null,
+        };
+        if (n == 0) return null;
+        for (buf[0..n]) |c| switch (field) {
+            .low => if (c == '-') {
+                field = .high;
+            } else {
+                low = low << 4 | (std.fmt.charToDigit(c, 16) catch return null);
+            },
+            .high => if (c == ' ') {
+                if (address >= low and address < high) return .{ .low = low, .high = high };
+                field = .rest;
+            } else {
+                high = high << 4 | (std.fmt.charToDigit(c, 16) catch return null);
+            },
+            .rest => if (c == '\n') {
+                field = .low;
+                low = 0;
+                high = 0;
+            },
+        };
+    }
+}
+
+fn record(p: *Profiler, addresses: []const usize) void {
+    const hash = h: {
+        // Word-sized so that 32-bit targets can compare-and-swap it.
+        const h: usize = @truncate(std.hash.Wyhash.hash(0, @ptrCast(addresses)));
+        break :h if (h == 0) 1 else h;
+    };
+    var i: usize = @intCast(hash % p.stacks.len);
+    for (0..p.stacks.len) |_| {
+        const stack = &p.stacks[i];
+        const prev = stack.hash.cmpxchgStrong(0, hash, .acq_rel, .acquire) orelse {
+            // We claimed this slot.
+            stack.len = addresses.len;
+            @memcpy(stack.addresses[0..addresses.len], addresses);
+            _ = stack.count.fetchAdd(1, .release);
+            return;
+        };
+        if (prev == hash) {
+            _ = stack.count.fetchAdd(1, .monotonic);
+            return;
+        }
+        i = if (i + 1 == p.stacks.len) 0 else i + 1;
+    }
+    _ = p.dropped.fetchAdd(1, .monotonic);
+}
+
+test Profiler {
+    if (!supported) return error.SkipZigTest;
+    const gpa = std.testing.allocator;
+
+    var p: Profiler = try .init(gpa, 256);
+    defer p.deinit(gpa);
+
+    var before: posix.Sigaction = undefined;
+    posix.sigaction(.PROF, null, &before);
+
+    try p.start(.{ .frequency = 1000 });
+    var other: Profiler = try .init(gpa, 1);
+    defer other.deinit(gpa);
+    try std.testing.expectError(error.AlreadyRunning, other.start(.{}));
+
+    // Burn enough CPU time to be sampled a few times.
+    var timer = try std.time.Timer.start();
+    var x: u64 = 0;
+    while (timer.read() < 100 * std.time.ns_per_ms and p.sampleCount() < 5) {
+        for (0..10_000) |i| {
+            x +%= i *% 31;
+            std.mem.doNotOptimizeAway(x);
+        }
+    }
+    p.stop();
+
+    var after: posix.Sigaction = undefined;
+    posix.sigaction(.PROF, null, &after);
+    try std.testing.expectEqual(before.handler.handler, after.handler.handler);
+
+    if (p.sampleCount() == 0) return error.SkipZigTest; // e.g. a heavily loaded machine
+
+    var aw: Writer.Allocating = .init(gpa);
+    defer aw.deinit();
+    try p.writeFolded(&aw.writer);
+    try std.testing.expect(std.mem.endsWith(u8, aw.written(), "\n"));
+
+    p.reset();
+    try std.testing.expectEqual(0, p.sampleCount());
+}
+
+test findMapping {
+    if (!supported) return error.SkipZigTest;
+    var local: usize = 0;
+    std.mem.doNotOptimizeAway(&local);
+    const stack = findMapping(@intFromPtr(&local)).?;
+    try std.testing.expect(stack.low <= @intFromPtr(&local) and @intFromPtr(&local) < stack.high);
+    try std.testing.expect(findMapping(0) == null);
+}
@@ -1931,6 +1931,9 @@ pub const CopyFileError = File.OpenError || File.StatError ||
 /// same contents as `source_path` within `source_dir`, overwriting any already
 /// existing file.
 ///
+/// On Linux, if both files are on a filesystem with reflink support, the new
+/// file shares the data of the source file instead of copying it.
+///
 /// On Linux, until https://patchwork.kernel.org/patch/9636735/ is merged and
 /// readily available, there is a possibility of power loss or application
 /// termination leaving temporary files present in the same directory as
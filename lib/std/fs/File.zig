@@ -688,6 +688,7 @@ pub const Writer = struct {
     sendfile_err: ?SendfileError = null,
     copy_file_range_err: ?CopyFileRangeError = null,
     fcopyfile_err: ?FcopyfileError = null,
+    ficlone_err: ?FicloneError = null,
     seek_err: ?Writer.SeekError = null,
     interface: Io.Writer,
 
@@ -710,6 +711,8 @@ pub const Writer = struct {
         Unexpected,
     };
 
+    pub const FicloneError = std.os.linux.wrapped.FicloneError;
+
     pub const SeekError = File.SeekError;
 
     /// Number of slices to store on the stack, when trying to send as many byte
@@ -1051,6 +1054,30 @@ pub const Writer = struct {
             return consumed;
         }
 
+        if (native_os == .linux) fc: {
+            // When the whole of the file is sent to the start of an empty
+            // file, try to make the destination share the data of the
+            // source. On filesystems with reflink support this turns copying
+            // a file of any size into a metadata operation.
+            if (w.ficlone_err != null) break :fc;
+            if (file_reader.pos != 0 or file_reader.mode != .positional) break :fc;
+            if (w.pos != 0 or w.mode != .positional) break :fc;
+            if (limit != .unlimited) break :fc;
+            if (writer_buffered.len != 0 or reader_buffered.len != 0) break :fc;
+            const size = file_reader.getSize() catch break :fc;
+            if (size == 0) break :fc;
+            const n = std.math.cast(usize, size) orelse break :fc;
+            const dest_size = w.file.getEndPos() catch break :fc;
+            if (dest_size != 0) break :fc;
+            std.os.linux.wrapped.ficlone(out_fd, in_fd) catch |err| {
+                w.ficlone_err = err;
+                break :fc;
+            };
+            file_reader.pos = size;
+            w.pos = size;
+            return n;
+        }
+
         if (native_os == .linux and w.mode == .streaming) sf: {
             // Try using sendfile on Linux.
             if (w.sendfile_err != null) break :sf;
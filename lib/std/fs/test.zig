@@ -1580,6 +1580,36 @@ test "copyFile" {
     }.impl);
 }
 
+test "copyFile round trip of a multi-block file" {
+    var tmp = tmpDir(.{});
+    defer tmp.cleanup();
+
+    // Larger than the copy buffers, so that every fallback from cloning the file takes several
+    // reads and writes.
+    const data = try testing.allocator.alloc(u8, 300 * 1024 + 17);
+    defer testing.allocator.free(data);
+    var prng: std.Random.DefaultPrng = .init(0x2a);
+    prng.random().bytes(data);
+
+    try tmp.dir.writeFile(.{ .sub_path = "src", .data = data });
+    try tmp.dir.copyFile("src", tmp.dir, "copy", .{});
+    try tmp.dir.copyFile("copy", tmp.dir, "copy2", .{});
+
+    const contents = try tmp.dir.readFileAlloc("copy2", testing.allocator, .limited(data.len + 1));
+    defer testing.allocator.free(contents);
+    try testing.expectEqualSlices(u8, data, contents);
+
+    // Modifying a copy must not affect the source, whether or not they share storage.
+    {
+        var file = try tmp.dir.openFile("copy", .{ .mode = .write_only });
+        defer file.close();
+        try file.pwriteAll("changed", 1000);
+    }
+    const src_contents = try tmp.dir.readFileAlloc("src", testing.allocator, .limited(data.len + 1));
+    defer testing.allocator.free(src_contents);
+    try testing.expectEqualSlices(u8, data, src_contents);
+}
+
 fn expectFileContents(dir: Dir, file_path: []const u8, data: []const u8) !void {
     const contents = try dir.readFileAlloc(file_path, testing.allocator, .limited(1000));
     defer testing.allocator.free(contents);
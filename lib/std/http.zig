@@ -6,6 +6,7 @@ const File = std.fs.File;
 
 pub const Client = @import("http/Client.zig");
 pub const Server = @import("http/Server.zig");
+pub const Engine = @import("http/Engine.zig");
 pub const HeadParser = @import("http/HeadParser.zig");
 pub const ChunkParser = @import("http/ChunkParser.zig");
 pub const HeaderIterator = @import("http/HeaderIterator.zig");
@@ -1042,6 +1043,7 @@ test {
 
     if (builtin.os.tag != .wasi) {
         _ = Client;
+        _ = Engine;
         _ = @import("http/test.zig");
     }
 }
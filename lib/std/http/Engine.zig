@@ -0,0 +1,233 @@
+//! Serves HTTP/1.1 connections on one or more listening sockets.
+//!
+//! Every accepted connection runs as a task of an `Io.Group`, so the degree of
+//! parallelism is decided by the `Io` implementation. With `Io.Threaded`, once
+//! every worker thread is busy, new connections are served by the thread that
+//! accepted them, which stops that listener from accepting until the
+//! connection closes. Pending connections then queue in the kernel backlog,
+//! providing backpressure instead of unbounded memory growth.
+//!
+//! Each connection handles any number of requests (keep-alive). Requests that
+//! a client sends without waiting for the previous response (pipelining) are
+//! parsed from the bytes already buffered, and responses written with
+//! `Server.Request.respondUnflushed` are flushed together once no more
+//! requests are buffered.
+
+const std = @import("../std.zig");
+const http = std.http;
+const Io = std.Io;
+const net = std.Io.net;
+const Allocator = std.mem.Allocator;
+const assert = std.debug.assert;
+
+const Engine = @This();
+
+io: Io,
+gpa: Allocator,
+handler: Handler,
+options: Options,
+/// All listen on the same address. On POSIX, the kernel distributes incoming
+/// connections among them (`SO_REUSEPORT`).
+listeners: []net.Server,
+connections: Io.Group,
+/// Memory for connection buffers, each `options.recv_buffer_len +
+/// options.send_buffer_len` bytes, ready to be reused by new connections.
+/// Capacity is `options.max_pooled_buffers`.
+free_buffers: std.ArrayList([]u8),
+free_buffers_mutex: Io.Mutex,
+
+pub const Handler = struct {
+    context: ?*anyopaque,
+    /// Called once for each request received. The request must be responded
+    /// to before returning, or the connection is closed. Returning an error
+    /// also closes the connection.
+    handle: *const fn (context: ?*anyopaque, request: *http.Server.Request) HandleError!void,
+};
+
+pub const HandleError = http.Server.Request.RespondFileError || error{
+    /// The handler could not respond to the request for a reason of its own.
+    HandlerFailed,
+};
+
+pub const Options = struct {
+    /// How many sockets listen on the address, each with its own accept loop.
+    listen_count: u32 = 1,
+    /// Limits the size of a request head. See `http.Server.init`.
+    recv_buffer_len: usize = 8192,
+    send_buffer_len: usize = 8192,
+    /// Buffers of closed connections are kept for reuse, up to this many.
+    max_pooled_buffers: usize = 64,
+    kernel_backlog: u31 = net.default_kernel_backlog,
+};
+
+pub const InitError = net.IpAddress.ListenError || Allocator.Error;
+
+/// Listens on `address`. If its port is zero, all listeners share the port
+/// chosen for the first one; see `port`.
+pub fn init(
+    io: Io,
+    gpa: Allocator,
+    address: net.IpAddress,
+    handler: Handler,
+    options: Options,
+) InitError!Engine {
+    assert(options.listen_count > 0);
+    assert(options.recv_buffer_len > 0);
+    assert(options.send_buffer_len > 0);
+
+    const listeners = try gpa.alloc(net.Server, options.listen_count);
+    errdefer gpa.free(listeners);
+    var free_buffers: std.ArrayList([]u8) = try .initCapacity(gpa, options.max_pooled_buffers);
+    errdefer free_buffers.deinit(gpa);
+
+    const listen_options: net.IpAddress.ListenOptions = .{
+        .kernel_backlog = options.kernel_backlog,
+        .reuse_address = true,
+    };
+    var n: usize = 0;
+    errdefer for (listeners[0..n]) |*listener| listener.deinit(io);
+    while (n < listeners.len) : (n += 1) {
+        const bind_address = if (n == 0) address else listeners[0].socket.address;
+        listeners[n] = try bind_address.listen(io, listen_options);
+    }
+
+    return .{
+        .io = io,
+        .gpa = gpa,
+        .handler = handler,
+        .options = options,
+        .listeners = listeners,
+        .connections = .init,
+        .free_buffers = free_buffers,
+        .free_buffers_mutex = .init,
+    };
+}
+
+/// Asserts `serve` is not running.
+pub fn deinit(e: *Engine) void {
+    const io = e.io;
+    const gpa = e.gpa;
+    for (e.listeners) |*listener| listener.deinit(io);
+    gpa.free(e.listeners);
+    for (e.free_buffers.items) |buffer| gpa.free(buffer);
+    e.free_buffers.deinit(gpa);
+    e.* = undefined;
+}
+
+/// The port all listeners are bound to.
+pub fn port(e: *const Engine) u16 {
+    return e.listeners[0].socket.address.getPort();
+}
+
+pub const ServeError = net.Server.AcceptError || Io.ConcurrentError || Allocator.Error;
+
+/// Accepts and serves connections until canceled, or until accepting fails on
+/// any listener, in which case that error is returned. Before returning,
+/// stops the other listeners, cancels all connections and waits for them to
+/// close.
+///
+/// With more than one listener, the `Io` implementation must support
+/// `Io.concurrent`.
+pub fn serve(e: *Engine) ServeError!void {
+    const io = e.io;
+    const gpa = e.gpa;
+    defer e.connections.cancel(io);
+
+    if (e.listeners.len == 1) return e.acceptLoop(&e.listeners[0]);
+
+    // Each accept loop reports the error it ended with, so that the first to
+    // fail ends all of them. There is room for every error, so reporting
+    // never blocks.
+    const failures = try gpa.alloc(AcceptFailure, e.listeners.len);
+    defer gpa.free(failures);
+    var failed: Io.Queue(AcceptFailure) = .init(failures);
+
+    const futures = try gpa.alloc(Io.Future(void), e.listeners.len);
+    defer gpa.free(futures);
+    var n: usize = 0;
+    defer for (futures[0..n]) |*future| future.cancel(io);
+    while (n < futures.len) : (n += 1) {
+        futures[n] = try io.concurrent(acceptLoopReport, .{ e, &e.listeners[n], &failed });
+    }
+
+    return (try failed.getOne(io)).err;
+}
+
+const AcceptFailure = struct { err: net.Server.AcceptError };
+
+fn acceptLoopReport(e: *Engine, listener: *net.Server, failed: *Io.Queue(AcceptFailure)) void {
+    e.acceptLoop(listener) catch |err| failed.putOneUncancelable(e.io, .{ .err = err });
+}
+
+/// Only returns on error.
+fn acceptLoop(e: *Engine, listener: *net.Server) net.Server.AcceptError!void {
+    const io = e.io;
+    while (true) {
+        const stream = listener.accept(io) catch |err| switch (err) {
+            // The client gave up before its connection was accepted.
+            error.ConnectionAborted => continue,
+            else => return err,
+        };
+        e.connections.async(io, serveConnection, .{ e, stream });
+    }
+}
+
+fn serveConnection(e: *Engine, stream: net.Stream) void {
+    const io = e.io;
+    defer {
+        var copy = stream;
+        copy.close(io);
+    }
+    const buffer = e.acquireBuffer() catch return;
+    defer e.releaseBuffer(buffer);
+
+    var connection_reader = stream.reader(io, buffer[0..e.options.recv_buffer_len]);
+    var connection_writer = stream.writer(io, buffer[e.options.recv_buffer_len..]);
+    var server: http.Server = .init(&connection_reader.interface, &connection_writer.interface);
+
+    while (true) {
+        var request = server.receiveHead() catch |err| switch (err) {
+            error.HttpHeadersOversize => {
+                server.out.writeAll("HTTP/1.1 431 Request Header Fields Too Large\r\n" ++
+                    "connection: close\r\ncontent-length: 0\r\n\r\n") catch {};
+                server.out.flush() catch {};
+                return;
+            },
+            else => return,
+        };
+        e.handler.handle(e.handler.context, &request) catch {
+            server.out.flush() catch {};
+            return;
+        };
+        if (server.reader.state != .ready) {
+            // Not responded to, or not to be kept alive.
+            server.out.flush() catch {};
+            return;
+        }
+        // Batch the responses to pipelined requests into fewer writes.
+        if (server.reader.in.bufferedLen() == 0) server.out.flush() catch return;
+    }
+}
+
+fn acquireBuffer(e: *Engine) Allocator.Error![]u8 {
+    const io = e.io;
+    {
+        e.free_buffers_mutex.lockUncancelable(io);
+        defer e.free_buffers_mutex.unlock(io);
+        if (e.free_buffers.pop()) |buffer| return buffer;
+    }
+    return e.gpa.alloc(u8, e.options.recv_buffer_len + e.options.send_buffer_len);
+}
+
+fn releaseBuffer(e: *Engine, buffer: []u8) void {
+    const io = e.io;
+    {
+        e.free_buffers_mutex.lockUncancelable(io);
+        defer e.free_buffers_mutex.unlock(io);
+        if (e.free_buffers.items.len < e.free_buffers.capacity) {
+            e.free_buffers.appendAssumeCapacity(buffer);
+            return;
+        }
+    }
+    e.gpa.free(buffer);
+}
@@ -490,6 +490,39 @@ pub const Request = struct {
         };
     }
 
+    pub const RespondFileError = ExpectContinueError || error{ReadFailed};
+
+    /// Send an entire HTTP response whose body is the remainder of the file
+    /// read by `file_reader`, using the "content-length" header.
+    ///
+    /// When the connection supports it, the body is sent with
+    /// `Writer.sendFile`, so that the operating system copies it directly
+    /// from the file to the connection. Otherwise, it is read into `buffer`
+    /// first, which must be nonempty.
+    ///
+    /// Automatically handles HEAD requests by omitting the body.
+    ///
+    /// Asserts `options.transfer_encoding` is `null`.
+    pub fn respondFile(
+        request: *Request,
+        buffer: []u8,
+        file_reader: *std.fs.File.Reader,
+        options: RespondOptions,
+    ) RespondFileError!void {
+        assert(options.transfer_encoding == null);
+        const size = file_reader.getSize() catch return error.ReadFailed;
+        const content_length = size - file_reader.logicalPos();
+        var body = try request.respondStreaming(buffer, .{
+            .content_length = content_length,
+            .respond_options = options,
+        });
+        // When eliding the body, this only seeks past the contents.
+        const n = try body.writer.sendFileAll(file_reader, .limited64(content_length));
+        // The file was truncated while it was being sent.
+        if (n != content_length) return error.ReadFailed;
+        try body.end();
+    }
+
     pub const UpgradeRequest = union(enum) {
         websocket: ?[]const u8,
         other: []const u8,
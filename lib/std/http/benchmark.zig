@@ -0,0 +1,170 @@
+// zig run -O ReleaseFast --zig-lib-dir ../.. benchmark.zig
+//
+// Measures the throughput of `std.http.Engine` serving a small fixed response to keep-alive
+// clients on the loopback interface, with and without pipelining, for several listener counts.
+
+const std = @import("std");
+const http = std.http;
+const Io = std.Io;
+const net = std.Io.net;
+const Timer = std.time.Timer;
+
+const response_body = "hello";
+const expected_response = "HTTP/1.1 200 OK\r\ncontent-length: 5\r\n\r\n" ++ response_body;
+const request_bytes = "GET / HTTP/1.1\r\nhost: 127.0.0.1\r\n\r\n";
+
+fn handle(context: ?*anyopaque, request: *http.Server.Request) http.Engine.HandleError!void {
+    _ = context;
+    try request.respondUnflushed(response_body, .{});
+}
+
+const Client = struct {
+    io: Io,
+    port: u16,
+    requests: usize,
+    pipeline: usize,
+    err: ?anyerror = null,
+
+    fn run(c: *Client) void {
+        c.runInner() catch |err| {
+            c.err = err;
+        };
+    }
+
+    fn runInner(c: *Client) !void {
+        const io = c.io;
+        const host_name: net.HostName = try .init("127.0.0.1");
+        var stream = try host_name.connect(io, c.port, .{ .mode = .stream });
+        defer stream.close(io);
+        var write_buffer: [4096]u8 = undefined;
+        var stream_writer = stream.writer(io, &write_buffer);
+        var read_buffer: [4096]u8 = undefined;
+        var stream_reader = stream.reader(io, &read_buffer);
+
+        var remaining = c.requests;
+        while (remaining > 0) {
+            const batch = @min(remaining, c.pipeline);
+            for (0..batch) |_| try stream_writer.interface.writeAll(request_bytes);
+            try stream_writer.interface.flush();
+            try stream_reader.interface.discardAll(batch * expected_response.len);
+            remaining -= batch;
+        }
+    }
+};
+
+fn benchmarkEngine(
+    io: Io,
+    gpa: std.mem.Allocator,
+    listen_count: u32,
+    client_count: usize,
+    requests: usize,
+    pipeline: usize,
+) !u64 {
+    const address = try net.IpAddress.parse("127.0.0.1", 0);
+    var engine: http.Engine = try .init(io, gpa, address, .{
+        .context = null,
+        .handle = handle,
+    }, .{ .listen_count = listen_count });
+    defer engine.deinit();
+    var serve_future = try io.concurrent(http.Engine.serve, .{&engine});
+    defer serve_future.cancel(io) catch {};
+
+    const clients = try gpa.alloc(Client, client_count);
+    defer gpa.free(clients);
+    const threads = try gpa.alloc(std.Thread, client_count);
+    defer gpa.free(threads);
+
+    var timer = try Timer.start();
+    for (clients, threads) |*client, *thread| {
+        client.* = .{ .io = io, .port = engine.port(), .requests = requests, .pipeline = pipeline };
+        thread.* = try std.Thread.spawn(.{}, Client.run, .{client});
+    }
+    for (threads) |thread| thread.join();
+    const elapsed_ns = timer.read();
+
+    for (clients) |client| if (client.err) |err| return err;
+    const total: u64 = client_count * requests;
+    return total * std.time.ns_per_s / @max(elapsed_ns, 1);
+}
+
+pub fn main() !void {
+    var stdout_buffer: [0x100]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const stdout = &stdout_writer.interface;
+
+    var buffer: [1024]u8 = undefined;
+    var fixed = std.heap.FixedBufferAllocator.init(buffer[0..]);
+    const args = try std.process.argsAlloc(fixed.allocator());
+
+    var client_count: usize = 16;
+    var requests: usize = 10_000;
+    var max_listeners: u32 = @intCast(@min(std.Thread.getCpuCount() catch 1, 8));
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        if (std.mem.eql(u8, args[i], "--clients")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            client_count = try std.fmt.parseUnsigned(usize, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--requests")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            requests = try std.fmt.parseUnsigned(usize, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--listeners")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            max_listeners = try std.fmt.parseUnsigned(u32, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--help")) {
+            usage();
+            return;
+        } else {
+            usage();
+            std.process.exit(1);
+        }
+    }
+    if (client_count == 0 or requests == 0 or max_listeners == 0) {
+        usage();
+        std.process.exit(1);
+    }
+
+    const gpa = std.heap.smp_allocator;
+    var threaded: Io.Threaded = .init(gpa);
+    defer threaded.deinit();
+    const io = threaded.io();
+
+    try stdout.print("{s: >10} {s: >10} {s: >14}\n", .{ "listeners", "pipeline", "requests/s" });
+    try stdout.flush();
+
+    var listen_count: u32 = 1;
+    while (true) {
+        for ([_]usize{ 1, 16 }) |pipeline| {
+            const rate = try benchmarkEngine(io, gpa, listen_count, client_count, requests, pipeline);
+            try stdout.print("{d: >10} {d: >10} {d: >14}\n", .{ listen_count, pipeline, rate });
+            try stdout.flush();
+        }
+        if (listen_count >= max_listeners) break;
+        listen_count = @min(listen_count * 2, max_listeners);
+    }
+}
+
+fn usage() void {
+    std.debug.print(
+        \\benchmark [options]
+        \\
+        \\options:
+        \\ --clients   [int]
+        \\ --requests  [int]  per client
+        \\ --listeners [int]  maximum
+        \\ --help
+        \\
+    , .{});
+}
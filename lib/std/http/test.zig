@@ -1219,3 +1219,64 @@ test "redirect to different connection" {
         try expectEqualStrings("good job, you pass", body);
     }
 }
+
+test "Engine serves keep-alive and pipelined requests" {
+    if (builtin.single_threaded) return error.SkipZigTest;
+    const io = std.testing.io;
+    const gpa = std.testing.allocator;
+
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+    try tmp.dir.writeFile(.{ .sub_path = "file.txt", .data = "file contents\n" });
+
+    const Context = struct {
+        dir: std.fs.Dir,
+
+        fn handle(context: ?*anyopaque, request: *http.Server.Request) http.Engine.HandleError!void {
+            const ctx: *@This() = @ptrCast(@alignCast(context));
+            if (mem.eql(u8, request.head.target, "/file")) {
+                var file = ctx.dir.openFile("file.txt", .{}) catch return error.HandlerFailed;
+                defer file.close();
+                var file_reader = file.reader(io, &.{});
+                var buffer: [64]u8 = undefined;
+                try request.respondFile(&buffer, &file_reader, .{});
+            } else {
+                try request.respondUnflushed("hello", .{});
+            }
+        }
+    };
+    var context: Context = .{ .dir = tmp.dir };
+
+    const address = try net.IpAddress.parse("127.0.0.1", 0);
+    var engine: http.Engine = try .init(io, gpa, address, .{
+        .context = &context,
+        .handle = Context.handle,
+    }, .{ .listen_count = 2 });
+    defer engine.deinit();
+    var serve_future = try io.concurrent(http.Engine.serve, .{&engine});
+    defer serve_future.cancel(io) catch {};
+
+    const request_bytes =
+        "GET / HTTP/1.1\r\n\r\n" ++
+        "GET /file HTTP/1.1\r\n\r\n" ++
+        "HEAD /file HTTP/1.1\r\n\r\n" ++
+        "GET / HTTP/1.1\r\nconnection: close\r\n\r\n";
+    const expected_response =
+        "HTTP/1.1 200 OK\r\ncontent-length: 5\r\n\r\nhello" ++
+        "HTTP/1.1 200 OK\r\ncontent-length: 14\r\n\r\nfile contents\n" ++
+        "HTTP/1.1 200 OK\r\ncontent-length: 14\r\n\r\n" ++
+        "HTTP/1.1 200 OK\r\nconnection: close\r\ncontent-length: 5\r\n\r\nhello";
+
+    for (0..4) |_| {
+        const host_name: net.HostName = try .init("127.0.0.1");
+        var stream = try host_name.connect(io, engine.port(), .{ .mode = .stream });
+        defer stream.close(io);
+        var stream_writer = stream.writer(io, &.{});
+        try stream_writer.interface.writeAll(request_bytes);
+
+        var stream_reader = stream.reader(io, &.{});
+        const response = try stream_reader.interface.allocRemaining(gpa, .limited(expected_response.len + 1));
+        defer gpa.free(response);
+        try expectEqualStrings(expected_response, response);
+    }
+}
@@ -0,0 +1,143 @@
+// zig run -O ReleaseFast --zig-lib-dir ../../.. benchmark.zig
+//
+// Compares karatsuba and Toom-3 multiplication of two numbers with the same number of limbs, for
+// sizes around `toom3_threshold`. Only the outermost split differs between the two; the parts are
+// multiplied as usual. Toom-3 should be used once it is faster, and remain faster for larger sizes.
+
+const std = @import("std");
+const Timer = std.time.Timer;
+const big = std.math.big;
+const Limb = big.Limb;
+
+var prng = std.Random.DefaultPrng.init(0);
+const random = prng.random();
+
+const default_sizes = [_]usize{ 64, 96, 128, 160, 192, 224, 256, 288, 320, 384, 448, 512, 768, 1024, 2048 };
+
+/// Returns the time of one multiplication in nanoseconds, averaged over a batch of them which takes
+/// at least `min_ns`. The fastest of several batches is used, since interference only adds time.
+fn benchmarkMul(
+    comptime algorithm: big.int.MulAlgorithm,
+    gpa: std.mem.Allocator,
+    r: []Limb,
+    a: []const Limb,
+    b: []const Limb,
+    min_ns: u64,
+) !u64 {
+    const batches = 5;
+
+    // Warm up, which also gives an estimate of the number of iterations that fit in `min_ns`.
+    var timer = try Timer.start();
+    @memset(r, 0);
+    try big.int.llmulaccWith(algorithm, gpa, r, a, b);
+    const estimate_ns = @max(timer.lap(), 1);
+    const iterations = @max(min_ns / batches / estimate_ns, 3);
+
+    var best_ns: u64 = std.math.maxInt(u64);
+    for (0..batches) |_| {
+        timer.reset();
+        for (0..iterations) |_| {
+            @memset(r, 0);
+            try big.int.llmulaccWith(algorithm, gpa, r, a, b);
+            std.mem.doNotOptimizeAway(r[0]);
+        }
+        best_ns = @min(best_ns, timer.read() / iterations);
+    }
+    return best_ns;
+}
+
+pub fn main() !void {
+    var stdout_buffer: [0x100]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const stdout = &stdout_writer.interface;
+
+    var buffer: [1024]u8 = undefined;
+    var fixed = std.heap.FixedBufferAllocator.init(buffer[0..]);
+    const args = try std.process.argsAlloc(fixed.allocator());
+
+    var single_size: ?usize = null;
+    var min_ms: u64 = 500;
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        if (std.mem.eql(u8, args[i], "--limbs")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            single_size = try std.fmt.parseUnsigned(usize, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--ms")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            min_ms = try std.fmt.parseUnsigned(u64, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--help")) {
+            usage();
+            return;
+        } else {
+            usage();
+            std.process.exit(1);
+        }
+    }
+    // Toom-3 needs the operands to split into three parts.
+    if (single_size) |size| if (size < 8) {
+        usage();
+        std.process.exit(1);
+    };
+
+    const gpa = std.heap.smp_allocator;
+    const sizes: []const usize = if (single_size) |*size| size[0..1] else &default_sizes;
+
+    try stdout.print("toom3_threshold = {d}\n", .{big.int.toom3_threshold});
+    try stdout.print("{s: >6} {s: >14} {s: >14} {s: >8}\n", .{ "limbs", "karatsuba ns", "toom3 ns", "ratio" });
+    try stdout.flush();
+
+    var crossover: ?usize = null;
+    for (sizes) |size| {
+        const a = try gpa.alloc(Limb, size);
+        defer gpa.free(a);
+        const b = try gpa.alloc(Limb, size);
+        defer gpa.free(b);
+        const r = try gpa.alloc(Limb, 2 * size);
+        defer gpa.free(r);
+        random.bytes(std.mem.sliceAsBytes(a));
+        random.bytes(std.mem.sliceAsBytes(b));
+
+        const min_ns = min_ms * std.time.ns_per_ms;
+        const karatsuba_ns = try benchmarkMul(.karatsuba, gpa, r, a, b, min_ns);
+        const toom3_ns = try benchmarkMul(.toom3, gpa, r, a, b, min_ns);
+        const ratio = @as(f64, @floatFromInt(toom3_ns)) / @as(f64, @floatFromInt(@max(karatsuba_ns, 1)));
+        if (ratio < 1) {
+            if (crossover == null) crossover = size;
+        } else {
+            crossover = null;
+        }
+
+        try stdout.print("{d: >6} {d: >14} {d: >14} {d: >8.3}\n", .{ size, karatsuba_ns, toom3_ns, ratio });
+        try stdout.flush();
+    }
+
+    if (single_size == null) {
+        if (crossover) |size| {
+            try stdout.print("Toom-3 is faster from {d} limbs\n", .{size});
+        } else {
+            try stdout.print("Toom-3 is not faster at the largest size\n", .{});
+        }
+        try stdout.flush();
+    }
+}
+
+fn usage() void {
+    std.debug.print(
+        \\benchmark [options]
+        \\
+        \\options:
+        \\ --limbs [int]  only measure this size (at least 8)
+        \\ --ms [int]     minimum time per measurement of one algorithm and size
+        \\ --help
+        \\
+    , .{});
+}
@@ -3397,20 +3397,185 @@ fn llmulacc(comptime op: AccOp, opt_allocator: ?Allocator, r: []Limb, a: []const
         y = a;
     }
 
-    k_mul: {
-        if (y.len > 48) {
-            if (opt_allocator) |allocator| {
-                llmulaccKaratsuba(op, allocator, r, x, y) catch |err| switch (err) {
-                    error.OutOfMemory => break :k_mul, // handled below
-                };
-                return;
-            }
+    if (opt_allocator) |allocator| {
+        // Toom-3 needs y to be split into three parts of the same size as x's.
+        if (y.len > toom3_threshold and y.len > 2 * toom3Split(x.len)) toom3: {
+            llmulaccToom3(op, allocator, r, x, y) catch |err| switch (err) {
+                error.OutOfMemory => break :toom3, // fall back to karatsuba
+            };
+            return;
+        }
+        if (y.len > 48) k_mul: {
+            llmulaccKaratsuba(op, allocator, r, x, y) catch |err| switch (err) {
+                error.OutOfMemory => break :k_mul, // handled below
+            };
+            return;
         }
     }
 
     llmulaccLong(op, r, x, y);
 }
 
+/// The length of the shorter operand, in limbs, above which Toom-3 is used instead of karatsuba.
+/// `benchmark.zig` in this directory compares both algorithms at the sizes around it.
+pub const toom3_threshold = 256;
+
+pub const MulAlgorithm = enum { karatsuba, toom3 };
+
+/// r = r + a * b, splitting the operands with `algorithm` regardless of `toom3_threshold`. The
+/// parts are multiplied as usual. Exposed for `benchmark.zig`, which compares both algorithms at
+/// the sizes around the threshold.
+///
+/// r MUST NOT alias any of a or b, and `r.len >= a.len + b.len`. For Toom-3, the shorter operand
+/// must be more than two thirds of the length of the longer one.
+pub fn llmulaccWith(
+    comptime algorithm: MulAlgorithm,
+    allocator: Allocator,
+    r: []Limb,
+    a: []const Limb,
+    b: []const Limb,
+) error{OutOfMemory}!void {
+    assert(r.len >= a.len + b.len);
+    const x, const y = if (a.len >= b.len) .{ a, b } else .{ b, a };
+    switch (algorithm) {
+        .karatsuba => try llmulaccKaratsuba(.add, allocator, r, x, y),
+        .toom3 => {
+            assert(y.len > 2 * toom3Split(x.len));
+            try llmulaccToom3(.add, allocator, r, x, y);
+        },
+    }
+}
+
+/// Returns the size of the lower two parts when splitting an operand with `len` limbs for Toom-3.
+fn toom3Split(len: usize) usize {
+    return (len + 2) / 3;
+}
+
+/// Toom-Cook 3-way multiplication. Evaluates at 0, 1, -1, -2 and infinity, and interpolates with
+/// the sequence given by Bodrato and Zanoni, "What about Toom-Cook matrices optimality?" (2006).
+///
+/// r = r (op) a * b
+/// r MUST NOT alias any of a or b.
+///
+/// The result is computed modulo `r.len`. When `r.len >= a.len + b.len`, no overflow occurs.
+fn llmulaccToom3(
+    comptime op: AccOp,
+    allocator: Allocator,
+    r: []Limb,
+    a: []const Limb,
+    b: []const Limb,
+) error{OutOfMemory}!void {
+    assert(r.len >= a.len);
+    assert(a.len >= b.len);
+    assert(!slicesOverlap(r, a));
+    assert(!slicesOverlap(r, b));
+
+    // a = a2 * B^2 + a1 * B + a0
+    // b = b2 * B^2 + b1 * B + b0
+    // Where a0, a1, b0, b1 < B.
+    //
+    // Treating these as polynomials in B, their product p(x) = a(x) * b(x) has degree 4, and is
+    // determined by its values at the five points 0, 1, -1, -2 and infinity, each of which is a
+    // product of numbers about a third of the size of a and b.
+    const split = toom3Split(a.len); // B
+    assert(b.len > 2 * split);
+
+    // The evaluations at 1, -1 and -2 are below 7B in magnitude, so they fit in `split + 1` limbs.
+    // Leave an extra limb for the intermediate carries of `Mutable.add`.
+    const eval_limbs = split + 2;
+    const prod_limbs = 2 * eval_limbs;
+    const buf = try allocator.alloc(Limb, 6 * eval_limbs + 5 * prod_limbs);
+    defer allocator.free(buf);
+
+    const a0 = toom3Part(a[0..split]);
+    const a1 = toom3Part(a[split .. 2 * split]);
+    const a2 = toom3Part(a[2 * split ..]);
+    const b0 = toom3Part(b[0..split]);
+    const b1 = toom3Part(b[split .. 2 * split]);
+    const b2 = toom3Part(b[2 * split ..]);
+
+    const a_evals = toom3Evaluate(buf[0 .. 3 * eval_limbs], a0, a1, a2);
+    const b_evals = toom3Evaluate(buf[3 * eval_limbs .. 6 * eval_limbs], b0, b1, b2);
+
+    const prods = buf[6 * eval_limbs ..];
+    var r0: Mutable = .init(prods[0 * prod_limbs ..][0..prod_limbs], 0);
+    var r1: Mutable = .init(prods[1 * prod_limbs ..][0..prod_limbs], 0);
+    var rm1: Mutable = .init(prods[2 * prod_limbs ..][0..prod_limbs], 0);
+    var rm2: Mutable = .init(prods[3 * prod_limbs ..][0..prod_limbs], 0);
+    var rinf: Mutable = .init(prods[4 * prod_limbs ..][0..prod_limbs], 0);
+
+    r0.mulNoAlias(a0, b0, allocator); // p(0)
+    r1.mulNoAlias(a_evals[0].toConst(), b_evals[0].toConst(), allocator); // p(1)
+    rm1.mulNoAlias(a_evals[1].toConst(), b_evals[1].toConst(), allocator); // p(-1)
+    rm2.mulNoAlias(a_evals[2].toConst(), b_evals[2].toConst(), allocator); // p(-2)
+    rinf.mulNoAlias(a2, b2, allocator); // p(inf)
+
+    // Interpolate, turning r1, rm1 and rm2 into the coefficients of x, x^2 and x^3:
+    // r3 = (p(-2) - p(1)) / 3
+    var r3 = rm2;
+    r3.sub(r3.toConst(), r1.toConst());
+    toom3DivExact3(&r3);
+    // r1 = (p(1) - p(-1)) / 2
+    r1.sub(r1.toConst(), rm1.toConst());
+    r1.shiftRight(r1.toConst(), 1);
+    // r2 = p(-1) - p(0)
+    var r2 = rm1;
+    r2.sub(r2.toConst(), r0.toConst());
+    // r3 = (r2 - r3) / 2 + 2 * p(inf)
+    r3.sub(r2.toConst(), r3.toConst());
+    r3.shiftRight(r3.toConst(), 1);
+    r3.add(r3.toConst(), rinf.toConst());
+    r3.add(r3.toConst(), rinf.toConst());
+    // r2 = r2 + r1 - p(inf)
+    r2.add(r2.toConst(), r1.toConst());
+    r2.sub(r2.toConst(), rinf.toConst());
+    // r1 = r1 - r3
+    r1.sub(r1.toConst(), r3.toConst());
+
+    // Since a * b = r0 + r1 * B + r2 * B^2 + r3 * B^3 + rinf * B^4, accumulating each coefficient
+    // individually (modulo r.len) gives the same result as accumulating the full product.
+    for ([_]Mutable{ r0, r1, r2, r3, rinf }, 0..) |coeff, i| {
+        assert(coeff.positive or coeff.eqlZero());
+        const offset = i * split;
+        if (offset >= r.len) break;
+        const limbs = coeff.limbs[0..@min(coeff.len, r.len - offset)];
+        llaccum(op, r[offset..], limbs);
+    }
+}
+
+fn toom3Part(limbs: []const Limb) Const {
+    return .{ .limbs = limbs[0..llnormalize(limbs)], .positive = true };
+}
+
+/// Evaluates x(t) = x2 * t^2 + x1 * t + x0 at t = 1, -1 and -2, using `buf` for storage.
+fn toom3Evaluate(buf: []Limb, x0: Const, x1: Const, x2: Const) [3]Mutable {
+    const limbs = buf.len / 3;
+    var p1: Mutable = .init(buf[0 * limbs ..][0..limbs], 0);
+    var pm1: Mutable = .init(buf[1 * limbs ..][0..limbs], 0);
+    var pm2: Mutable = .init(buf[2 * limbs ..][0..limbs], 0);
+
+    // x(1) = x0 + x2 + x1
+    // x(-1) = x0 + x2 - x1
+    pm1.add(x0, x2);
+    p1.add(pm1.toConst(), x1);
+    pm1.sub(pm1.toConst(), x1);
+    // x(-2) = 2 * (x(-1) + x2) - x0
+    pm2.add(pm1.toConst(), x2);
+    pm2.shiftLeft(pm2.toConst(), 1);
+    pm2.sub(pm2.toConst(), x0);
+
+    return .{ p1, pm1, pm2 };
+}
+
+/// m = m / 3, where m is known to be a multiple of 3.
+fn toom3DivExact3(m: *Mutable) void {
+    if (m.eqlZero()) return;
+    var rem: Limb = undefined;
+    lldiv1(m.limbs[0..m.len], &rem, m.limbs[0..m.len], 3);
+    assert(rem == 0);
+    m.normalize(m.len);
+}
+
 /// Knuth 4.3.1, Algorithm M.
 ///
 /// r = r (op) a * b
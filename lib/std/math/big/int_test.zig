@@ -1466,6 +1466,67 @@ test "mul large" {
     try testing.expect(b.eql(c));
 }
 
+fn expectMulMatchesSquares(a: *const Managed, b: *const Managed) !void {
+    // a * b = ((a + b)^2 - (a - b)^2) / 4, where squaring always uses the basecase algorithm.
+    var c = try Managed.init(testing.allocator);
+    defer c.deinit();
+    try c.mul(a, b);
+    try c.shiftLeft(&c, 2);
+
+    var sum = try Managed.init(testing.allocator);
+    defer sum.deinit();
+    try sum.add(a, b);
+    try sum.sqr(&sum);
+    var diff = try Managed.init(testing.allocator);
+    defer diff.deinit();
+    try diff.sub(a, b);
+    try diff.sqr(&diff);
+    try sum.sub(&sum, &diff);
+
+    try testing.expect(c.eql(sum));
+}
+
+test "mul toom-3" {
+    var prng: std.Random.DefaultPrng = .init(0x70043);
+    const random = prng.random();
+
+    var a = try Managed.initCapacity(testing.allocator, 900);
+    defer a.deinit();
+    var b = try Managed.initCapacity(testing.allocator, 700);
+    defer b.deinit();
+
+    // Large enough to recurse into toom-3 from toom-3.
+    random.bytes(mem.sliceAsBytes(a.limbs[0..900]));
+    a.limbs[899] |= 1;
+    a.setMetadata(true, 900);
+    random.bytes(mem.sliceAsBytes(b.limbs[0..700]));
+    b.limbs[699] |= 1;
+    b.setMetadata(true, 700);
+    try expectMulMatchesSquares(&a, &b);
+
+    // Maximal limbs stress the carries during evaluation and interpolation.
+    @memset(a.limbs[0..900], maxInt(Limb));
+    @memset(b.limbs[0..700], maxInt(Limb));
+    try expectMulMatchesSquares(&a, &b);
+
+    // Zero parts, so that some evaluations and products are zero.
+    @memset(a.limbs[0..600], 0);
+    @memset(b.limbs[300..700], 0);
+    b.limbs[699] = 1;
+    try expectMulMatchesSquares(&a, &b);
+
+    // Truncated products only accumulate the low limbs of each coefficient.
+    var full = try Managed.init(testing.allocator);
+    defer full.deinit();
+    try full.mul(&a, &b);
+    var wrapped = try Managed.init(testing.allocator);
+    defer wrapped.deinit();
+    const bits = 1000 * @bitSizeOf(Limb) + 7;
+    try wrapped.mulWrap(&a, &b, .unsigned, bits);
+    try full.truncate(&full, .unsigned, bits);
+    try testing.expect(wrapped.eql(full));
+}
+
 test "mulWrap single-single unsigned" {
     var a = try Managed.initSet(testing.allocator, 1234);
     defer a.deinit();
@@ -2477,11 +2477,28 @@ pub const ITIMER = enum(i32) {
     PROF = 2,
 };
 
-pub fn getitimer(which: i32, curr_value: *itimerspec) usize {
+pub const itimerval = extern struct {
+    interval: Timeval,
+    value: Timeval,
+
+    /// The kernel's `__kernel_old_timeval`, whose fields have the width of `long` in the kernel,
+    /// unlike `timeval`.
+    pub const Timeval = extern struct {
+        sec: Long,
+        usec: Long,
+
+        const Long = switch (native_abi) {
+            .gnux32, .muslx32 => i64,
+            else => isize,
+        };
+    };
+};
+
+pub fn getitimer(which: i32, curr_value: *itimerval) usize {
     return syscall2(.getitimer, @as(usize, @bitCast(@as(isize, which))), @intFromPtr(curr_value));
 }
 
-pub fn setitimer(which: i32, new_value: *const itimerspec, old_value: ?*itimerspec) usize {
+pub fn setitimer(which: i32, new_value: *const itimerval, old_value: ?*itimerval) usize {
     return syscall3(.setitimer, @as(usize, @bitCast(@as(isize, which))), @intFromPtr(new_value), @intFromPtr(old_value));
 }
 
@@ -7737,6 +7754,11 @@ pub const SIOCGSTAMPNS_OLD = IOCTL.IOR('s', 101, kernel_timespec);
 /// Get stamp (timespec)
 pub const SIOCGSTAMPNS = if (native_arch == .x86_64 or @sizeOf(timespec) == 8) SIOCGSTAMPNS_OLD else SIOCGSTAMPNS_NEW;
 
+/// Makes the file referred to by the file descriptor passed as the ioctl
+/// request's file descriptor share the data of the file descriptor passed as
+/// the argument, without copying it.
+pub const FICLONE = IOCTL.IOW(0x94, 9, c_int);
+
 // Routing table calls.
 /// Add routing table entry
 pub const SIOCADDRT = 0x890B;
@@ -9969,6 +9991,38 @@ pub const wrapped = struct {
         }
     }
 
+    pub const FicloneError = std.posix.UnexpectedError || error{
+        /// The filesystem does not support reflinks, or one of the file
+        /// descriptors does not refer to a regular file.
+        OperationNotSupported,
+        /// The files are not on the same mounted filesystem.
+        NotSameFileSystem,
+        /// `dest_fd` is not open for writing, is opened with `O_APPEND`, or
+        /// refers to an immutable file.
+        PermissionDenied,
+        /// `dest_fd` refers to an active swap file.
+        SwapFile,
+        NoSpaceLeft,
+        InputOutput,
+    };
+
+    /// Replaces the contents of `dest_fd` with those of `src_fd` by sharing
+    /// the underlying data blocks, on filesystems which support reflinks such
+    /// as Btrfs, XFS, and bcachefs.
+    pub fn ficlone(dest_fd: fd_t, src_fd: fd_t) FicloneError!void {
+        const rc = std.os.linux.ioctl(dest_fd, FICLONE, @as(usize, @bitCast(@as(isize, src_fd))));
+        switch (std.os.linux.errno(rc)) {
+            .SUCCESS => return,
+            .OPNOTSUPP, .INVAL, .NOTTY, .ISDIR => return error.OperationNotSupported,
+            .XDEV => return error.NotSameFileSystem,
+            .BADF, .PERM => return error.PermissionDenied,
+            .TXTBSY => return error.SwapFile,
+            .NOSPC => return error.NoSpaceLeft,
+            .IO => return error.InputOutput,
+            else => |err| return unexpectedErrno(err),
+        }
+    }
+
     const unexpectedErrno = std.posix.unexpectedErrno;
 
     fn invalidApiUsage() error{Unexpected} {
@@ -640,45 +640,25 @@ fn spawnPosix(self: *ChildProcess) SpawnError!void {
     const err_pipe: [2]posix.fd_t = try posix.pipe2(.{ .CLOEXEC = true });
     errdefer destroyPipe(err_pipe);
 
-    const pid_result = try posix.fork();
-    if (pid_result == 0) {
-        // we are the child
-        setUpChildIo(self.stdin_behavior, stdin_pipe[0], posix.STDIN_FILENO, dev_null_fd) catch |err| forkChildErrReport(err_pipe[1], err);
-        setUpChildIo(self.stdout_behavior, stdout_pipe[1], posix.STDOUT_FILENO, dev_null_fd) catch |err| forkChildErrReport(err_pipe[1], err);
-        setUpChildIo(self.stderr_behavior, stderr_pipe[1], posix.STDERR_FILENO, dev_null_fd) catch |err| forkChildErrReport(err_pipe[1], err);
-
-        if (self.cwd_dir) |cwd| {
-            posix.fchdir(cwd.fd) catch |err| forkChildErrReport(err_pipe[1], err);
-        } else if (self.cwd) |cwd| {
-            posix.chdir(cwd) catch |err| forkChildErrReport(err_pipe[1], err);
-        }
-
-        // Must happen after fchdir above, the cwd file descriptor might be
-        // equal to prog_fileno and be clobbered by this dup2 call.
-        if (prog_pipe[1] != -1) posix.dup2(prog_pipe[1], prog_fileno) catch |err| forkChildErrReport(err_pipe[1], err);
-
-        if (self.gid) |gid| {
-            posix.setregid(gid, gid) catch |err| forkChildErrReport(err_pipe[1], err);
-        }
-
-        if (self.uid) |uid| {
-            posix.setreuid(uid, uid) catch |err| forkChildErrReport(err_pipe[1], err);
-        }
-
-        if (self.pgid) |pid| {
-            posix.setpgid(0, pid) catch |err| forkChildErrReport(err_pipe[1], err);
-        }
-
-        if (self.start_suspended) {
-            posix.kill(posix.getpid(), .STOP) catch |err| forkChildErrReport(err_pipe[1], err);
-        }
-
-        const err = switch (self.expand_arg0) {
-            .expand => posix.execvpeZ_expandArg0(.expand, argv_buf.ptr[0].?, argv_buf.ptr, envp),
-            .no_expand => posix.execvpeZ_expandArg0(.no_expand, argv_buf.ptr[0].?, argv_buf.ptr, envp),
-        };
-        forkChildErrReport(err_pipe[1], err);
-    }
+    const fork_child: ForkChild = .{
+        .child = self,
+        .stdin_pipe = stdin_pipe,
+        .stdout_pipe = stdout_pipe,
+        .stderr_pipe = stderr_pipe,
+        .dev_null_fd = dev_null_fd,
+        .prog_pipe = prog_pipe,
+        .prog_fileno = prog_fileno,
+        .err_pipe = err_pipe,
+        .argv_buf = argv_buf,
+        .envp = envp,
+    };
+    const pid_result = if (fork_child.canVfork())
+        try fork_child.vfork(arena)
+    else pid: {
+        const pid = try posix.fork();
+        if (pid == 0) fork_child.exec(); // we are the child
+        break :pid pid;
+    };
 
     // we are the parent
     errdefer comptime unreachable; // The child is forked; we must not error from now on
@@ -722,6 +702,142 @@ fn spawnPosix(self: *ChildProcess) SpawnError!void {
     self.progress_node.setIpcFd(prog_pipe[0]);
 }
 
+/// Everything the child needs between `fork` and `execvpe`. It is all prepared beforehand, so
+/// that the child does not need to allocate.
+const ForkChild = struct {
+    child: *const ChildProcess,
+    stdin_pipe: [2]posix.fd_t,
+    stdout_pipe: [2]posix.fd_t,
+    stderr_pipe: [2]posix.fd_t,
+    dev_null_fd: posix.fd_t,
+    prog_pipe: [2]posix.fd_t,
+    prog_fileno: posix.fd_t,
+    err_pipe: [2]posix.fd_t,
+    argv_buf: [:null]?[*:0]const u8,
+    envp: [*:null]const ?[*:0]const u8,
+
+    /// Large enough for `execvpe` to build each candidate path on the stack.
+    const vfork_stack_size = 64 * 1024;
+
+    /// Whether the child can share the memory of the parent until it calls `execve`, which
+    /// avoids copying the page tables of the parent. The parent's thread is suspended meanwhile,
+    /// so this is not possible if the child stops itself. Changing the user or group ID is
+    /// excluded as well, since libc implementations coordinate it between all the threads of a
+    /// process, which the child would believe it shares.
+    fn canVfork(fc: *const ForkChild) bool {
+        if (native_os != .linux) return false;
+        return fc.child.uid == null and fc.child.gid == null and !fc.child.start_suspended;
+    }
+
+    /// Starts a child with `clone(CLONE_VM | CLONE_VFORK)` on a separate stack, returning its
+    /// PID once it has called `execve` or exited.
+    fn vfork(fc: *const ForkChild, arena: Allocator) (Allocator.Error || posix.ForkError)!posix.pid_t {
+        const stack = try arena.alignedAlloc(u8, .@"16", vfork_stack_size);
+
+        // Until it resets the signal handlers, a signal must not run a handler of the parent in
+        // the child, where it would act on the memory of the parent.
+        const all_mask = linux.sigfillset();
+        var old_mask: linux.sigset_t = undefined;
+        _ = linux.sigprocmask(linux.SIG.SETMASK, &all_mask, &old_mask);
+        defer _ = linux.sigprocmask(linux.SIG.SETMASK, &old_mask, null);
+
+        const args: VforkArgs = .{ .fork_child = fc, .old_mask = &old_mask };
+        const rc = linux.clone(
+            VforkArgs.entry,
+            @intFromPtr(stack.ptr) + stack.len,
+            linux.CLONE.VM | linux.CLONE.VFORK | @intFromEnum(linux.SIG.CHLD),
+            @intFromPtr(&args),
+            null,
+            0,
+            null,
+        );
+        switch (linux.errno(rc)) {
+            .SUCCESS => return @intCast(rc),
+            .AGAIN, .NOMEM => return error.SystemResources,
+            else => |err| return posix.unexpectedErrno(err),
+        }
+    }
+
+    const VforkArgs = struct {
+        fork_child: *const ForkChild,
+        old_mask: *const linux.sigset_t,
+
+        fn entry(arg: usize) callconv(.c) u8 {
+            const args: *const VforkArgs = @ptrFromInt(arg);
+            resetSignalHandlers();
+            _ = linux.sigprocmask(linux.SIG.SETMASK, args.old_mask, null);
+            args.fork_child.exec();
+        }
+
+        /// Restores the default action of every signal with a handler. Ignored signals stay
+        /// ignored, as they would after `fork`.
+        fn resetSignalHandlers() void {
+            // `linux.sigaction` only accepts the signals named by `linux.SIG`, so this makes the
+            // system call directly to cover the real-time signals too.
+            var sig: usize = 1;
+            while (sig < linux.NSIG) : (sig += 1) {
+                var action: linux.k_sigaction = undefined;
+                if (linux.errno(rtSigaction(sig, null, &action)) != .SUCCESS) continue;
+                const handler = @intFromPtr(action.handler);
+                if (handler == @intFromPtr(linux.SIG.DFL) or handler == @intFromPtr(linux.SIG.IGN)) continue;
+                action.handler = null;
+                action.flags = 0;
+                _ = rtSigaction(sig, &action, null);
+            }
+        }
+
+        fn rtSigaction(sig: usize, act: ?*const linux.k_sigaction, oact: ?*linux.k_sigaction) usize {
+            const mask_size = @sizeOf(linux.sigset_t);
+            return switch (builtin.cpu.arch) {
+                // The sparc version also takes the restorer, which is not needed for `SIG.DFL`.
+                .sparc, .sparc64 => linux.syscall5(.rt_sigaction, sig, @intFromPtr(act), @intFromPtr(oact), 0, mask_size),
+                else => linux.syscall4(.rt_sigaction, sig, @intFromPtr(act), @intFromPtr(oact), mask_size),
+            };
+        }
+    };
+
+    /// Sets up the child and calls `execvpe`, reporting any error through `err_pipe`.
+    fn exec(fc: *const ForkChild) noreturn {
+        const self = fc.child;
+        const err_fd = fc.err_pipe[1];
+        setUpChildIo(self.stdin_behavior, fc.stdin_pipe[0], posix.STDIN_FILENO, fc.dev_null_fd) catch |err| forkChildErrReport(err_fd, err);
+        setUpChildIo(self.stdout_behavior, fc.stdout_pipe[1], posix.STDOUT_FILENO, fc.dev_null_fd) catch |err| forkChildErrReport(err_fd, err);
+        setUpChildIo(self.stderr_behavior, fc.stderr_pipe[1], posix.STDERR_FILENO, fc.dev_null_fd) catch |err| forkChildErrReport(err_fd, err);
+
+        if (self.cwd_dir) |cwd| {
+            posix.fchdir(cwd.fd) catch |err| forkChildErrReport(err_fd, err);
+        } else if (self.cwd) |cwd| {
+            posix.chdir(cwd) catch |err| forkChildErrReport(err_fd, err);
+        }
+
+        // Must happen after fchdir above, the cwd file descriptor might be
+        // equal to prog_fileno and be clobbered by this dup2 call.
+        if (fc.prog_pipe[1] != -1) posix.dup2(fc.prog_pipe[1], fc.prog_fileno) catch |err| forkChildErrReport(err_fd, err);
+
+        if (self.gid) |gid| {
+            posix.setregid(gid, gid) catch |err| forkChildErrReport(err_fd, err);
+        }
+
+        if (self.uid) |uid| {
+            posix.setreuid(uid, uid) catch |err| forkChildErrReport(err_fd, err);
+        }
+
+        if (self.pgid) |pid| {
+            posix.setpgid(0, pid) catch |err| forkChildErrReport(err_fd, err);
+        }
+
+        if (self.start_suspended) {
+            posix.kill(posix.getpid(), .STOP) catch |err| forkChildErrReport(err_fd, err);
+        }
+
+        const err = switch (self.expand_arg0) {
+            .expand => posix.execvpeZ_expandArg0(.expand, fc.argv_buf.ptr[0].?, fc.argv_buf.ptr, fc.envp),
+            .no_expand => posix.execvpeZ_expandArg0(.no_expand, fc.argv_buf.ptr[0].?, fc.argv_buf.ptr, fc.envp),
+        };
+        forkChildErrReport(err_fd, err);
+    }
+};
+
 fn spawnWindows(self: *ChildProcess) SpawnError!void {
     var saAttr = windows.SECURITY_ATTRIBUTES{
         .nLength = @sizeOf(windows.SECURITY_ATTRIBUTES),
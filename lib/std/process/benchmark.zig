@@ -0,0 +1,130 @@
+// zig run -O ReleaseFast --zig-lib-dir ../.. benchmark.zig
+//
+// Measures the latency of spawning a child process and waiting for it while the parent has a
+// large resident set, comparing `std.process.Child` with a plain `fork` and `execve`.
+
+const std = @import("std");
+const posix = std.posix;
+const Timer = std.time.Timer;
+
+const MiB = 1024 * 1024;
+
+const default_program = "/bin/true";
+
+fn benchmarkChild(gpa: std.mem.Allocator, program: []const u8, count: usize) !u64 {
+    var timer = try Timer.start();
+    for (0..count) |_| {
+        var child = std.process.Child.init(&.{program}, gpa);
+        child.stdin_behavior = .Ignore;
+        child.stdout_behavior = .Ignore;
+        child.stderr_behavior = .Ignore;
+        const term = try child.spawnAndWait();
+        if (term != .Exited) return error.ChildFailed;
+    }
+    return timer.read() / count;
+}
+
+fn benchmarkFork(program: [:0]const u8, count: usize) !u64 {
+    const argv: [*:null]const ?[*:0]const u8 = &.{program.ptr};
+    const envp: [*:null]const ?[*:0]const u8 = &.{};
+    var timer = try Timer.start();
+    for (0..count) |_| {
+        const pid = try posix.fork();
+        if (pid == 0) {
+            _ = posix.execveZ(program.ptr, argv, envp) catch {};
+            posix.exit(1);
+        }
+        _ = posix.waitpid(pid, 0);
+    }
+    return timer.read() / count;
+}
+
+pub fn main() !void {
+    var stdout_buffer: [0x100]u8 = undefined;
+    var stdout_writer = std.fs.File.stdout().writer(&stdout_buffer);
+    const stdout = &stdout_writer.interface;
+
+    var buffer: [1024]u8 = undefined;
+    var fixed = std.heap.FixedBufferAllocator.init(buffer[0..]);
+    const args = try std.process.argsAlloc(fixed.allocator());
+
+    var count: usize = 200;
+    var max_rss_mib: usize = 4096;
+    var program: [:0]const u8 = default_program;
+
+    var i: usize = 1;
+    while (i < args.len) : (i += 1) {
+        if (std.mem.eql(u8, args[i], "--count")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            count = try std.fmt.parseUnsigned(usize, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--rss")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            max_rss_mib = try std.fmt.parseUnsigned(usize, args[i], 10);
+        } else if (std.mem.eql(u8, args[i], "--program")) {
+            i += 1;
+            if (i == args.len) {
+                usage();
+                std.process.exit(1);
+            }
+            program = args[i];
+        } else if (std.mem.eql(u8, args[i], "--help")) {
+            usage();
+            return;
+        } else {
+            usage();
+            std.process.exit(1);
+        }
+    }
+    if (count == 0) {
+        usage();
+        std.process.exit(1);
+    }
+
+    const gpa = std.heap.page_allocator;
+    try stdout.print("{s: >10} {s: >14} {s: >14}\n", .{ "rss (MiB)", "Child (us)", "fork (us)" });
+    try stdout.flush();
+
+    // The ballast grows by doubling, and is touched so that its pages are resident and mapped.
+    var ballast: []u8 = &.{};
+    defer gpa.free(ballast);
+    var rss_mib: usize = 0;
+    while (true) {
+        if (rss_mib != 0) {
+            ballast = try gpa.realloc(ballast, rss_mib * MiB);
+            @memset(ballast, 0xaa);
+        }
+
+        const child_ns = try benchmarkChild(gpa, program, count);
+        const fork_ns = try benchmarkFork(program, count);
+        try stdout.print("{d: >10} {d: >14.1} {d: >14.1}\n", .{
+            rss_mib,
+            @as(f64, @floatFromInt(child_ns)) / std.time.ns_per_us,
+            @as(f64, @floatFromInt(fork_ns)) / std.time.ns_per_us,
+        });
+        try stdout.flush();
+
+        if (rss_mib >= max_rss_mib) break;
+        rss_mib = if (rss_mib == 0) 256 else @min(rss_mib * 2, max_rss_mib);
+    }
+}
+
+fn usage() void {
+    std.debug.print(
+        \\benchmark [options]
+        \\
+        \\options:
+        \\ --count     [int]
+        \\ --rss       [MiB]
+        \\ --program   [path]
+        \\ --help
+        \\
+    , .{});
+}
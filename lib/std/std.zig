@@ -144,6 +144,15 @@ pub const Options = struct {
 
     crypto_fork_safety: bool = true,
 
+    /// When the compilation target does not enable them, detect CPU features at runtime and use
+    /// them in `std.crypto` primitives where supported: AES-NI for single-block AES encryption and
+    /// decryption contexts, SHA-NI for SHA-224/SHA-256, and PCLMULQDQ for GHASH and POLYVAL (and
+    /// thus AES-GCM and AES-GCM-SIV). Currently x86_64 only.
+    ///
+    /// The cost is a predictable branch per block, so this is useful for binaries built for a
+    /// baseline CPU which are expected to run on newer hardware.
+    crypto_runtime_cpu_features: bool = false,
+
     /// By default, std.http.Client will support HTTPS connections.  Set this option to `true` to
     /// disable TLS support.
     ///
@@ -31,6 +31,7 @@ pub const WindowsSdk = @import("zig/WindowsSdk.zig");
 pub const LibCDirs = @import("zig/LibCDirs.zig");
 pub const target = @import("zig/target.zig");
 pub const llvm = @import("zig/llvm.zig");
+pub const docs_index = @import("zig/docs_index.zig");
 
 // Character literal parsing
 pub const ParsedCharLiteral = string_literal.ParsedCharLiteral;
@@ -979,4 +980,5 @@ test {
     _ = target;
     _ = c_translation;
     _ = llvm;
+    _ = docs_index;
 }
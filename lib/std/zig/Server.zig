@@ -62,6 +62,8 @@ pub const Message = struct {
         fuzz_start_addr,
         /// Body is a TimeReport.
         time_report,
+        /// Body is a MemReport.
+        mem_report,
 
         _,
     };
@@ -114,6 +116,7 @@ pub const Message = struct {
         llvm_pass_timings_len: u32,
         files_len: u32,
         decls_len: u32,
+        fns_len: u32,
         flags: Flags,
         pub const Flags = packed struct(u32) {
             use_llvm: bool,
@@ -121,6 +124,14 @@ pub const Message = struct {
         };
     };
 
+    /// Trailing is the same as in `std.Build.abi.mem_report.CompileResult`.
+    pub const MemReport = extern struct {
+        stats: std.Build.abi.mem_report.CompileResult.Stats align(4),
+        files_len: u32,
+        tags_len: u32,
+        decls_len: u32,
+    };
+
     /// Trailing:
     /// * the hex digest of the cache directory within the /o/ subdirectory.
     pub const EmitDigest = extern struct {
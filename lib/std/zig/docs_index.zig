@@ -0,0 +1,168 @@
+//! Search index for Autodoc, emitted in shards next to `sources.tar`.
+//!
+//! For each file of the tarball, the index records the names of declarations
+//! and the text of doc comments. This is enough for the frontend to rule out
+//! files which cannot contain a match for a search query, so that it only
+//! needs to parse the remaining ones instead of every file.
+//!
+//! A shard is a sequence of records, each of which is a little-endian `u32`
+//! length followed by the path of the file in the tarball, then a `u32` length
+//! followed by the text of the file.
+
+const std = @import("../std.zig");
+const Allocator = std.mem.Allocator;
+const Tokenizer = std.zig.Tokenizer;
+
+/// Shard `n` contains the records of the files at positions
+/// `n * files_per_shard` through `(n + 1) * files_per_shard - 1` in the
+/// tarball, and is served as `search/{n}.bin`.
+pub const files_per_shard = 64;
+
+pub fn shardCount(file_count: usize) usize {
+    return std.math.divCeil(usize, file_count, files_per_shard) catch unreachable;
+}
+
+/// Appends the record of the file at `path` in the tarball to `shard`.
+pub fn appendFile(
+    gpa: Allocator,
+    shard: *std.ArrayList(u8),
+    path: []const u8,
+    source: [:0]const u8,
+) Allocator.Error!void {
+    try appendLength(gpa, shard, path.len);
+    try shard.appendSlice(gpa, path);
+    const text_len_index = shard.items.len;
+    try shard.appendNTimes(gpa, undefined, 4);
+    const text_start = shard.items.len;
+
+    var names: std.StringHashMapUnmanaged(void) = .empty;
+    defer names.deinit(gpa);
+
+    // Each line of the text is either the name of a declaration, or the
+    // consecutive doc comment lines of one declaration concatenated, which is
+    // how the frontend searches them.
+    var tokenizer: Tokenizer = .init(source);
+    var prev_tag: std.zig.Token.Tag = .invalid;
+    while (true) {
+        const token = tokenizer.next();
+        const is_doc_comment = switch (token.tag) {
+            .doc_comment, .container_doc_comment => true,
+            else => false,
+        };
+        if (!is_doc_comment and (prev_tag == .doc_comment or prev_tag == .container_doc_comment)) {
+            try shard.append(gpa, '\n');
+        }
+        switch (token.tag) {
+            .eof => break,
+            .doc_comment, .container_doc_comment => {
+                try shard.appendSlice(gpa, source[token.loc.start + 3 .. token.loc.end]);
+            },
+            .identifier => switch (prev_tag) {
+                .keyword_const, .keyword_var, .keyword_fn => {
+                    const name = source[token.loc.start..token.loc.end];
+                    const gop = try names.getOrPut(gpa, name);
+                    if (!gop.found_existing) {
+                        try shard.appendSlice(gpa, name);
+                        try shard.append(gpa, '\n');
+                    }
+                },
+                else => {},
+            },
+            else => {},
+        }
+        prev_tag = token.tag;
+    }
+
+    std.mem.writeInt(u32, shard.items[text_len_index..][0..4], @intCast(shard.items.len - text_start), .little);
+}
+
+fn appendLength(gpa: Allocator, shard: *std.ArrayList(u8), len: usize) Allocator.Error!void {
+    var bytes: [4]u8 = undefined;
+    std.mem.writeInt(u32, &bytes, @intCast(len), .little);
+    try shard.appendSlice(gpa, &bytes);
+}
+
+pub const Record = struct {
+    path: []const u8,
+    text: []const u8,
+};
+
+pub const Iterator = struct {
+    bytes: []const u8,
+    index: usize = 0,
+
+    /// Returns null at the end of the shard, or if the shard is malformed.
+    pub fn next(it: *Iterator) ?Record {
+        const path = it.takeSlice() orelse return null;
+        const text = it.takeSlice() orelse return null;
+        return .{ .path = path, .text = text };
+    }
+
+    fn takeSlice(it: *Iterator) ?[]const u8 {
+        if (it.bytes.len - it.index < 4) return null;
+        const len = std.mem.readInt(u32, it.bytes[it.index..][0..4], .little);
+        it.index += 4;
+        if (it.bytes.len - it.index < len) return null;
+        defer it.index += len;
+        return it.bytes[it.index..][0..len];
+    }
+};
+
+/// Returns false only if no declaration in the file with the given record can
+/// match `query`. Every space-separated term of a query must be found in the
+/// fully qualified name of a declaration or in its doc comment. As a fully
+/// qualified name is the module name or file path followed by declaration
+/// names, joined by '.', each '.'-separated part of a term must then be found
+/// in `record.path` or `record.text`. Case is ignored.
+pub fn mayMatch(record: Record, query: []const u8) bool {
+    var terms = std.mem.tokenizeScalar(u8, query, ' ');
+    while (terms.next()) |term| {
+        var parts = std.mem.tokenizeScalar(u8, term, '.');
+        while (parts.next()) |part| {
+            if (std.ascii.indexOfIgnoreCase(record.text, part) == null and
+                std.ascii.indexOfIgnoreCase(record.path, part) == null)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+test mayMatch {
+    const gpa = std.testing.allocator;
+    var shard: std.ArrayList(u8) = .empty;
+    defer shard.deinit(gpa);
+    try appendFile(gpa, &shard, "std/mem/Allocator.zig",
+        \\//! The interface of memory
+        \\//! allocators.
+        \\pub fn alloc() void {}
+        \\/// Resizes in
+        \\// not a doc comment
+        \\/// place.
+        \\pub const Resize = struct { x: u8 };
+        \\const alloc = 1;
+        \\
+    );
+    try appendFile(gpa, &shard, "std/empty.zig", "");
+
+    var it: Iterator = .{ .bytes = shard.items };
+    const record = it.next().?;
+    try std.testing.expectEqualStrings("std/mem/Allocator.zig", record.path);
+    try std.testing.expectEqualStrings(
+        " The interface of memory allocators.\nalloc\n Resizes in place.\nResize\n",
+        record.text,
+    );
+    const empty = it.next().?;
+    try std.testing.expectEqualStrings("std/empty.zig", empty.path);
+    try std.testing.expectEqualStrings("", empty.text);
+    try std.testing.expect(it.next() == null);
+
+    try std.testing.expect(mayMatch(record, "std.mem.Allocator.alloc"));
+    try std.testing.expect(mayMatch(record, "allocator.resize"));
+    try std.testing.expect(mayMatch(record, "esizes memory"));
+    try std.testing.expect(mayMatch(record, "in place"));
+    try std.testing.expect(!mayMatch(record, "free"));
+    try std.testing.expect(!mayMatch(record, "mem.x"));
+    try std.testing.expect(mayMatch(empty, "std.empty"));
+}
@@ -14,6 +14,7 @@ pub const NativePaths = @import("system/NativePaths.zig");
 pub const windows = @import("system/windows.zig");
 pub const darwin = @import("system/darwin.zig");
 pub const linux = @import("system/linux.zig");
+pub const x86 = @import("system/x86.zig");
 
 pub const Executor = union(enum) {
     native,
@@ -532,7 +533,7 @@ fn detectNativeCpuAndFeatures(io: Io, cpu_arch: Target.Cpu.Arch, os: Target.Os,
     // of the respective switch prong.
     switch (builtin.cpu.arch) {
         .loongarch32, .loongarch64 => return @import("system/loongarch.zig").detectNativeCpuAndFeatures(cpu_arch, os, query),
-        .x86_64, .x86 => return @import("system/x86.zig").detectNativeCpuAndFeatures(cpu_arch, os, query),
+        .x86_64, .x86 => return x86.detectNativeCpuAndFeatures(cpu_arch, os, query),
         else => {},
     }
 
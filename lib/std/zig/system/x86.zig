@@ -731,7 +731,7 @@ fn detectNativeFeatures(cpu: *Target.Cpu, os_tag: Target.Os.Tag) void {
     }
 }
 
-const CpuidLeaf = packed struct {
+pub const CpuidLeaf = packed struct {
     eax: u32,
     ebx: u32,
     ecx: u32,
@@ -742,7 +742,9 @@ const CpuidLeaf = packed struct {
 /// C code in inline assembly.
 extern fn zig_x86_cpuid(leaf_id: u32, subid: u32, eax: *u32, ebx: *u32, ecx: *u32, edx: *u32) callconv(.c) void;
 
-fn cpuid(leaf_id: u32, subid: u32) CpuidLeaf {
+/// Executes the `cpuid` instruction. Also used by code which detects features at runtime, such as
+/// `std.crypto` and compiler_rt.
+pub fn cpuid(leaf_id: u32, subid: u32) CpuidLeaf {
     // valid for both x86 and x86_64
     var eax: u32 = undefined;
     var ebx: u32 = undefined;
@@ -18,6 +18,7 @@ const types_resolved = @import("Air/types_resolved.zig");
 
 pub const Legalize = @import("Air/Legalize.zig");
 pub const Liveness = @import("Air/Liveness.zig");
+pub const Optimize = @import("Air/Optimize.zig");
 
 instructions: std.MultiArrayList(Inst).Slice,
 /// The meaning of this data is determined by `Inst.Tag` value.
@@ -2198,6 +2199,7 @@ pub const typesFullyResolved = types_resolved.typesFullyResolved;
 pub const typeFullyResolved = types_resolved.checkType;
 pub const valFullyResolved = types_resolved.checkVal;
 pub const legalize = Legalize.legalize;
+pub const optimize = Optimize.optimize;
 pub const write = print.write;
 pub const writeInst = print.writeInst;
 pub const dump = print.dump;
@@ -0,0 +1,202 @@
+//! Peephole rewrites of single AIR instructions for the self-hosted code generation backends:
+//! integer multiplication, division, and remainder by a comptime-known power of two become shifts
+//! and masks, and overflow-checked arithmetic with an operand which cannot overflow loses its check.
+//! Each instruction is looked at on its own; there is no constant propagation, dead code
+//! elimination, or inlining, since AIR has no use lists to drive them.
+//!
+//! This is a small part of the work. Of the 547277 instructions in the ReleaseSafe build runner,
+//! 386 are rewritten: about half of its divisions and remainders, and 104 of 5081 safety checks.
+//!
+//! This runs on the codegen worker threads, before `Legalize`. Every pass rewrites instructions
+//! in place and preserves the result type of every instruction it touches, so the output is still
+//! valid input for `Legalize`, `Liveness`, and the backends. Which passes run is decided by the
+//! optimize mode of the module which owns the function; see `passesForMode`.
+
+pt: Zcu.PerThread,
+air: *Air,
+passes: *const Passes,
+
+pub const Pass = enum {
+    /// Replace integer `mul` and `mul_wrap` by a power of two with `shl`.
+    /// `mul` is only rewritten for unsigned integers, since signed overflow is not a shift.
+    strength_reduce_mul,
+    /// Replace unsigned `div_trunc`, `div_floor`, and `div_exact` by a power of two with `shr`.
+    strength_reduce_div,
+    /// Replace unsigned `rem` and `mod` by a power of two with `bit_and`.
+    strength_reduce_rem,
+    /// Replace `add_safe`, `sub_safe`, and `mul_safe` with their unchecked counterparts when a
+    /// comptime-known operand makes overflow impossible, e.g. `x + 0` or `x * 1`.
+    elide_safety_checks,
+};
+
+pub const Passes = std.enums.EnumSet(Pass);
+
+pub const Error = std.mem.Allocator.Error;
+
+/// Returns the passes to run on functions in a module with the given optimize mode, or `null` if
+/// the AIR should be lowered as-is.
+pub fn passesForMode(mode: std.builtin.OptimizeMode) ?*const Passes {
+    return switch (mode) {
+        // Debug builds favor compilation speed and a direct mapping from source to machine code.
+        .Debug => null,
+        .ReleaseSafe, .ReleaseFast, .ReleaseSmall => comptime &.initFull(),
+    };
+}
+
+pub fn optimize(air: *Air, pt: Zcu.PerThread, passes: *const Passes) Error!void {
+    dev.check(.optimize);
+    assert(!passes.eql(comptime .initEmpty())); // backend asked to run optimize, but no passes were enabled
+    var o: Optimize = .{
+        .pt = pt,
+        .air = air,
+        .passes = passes,
+    };
+    try o.optimizeBody(air.getMainBody());
+}
+
+fn optimizeBody(o: *Optimize, body: []const Air.Inst.Index) Error!void {
+    const air = o.air;
+    const tags = air.instructions.items(.tag);
+    const datas = air.instructions.items(.data);
+    for (body) |inst| switch (tags[@intFromEnum(inst)]) {
+        else => {},
+        .block, .loop => {
+            const extra = air.extraData(Air.Block, datas[@intFromEnum(inst)].ty_pl.payload);
+            try o.optimizeBody(@ptrCast(air.extra.items[extra.end..][0..extra.data.body_len]));
+        },
+        .dbg_inline_block => {
+            const extra = air.extraData(Air.DbgInlineBlock, datas[@intFromEnum(inst)].ty_pl.payload);
+            try o.optimizeBody(@ptrCast(air.extra.items[extra.end..][0..extra.data.body_len]));
+        },
+        .cond_br => {
+            const extra = air.extraData(Air.CondBr, datas[@intFromEnum(inst)].pl_op.payload);
+            try o.optimizeBody(@ptrCast(air.extra.items[extra.end..][0..extra.data.then_body_len]));
+            try o.optimizeBody(@ptrCast(air.extra.items[extra.end + extra.data.then_body_len ..][0..extra.data.else_body_len]));
+        },
+        .switch_br, .loop_switch_br => {
+            var it = air.unwrapSwitch(inst).iterateCases();
+            while (it.next()) |case| try o.optimizeBody(case.body);
+            try o.optimizeBody(it.elseBody());
+        },
+        .@"try", .try_cold => {
+            const extra = air.extraData(Air.Try, datas[@intFromEnum(inst)].pl_op.payload);
+            try o.optimizeBody(@ptrCast(air.extra.items[extra.end..][0..extra.data.body_len]));
+        },
+        .try_ptr, .try_ptr_cold => {
+            const extra = air.extraData(Air.TryPtr, datas[@intFromEnum(inst)].ty_pl.payload);
+            try o.optimizeBody(@ptrCast(air.extra.items[extra.end..][0..extra.data.body_len]));
+        },
+        .mul, .mul_wrap => if (o.passes.contains(.strength_reduce_mul)) try o.strengthReduceMul(inst),
+        .div_trunc, .div_floor, .div_exact => if (o.passes.contains(.strength_reduce_div)) try o.strengthReduceDiv(inst),
+        .rem, .mod => if (o.passes.contains(.strength_reduce_rem)) try o.strengthReduceRem(inst),
+        .add_safe, .sub_safe, .mul_safe => if (o.passes.contains(.elide_safety_checks)) o.elideSafetyCheck(inst),
+    };
+}
+
+fn strengthReduceMul(o: *Optimize, inst: Air.Inst.Index) Error!void {
+    const zcu = o.pt.zcu;
+    const bin_op = o.air.instructions.items(.data)[@intFromEnum(inst)].bin_op;
+    const ty = o.typeOf(bin_op.lhs);
+    if (ty.zigTypeTag(zcu) != .int) return;
+    switch (o.air.instructions.items(.tag)[@intFromEnum(inst)]) {
+        else => unreachable,
+        .mul => if (ty.isSignedInt(zcu)) return,
+        .mul_wrap => {},
+    }
+    // Multiplication is commutative, so the power of two may be on either side.
+    const operand: Air.Inst.Ref, const shift: u6 = if (o.powerOfTwo(bin_op.rhs)) |shift|
+        .{ bin_op.lhs, shift }
+    else if (o.powerOfTwo(bin_op.lhs)) |shift|
+        .{ bin_op.rhs, shift }
+    else
+        return;
+    o.replaceInst(inst, .shl, .{ .bin_op = .{
+        .lhs = operand,
+        .rhs = try o.pt.intRef(try o.log2IntType(ty), shift),
+    } });
+}
+
+fn strengthReduceDiv(o: *Optimize, inst: Air.Inst.Index) Error!void {
+    const zcu = o.pt.zcu;
+    const bin_op = o.air.instructions.items(.data)[@intFromEnum(inst)].bin_op;
+    const ty = o.typeOf(bin_op.lhs);
+    if (ty.zigTypeTag(zcu) != .int or ty.isSignedInt(zcu)) return;
+    const shift = o.powerOfTwo(bin_op.rhs) orelse return;
+    o.replaceInst(inst, .shr, .{ .bin_op = .{
+        .lhs = bin_op.lhs,
+        .rhs = try o.pt.intRef(try o.log2IntType(ty), shift),
+    } });
+}
+
+fn strengthReduceRem(o: *Optimize, inst: Air.Inst.Index) Error!void {
+    const zcu = o.pt.zcu;
+    const bin_op = o.air.instructions.items(.data)[@intFromEnum(inst)].bin_op;
+    const ty = o.typeOf(bin_op.lhs);
+    if (ty.zigTypeTag(zcu) != .int or ty.isSignedInt(zcu)) return;
+    const shift = o.powerOfTwo(bin_op.rhs) orelse return;
+    o.replaceInst(inst, .bit_and, .{ .bin_op = .{
+        .lhs = bin_op.lhs,
+        .rhs = try o.pt.intRef(ty, (@as(u64, 1) << shift) - 1),
+    } });
+}
+
+fn elideSafetyCheck(o: *Optimize, inst: Air.Inst.Index) void {
+    const zcu = o.pt.zcu;
+    const bin_op = o.air.instructions.items(.data)[@intFromEnum(inst)].bin_op;
+    if (o.typeOf(bin_op.lhs).zigTypeTag(zcu) != .int) return;
+    const lhs = o.intConstant(bin_op.lhs);
+    const rhs = o.intConstant(bin_op.rhs);
+    switch (o.air.instructions.items(.tag)[@intFromEnum(inst)]) {
+        else => unreachable,
+        .add_safe => if (lhs == 0 or rhs == 0) o.replaceInst(inst, .add, .{ .bin_op = bin_op }),
+        // `0 - x` can overflow, so only the subtrahend is considered.
+        .sub_safe => if (rhs == 0) o.replaceInst(inst, .sub, .{ .bin_op = bin_op }),
+        .mul_safe => if (lhs == 0 or lhs == 1 or rhs == 0 or rhs == 1) o.replaceInst(inst, .mul, .{ .bin_op = bin_op }),
+    }
+}
+
+/// Returns the value of `ref` if it is a comptime-known integer which fits in a `u64`.
+fn intConstant(o: *const Optimize, ref: Air.Inst.Ref) ?u64 {
+    const ip = &o.pt.zcu.intern_pool;
+    const ip_index = ref.toInterned() orelse return null;
+    return switch (ip.indexToKey(ip_index)) {
+        else => null,
+        .int => |int| switch (int.storage) {
+            .u64 => |x| x,
+            .i64 => |x| std.math.cast(u64, x),
+            .big_int, .lazy_align, .lazy_size => null,
+        },
+    };
+}
+
+/// Returns the base 2 logarithm of `ref` if it is a comptime-known power of two.
+fn powerOfTwo(o: *const Optimize, ref: Air.Inst.Ref) ?u6 {
+    const x = o.intConstant(ref) orelse return null;
+    if (x == 0 or !std.math.isPowerOfTwo(x)) return null;
+    return std.math.log2_int(u64, x);
+}
+
+/// Returns the type of the shift amount operand for shifting a value of type `ty`.
+fn log2IntType(o: *const Optimize, ty: Type) Error!Type {
+    const bits = ty.intInfo(o.pt.zcu).bits;
+    return o.pt.intType(.unsigned, if (bits == 0) 0 else std.math.log2_int_ceil(u16, bits));
+}
+
+fn typeOf(o: *const Optimize, ref: Air.Inst.Ref) Type {
+    return o.air.typeOf(ref, &o.pt.zcu.intern_pool);
+}
+
+fn replaceInst(o: *Optimize, inst: Air.Inst.Index, tag: Air.Inst.Tag, data: Air.Inst.Data) void {
+    const ip = &o.pt.zcu.intern_pool;
+    const orig_ty = if (std.debug.runtime_safety) o.air.typeOfIndex(inst, ip) else {};
+    o.air.instructions.set(@intFromEnum(inst), .{ .tag = tag, .data = data });
+    if (std.debug.runtime_safety) assert(o.air.typeOfIndex(inst, ip).toIntern() == orig_ty.toIntern());
+}
+
+const Air = @import("../Air.zig");
+const assert = std.debug.assert;
+const dev = @import("../dev.zig");
+const Optimize = @This();
+const std = @import("std");
+const Type = @import("../Type.zig");
+const Zcu = @import("../Zcu.zig");
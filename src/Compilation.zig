@@ -157,6 +157,12 @@ failed_win32_resources: if (dev.env.supports(.win32_resource)) std.AutoArrayHash
 /// Miscellaneous things that can fail.
 misc_failures: std.AutoArrayHashMapUnmanaged(MiscTask, MiscError) = .empty,
 
+/// The files archived by the previous `-femit-docs` update, keyed by path in
+/// `sources.tar`, along with their records of `std.zig.docs_index`. Files
+/// whose size and mtime did not change since then are archived without being
+/// read into memory, and keep their record.
+docs_sources: std.StringArrayHashMapUnmanaged(DocsSource) = .empty,
+
 /// When this is `true` it means invoking clang as a sub-process is expected to inherit
 /// stdin, stdout, stderr, and if it returns non success, to forward the exit code.
 /// Otherwise we attempt to parse the error messages and expose them via the Compilation API.
@@ -262,6 +268,10 @@ link_prog_node: std.Progress.Node = .none,
 llvm_opt_bisect_limit: c_int,
 
 time_report: ?TimeReport,
+/// Set by `--time-report-phases`. Only the timings of whole phases are reported, and unlike with
+/// `--time-report`, cache hits are not ignored.
+time_report_phases_only: bool,
+mem_report: ?MemReport,
 
 file_system_inputs: ?*std.ArrayList(u8),
 
@@ -888,12 +898,36 @@ pub const TimeReport = struct {
     /// Every key in `decl_link_ns` is also in `decl_sema_ns`.
     decl_link_ns: std.AutoArrayHashMapUnmanaged(InternPool.TrackedInst.Index, u64),
 
+    /// Key is a ZIR `declaration` instruction which is a function; value describes the calls to it
+    /// which were evaluated at compile time, and the runtime calls to it if it is generic. As above,
+    /// this is the total across all instances of the generic parent namespace.
+    /// An entry not existing means the function has not been called in either of these ways.
+    decl_call_info: std.AutoArrayHashMapUnmanaged(InternPool.TrackedInst.Index, CallInfo),
+
+    pub const CallInfo = struct {
+        /// The number of `comptime` calls, including those answered by memoization.
+        comptime_count: u32 = 0,
+        /// The number of `comptime` calls whose result was found in the `InternPool`.
+        comptime_memoized_count: u32 = 0,
+        /// Backwards branches evaluated by `comptime` calls, including nested calls. For memoized
+        /// calls, this is the number of branches of the original call.
+        comptime_branches: u64 = 0,
+        /// Nanoseconds spent evaluating `comptime` calls, including nested calls and any analysis
+        /// they trigger.
+        comptime_ns: u64 = 0,
+        /// The number of runtime calls of a generic function.
+        generic_count: u32 = 0,
+        /// The number of `generic_count` calls which created a new instance.
+        generic_instances: u32 = 0,
+    };
+
     pub fn deinit(tr: *TimeReport, gpa: Allocator) void {
         tr.stats = undefined;
         gpa.free(tr.llvm_pass_timings);
         tr.decl_sema_info.deinit(gpa);
         tr.decl_codegen_ns.deinit(gpa);
         tr.decl_link_ns.deinit(gpa);
+        tr.decl_call_info.deinit(gpa);
     }
 
     pub const init: TimeReport = .{
@@ -902,6 +936,38 @@ pub const TimeReport = struct {
         .decl_sema_info = .empty,
         .decl_codegen_ns = .empty,
         .decl_link_ns = .empty,
+        .decl_call_info = .empty,
+    };
+};
+
+pub const MemReport = struct {
+    /// Key is a ZIR `declaration` instruction. As with `TimeReport.decl_sema_info`, the value is
+    /// the total across all instances of the generic parent namespace and all generic instances.
+    decls: std.AutoArrayHashMapUnmanaged(InternPool.TrackedInst.Index, Decl),
+    /// Set if the dependency tables were compacted at the end of the update.
+    dependency_gc: ?InternPool.DependencyGcStats,
+
+    pub const Decl = struct {
+        /// Bytes added to the `InternPool` while analyzing this declaration, excluding analysis of
+        /// other declarations triggered by it.
+        ip_bytes: u64 = 0,
+        /// Bytes of AIR produced for function bodies.
+        air_bytes: u64 = 0,
+        /// Size of the largest single AIR in `air_bytes`.
+        max_air_bytes: u32 = 0,
+        sema_count: u32 = 0,
+        /// Bytes the linker holds for the `Nav`s of this declaration which were linked during the
+        /// update. Only tracked by the C, ELF and Mach-O linkers; see `link.File.navAtomSize`.
+        link_bytes: u64 = 0,
+    };
+
+    pub fn deinit(mr: *MemReport, gpa: Allocator) void {
+        mr.decls.deinit(gpa);
+    }
+
+    pub const init: MemReport = .{
+        .decls = .empty,
+        .dependency_gc = null,
     };
 };
 
@@ -1682,6 +1748,10 @@ pub const CreateOptions = struct {
     function_sections: bool = false,
     data_sections: bool = false,
     time_report: bool = false,
+    /// Collect a time report like `time_report`, but without ignoring cache hits, and only report
+    /// the timings of whole phases. Has no effect if `time_report` is set.
+    time_report_phases: bool = false,
+    mem_report: bool = false,
     stack_report: bool = false,
     link_eh_frame_hdr: bool = false,
     link_emit_relocs: bool = false,
@@ -1747,6 +1817,8 @@ pub const CreateOptions = struct {
     force_undefined_symbols: std.StringArrayHashMapUnmanaged(void) = .empty,
     stack_size: ?u64 = null,
     image_base: ?u64 = null,
+    /// (C) Split the output into this many translation units.
+    c_shards: ?u32 = null,
     version: ?std.SemanticVersion = null,
     compatibility_version: ?std.SemanticVersion = null,
     libc_installation: ?*const LibCInstallation = null,
@@ -2252,7 +2324,9 @@ pub fn create(gpa: Allocator, arena: Allocator, io: Io, diag: *CreateDiagnostic,
             .verbose_link = options.verbose_link,
             .disable_c_depfile = options.disable_c_depfile,
             .reference_trace = options.reference_trace,
-            .time_report = if (options.time_report) .init else null,
+            .time_report = if (options.time_report or options.time_report_phases) .init else null,
+            .time_report_phases_only = options.time_report_phases and !options.time_report,
+            .mem_report = if (options.mem_report) .init else null,
             .stack_report = options.stack_report,
             .test_filters = options.test_filters,
             .debug_compiler_runtime_libs = options.debug_compiler_runtime_libs,
@@ -2345,6 +2419,7 @@ pub fn create(gpa: Allocator, arena: Allocator, io: Io, diag: *CreateDiagnostic,
             .print_gc_sections = options.linker_print_gc_sections,
             .print_icf_sections = options.linker_print_icf_sections,
             .print_map = options.linker_print_map,
+            .c_shards = options.c_shards orelse 1,
             .tsaware = options.linker_tsaware,
             .nxcompat = options.linker_nxcompat,
             .dynamicbase = options.linker_dynamicbase,
@@ -2754,9 +2829,16 @@ pub fn destroy(comp: *Compilation) void {
     comp.failed_win32_resources.deinit(gpa);
 
     if (comp.time_report) |*tr| tr.deinit(gpa);
+    if (comp.mem_report) |*mr| mr.deinit(gpa);
 
     comp.link_diags.deinit();
 
+    for (comp.docs_sources.keys(), comp.docs_sources.values()) |path, *source| {
+        gpa.free(path);
+        source.deinit(gpa);
+    }
+    comp.docs_sources.deinit(gpa);
+
     comp.clearMiscFailures();
 
     comp.cache_parent.manifest_dir.close();
@@ -2872,6 +2954,12 @@ pub fn update(comp: *Compilation, main_progress_node: std.Progress.Node) UpdateE
         tr.deinit(gpa); // this is information about an old update
         tr.* = .init;
     }
+    if (comp.mem_report) |*mr| {
+        mr.deinit(gpa);
+        mr.* = .init;
+        // The link queue is idle between updates.
+        comp.link_task_queue.air_bytes_peak = 0;
+    }
 
     var tmp_dir_rand_int: u64 = undefined;
     var man: Cache.Manifest = undefined;
@@ -2903,8 +2991,10 @@ pub fn update(comp: *Compilation, main_progress_node: std.Progress.Node) UpdateE
             whole.cache_manifest = &man;
             try addNonIncrementalStuffToCacheManifest(comp, arena, &man);
 
-            // Under `--time-report`, ignore cache hits; do the work anyway for those juicy numbers.
-            const ignore_hit = comp.time_report != null;
+            // Under `--time-report` or `--mem-report`, ignore cache hits; do the work anyway for
+            // those juicy numbers.
+            const ignore_hit = (comp.time_report != null and !comp.time_report_phases_only) or
+                comp.mem_report != null;
 
             if (ignore_hit) {
                 // We're going to do the work regardless of whether this is a hit or a miss.
@@ -3095,6 +3185,14 @@ pub fn update(comp: *Compilation, main_progress_node: std.Progress.Node) UpdateE
             });
             zcu.intern_pool.dumpGenericInstances(gpa);
         }
+
+        // Re-analysis can leave many dependency entries unused, for example when function bodies
+        // shrink, so the dependency tables are compacted once enough of them is. This does not
+        // reclaim any other memory of the `InternPool`.
+        if (zcu.intern_pool.wantDependencyGarbageCollection()) {
+            const stats = try zcu.intern_pool.collectDependencyGarbage(gpa);
+            if (comp.mem_report) |*mr| mr.dependency_gc = stats;
+        }
     }
 
     if (anyErrors(comp)) {
@@ -3484,6 +3582,7 @@ fn addNonIncrementalStuffToCacheManifest(
     man.hash.addOptional(opts.stack_size);
     man.hash.addOptional(opts.image_base);
     man.hash.addOptional(opts.gc_sections);
+    man.hash.add(opts.c_shards);
     man.hash.add(opts.emit_relocs);
     const target = &comp.root_mod.resolved_target.result;
     if (target.ofmt == .macho or target.ofmt == .coff) {
@@ -5050,6 +5149,7 @@ fn processOneJob(tid: usize, comp: *Compilation, job: Job) JobError!void {
             // using a lot of memory). If this would cause too many AIR bytes to be in-flight, we
             // will block on the `dispatchZcuLinkTask` call below.
             const air_bytes: u32 = @intCast(air.instructions.len * 5 + air.extra.items.len * 4);
+            if (comp.mem_report != null) comp.reportAirBytes(func.func, air_bytes);
             if (comp.separateCodegenThreadOk()) {
                 // `workerZcuCodegen` takes ownership of `air`.
                 comp.thread_pool.spawnWgId(&comp.link_task_wait_group, workerZcuCodegen, .{ comp, func.func, air, shared_mir });
@@ -5248,6 +5348,27 @@ fn docsCopyFallible(comp: *Compilation) anyerror!void {
     var buffer: [1024]u8 = undefined;
     var tar_file_writer = tar_file.writer(&buffer);
 
+    var search_dir = out_dir.makeOpenPath("search", .{}) catch |err| {
+        return comp.lockAndSetMiscFailure(
+            .docs_copy,
+            "unable to create directory '{f}/search': {t}",
+            .{ docs_path, err },
+        );
+    };
+    defer search_dir.close();
+
+    var index: DocsIndex = .{ .search_dir = search_dir, .docs_path = docs_path };
+    defer {
+        // Files which this update did not archive are forgotten.
+        for (comp.docs_sources.keys(), comp.docs_sources.values()) |path, *source| {
+            comp.gpa.free(path);
+            source.deinit(comp.gpa);
+        }
+        comp.docs_sources.deinit(comp.gpa);
+        comp.docs_sources = index.sources;
+        index.shard.deinit(comp.gpa);
+    }
+
     var seen_table: std.AutoArrayHashMapUnmanaged(*Package.Module, []const u8) = .empty;
     defer seen_table.deinit(comp.gpa);
 
@@ -5257,7 +5378,7 @@ fn docsCopyFallible(comp: *Compilation) anyerror!void {
     var i: usize = 0;
     while (i < seen_table.count()) : (i += 1) {
         const mod = seen_table.keys()[i];
-        try comp.docsCopyModule(mod, seen_table.values()[i], &tar_file_writer);
+        try comp.docsCopyModule(mod, seen_table.values()[i], &tar_file_writer, &index);
 
         const deps = mod.deps.values();
         try seen_table.ensureUnusedCapacity(comp.gpa, deps.len);
@@ -5271,6 +5392,57 @@ fn docsCopyFallible(comp: *Compilation) anyerror!void {
             .{ docs_path, err },
         );
     };
+
+    if (index.sources.count() % std.zig.docs_index.files_per_shard != 0) {
+        comp.docsWriteSearchShard(&index);
+    }
+}
+
+/// Builds the shards of `std.zig.docs_index` while `sources.tar` is written, so
+/// that each file only needs to be in memory while it is archived and indexed.
+const DocsIndex = struct {
+    search_dir: fs.Dir,
+    docs_path: Cache.Path,
+    /// The files archived so far, in order.
+    sources: std.StringArrayHashMapUnmanaged(DocsSource) = .empty,
+    /// The records of the files of the shard being built.
+    shard: std.ArrayList(u8) = .empty,
+};
+
+const DocsSource = struct {
+    size: u64,
+    mtime: Io.Timestamp,
+    /// A record of `std.zig.docs_index`.
+    index_record: []const u8,
+
+    fn deinit(source: *DocsSource, gpa: Allocator) void {
+        gpa.free(source.index_record);
+    }
+};
+
+/// Takes ownership of `path` and `source`.
+fn docsIndexAdd(comp: *Compilation, index: *DocsIndex, path: []const u8, source: DocsSource) !void {
+    const gpa = comp.gpa;
+    index.sources.putAssumeCapacityNoClobber(path, source);
+    try index.shard.appendSlice(gpa, source.index_record);
+    if (index.sources.count() % std.zig.docs_index.files_per_shard == 0) {
+        comp.docsWriteSearchShard(index);
+    }
+}
+
+/// Writes the shard of the most recently added file, then starts the next one.
+fn docsWriteSearchShard(comp: *Compilation, index: *DocsIndex) void {
+    defer index.shard.clearRetainingCapacity();
+    const shard_index = (index.sources.count() - 1) / std.zig.docs_index.files_per_shard;
+    var name_buf: [16]u8 = undefined;
+    const name = std.fmt.bufPrint(&name_buf, "{d}.bin", .{shard_index}) catch unreachable;
+    index.search_dir.writeFile(.{ .sub_path = name, .data = index.shard.items }) catch |err| {
+        return comp.lockAndSetMiscFailure(
+            .docs_copy,
+            "unable to write '{f}/search/{s}': {t}",
+            .{ index.docs_path, name, err },
+        );
+    };
 }
 
 fn docsCopyModule(
@@ -5278,7 +5450,9 @@ fn docsCopyModule(
     module: *Package.Module,
     name: []const u8,
     tar_file_writer: *fs.File.Writer,
+    index: *DocsIndex,
 ) !void {
+    const gpa = comp.gpa;
     const io = comp.io;
     const root = module.root;
     var mod_dir = d: {
@@ -5289,7 +5463,7 @@ fn docsCopyModule(
     };
     defer mod_dir.close();
 
-    var walker = try mod_dir.walk(comp.gpa);
+    var walker = try mod_dir.walk(gpa);
     defer walker.deinit();
 
     var archiver: std.tar.Writer = .{ .underlying_writer = &tar_file_writer.interface };
@@ -5315,11 +5489,56 @@ fn docsCopyModule(
         const stat = try file.stat();
         var file_reader: fs.File.Reader = .initSize(file.adaptToNewApi(), io, &buffer, stat.size);
 
-        archiver.writeFileTimestamp(entry.path, &file_reader, stat.mtime) catch |err| {
+        try index.sources.ensureUnusedCapacity(gpa, 1);
+        const path = try std.fmt.allocPrint(gpa, "{s}/{s}", .{ name, entry.path });
+        var path_owned = true;
+        defer if (path_owned) gpa.free(path);
+
+        // A file which did not change since the previous update is streamed
+        // into the archive and keeps its record.
+        if (comp.docs_sources.fetchSwapRemove(path)) |kv| {
+            gpa.free(kv.key);
+            var source = kv.value;
+            if (source.size == stat.size and source.mtime.nanoseconds == stat.mtime.nanoseconds) {
+                archiver.writeFile(entry.path, &file_reader, @intCast(stat.mtime.toSeconds())) catch |err| {
+                    source.deinit(gpa);
+                    return comp.lockAndSetMiscFailure(.docs_copy, "unable to archive {f}{s}: {t}", .{
+                        root.fmt(comp), entry.path, err,
+                    });
+                };
+                path_owned = false;
+                try comp.docsIndexAdd(index, path, source);
+                continue;
+            }
+            source.deinit(gpa);
+        }
+
+        const bytes = file_reader.interface.allocRemainingAlignedSentinel(gpa, .unlimited, .of(u8), 0) catch |err| switch (err) {
+            error.OutOfMemory => |e| return e,
+            error.ReadFailed, error.StreamTooLong => {
+                return comp.lockAndSetMiscFailure(.docs_copy, "unable to read {f}{s}: {t}", .{
+                    root.fmt(comp), entry.path, file_reader.err orelse err,
+                });
+            },
+        };
+        defer gpa.free(bytes);
+
+        archiver.writeFileBytes(entry.path, bytes, .{ .mtime = @intCast(stat.mtime.toSeconds()) }) catch |err| {
             return comp.lockAndSetMiscFailure(.docs_copy, "unable to archive {f}{s}: {t}", .{
                 root.fmt(comp), entry.path, err,
             });
         };
+
+        var index_record: std.ArrayList(u8) = .empty;
+        defer index_record.deinit(gpa);
+        try std.zig.docs_index.appendFile(gpa, &index_record, path, bytes);
+        const source: DocsSource = .{
+            .size = stat.size,
+            .mtime = stat.mtime,
+            .index_record = try index_record.toOwnedSlice(gpa),
+        };
+        path_owned = false;
+        try comp.docsIndexAdd(index, path, source);
     }
 }
 
@@ -5671,6 +5890,8 @@ pub fn translateC(
     {
         const target = &owner_mod.resolved_target.result;
         try argv.appendSlice(&.{ "--zig-integration", "-x", "c" });
+        // Rendering uses at most as many threads as this compilation.
+        try argv.append(try std.fmt.allocPrint(arena, "-j{d}", .{@max(1, comp.thread_pool.threads.len)}));
 
         const resource_path = try comp.dirs.zig_lib.join(arena, &.{ "compiler", "aro", "include" });
         try argv.appendSlice(&.{ "-isystem", resource_path });
@@ -7682,6 +7903,136 @@ fn wantBuildLibUnwindFromSource(comp: *Compilation) bool {
     return is_exe_or_dyn_lib and comp.config.link_libunwind and ofmt != .c;
 }
 
+fn reportAirBytes(comp: *Compilation, func_index: InternPool.Index, air_bytes: u32) void {
+    const ip = &comp.zcu.?.intern_pool;
+    const zir_decl = ip.getNav(ip.indexToKey(func_index).func.owner_nav).srcInst(ip);
+    comp.mutex.lock();
+    defer comp.mutex.unlock();
+    const gop = comp.mem_report.?.decls.getOrPut(comp.gpa, zir_decl) catch |err| switch (err) {
+        error.OutOfMemory => return comp.setAllocFailure(),
+    };
+    if (!gop.found_existing) gop.value_ptr.* = .{};
+    gop.value_ptr.air_bytes += air_bytes;
+    gop.value_ptr.max_air_bytes = @max(gop.value_ptr.max_air_bytes, air_bytes);
+}
+
+pub fn reportLinkBytes(comp: *Compilation, nav_index: InternPool.Nav.Index, link_bytes: u64) void {
+    const ip = &comp.zcu.?.intern_pool;
+    const zir_decl = ip.getNav(nav_index).srcInst(ip);
+    comp.mutex.lock();
+    defer comp.mutex.unlock();
+    const gop = comp.mem_report.?.decls.getOrPut(comp.gpa, zir_decl) catch |err| switch (err) {
+        error.OutOfMemory => return comp.setAllocFailure(),
+    };
+    if (!gop.found_existing) gop.value_ptr.* = .{};
+    gop.value_ptr.link_bytes += link_bytes;
+}
+
+/// The totals of the data collected under `--mem-report` for the last update. `tag_stats` is the
+/// result of `InternPool.tagStats`.
+pub fn memReportStats(
+    comp: *Compilation,
+    tag_stats: *const std.AutoArrayHashMapUnmanaged(InternPool.Tag, InternPool.TagStats),
+) std.Build.abi.mem_report.CompileResult.Stats {
+    const mr = &comp.mem_report.?;
+    const ip = &comp.zcu.?.intern_pool;
+
+    var ip_bytes: u64 = 0;
+    for (0..ip.locals.len) |tid| ip_bytes += ip.localBytes(@enumFromInt(tid));
+    var link_bytes: u64 = 0;
+    for (mr.decls.values()) |decl| link_bytes += decl.link_bytes;
+    const separate_codegen = comp.separateCodegenThreadOk();
+    const gc: InternPool.DependencyGcStats = mr.dependency_gc orelse .{
+        .entries_reclaimed = 0,
+        .dependees_removed = 0,
+        .bytes_before = 0,
+        .bytes_after = 0,
+    };
+
+    return .{
+        .ip_bytes = ip_bytes,
+        .air_peak_bytes = if (separate_codegen) comp.link_task_queue.air_bytes_peak else 0,
+        .link_bytes = link_bytes,
+        .dependency_gc_bytes_before = gc.bytes_before,
+        .dependency_gc_bytes_after = gc.bytes_after,
+        .dep_entries = @intCast(ip.dep_entries.items.len),
+        .free_dep_entries = @intCast(ip.free_dep_entries.items.len),
+        .dependency_gc_entries_reclaimed = gc.entries_reclaimed,
+        .dependency_gc_dependees_removed = gc.dependees_removed,
+        .removed_items = if (tag_stats.get(.removed)) |stats| @intCast(stats.count) else 0,
+        .flags = .{
+            .separate_codegen = separate_codegen,
+            .dependency_gc = mr.dependency_gc != null,
+        },
+    };
+}
+
+/// Writes the data collected under `--mem-report` for the last update in human-readable form.
+pub fn writeMemReport(comp: *Compilation, w: *std.Io.Writer) (Allocator.Error || std.Io.Writer.Error)!void {
+    const gpa = comp.gpa;
+    const mr = &comp.mem_report.?;
+    const zcu = comp.zcu orelse return;
+    const ip = &zcu.intern_pool;
+
+    var tag_stats = try ip.tagStats(gpa);
+    defer tag_stats.deinit(gpa);
+    const stats = comp.memReportStats(&tag_stats);
+
+    try w.print("memory report for '{s}':\n", .{comp.root_name});
+    try w.print("  InternPool: {Bi:.1}\n", .{stats.ip_bytes});
+    if (stats.flags.separate_codegen) {
+        try w.print("  peak AIR in flight: {Bi:.1}\n", .{stats.air_peak_bytes});
+    }
+    try w.print("  linked: {Bi:.1}\n", .{stats.link_bytes});
+
+    const tags_len = @min(20, tag_stats.count());
+    try w.print("  top {d} InternPool tags:\n", .{tags_len});
+    for (tag_stats.keys()[0..tags_len], tag_stats.values()[0..tags_len]) |tag, tag_stat| {
+        try w.print("    {s}: {d} items, {Bi:.1}\n", .{ @tagName(tag), tag_stat.count, tag_stat.bytes });
+    }
+    if (stats.removed_items > 0) {
+        try w.print("  removed InternPool items: {d}\n", .{stats.removed_items});
+    }
+    try w.print("  dependency tables: {d} entries, {d} free\n", .{
+        stats.dep_entries, stats.free_dep_entries,
+    });
+    if (stats.flags.dependency_gc) {
+        try w.print("  dependency GC: reclaimed {d} entries and {d} dependees, {Bi:.1} -> {Bi:.1}\n", .{
+            stats.dependency_gc_entries_reclaimed,
+            stats.dependency_gc_dependees_removed,
+            stats.dependency_gc_bytes_before,
+            stats.dependency_gc_bytes_after,
+        });
+    }
+
+    const SortContext = struct {
+        values: []const MemReport.Decl,
+        pub fn lessThan(ctx: @This(), a_index: usize, b_index: usize) bool {
+            const a = ctx.values[a_index];
+            const b = ctx.values[b_index];
+            return a.ip_bytes + a.air_bytes + a.link_bytes > b.ip_bytes + b.air_bytes + b.link_bytes;
+        }
+    };
+    mr.decls.sort(SortContext{ .values = mr.decls.values() });
+    const decls_len = @min(30, mr.decls.count());
+    try w.print("  top {d} declarations:\n", .{decls_len});
+    for (mr.decls.keys()[0..decls_len], mr.decls.values()[0..decls_len]) |tracked_inst, decl| {
+        const resolved = tracked_inst.resolveFull(ip) orelse continue;
+        const file = zcu.fileByIndex(resolved.file);
+        const zir = file.zir orelse continue;
+        const decl_name = zir.nullTerminatedString(zir.getDeclaration(resolved.inst).name);
+        try w.print("    {f}: {s}: {Bi:.1} interned over {d} analyses, {Bi:.1} AIR (largest {Bi:.1}), {Bi:.1} linked\n", .{
+            file.path.fmt(comp),
+            decl_name,
+            decl.ip_bytes,
+            decl.sema_count,
+            decl.air_bytes,
+            decl.max_air_bytes,
+            decl.link_bytes,
+        });
+    }
+}
+
 pub fn setAllocFailure(comp: *Compilation) void {
     @branchHint(.cold);
     log.debug("memory allocation failure", .{});
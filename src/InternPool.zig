@@ -996,6 +996,193 @@ pub fn addDependency(ip: *InternPool, gpa: Allocator, depender: AnalUnit, depend
     ip.first_dependency.putAssumeCapacity(depender, new_index);
 }
 
+pub const DependencyGcStats = struct {
+    /// Free and dummy entries discarded from `dep_entries`.
+    entries_reclaimed: u32,
+    /// Keys removed from the `*_deps` maps because nothing depends on them anymore.
+    dependees_removed: u32,
+    bytes_before: u64,
+    bytes_after: u64,
+};
+
+/// Compacts `dep_entries`, discarding the entries in `free_dep_entries` as well as dummy entries,
+/// and removes dependees which no longer have any dependers from the `*_deps` maps. This renumbers
+/// every `DepEntry.Index`, so it must only be called between updates.
+///
+/// This is not a garbage collector for the pool as a whole: `items`, `extra`, `string_bytes` and
+/// the per-thread arenas are never compacted, since their indices are held throughout the
+/// compiler. Entries are only freed when their depender is re-analyzed, so the dependencies of
+/// units which are no longer referenced, such as those of deleted declarations, are not reclaimed
+/// either. Re-analysis mostly reuses the entries it frees within the same update, so this only
+/// runs after updates which shrink the dependencies of many units at once.
+pub fn collectDependencyGarbage(ip: *InternPool, gpa: Allocator) Allocator.Error!DependencyGcStats {
+    const bytes_before = ip.dependencyBytes();
+    const entries = ip.dep_entries.items;
+
+    // Maps old indices to new ones, or to `.none` for discarded entries.
+    const remap = try gpa.alloc(DepEntry.Index.Optional, entries.len);
+    defer gpa.free(remap);
+    for (remap, entries) |*new, entry| new.* = if (entry.depender == .none) .none else @enumFromInt(0);
+    for (ip.free_dep_entries.items) |idx| remap[@intFromEnum(idx)] = .none;
+    var new_len: u32 = 0;
+    for (remap) |*new| {
+        if (new.* == .none) continue;
+        new.* = @enumFromInt(new_len);
+        new_len += 1;
+    }
+
+    // Lists headed by a dummy entry now start at the entry after it. This must happen before
+    // compaction, which overwrites the dummy entries.
+    var dependees_removed: u32 = 0;
+    inline for (.{
+        &ip.src_hash_deps,
+        &ip.nav_val_deps,
+        &ip.nav_ty_deps,
+        &ip.interned_deps,
+        &ip.zon_file_deps,
+        &ip.embed_file_deps,
+        &ip.namespace_deps,
+        &ip.namespace_name_deps,
+    }) |deps| {
+        var i = deps.count();
+        while (i > 0) {
+            i -= 1;
+            const value = &deps.values()[i];
+            if (remapDepHead(entries, remap, value.*).unwrap()) |new| {
+                value.* = new;
+            } else {
+                deps.swapRemoveAt(i);
+                dependees_removed += 1;
+            }
+        }
+        deps.shrinkAndFree(gpa, deps.count());
+    }
+    inline for (.{
+        &ip.memoized_state_main_deps,
+        &ip.memoized_state_panic_deps,
+        &ip.memoized_state_va_list_deps,
+        &ip.memoized_state_assembly_deps,
+    }) |deps| {
+        if (deps.unwrap()) |head| deps.* = remapDepHead(entries, remap, head);
+    }
+    for (ip.first_dependency.values()) |*idx| idx.* = remap[@intFromEnum(idx.*)].unwrap().?;
+
+    // Entries only move towards the start, so this can be done in place.
+    for (entries, remap) |entry, new| {
+        const new_index = new.unwrap() orelse continue;
+        entries[@intFromEnum(new_index)] = .{
+            .depender = entry.depender,
+            .next = remapDepEntry(remap, entry.next),
+            .prev = remapDepEntry(remap, entry.prev),
+            .next_dependee = remapDepEntry(remap, entry.next_dependee),
+        };
+    }
+    const entries_reclaimed: u32 = @intCast(entries.len - new_len);
+    ip.dep_entries.shrinkAndFree(gpa, new_len);
+    ip.free_dep_entries.clearAndFree(gpa);
+
+    return .{
+        .entries_reclaimed = entries_reclaimed,
+        .dependees_removed = dependees_removed,
+        .bytes_before = bytes_before,
+        .bytes_after = ip.dependencyBytes(),
+    };
+}
+
+/// A live entry can only link to a dummy entry through `prev`, since dummy entries are always at
+/// the start of a list, which is then unlinked.
+fn remapDepEntry(remap: []const DepEntry.Index.Optional, idx: DepEntry.Index.Optional) DepEntry.Index.Optional {
+    return remap[@intFromEnum(idx.unwrap() orelse return .none)];
+}
+
+fn remapDepHead(entries: []const DepEntry, remap: []const DepEntry.Index.Optional, head: DepEntry.Index) DepEntry.Index.Optional {
+    const entry = entries[@intFromEnum(head)];
+    if (entry.depender == .none) return remapDepEntry(remap, entry.next);
+    return remap[@intFromEnum(head)];
+}
+
+test collectDependencyGarbage {
+    const gpa = std.testing.allocator;
+
+    var ip: InternPool = .empty;
+    try ip.init(gpa, 1);
+    defer ip.deinit(gpa);
+
+    const dependees: [4]Dependee = .{
+        .{ .src_hash = @enumFromInt(0) },
+        .{ .nav_val = @enumFromInt(1) },
+        .{ .nav_ty = @enumFromInt(2) },
+        .{ .memoized_state = .panic },
+    };
+    // Bit `j` is set if unit `i` depends on `dependees[j]`.
+    const masks = [_]u4{ 0b1011, 0b1111, 0b1001, 0b0011, 0b0110, 0b1100 };
+    var units: [masks.len]AnalUnit = undefined;
+    for (&units, masks, 0..) |*unit, mask, i| {
+        unit.* = .wrap(.{ .nav_val = @enumFromInt(i) });
+        for (dependees, 0..) |dependee, j| {
+            if (mask >> @intCast(j) & 1 != 0) try ip.addDependency(gpa, unit.*, dependee);
+        }
+    }
+    // Leaves `nav_ty` with no dependers, and dummy entries at the start of the `nav_val` and
+    // `memoized_state` lists.
+    for ([_]usize{ 1, 4, 5 }) |i| ip.removeDependenciesForDepender(gpa, units[i]);
+
+    var expected: [dependees.len]std.ArrayList(AnalUnit) = @splat(.empty);
+    defer for (&expected) |*list| list.deinit(gpa);
+    for (dependees, &expected) |dependee, *list| {
+        var it = ip.dependencyIterator(dependee);
+        while (it.next()) |unit| try list.append(gpa, unit);
+    }
+    try std.testing.expectEqual(0, expected[2].items.len);
+
+    const stats = try ip.collectDependencyGarbage(gpa);
+    try std.testing.expectEqual(1, stats.dependees_removed);
+    try std.testing.expectEqual(0, ip.free_dep_entries.items.len);
+    try std.testing.expect(stats.entries_reclaimed > 0);
+    try std.testing.expect(!ip.nav_ty_deps.contains(@enumFromInt(2)));
+    for (ip.dep_entries.items) |entry| try std.testing.expect(entry.depender != .none);
+
+    for (dependees, expected) |dependee, list| {
+        var it = ip.dependencyIterator(dependee);
+        for (list.items) |unit| try std.testing.expectEqual(unit, it.next().?);
+        try std.testing.expectEqual(null, it.next());
+    }
+
+    // The links between entries must still allow removing them.
+    for ([_]usize{ 0, 2, 3 }) |i| ip.removeDependenciesForDepender(gpa, units[i]);
+    for (dependees) |dependee| {
+        var it = ip.dependencyIterator(dependee);
+        try std.testing.expectEqual(null, it.next());
+    }
+}
+
+/// Returns whether enough of `dep_entries` is unused that `collectDependencyGarbage` is worthwhile.
+pub fn wantDependencyGarbageCollection(ip: *const InternPool) bool {
+    return ip.free_dep_entries.items.len >= 4096 and
+        ip.free_dep_entries.items.len * 4 >= ip.dep_entries.items.len;
+}
+
+fn dependencyBytes(ip: *const InternPool) u64 {
+    var bytes: u64 = @as(u64, ip.dep_entries.capacity) * @sizeOf(DepEntry) +
+        @as(u64, ip.free_dep_entries.capacity) * @sizeOf(DepEntry.Index);
+    inline for (.{
+        &ip.src_hash_deps,
+        &ip.nav_val_deps,
+        &ip.nav_ty_deps,
+        &ip.interned_deps,
+        &ip.zon_file_deps,
+        &ip.embed_file_deps,
+        &ip.namespace_deps,
+        &ip.namespace_name_deps,
+        &ip.first_dependency,
+    }) |map| {
+        const Map = @TypeOf(map.*);
+        const elem_size = @sizeOf(Map.Hash) + @sizeOf(@FieldType(Map.KV, "key")) + @sizeOf(@FieldType(Map.KV, "value"));
+        bytes += @as(u64, map.capacity()) * elem_size;
+    }
+    return bytes;
+}
+
 /// String is the name whose existence the dependency is on.
 /// DepEntry.Index refers to the first such dependency.
 pub const NamespaceNameKey = struct {
@@ -9572,12 +9759,18 @@ pub const GetFuncInstanceKey = struct {
     inferred_error_set: bool,
 };
 
+pub const GetFuncInstanceResult = struct {
+    index: Index,
+    /// Whether the instance was newly created, rather than already existing.
+    is_new: bool,
+};
+
 pub fn getFuncInstance(
     ip: *InternPool,
     gpa: Allocator,
     tid: Zcu.PerThread.Id,
     arg: GetFuncInstanceKey,
-) Allocator.Error!Index {
+) Allocator.Error!GetFuncInstanceResult {
     if (arg.inferred_error_set)
         return getFuncInstanceIes(ip, gpa, tid, arg);
 
@@ -9628,7 +9821,7 @@ pub fn getFuncInstance(
     defer gop.deinit();
     if (gop == .existing) {
         extra.mutate.len = prev_extra_len;
-        return gop.existing;
+        return .{ .index = gop.existing, .is_new = false };
     }
 
     const func_index = Index.Unwrapped.wrap(.{ .tid = tid, .index = items.mutate.len }, ip);
@@ -9646,7 +9839,7 @@ pub fn getFuncInstance(
         func_index,
         func_extra_index,
     );
-    return gop.put();
+    return .{ .index = gop.put(), .is_new = true };
 }
 
 /// This function exists separately than `getFuncInstance` because it needs to
@@ -9657,7 +9850,7 @@ pub fn getFuncInstanceIes(
     gpa: Allocator,
     tid: Zcu.PerThread.Id,
     arg: GetFuncInstanceKey,
-) Allocator.Error!Index {
+) Allocator.Error!GetFuncInstanceResult {
     // Validate input parameters.
     assert(arg.inferred_error_set);
     assert(arg.bare_return_type != .none);
@@ -9768,7 +9961,7 @@ pub fn getFuncInstanceIes(
         // Hot path: undo the additions to our two arrays.
         items.mutate.len -= 4;
         extra.mutate.len = prev_extra_len;
-        return func_gop.existing;
+        return .{ .index = func_gop.existing, .is_new = false };
     }
     func_gop.putTentative(func_index);
     var error_union_type_gop = try ip.getOrPutKeyEnsuringAdditionalCapacity(gpa, tid, .{ .error_union_type = .{
@@ -9801,7 +9994,7 @@ pub fn getFuncInstanceIes(
     error_union_type_gop.putFinal(error_union_type);
     error_set_type_gop.putFinal(error_set_type);
     func_ty_gop.putFinal(func_ty);
-    return func_index;
+    return .{ .index = func_index, .is_new = true };
 }
 
 fn finishFuncInstance(
@@ -11096,11 +11289,26 @@ fn dumpStatsFallible(ip: *const InternPool, arena: Allocator) anyerror!void {
         limbs_size,
     });
 
-    const TagStats = struct {
-        count: usize = 0,
-        bytes: usize = 0,
-    };
-    var counts = std.AutoArrayHashMap(Tag, TagStats).init(arena);
+    const counts = try ip.tagStats(arena);
+    const len = @min(50, counts.count());
+    std.debug.print("  top 50 tags:\n", .{});
+    for (counts.keys()[0..len], counts.values()[0..len]) |tag, stats| {
+        std.debug.print("    {s}: {d} occurrences, {d} total bytes\n", .{
+            @tagName(tag), stats.count, stats.bytes,
+        });
+    }
+}
+
+pub const TagStats = struct {
+    count: usize = 0,
+    bytes: usize = 0,
+};
+
+/// Returns the number of items of each tag and the bytes of `items` and `extra` they occupy,
+/// sorted by descending size. Must not be called while other threads are mutating the pool.
+pub fn tagStats(ip: *const InternPool, gpa: Allocator) Allocator.Error!std.AutoArrayHashMapUnmanaged(Tag, TagStats) {
+    var counts: std.AutoArrayHashMapUnmanaged(Tag, TagStats) = .empty;
+    errdefer counts.deinit(gpa);
     for (ip.locals) |*local| {
         const items = local.shared.items.view().slice();
         const extra_list = local.shared.extra;
@@ -11109,7 +11317,7 @@ fn dumpStatsFallible(ip: *const InternPool, arena: Allocator) anyerror!void {
             items.items(.tag)[0..local.mutate.items.len],
             items.items(.data)[0..local.mutate.items.len],
         ) |tag, data| {
-            const gop = try counts.getOrPut(tag);
+            const gop = try counts.getOrPut(gpa, tag);
             if (!gop.found_existing) gop.value_ptr.* = .{};
             gop.value_ptr.count += 1;
             gop.value_ptr.bytes += 1 + 4 + @as(usize, switch (tag) {
@@ -11308,21 +11516,25 @@ fn dumpStatsFallible(ip: *const InternPool, arena: Allocator) anyerror!void {
         }
     }
     const SortContext = struct {
-        map: *std.AutoArrayHashMap(Tag, TagStats),
+        values: []const TagStats,
         pub fn lessThan(ctx: @This(), a_index: usize, b_index: usize) bool {
-            const values = ctx.map.values();
-            return values[a_index].bytes > values[b_index].bytes;
-            //return values[a_index].count > values[b_index].count;
+            return ctx.values[a_index].bytes > ctx.values[b_index].bytes;
         }
     };
-    counts.sort(SortContext{ .map = &counts });
-    const len = @min(50, counts.count());
-    std.debug.print("  top 50 tags:\n", .{});
-    for (counts.keys()[0..len], counts.values()[0..len]) |tag, stats| {
-        std.debug.print("    {s}: {d} occurrences, {d} total bytes\n", .{
-            @tagName(tag), stats.count, stats.bytes,
-        });
-    }
+    counts.sort(SortContext{ .values = counts.values() });
+    return counts;
+}
+
+/// The number of bytes in the `items`, `extra`, `limbs`, `strings` and `string_bytes` of thread
+/// `tid`, excluding unused capacity. Since only the owning thread appends to these, the difference
+/// between two calls from thread `tid` is the amount it interned in between.
+pub fn localBytes(ip: *const InternPool, tid: Zcu.PerThread.Id) u64 {
+    const mutate = &ip.locals[@intFromEnum(tid)].mutate;
+    return @as(u64, mutate.items.len) * (1 + 4) +
+        @as(u64, mutate.extra.len) * 4 +
+        @as(u64, mutate.limbs.len) * @sizeOf(Limb) +
+        @as(u64, mutate.strings.len) * 4 +
+        mutate.string_bytes.len;
 }
 
 fn dumpAllFallible(ip: *const InternPool) anyerror!void {
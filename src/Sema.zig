@@ -5849,11 +5849,13 @@ fn zirCImport(sema: *Sema, parent_block: *Block, inst: Zir.Inst.Index) CompileEr
             .source = null,
             .tree = null,
             .zir = null,
+            .zir_mapping = null,
             .zoir = null,
             .mod = c_import_mod,
             .sub_file_path = "cimport.zig",
             .module_changed = false,
             .prev_zir = null,
+            .prev_zir_mapping = null,
             .zoir_invalidated = false,
         };
         break :file c_import_file_index;
@@ -7595,8 +7597,12 @@ fn analyzeCall(
                 .generic_owner = func_val.?.toIntern(),
                 .comptime_args = comptime_args,
             });
+            if (try sema.timeReportCallInfo(fn_nav)) |info| {
+                info.generic_count += 1;
+                if (func_instance.is_new) info.generic_instances += 1;
+            }
             if (zcu.comp.debugIncremental()) {
-                const nav = ip.indexToKey(func_instance).func.owner_nav;
+                const nav = ip.indexToKey(func_instance.index).func.owner_nav;
                 const gop = try zcu.incremental_debug_state.navs.getOrPut(gpa, nav);
                 if (!gop.found_existing) gop.value_ptr.* = zcu.generation;
             }
@@ -7604,9 +7610,9 @@ fn analyzeCall(
             // This call is problematic as it breaks guarantees about order-independency of semantic analysis.
             // These guarantees are necessary for incremental compilation and parallel semantic analysis.
             // See: #22410
-            zcu.funcInfo(func_instance).maxBranchQuota(ip, sema.branch_quota);
+            zcu.funcInfo(func_instance.index).maxBranchQuota(ip, sema.branch_quota);
 
-            break :func .{ Air.internedToRef(func_instance), runtime_args.items };
+            break :func .{ Air.internedToRef(func_instance.index), runtime_args.items };
         };
 
         ref_func: {
@@ -7777,6 +7783,11 @@ fn analyzeCall(
             break :memoize;
         }
         sema.branch_count += memoized_call.branch_count;
+        if (try sema.timeReportCallInfo(fn_nav)) |info| {
+            info.comptime_count += 1;
+            info.comptime_memoized_count += 1;
+            info.comptime_branches += memoized_call.branch_count;
+        }
         const result = Air.internedToRef(memoized_call.result);
         if (ensure_result_used) {
             try sema.ensureResultUsed(block, sema.typeOf(result), call_src);
@@ -7906,6 +7917,7 @@ fn analyzeCall(
     // Store the current eval branch count so we can find out how many eval branches
     // the comptime call caused.
     const old_branch_count = sema.branch_count;
+    var comptime_timer: Compilation.Timer = if (block.isComptime()) zcu.comp.startTimer() else .unused;
 
     const result_raw: Air.Inst.Ref = result: {
         sema.analyzeFnBody(&child_block, fn_zir_info.body) catch |err| switch (err) {
@@ -7936,6 +7948,12 @@ fn analyzeCall(
                 .branch_count = sema.branch_count - old_branch_count,
             } });
         }
+        if (comptime_timer.finish()) |ns| {
+            const info = (try sema.timeReportCallInfo(fn_nav)).?;
+            info.comptime_count += 1;
+            info.comptime_branches += sema.branch_count - old_branch_count;
+            info.comptime_ns += ns;
+        }
     }
 
     if (ensure_result_used) {
@@ -7945,6 +7963,16 @@ fn analyzeCall(
     return maybe_opv;
 }
 
+/// Returns the `--time-report` statistics for calls to the function declared by `fn_nav`, or `null`
+/// if no time report is being collected. The pointer is invalidated by the next call.
+fn timeReportCallInfo(sema: *Sema, fn_nav: InternPool.Nav) Allocator.Error!?*Compilation.TimeReport.CallInfo {
+    const comp = sema.pt.zcu.comp;
+    const tr = if (comp.time_report) |*tr| tr else return null;
+    const gop = try tr.decl_call_info.getOrPut(comp.gpa, fn_nav.analysis.?.zir_index);
+    if (!gop.found_existing) gop.value_ptr.* = .{};
+    return gop.value_ptr;
+}
+
 fn handleTailCall(sema: *Sema, block: *Block, call_src: LazySrcLoc, func_ty: Type, result: Air.Inst.Ref) !Air.Inst.Ref {
     const pt = sema.pt;
     const zcu = pt.zcu;
@@ -316,6 +316,9 @@ incremental_debug_state: if (build_options.enable_debug_extensions) IncrementalD
 /// Times semantic analysis of the current `AnalUnit`. When we pause to analyze a different unit,
 /// this timer must be temporarily paused and resumed later.
 cur_analysis_timer: ?Compilation.Timer = null,
+/// Under `--mem-report`, the number of `InternPool` bytes added by units nested within the
+/// current `AnalUnit`, which are attributed to those units instead.
+cur_analysis_nested_ip_bytes: u64 = 0,
 
 generation: u32 = 0,
 
@@ -931,6 +934,9 @@ pub const File = struct {
     tree: ?Ast,
 
     zir: ?Zir,
+    /// If `zir` was loaded from the cache by memory-mapping it, this is the mapping its arrays point
+    /// into. In that case, `zir` is released by unmapping this instead of with `Zir.deinit`.
+    zir_mapping: ?[]align(std.heap.page_size_min) const u8,
     zoir: ?Zoir,
 
     /// Module that this file is a part of, managed externally.
@@ -962,6 +968,8 @@ pub const File = struct {
     /// In other words, if `TrackedInst`s are tied to ZIR other than what's in the `zir` field, this
     /// field is populated with that old ZIR.
     prev_zir: ?*Zir,
+    /// Like `zir_mapping`, but for `prev_zir`.
+    prev_zir_mapping: ?[]align(std.heap.page_size_min) const u8,
 
     /// This field serves a similar purpose to `prev_zir`, but for ZOIR. However, since we do not
     /// need to map old ZOIR to new ZOIR -- instead only invalidating dependencies if the ZOIR
@@ -1031,11 +1039,25 @@ pub const File = struct {
 
     pub fn unloadZir(file: *File, gpa: Allocator) void {
         if (file.zir) |*zir| {
-            zir.deinit(gpa);
+            if (file.zir_mapping) |mapping| {
+                std.posix.munmap(mapping);
+                file.zir_mapping = null;
+            } else zir.deinit(gpa);
             file.zir = null;
         }
     }
 
+    pub fn unloadPrevZir(file: *File, gpa: Allocator) void {
+        if (file.prev_zir) |prev_zir| {
+            if (file.prev_zir_mapping) |mapping| {
+                std.posix.munmap(mapping);
+                file.prev_zir_mapping = null;
+            } else prev_zir.deinit(gpa);
+            gpa.destroy(prev_zir);
+            file.prev_zir = null;
+        }
+    }
+
     pub const GetSourceError = error{
         OutOfMemory,
         FileChanged,
@@ -2885,6 +2907,109 @@ pub fn loadZirCache(gpa: Allocator, io: Io, cache_file: std.fs.File) !Zir {
     };
 }
 
+/// Whether `loadZirZoirCache` memory-maps cached ZIR rather than reading it into allocated memory.
+/// This requires instructions to have the same layout in memory as in the cache file.
+pub const zir_cache_mmap = !data_has_safety_tag and switch (builtin.os.tag) {
+    .windows, .wasi => false,
+    else => true,
+};
+
+/// The body of a ZIR cache file consists of these arrays, in this order, following a `Zir.Header`.
+/// Arrays with stricter alignment come first so that each is naturally aligned in the file,
+/// allowing it to be used in place when the file is memory-mapped.
+const ZirCacheLayout = struct {
+    data: u64,
+    extra: u64,
+    tags: u64,
+    string_bytes: u64,
+    end: u64,
+
+    fn init(header: Zir.Header) ZirCacheLayout {
+        const data: u64 = @sizeOf(Zir.Header);
+        const extra = data + @as(u64, header.instructions_len) * 8;
+        const tags = extra + @as(u64, header.extra_len) * 4;
+        const string_bytes = tags + header.instructions_len;
+        return .{
+            .data = data,
+            .extra = extra,
+            .tags = tags,
+            .string_bytes = string_bytes,
+            .end = string_bytes + header.string_bytes_len,
+        };
+    }
+
+    comptime {
+        assert(@sizeOf(Zir.Header) % @alignOf(Zir.Inst.Data) == 0);
+        assert(@alignOf(Zir.Inst.Data) <= 8);
+    }
+};
+
+/// Maps a ZIR cache file whose `header` has already been validated. The returned `Zir` points into
+/// the returned mapping, which the caller must unmap instead of calling `Zir.deinit`. Returns
+/// `error.EndOfStream` if the file is shorter than the header claims.
+pub fn mapZirCache(
+    cache_file: std.fs.File,
+    header: Zir.Header,
+) !struct { Zir, []align(std.heap.page_size_min) const u8 } {
+    comptime assert(zir_cache_mmap);
+    const layout: ZirCacheLayout = .init(header);
+    // Accessing a mapping beyond the end of the file faults rather than failing gracefully.
+    if (try cache_file.getEndPos() < layout.end) return error.EndOfStream;
+    // Read-only: ZIR is never modified once generated, and the file may be shared with other
+    // processes.
+    const mapping = try std.posix.mmap(
+        null,
+        std.math.cast(usize, layout.end) orelse return error.FileTooBig,
+        std.posix.PROT.READ,
+        .{ .TYPE = .PRIVATE },
+        cache_file.handle,
+        0,
+    );
+    const zir: Zir = .{
+        .instructions = .{
+            .ptrs = .{
+                mapping[@intCast(layout.tags)..].ptr,
+                mapping[@intCast(layout.data)..].ptr,
+            },
+            .len = header.instructions_len,
+            .capacity = header.instructions_len,
+        },
+        .string_bytes = mapping[@intCast(layout.string_bytes)..@intCast(layout.end)],
+        .extra = @alignCast(std.mem.bytesAsSlice(u32, mapping[@intCast(layout.extra)..@intCast(layout.tags)])),
+    };
+    return .{ zir, mapping };
+}
+
+/// Loads the body of a ZIR cache file whose `header` has already been validated and taken from
+/// `cache_br`, which reads `cache_file`. If `zir_cache_mmap`, the body is mapped as by
+/// `mapZirCache`, and the mapping is returned too. Mapping can fail where reading still works, e.g.
+/// on a file system without mmap support or once the process runs out of mappings, in which case
+/// the body is read from `cache_br` instead and no mapping is returned.
+pub fn mapOrLoadZirCacheBody(
+    gpa: Allocator,
+    cache_file: std.fs.File,
+    header: Zir.Header,
+    cache_br: *Io.Reader,
+) !struct { Zir, ?[]align(std.heap.page_size_min) const u8 } {
+    if (zir_cache_mmap) {
+        if (mapZirCache(cache_file, header)) |mapped| {
+            return mapped;
+        } else |err| switch (err) {
+            error.MemoryMappingNotSupported,
+            error.AccessDenied,
+            error.PermissionDenied,
+            error.LockedMemoryLimitExceeded,
+            error.ProcessFdQuotaExceeded,
+            error.SystemFdQuotaExceeded,
+            error.OutOfMemory,
+            error.FileTooBig,
+            => |e| log.debug("unable to map cached ZIR, reading it instead: {t}", .{e}),
+            else => |e| return e,
+        }
+    }
+    return .{ try loadZirCacheBody(gpa, header, cache_br), null };
+}
+
 pub fn loadZirCacheBody(gpa: Allocator, header: Zir.Header, cache_br: *Io.Reader) !Zir {
     var instructions: std.MultiArrayList(Zir.Inst) = .{};
     errdefer instructions.deinit(gpa);
@@ -2908,14 +3033,15 @@ pub fn loadZirCacheBody(gpa: Allocator, header: Zir.Header, cache_br: *Io.Reader
         undefined;
     defer if (data_has_safety_tag) gpa.free(safety_buffer);
 
+    // See `ZirCacheLayout`.
     var vecs = [_][]u8{
-        @ptrCast(zir.instructions.items(.tag)),
         if (data_has_safety_tag)
             @ptrCast(safety_buffer)
         else
             @ptrCast(zir.instructions.items(.data)),
-        zir.string_bytes,
         @ptrCast(zir.extra),
+        @ptrCast(zir.instructions.items(.tag)),
+        zir.string_bytes,
     };
     try cache_br.readVecAll(&vecs);
     if (data_has_safety_tag) {
@@ -2956,15 +3082,16 @@ pub fn saveZirCache(gpa: Allocator, cache_file: std.fs.File, stat: std.fs.File.S
         .stat_inode = stat.inode,
         .stat_mtime = stat.mtime.toNanoseconds(),
     };
+    // See `ZirCacheLayout`.
     var vecs = [_][]const u8{
         @ptrCast((&header)[0..1]),
-        @ptrCast(zir.instructions.items(.tag)),
         if (data_has_safety_tag)
             @ptrCast(safety_buffer)
         else
             @ptrCast(zir.instructions.items(.data)),
-        zir.string_bytes,
         @ptrCast(zir.extra),
+        @ptrCast(zir.instructions.items(.tag)),
+        zir.string_bytes,
     };
     var cache_fw = cache_file.writer(&.{});
     cache_fw.interface.writeVecAll(&vecs) catch |err| switch (err) {
@@ -2972,6 +3099,15 @@ pub fn saveZirCache(gpa: Allocator, cache_file: std.fs.File, stat: std.fs.File.S
     };
 }
 
+/// Like `saveZirCache`, but writes a new file and renames it over `sub_path`. Unlike truncating and
+/// rewriting the existing file, this keeps any mappings of it created by `mapZirCache` valid.
+pub fn replaceZirCache(gpa: Allocator, dir: std.fs.Dir, sub_path: []const u8, stat: std.fs.File.Stat, zir: Zir) !void {
+    var atomic_file = try dir.atomicFile(sub_path, .{ .write_buffer = &.{} });
+    defer atomic_file.deinit();
+    try saveZirCache(gpa, atomic_file.file_writer.file, stat, zir);
+    try atomic_file.renameIntoPlace();
+}
+
 pub fn saveZoirCache(cache_file: std.fs.File, stat: std.fs.File.Stat, zoir: Zoir) std.fs.File.WriteError!void {
     const header: Zoir.Header = .{
         .nodes_len = @intCast(zoir.nodes.len),
@@ -4735,6 +4871,9 @@ const TrackedUnitSema = struct {
     old_name: ?[std.Progress.Node.max_name_len]u8,
     old_analysis_timer: ?Compilation.Timer,
     analysis_timer_decl: ?InternPool.TrackedInst.Index,
+    /// `null` unless this unit's `InternPool` usage is being reported.
+    ip_bytes_start: ?u64,
+    old_nested_ip_bytes: u64,
     pub fn end(tus: TrackedUnitSema, zcu: *Zcu) void {
         const comp = zcu.comp;
         if (tus.old_name) |old_name| {
@@ -4762,6 +4901,24 @@ const TrackedUnitSema = struct {
         }
         zcu.cur_analysis_timer = tus.old_analysis_timer;
         if (zcu.cur_analysis_timer) |*t| t.@"resume"();
+        report_mem: {
+            const ip_bytes_start = tus.ip_bytes_start orelse break :report_mem;
+            // Analysis always happens on the main thread. Saturate in case items were removed.
+            const ip_bytes = zcu.intern_pool.localBytes(.main) -| ip_bytes_start;
+            const own_ip_bytes = ip_bytes -| zcu.cur_analysis_nested_ip_bytes;
+            zcu.cur_analysis_nested_ip_bytes = tus.old_nested_ip_bytes + ip_bytes;
+            comp.mutex.lock();
+            defer comp.mutex.unlock();
+            const gop = comp.mem_report.?.decls.getOrPut(comp.gpa, tus.analysis_timer_decl.?) catch |err| switch (err) {
+                error.OutOfMemory => {
+                    comp.setAllocFailure();
+                    break :report_mem;
+                },
+            };
+            if (!gop.found_existing) gop.value_ptr.* = .{};
+            gop.value_ptr.ip_bytes += own_ip_bytes;
+            gop.value_ptr.sema_count += 1;
+        }
     }
 };
 pub fn trackUnitSema(zcu: *Zcu, name: []const u8, zir_inst: ?InternPool.TrackedInst.Index) TrackedUnitSema {
@@ -4777,9 +4934,51 @@ pub fn trackUnitSema(zcu: *Zcu, name: []const u8, zir_inst: ?InternPool.TrackedI
         zcu.cur_sema_prog_node.setName(name);
         break :old_name old_name;
     };
+    // Units without a declaration, such as type resolution, are attributed to the enclosing unit.
+    const ip_bytes_start: ?u64 = if (zcu.comp.mem_report != null and zir_inst != null)
+        zcu.intern_pool.localBytes(.main)
+    else
+        null;
+    const old_nested_ip_bytes = zcu.cur_analysis_nested_ip_bytes;
+    if (ip_bytes_start != null) zcu.cur_analysis_nested_ip_bytes = 0;
     return .{
         .old_name = old_name,
         .old_analysis_timer = old_analysis_timer,
         .analysis_timer_decl = zir_inst,
+        .ip_bytes_start = ip_bytes_start,
+        .old_nested_ip_bytes = old_nested_ip_bytes,
     };
 }
+
+test mapOrLoadZirCacheBody {
+    const gpa = std.testing.allocator;
+    var tmp = std.testing.tmpDir(.{});
+    defer tmp.cleanup();
+
+    var tree: Ast = try .parse(gpa, "const answer: u32 = 42;\n", .zig);
+    defer tree.deinit(gpa);
+    var zir = try AstGen.generate(gpa, tree);
+    defer zir.deinit(gpa);
+    {
+        const cache_file = try tmp.dir.createFile("zir", .{});
+        defer cache_file.close();
+        try saveZirCache(gpa, cache_file, try cache_file.stat(), zir);
+    }
+
+    // A file which is not open for reading cannot be mapped, so the body is read through the
+    // second handle instead.
+    const write_only = try tmp.dir.openFile("zir", .{ .mode = .write_only });
+    defer write_only.close();
+    const read_only = try tmp.dir.openFile("zir", .{});
+    defer read_only.close();
+    var buffer: [2000]u8 = undefined;
+    var cache_fr = read_only.reader(std.testing.io, &buffer);
+    const header = (try cache_fr.interface.takeStructPointer(Zir.Header)).*;
+    var loaded, const mapping = try mapOrLoadZirCacheBody(gpa, write_only, header, &cache_fr.interface);
+    defer loaded.deinit(gpa);
+
+    try std.testing.expect(mapping == null);
+    try std.testing.expectEqualSlices(Zir.Inst.Tag, zir.instructions.items(.tag), loaded.instructions.items(.tag));
+    try std.testing.expectEqualSlices(u32, zir.extra, loaded.extra);
+    try std.testing.expectEqualSlices(u8, zir.string_bytes, loaded.string_bytes);
+}
@@ -57,10 +57,7 @@ fn deinitFile(pt: Zcu.PerThread, file_index: Zcu.File.Index) void {
     log.debug("deinit File {f}", .{file.path.fmt(zcu.comp)});
     file.path.deinit(gpa);
     file.unload(gpa);
-    if (file.prev_zir) |prev_zir| {
-        prev_zir.deinit(gpa);
-        gpa.destroy(prev_zir);
-    }
+    file.unloadPrevZir(gpa);
     file.* = undefined;
 }
 
@@ -154,7 +151,9 @@ pub fn updateFile(
         const prev_zir_ptr = try gpa.create(Zir);
         file.prev_zir = prev_zir_ptr;
         prev_zir_ptr.* = file.zir.?;
+        file.prev_zir_mapping = file.zir_mapping;
         file.zir = null;
+        file.zir_mapping = null;
     }
 
     // If ZOIR is changing, then we need to invalidate dependencies on it
@@ -167,8 +166,8 @@ pub fn updateFile(
     // If another process is already working on this file, we will get the cached
     // version. Likewise if we're working on AstGen and another process asks for
     // the cached file, they'll get it.
-    const cache_file = while (true) {
-        break zir_dir.createFile(&hex_digest, .{
+    var cache_file = while (true) {
+        const f = zir_dir.createFile(&hex_digest, .{
             .read = true,
             .truncate = false,
             .lock = lock,
@@ -179,7 +178,7 @@ pub fn updateFile(
             error.PipeBusy => unreachable, // it's not a pipe
             error.NoDevice => unreachable, // it's not a pipe
             error.WouldBlock => unreachable, // not asking for non-blocking I/O
-            error.FileNotFound => {
+            error.FileNotFound => f: {
                 // There are no dir components, so the only possibility should
                 // be that the directory behind the handle has been deleted,
                 // however we have observed on macOS two processes racing to do
@@ -194,7 +193,7 @@ pub fn updateFile(
                         cache_directory,
                     });
                 }
-                break zir_dir.createFile(&hex_digest, .{
+                break :f zir_dir.createFile(&hex_digest, .{
                     .read = true,
                     .truncate = false,
                     .lock = lock,
@@ -212,16 +211,28 @@ pub fn updateFile(
 
             else => |e| return e, // Retryable errors are handled at callsite.
         };
+        if (try zirCacheFileReplaced(zir_dir, &hex_digest, f)) {
+            f.close();
+            continue;
+        }
+        break f;
     };
     defer cache_file.close();
 
     // Under `--time-report`, ignore cache hits; do the work anyway for those juicy numbers.
-    const ignore_hit = comp.time_report != null;
+    const ignore_hit = comp.time_report != null and !comp.time_report_phases_only;
 
+    // A cache file with a valid header may be mapped by this or another process (see
+    // `Zcu.mapZirCache`), so rather than being rewritten in place, it is replaced.
+    var replace_cache_file = false;
     const need_update = while (true) {
         const result = switch (file.getMode()) {
             inline else => |mode| try loadZirZoirCache(zcu, cache_file, stat, file, mode),
         };
+        replace_cache_file = Zcu.zir_cache_mmap and file.getMode() == .zig and switch (result) {
+            .success, .stale => true,
+            .invalid, .truncated => false,
+        };
         switch (result) {
             .success => if (!ignore_hit) {
                 log.debug("AstGen cached success: {f}", .{file.path.fmt(comp)});
@@ -239,15 +250,28 @@ pub fn updateFile(
         cache_file.unlock();
         lock = .exclusive;
         try cache_file.lock(lock);
+        while (try zirCacheFileReplaced(zir_dir, &hex_digest, cache_file)) {
+            cache_file.close();
+            cache_file = try zir_dir.createFile(&hex_digest, .{
+                .read = true,
+                .truncate = false,
+                .lock = lock,
+            });
+        }
     };
 
     if (need_update) {
-        // The cache is definitely stale so delete the contents to avoid an underwrite later.
-        cache_file.setEndPos(0) catch |err| switch (err) {
-            error.FileTooBig => unreachable, // 0 is not too big
-            else => |e| return e,
-        };
-        try cache_file.seekTo(0);
+        if (replace_cache_file) {
+            // If we ignored a cache hit, the ZIR was loaded.
+            file.unloadZir(gpa);
+        } else {
+            // The cache is definitely stale so delete the contents to avoid an underwrite later.
+            cache_file.setEndPos(0) catch |err| switch (err) {
+                error.FileTooBig => unreachable, // 0 is not too big
+                else => |e| return e,
+            };
+            try cache_file.seekTo(0);
+        }
 
         if (stat.size > std.math.maxInt(u32))
             return error.FileTooBig;
@@ -276,7 +300,11 @@ pub fn updateFile(
         switch (file.getMode()) {
             .zig => {
                 file.zir = try AstGen.generate(gpa, file.tree.?);
-                Zcu.saveZirCache(gpa, cache_file, stat, file.zir.?) catch |err| switch (err) {
+                const save_result = if (replace_cache_file)
+                    Zcu.replaceZirCache(gpa, zir_dir, &hex_digest, stat, file.zir.?)
+                else
+                    Zcu.saveZirCache(gpa, cache_file, stat, file.zir.?);
+                save_result catch |err| switch (err) {
                     error.OutOfMemory => |e| return e,
                     else => log.warn("unable to write cached ZIR code for {f} to {f}{s}: {s}", .{
                         file.path.fmt(comp), cache_directory, &hex_digest, @errorName(err),
@@ -342,6 +370,20 @@ pub fn updateFile(
     }
 }
 
+/// Whether the ZIR cache file at `sub_path` was replaced by another process (see
+/// `Zcu.replaceZirCache`) after `cache_file` was opened, for instance while waiting for its lock.
+/// The lock then only protects the old file, so the caller must open the path again.
+fn zirCacheFileReplaced(zir_dir: std.fs.Dir, sub_path: []const u8, cache_file: std.fs.File) !bool {
+    if (!Zcu.zir_cache_mmap) return false;
+    const opened = try cache_file.stat();
+    const current = zir_dir.statFile(sub_path) catch |err| switch (err) {
+        // The cache file was deleted; opening the path again creates it.
+        error.FileNotFound => return true,
+        else => |e| return e,
+    };
+    return opened.inode != current.inode;
+}
+
 fn loadZirZoirCache(
     zcu: *Zcu,
     cache_file: std.fs.File,
@@ -383,10 +425,12 @@ fn loadZirZoirCache(
     }
 
     switch (mode) {
-        .zig => file.zir = Zcu.loadZirCacheBody(gpa, header, cache_br) catch |err| switch (err) {
-            error.ReadFailed => return cache_fr.err.?,
-            error.EndOfStream => return .truncated,
-            else => |e| return e,
+        .zig => {
+            file.zir, file.zir_mapping = Zcu.mapOrLoadZirCacheBody(gpa, cache_file, header, cache_br) catch |err| switch (err) {
+                error.ReadFailed => return cache_fr.err.?,
+                error.EndOfStream => return .truncated,
+                else => |e| return e,
+            };
         },
         .zon => file.zoir = Zcu.loadZoirCacheBody(gpa, header, cache_br) catch |err| switch (err) {
             error.ReadFailed => return cache_fr.err.?,
@@ -578,11 +622,7 @@ pub fn updateZirRefs(pt: Zcu.PerThread) Allocator.Error!void {
     for (updated_files.keys(), updated_files.values()) |file_index, updated_file| {
         const file = updated_file.file;
 
-        if (file.prev_zir) |prev_zir| {
-            prev_zir.deinit(gpa);
-            gpa.destroy(prev_zir);
-            file.prev_zir = null;
-        }
+        file.unloadPrevZir(gpa);
         file.module_changed = false;
 
         // For every file which has changed, re-scan the namespace of the file's root struct type.
@@ -1951,11 +1991,13 @@ pub fn discoverImport(
         .source = null,
         .tree = null,
         .zir = null,
+        .zir_mapping = null,
         .zoir = null,
         .mod = null,
         .sub_file_path = undefined,
         .module_changed = false,
         .prev_zir = null,
+        .prev_zir_mapping = null,
         .zoir_invalidated = false,
     };
 
@@ -2095,11 +2137,13 @@ pub fn populateModuleRootTable(pt: Zcu.PerThread) error{
             .source = null,
             .tree = null,
             .zir = null,
+            .zir_mapping = null,
             .zoir = null,
             .mod = null,
             .sub_file_path = undefined,
             .module_changed = false,
             .prev_zir = null,
+            .prev_zir_mapping = null,
             .zoir_invalidated = false,
         };
     }
@@ -2315,11 +2359,13 @@ pub fn updateBuiltinModule(pt: Zcu.PerThread, opts: Builtin) Allocator.Error!voi
         .source = null,
         .tree = null,
         .zir = null,
+        .zir_mapping = null,
         .zoir = null,
         .mod = mod,
         .sub_file_path = "builtin.zig",
         .module_changed = false,
         .prev_zir = null,
+        .prev_zir_mapping = null,
         .zoir_invalidated = false,
     };
 
@@ -4480,6 +4526,10 @@ fn runCodegenInner(pt: Zcu.PerThread, func_index: InternPool.Index, air: *Air) e
     const codegen_prog_node = zcu.codegen_prog_node.start(fqn.toSlice(ip), 0);
     defer codegen_prog_node.end();
 
+    if (codegen.optimizePasses(pt, nav)) |passes| {
+        try air.optimize(pt, passes);
+    }
+
     if (codegen.legalizeFeatures(pt, nav)) |features| {
         try air.legalize(pt, features);
     }
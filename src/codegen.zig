@@ -85,6 +85,22 @@ pub fn legalizeFeatures(pt: Zcu.PerThread, nav_index: InternPool.Nav.Index) ?*co
     }
 }
 
+/// Returns the `Air.Optimize` passes to run on a function before legalization, or `null` to lower
+/// the AIR as-is. LLVM runs its own optimization pipeline and the C backend leaves optimization to
+/// the C compiler, so this only applies to the self-hosted machine code backends.
+pub fn optimizePasses(pt: Zcu.PerThread, nav_index: InternPool.Nav.Index) ?*const Air.Optimize.Passes {
+    const zcu = pt.zcu;
+    const mod = zcu.navFileScope(nav_index).mod.?;
+    return switch (target_util.zigBackend(&mod.resolved_target.result, zcu.comp.config.use_llvm)) {
+        else => null,
+        .stage2_x86_64,
+        .stage2_aarch64,
+        .stage2_riscv64,
+        .stage2_wasm,
+        => Air.Optimize.passesForMode(mod.optimize_mode),
+    };
+}
+
 pub fn wantsLiveness(pt: Zcu.PerThread, nav_index: InternPool.Nav.Index) bool {
     const zcu = pt.zcu;
     const target = &zcu.navFileScope(nav_index).mod.?.resolved_target.result;
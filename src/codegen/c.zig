@@ -56,6 +56,9 @@ pub const Mir = struct {
     /// `.none` for natural alignment. The specified alignment is never
     /// less than the natural alignment.
     uavs: std.AutoArrayHashMapUnmanaged(InternPool.Index, Alignment),
+    /// The navs referenced by the generated code. `link.C` uses this to find the forward
+    /// declarations needed by each shard when it splits its output.
+    navs: std.AutoArrayHashMapUnmanaged(InternPool.Nav.Index, void),
     // These remaining fields are essentially just an owned version of `link.C.AvBlock`.
     code_header: []u8,
     code: []u8,
@@ -65,6 +68,7 @@ pub const Mir = struct {
 
     pub fn deinit(mir: *Mir, gpa: Allocator) void {
         mir.uavs.deinit(gpa);
+        mir.navs.deinit(gpa);
         gpa.free(mir.code_header);
         gpa.free(mir.code);
         gpa.free(mir.fwd_decl);
@@ -380,6 +384,24 @@ pub fn fmtIdentUnsolo(ident: []const u8) std.fmt.Alt([]const u8, formatIdentUnso
     return .{ .data = ident };
 }
 
+/// Renders the C identifier of `nav_index`.
+pub fn renderNavIdent(w: *Writer, ip: *const InternPool, nav_index: InternPool.Nav.Index) Writer.Error!void {
+    const nav = ip.getNav(nav_index);
+    if (nav.getExtern(ip)) |@"extern"| {
+        try w.print("{f}", .{
+            fmtIdentSolo(ip.getNav(@"extern".owner_nav).name.toSlice(ip)),
+        });
+    } else {
+        // MSVC has a limit of 4095 character token length limit, and fmtIdent can (worst case),
+        // expand to 3x the length of its input, but let's cut it off at a much shorter limit.
+        const fqn_slice = nav.fqn.toSlice(ip);
+        try w.print("{f}__{d}", .{
+            fmtIdentUnsolo(fqn_slice[0..@min(fqn_slice.len, 100)]),
+            @intFromEnum(nav_index),
+        });
+    }
+}
+
 const CTypePoolStringFormatData = struct {
     ctype_pool_string: CType.Pool.String,
     ctype_pool: *const CType.Pool,
@@ -759,6 +781,8 @@ pub const DeclGen = struct {
     /// `.none` for natural alignment. The specified alignment is never
     /// less than the natural alignment.
     uavs: std.AutoArrayHashMapUnmanaged(InternPool.Index, Alignment),
+    /// If not null, every nav whose name is rendered is added to this set.
+    ref_navs: ?*std.AutoArrayHashMapUnmanaged(InternPool.Nav.Index, void) = null,
 
     pub const Pass = union(enum) {
         nav: InternPool.Nav.Index,
@@ -2268,25 +2292,11 @@ pub const DeclGen = struct {
     }
 
     fn renderNavName(dg: *DeclGen, w: *Writer, nav_index: InternPool.Nav.Index) !void {
-        const zcu = dg.pt.zcu;
-        const ip = &zcu.intern_pool;
-        const nav = ip.getNav(nav_index);
-        if (nav.getExtern(ip)) |@"extern"| {
-            try w.print("{f}", .{
-                fmtIdentSolo(ip.getNav(@"extern".owner_nav).name.toSlice(ip)),
-            });
-        } else {
-            // MSVC has a limit of 4095 character token length limit, and fmtIdent can (worst case),
-            // expand to 3x the length of its input, but let's cut it off at a much shorter limit.
-            const fqn_slice = ip.getNav(nav_index).fqn.toSlice(ip);
-            try w.print("{f}__{d}", .{
-                fmtIdentUnsolo(fqn_slice[0..@min(fqn_slice.len, 100)]),
-                @intFromEnum(nav_index),
-            });
-        }
+        if (dg.ref_navs) |ref_navs| try ref_navs.put(dg.gpa, nav_index, {});
+        try renderNavIdent(w, &dg.pt.zcu.intern_pool, nav_index);
     }
 
-    fn renderUavName(w: *Writer, uav: Value) !void {
+    pub fn renderUavName(w: *Writer, uav: Value) !void {
         try w.print("__anon_{d}", .{@intFromEnum(uav.toIntern())});
     }
 
@@ -2925,6 +2935,9 @@ pub fn generate(
 
     const func = zcu.funcInfo(func_index);
 
+    var ref_navs: std.AutoArrayHashMapUnmanaged(InternPool.Nav.Index, void) = .empty;
+    defer ref_navs.deinit(gpa);
+
     var function: Function = .{
         .value_map = .init(gpa),
         .air = air.*,
@@ -2943,6 +2956,7 @@ pub fn generate(
                 .ctype_pool = .empty,
                 .scratch = .empty,
                 .uavs = .empty,
+                .ref_navs = &ref_navs,
             },
             .code_header = .init(gpa),
             .code = .init(gpa),
@@ -2969,6 +2983,7 @@ pub fn generate(
 
     var mir: Mir = .{
         .uavs = .empty,
+        .navs = .empty,
         .code = &.{},
         .code_header = &.{},
         .fwd_decl = &.{},
@@ -2977,6 +2992,7 @@ pub fn generate(
     };
     errdefer mir.deinit(gpa);
     mir.uavs = function.object.dg.uavs.move();
+    mir.navs = ref_navs.move();
     mir.code_header = try function.object.code_header.toOwnedSlice();
     mir.code = try function.object.code.toOwnedSlice();
     mir.fwd_decl = try function.object.dg.fwd_decl.toOwnedSlice();
@@ -3676,7 +3692,11 @@ fn airPtrElemPtr(f: *Function, inst: Air.Inst.Index) !CValue {
 
     const inst_ty = f.typeOfIndex(inst);
     const ptr_ty = f.typeOf(bin_op.lhs);
-    const elem_has_bits = ptr_ty.elemType2(zcu).hasRuntimeBitsIgnoreComptime(zcu);
+    const elem_ty = ptr_ty.elemType2(zcu);
+    const elem_has_bits = elem_ty.hasRuntimeBitsIgnoreComptime(zcu);
+    // Indexing needs the complete element type, which another declaration is not guaranteed to
+    // provide when the output is split into shards.
+    if (elem_has_bits) _ = try f.ctypeFromType(elem_ty, .complete);
 
     const ptr = try f.resolveInst(bin_op.lhs);
     const index = try f.resolveInst(bin_op.rhs);
@@ -3740,6 +3760,8 @@ fn airSliceElemPtr(f: *Function, inst: Air.Inst.Index) !CValue {
     const slice_ty = f.typeOf(bin_op.lhs);
     const elem_ty = slice_ty.elemType2(zcu);
     const elem_has_bits = elem_ty.hasRuntimeBitsIgnoreComptime(zcu);
+    // See `airPtrElemPtr`.
+    if (elem_has_bits) _ = try f.ctypeFromType(elem_ty, .complete);
 
     const slice = try f.resolveInst(bin_op.lhs);
     const index = try f.resolveInst(bin_op.rhs);
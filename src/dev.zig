@@ -82,6 +82,7 @@ pub const Env = enum {
                 .ast_gen,
                 .sema,
                 .legalize,
+                .optimize,
                 .c_compiler,
                 .llvm_backend,
                 .c_backend,
@@ -161,6 +162,7 @@ pub const Env = enum {
                 .build_command,
                 .stdio_listen,
                 .incremental,
+                .optimize,
                 .aarch64_backend,
                 .elf_linker,
                 .elf2_linker,
@@ -178,12 +180,14 @@ pub const Env = enum {
                 .build_command,
                 .stdio_listen,
                 .incremental,
+                .optimize,
                 .x86_64_backend,
                 .elf_linker,
                 => true,
                 else => Env.sema.supports(feature),
             },
             .@"riscv64-linux" => switch (feature) {
+                .optimize,
                 .riscv64_backend,
                 .elf_linker,
                 => true,
@@ -199,6 +203,7 @@ pub const Env = enum {
             .wasm => switch (feature) {
                 .stdio_listen,
                 .incremental,
+                .optimize,
                 .wasm_backend,
                 .wasm_linker,
                 => true,
@@ -209,6 +214,7 @@ pub const Env = enum {
                 .stdio_listen,
                 .incremental,
                 .legalize,
+                .optimize,
                 .x86_64_backend,
                 .elf_linker,
                 .elf2_linker,
@@ -266,6 +272,7 @@ pub const Feature = enum {
     ast_gen,
     sema,
     legalize,
+    optimize,
 
     c_compiler,
 
@@ -455,6 +455,8 @@ pub const File = struct {
         print_gc_sections: bool,
         print_icf_sections: bool,
         print_map: bool,
+        /// (C) The number of translation units to split the output into.
+        c_shards: u32,
 
         /// Use a wrapper function for symbol. Any undefined reference to symbol
         /// will be resolved to __wrap_symbol. Any undefined reference to
@@ -977,6 +979,20 @@ pub const File = struct {
     /// May be called before or after updateFunc/updateNav therefore it is up to the linker to allocate
     /// the block/atom.
     /// Never called when LLVM is codegenning the ZCU.
+    /// The number of bytes the output holds for `nav_index` as of its last update, or `null` if
+    /// this linker does not track that per `Nav`. Used to attribute output size under
+    /// `--mem-report`.
+    fn navAtomSize(base: *File, nav_index: InternPool.Nav.Index) ?u64 {
+        assert(base.comp.zcu.?.llvm_object == null);
+        switch (base.tag) {
+            inline .c, .elf, .macho => |tag| {
+                dev.check(tag.devFeature());
+                return @as(*tag.Type(), @fieldParentPtr("base", base)).navAtomSize(nav_index);
+            },
+            else => return null,
+        }
+    }
+
     pub fn getNavVAddr(base: *File, pt: Zcu.PerThread, nav_index: InternPool.Nav.Index, reloc_info: RelocInfo) !u64 {
         assert(base.comp.zcu.?.llvm_object == null);
         switch (base.tag) {
@@ -1570,6 +1586,16 @@ pub fn doZcuTask(comp: *Compilation, tid: usize, task: ZcuTask) void {
         },
     }
 
+    if (comp.mem_report != null and zcu.llvm_object == null) report_size: {
+        const nav: InternPool.Nav.Index = switch (task) {
+            .link_type, .update_line_number => break :report_size,
+            .link_nav => |nav| nav,
+            .link_func => |f| zcu.funcInfo(f.func).owner_nav,
+        };
+        const lf = comp.bin_file orelse break :report_size;
+        comp.reportLinkBytes(nav, lf.navAtomSize(nav) orelse break :report_size);
+    }
+
     if (timer.finish()) |ns_link| report_time: {
         const zir_decl: ?InternPool.TrackedInst.Index = switch (task) {
             .link_type, .update_line_number => null,
@@ -53,6 +53,13 @@ code_buf: []u8,
 /// Optimization, `flush` reuses this buffer rather than creating a new
 /// one with every call.
 scratch_buf: []u32,
+/// The number of translation units the output is split into. When greater than one, see
+/// `flushShards` for the layout of the emitted files.
+shard_count: u32,
+/// The hash of the contents of each shard as of the last `flush`, so that files whose contents
+/// did not change are not rewritten, preserving their modification time for the downstream C
+/// build. Empty until the first sharded `flush`.
+shard_digests: []?u64,
 
 /// A reference into `string_bytes`.
 const String = extern struct {
@@ -82,8 +89,14 @@ pub const AvBlock = struct {
     ctype_pool: codegen.CType.Pool = .empty,
     /// May contain string references to ctype_pool
     lazy_fns: codegen.LazyFnMap = .{},
+    /// The navs and UAVs referenced by this block, which need forward declarations in the shard
+    /// defining it. Only collected when the output is split into shards.
+    ref_navs: []const InternPool.Nav.Index = &.{},
+    ref_uavs: []const InternPool.Index = &.{},
 
     fn deinit(ab: *AvBlock, gpa: Allocator) void {
+        gpa.free(ab.ref_navs);
+        gpa.free(ab.ref_uavs);
         ab.lazy_fns.deinit(gpa);
         ab.ctype_pool.deinit(gpa);
         ab.* = undefined;
@@ -99,6 +112,12 @@ pub fn getString(this: C, s: String) []const u8 {
     return this.string_bytes.items[s.start..][0..s.len];
 }
 
+/// The number of bytes of C source rendered for `nav_index`, not counting the `CType`s it uses.
+pub fn navAtomSize(this: *C, nav_index: InternPool.Nav.Index) ?u64 {
+    const av_block = this.navs.getPtr(nav_index) orelse return null;
+    return av_block.fwd_decl.len + av_block.code.len;
+}
+
 pub fn addString(this: *C, s: []const u8) Allocator.Error!String {
     const comp = this.base.comp;
     const gpa = comp.gpa;
@@ -165,6 +184,8 @@ pub fn createEmpty(
         .code_header_buf = &.{},
         .code_buf = &.{},
         .scratch_buf = &.{},
+        .shard_count = options.c_shards,
+        .shard_digests = &.{},
     };
 
     return c_file;
@@ -192,6 +213,7 @@ pub fn deinit(self: *C) void {
     gpa.free(self.code_header_buf);
     gpa.free(self.code_buf);
     gpa.free(self.scratch_buf);
+    gpa.free(self.shard_digests);
 }
 
 pub fn updateFunc(
@@ -216,6 +238,10 @@ pub fn updateFunc(
     const code_header = try self.addString(mir.c.code_header);
     const code = try self.addString(mir.c.code);
     gop.value_ptr.code = code_header.concat(code);
+    if (self.shard_count > 1) {
+        gop.value_ptr.ref_navs = try gpa.dupe(InternPool.Nav.Index, mir.c.navs.keys());
+        gop.value_ptr.ref_uavs = try gpa.dupe(InternPool.Index, mir.c.uavs.keys());
+    }
     try self.addUavsFromCodegen(&mir.c.uavs);
 }
 
@@ -223,6 +249,9 @@ fn updateUav(self: *C, pt: Zcu.PerThread, i: usize) link.File.FlushError!void {
     const gpa = self.base.comp.gpa;
     const uav = self.uavs.keys()[i];
 
+    var ref_navs: std.AutoArrayHashMapUnmanaged(InternPool.Nav.Index, void) = .empty;
+    defer ref_navs.deinit(gpa);
+
     var object: codegen.Object = .{
         .dg = .{
             .gpa = gpa,
@@ -236,6 +265,7 @@ fn updateUav(self: *C, pt: Zcu.PerThread, i: usize) link.File.FlushError!void {
             .ctype_pool = .empty,
             .scratch = .initBuffer(self.scratch_buf),
             .uavs = .empty,
+            .ref_navs = if (self.shard_count > 1) &ref_navs else null,
         },
         .code_header = undefined,
         .code = undefined,
@@ -267,11 +297,18 @@ fn updateUav(self: *C, pt: Zcu.PerThread, i: usize) link.File.FlushError!void {
     try self.addUavsFromCodegen(&object.dg.uavs);
 
     object.dg.ctype_pool.freeUnusedCapacity(gpa);
-    self.uavs.values()[i] = .{
+    const av_block = &self.uavs.values()[i];
+    gpa.free(av_block.ref_navs);
+    gpa.free(av_block.ref_uavs);
+    av_block.* = .{
         .fwd_decl = try self.addString(object.dg.fwd_decl.written()),
         .code = try self.addString(object.code.written()),
         .ctype_pool = object.dg.ctype_pool.move(),
     };
+    if (self.shard_count > 1) {
+        av_block.ref_navs = try gpa.dupe(InternPool.Nav.Index, ref_navs.keys());
+        av_block.ref_uavs = try gpa.dupe(InternPool.Index, object.dg.uavs.keys());
+    }
 }
 
 pub fn updateNav(self: *C, pt: Zcu.PerThread, nav_index: InternPool.Nav.Index) link.File.UpdateNavError!void {
@@ -298,6 +335,9 @@ pub fn updateNav(self: *C, pt: Zcu.PerThread, nav_index: InternPool.Nav.Index) l
     try ctype_pool.init(gpa);
     ctype_pool.clearRetainingCapacity();
 
+    var ref_navs: std.AutoArrayHashMapUnmanaged(InternPool.Nav.Index, void) = .empty;
+    defer ref_navs.deinit(gpa);
+
     var object: codegen.Object = .{
         .dg = .{
             .gpa = gpa,
@@ -311,6 +351,7 @@ pub fn updateNav(self: *C, pt: Zcu.PerThread, nav_index: InternPool.Nav.Index) l
             .ctype_pool = ctype_pool.*,
             .scratch = .initBuffer(self.scratch_buf),
             .uavs = .empty,
+            .ref_navs = if (self.shard_count > 1) &ref_navs else null,
         },
         .code_header = undefined,
         .code = undefined,
@@ -337,6 +378,14 @@ pub fn updateNav(self: *C, pt: Zcu.PerThread, nav_index: InternPool.Nav.Index) l
     };
     gop.value_ptr.fwd_decl = try self.addString(object.dg.fwd_decl.written());
     gop.value_ptr.code = try self.addString(object.code.written());
+    if (self.shard_count > 1) {
+        gpa.free(gop.value_ptr.ref_navs);
+        gop.value_ptr.ref_navs = &.{};
+        gpa.free(gop.value_ptr.ref_uavs);
+        gop.value_ptr.ref_uavs = &.{};
+        gop.value_ptr.ref_navs = try gpa.dupe(InternPool.Nav.Index, ref_navs.keys());
+        gop.value_ptr.ref_uavs = try gpa.dupe(InternPool.Index, object.dg.uavs.keys());
+    }
     try self.addUavsFromCodegen(&object.dg.uavs);
 }
 
@@ -359,8 +408,6 @@ fn abiDefines(w: *std.Io.Writer, target: *const std.Target) !void {
 }
 
 pub fn flush(self: *C, arena: Allocator, tid: Zcu.PerThread.Id, prog_node: std.Progress.Node) link.File.FlushError!void {
-    _ = arena; // Has the same lifetime as the call to Compilation.update.
-
     const tracy = trace(@src());
     defer tracy.end();
 
@@ -394,6 +441,8 @@ pub fn flush(self: *C, arena: Allocator, tid: Zcu.PerThread.Id, prog_node: std.P
         .lazy_fns = .empty,
         .lazy_fwd_decl = .empty,
         .lazy_code = .empty,
+        .lazy_ref_navs = .empty,
+        .lazy_ref_uavs = .empty,
 
         .all_buffers = .empty,
         .file_size = 0,
@@ -431,27 +480,27 @@ pub fn flush(self: *C, arena: Allocator, tid: Zcu.PerThread.Id, prog_node: std.P
     // Unlike other backends, the .c code we are emitting has order-dependent decls.
     // `CType`s, forward decls, and non-functions first.
 
-    {
-        var export_names: std.AutoHashMapUnmanaged(InternPool.NullTerminatedString, void) = .empty;
-        defer export_names.deinit(gpa);
-        try export_names.ensureTotalCapacity(gpa, @intCast(zcu.single_exports.count()));
-        for (zcu.single_exports.values()) |export_index| {
-            export_names.putAssumeCapacity(export_index.ptr(zcu).opts.name, {});
-        }
-        for (zcu.multi_exports.values()) |info| {
-            try export_names.ensureUnusedCapacity(gpa, info.len);
-            for (zcu.all_exports.items[info.index..][0..info.len]) |@"export"| {
-                export_names.putAssumeCapacity(@"export".opts.name, {});
-            }
+    var export_names: std.AutoHashMapUnmanaged(InternPool.NullTerminatedString, void) = .empty;
+    defer export_names.deinit(gpa);
+    try export_names.ensureTotalCapacity(gpa, @intCast(zcu.single_exports.count()));
+    for (zcu.single_exports.values()) |export_index| {
+        export_names.putAssumeCapacity(export_index.ptr(zcu).opts.name, {});
+    }
+    for (zcu.multi_exports.values()) |info| {
+        try export_names.ensureUnusedCapacity(gpa, info.len);
+        for (zcu.all_exports.items[info.index..][0..info.len]) |@"export"| {
+            export_names.putAssumeCapacity(@"export".opts.name, {});
         }
+    }
 
+    {
         for (self.uavs.keys(), self.uavs.values()) |uav, *av_block| try self.flushAvBlock(
             pt,
             zcu.root_mod,
             &f,
             av_block,
             self.exported_uavs.getPtr(uav),
-            export_names,
+            &export_names,
             .none,
         );
 
@@ -461,7 +510,7 @@ pub fn flush(self: *C, arena: Allocator, tid: Zcu.PerThread.Id, prog_node: std.P
             &f,
             av_block,
             self.exported_navs.getPtr(nav),
-            export_names,
+            &export_names,
             if (ip.getNav(nav).getExtern(ip) != null)
                 ip.getNav(nav).name.toOptional()
             else
@@ -494,17 +543,13 @@ pub fn flush(self: *C, arena: Allocator, tid: Zcu.PerThread.Id, prog_node: std.P
     try f.all_buffers.ensureUnusedCapacity(gpa, 1 + (self.uavs.count() + self.navs.count()) * 2);
     f.appendBufAssumeCapacity(f.lazy_code.items);
     for (self.uavs.keys(), self.uavs.values()) |uav, av_block| f.appendCodeAssumeCapacity(
-        if (self.exported_uavs.contains(uav)) .default else switch (ip.indexToKey(uav)) {
-            .@"extern" => .zig_extern,
-            else => .static,
-        },
+        self.uavStorage(uav),
+        self.getString(av_block.code),
+    );
+    for (self.navs.keys(), self.navs.values()) |nav, av_block| f.appendCodeAssumeCapacity(
+        self.navStorage(nav),
         self.getString(av_block.code),
     );
-    for (self.navs.keys(), self.navs.values()) |nav, av_block| f.appendCodeAssumeCapacity(storage: {
-        if (self.exported_navs.contains(nav)) break :storage .default;
-        if (ip.getNav(nav).getExtern(ip) != null) break :storage .zig_extern;
-        break :storage .static;
-    }, self.getString(av_block.code));
 
     const file = self.base.file.?;
     file.setEndPos(f.file_size) catch |err| return diags.fail("failed to allocate file: {s}", .{@errorName(err)});
@@ -515,6 +560,14 @@ pub fn flush(self: *C, arena: Allocator, tid: Zcu.PerThread.Id, prog_node: std.P
             std.fmt.alt(self.base.emit, .formatEscapeChar), @errorName(fw.err.?),
         }),
     };
+
+    if (self.shard_count > 1) try self.flushShards(
+        arena,
+        &f,
+        abi_defines_aw.written(),
+        asm_aw.written(),
+        &export_names,
+    );
 }
 
 const Flush = struct {
@@ -526,6 +579,9 @@ const Flush = struct {
     lazy_fns: LazyFns,
     lazy_fwd_decl: std.ArrayList(u8),
     lazy_code: std.ArrayList(u8),
+    /// The navs and UAVs referenced by `lazy_code`, which every shard includes.
+    lazy_ref_navs: std.AutoArrayHashMapUnmanaged(InternPool.Nav.Index, void),
+    lazy_ref_uavs: std.ArrayList(InternPool.Index),
 
     /// We collect a list of buffers to write, and write them all at once with pwritev 😎
     all_buffers: std.ArrayList([]const u8),
@@ -540,13 +596,9 @@ const Flush = struct {
         f.file_size += buf.len;
     }
 
-    fn appendCodeAssumeCapacity(f: *Flush, storage: enum { default, zig_extern, static }, code: []const u8) void {
+    fn appendCodeAssumeCapacity(f: *Flush, storage: Storage, code: []const u8) void {
         if (code.len == 0) return;
-        f.appendBufAssumeCapacity(switch (storage) {
-            .default => "\n",
-            .zig_extern => "\nzig_extern ",
-            .static => "\nstatic ",
-        });
+        f.appendBufAssumeCapacity(storage.prefix());
         f.appendBufAssumeCapacity(code);
     }
 
@@ -559,10 +611,273 @@ const Flush = struct {
         f.lazy_fns.deinit(gpa);
         f.lazy_fwd_decl.deinit(gpa);
         f.lazy_code.deinit(gpa);
+        f.lazy_ref_navs.deinit(gpa);
+        f.lazy_ref_uavs.deinit(gpa);
         f.all_buffers.deinit(gpa);
     }
 };
 
+const Storage = enum {
+    default,
+    zig_extern,
+    static,
+
+    fn prefix(storage: Storage) []const u8 {
+        return switch (storage) {
+            .default => "\n",
+            .zig_extern => "\nzig_extern ",
+            .static => "\nstatic ",
+        };
+    }
+};
+
+fn uavStorage(self: *const C, uav: InternPool.Index) Storage {
+    const ip = &self.base.comp.zcu.?.intern_pool;
+    if (self.exported_uavs.contains(uav)) return .default;
+    return switch (ip.indexToKey(uav)) {
+        .@"extern" => .zig_extern,
+        else => .static,
+    };
+}
+
+fn navStorage(self: *const C, nav: InternPool.Nav.Index) Storage {
+    const ip = &self.base.comp.zcu.?.intern_pool;
+    if (self.exported_navs.contains(nav)) return .default;
+    if (ip.getNav(nav).getExtern(ip) != null) return .zig_extern;
+    return .static;
+}
+
+/// In addition to the complete output, writes it as `shard_count` translation units which can be
+/// compiled independently, and therefore in parallel. Given the emitted file `foo.c`, these are
+/// `foo.0.c` through `foo.{shard_count-1}.c`, and they are installed next to it.
+///
+/// Navs are assigned to shards by hashing their fully qualified names, and UAVs are defined in
+/// the lowest shard referencing them, so that the assignment does not depend on the order of
+/// analysis. Each shard contains only the `CType`s and forward declarations used by the
+/// declarations it defines, so editing a declaration only changes the shards which define or
+/// reference it.
+///
+/// Declarations which would otherwise have internal linkage are given external linkage, since
+/// they may be referenced from a different shard than the one defining them. To keep the objects
+/// of two different outputs from clashing when linked together, their names are prefixed with
+/// the name of the output.
+fn flushShards(
+    self: *C,
+    arena: Allocator,
+    f: *const Flush,
+    abi_defines: []const u8,
+    global_asm: []const u8,
+    export_names: *const std.AutoHashMapUnmanaged(InternPool.NullTerminatedString, void),
+) link.File.FlushError!void {
+    const comp = self.base.comp;
+    const gpa = comp.gpa;
+    const zcu = comp.zcu.?;
+    const ip = &zcu.intern_pool;
+
+    const sub_path = self.base.emit.sub_path;
+    const dir_and_stem = sub_path[0 .. sub_path.len - fs.path.extension(sub_path).len];
+    const prefix = try std.fmt.allocPrint(arena, "zig_{f}_", .{
+        codegen.fmtIdentUnsolo(fs.path.basename(dir_and_stem)),
+    });
+
+    if (self.shard_digests.len != self.shard_count) {
+        gpa.free(self.shard_digests);
+        self.shard_digests = &.{};
+        self.shard_digests = try gpa.alloc(?u64, self.shard_count);
+        @memset(self.shard_digests, null);
+    }
+
+    const nav_shards = try arena.alloc(u32, self.navs.count());
+    for (self.navs.keys(), nav_shards) |nav, *shard| {
+        shard.* = @intCast(std.hash.Wyhash.hash(0, ip.getNav(nav).fqn.toSlice(ip)) % self.shard_count);
+    }
+    const uav_shards = try arena.alloc(u32, self.uavs.count());
+    @memset(uav_shards, self.shard_count);
+    for (self.navs.values(), nav_shards) |av_block, shard| for (av_block.ref_uavs) |uav| {
+        const uav_i = self.uavs.getIndex(uav) orelse continue;
+        uav_shards[uav_i] = @min(uav_shards[uav_i], shard);
+    };
+    // UAVs referenced by other UAVs are added after them by `updateUav`.
+    for (self.uavs.values(), uav_shards) |av_block, *shard| {
+        if (shard.* == self.shard_count) shard.* = 0;
+        for (av_block.ref_uavs) |uav| {
+            const uav_i = self.uavs.getIndex(uav) orelse continue;
+            uav_shards[uav_i] = @min(uav_shards[uav_i], shard.*);
+        }
+    }
+
+    var ref_navs: std.DynamicBitSetUnmanaged = try .initEmpty(arena, self.navs.count());
+    var ref_uavs: std.DynamicBitSetUnmanaged = try .initEmpty(arena, self.uavs.count());
+    for (0..self.shard_count) |shard| {
+        ref_navs.unsetAll();
+        ref_uavs.unsetAll();
+        const Refs = struct {
+            c: *const C,
+            navs: *std.DynamicBitSetUnmanaged,
+            uavs: *std.DynamicBitSetUnmanaged,
+
+            fn add(refs: @This(), navs: []const InternPool.Nav.Index, uavs: []const InternPool.Index) void {
+                for (navs) |nav| if (refs.c.navs.getIndex(nav)) |nav_i| refs.navs.set(nav_i);
+                for (uavs) |uav| if (refs.c.uavs.getIndex(uav)) |uav_i| refs.uavs.set(uav_i);
+            }
+        };
+        const refs: Refs = .{ .c = self, .navs = &ref_navs, .uavs = &ref_uavs };
+        refs.add(f.lazy_ref_navs.keys(), f.lazy_ref_uavs.items);
+        for (self.navs.values(), nav_shards, 0..) |av_block, nav_shard, nav_i| if (nav_shard == shard) {
+            ref_navs.set(nav_i);
+            refs.add(av_block.ref_navs, av_block.ref_uavs);
+        };
+        for (self.uavs.values(), uav_shards, 0..) |av_block, uav_shard, uav_i| if (uav_shard == shard) {
+            ref_uavs.set(uav_i);
+            refs.add(av_block.ref_navs, av_block.ref_uavs);
+        };
+
+        var sf: Flush = .{
+            .ctype_pool = .empty,
+            .ctype_global_from_decl_map = .empty,
+            .ctypes = .empty,
+
+            .lazy_ctype_pool = .empty,
+            .lazy_fns = .empty,
+            .lazy_fwd_decl = .empty,
+            .lazy_code = .empty,
+            .lazy_ref_navs = .empty,
+            .lazy_ref_uavs = .empty,
+
+            .all_buffers = .empty,
+            .file_size = 0,
+        };
+        defer sf.deinit(gpa);
+        // As in `flush`, the lazy `CType`s come first so that their indexes match.
+        try sf.ctype_pool.init(gpa);
+        try self.flushCTypes(zcu, &sf, .flush, &f.lazy_ctype_pool);
+
+        var names_aw: std.Io.Writer.Allocating = .init(arena);
+        var fwd_decls: std.ArrayList([]const u8) = .empty;
+        var code: std.ArrayList([]const u8) = .empty;
+        {
+            var it = ref_uavs.iterator(.{});
+            while (it.next()) |uav_i| {
+                const uav = self.uavs.keys()[uav_i];
+                const av_block = &self.uavs.values()[uav_i];
+                try self.flushCTypes(zcu, &sf, .{ .uav = uav }, &av_block.ctype_pool);
+                if (self.uavStorage(uav) == .static) {
+                    names_aw.writer.print("#define __anon_{d} {s}__anon_{d}\n", .{
+                        @intFromEnum(uav), prefix, @intFromEnum(uav),
+                    }) catch return error.OutOfMemory;
+                }
+                try appendShardedFwdDecl(arena, &fwd_decls, self.avBlockFwdDecl(
+                    av_block,
+                    self.exported_uavs.getPtr(uav),
+                    export_names,
+                    .none,
+                ));
+            }
+        }
+        {
+            var it = ref_navs.iterator(.{});
+            while (it.next()) |nav_i| {
+                const nav = self.navs.keys()[nav_i];
+                const av_block = &self.navs.values()[nav_i];
+                try self.flushCTypes(zcu, &sf, .{ .nav = nav }, &av_block.ctype_pool);
+                if (self.navStorage(nav) == .static) {
+                    const w = &names_aw.writer;
+                    w.writeAll("#define ") catch return error.OutOfMemory;
+                    codegen.renderNavIdent(w, ip, nav) catch return error.OutOfMemory;
+                    w.print(" {s}", .{prefix}) catch return error.OutOfMemory;
+                    codegen.renderNavIdent(w, ip, nav) catch return error.OutOfMemory;
+                    w.writeByte('\n') catch return error.OutOfMemory;
+                }
+                try appendShardedFwdDecl(arena, &fwd_decls, self.avBlockFwdDecl(
+                    av_block,
+                    self.exported_navs.getPtr(nav),
+                    export_names,
+                    if (ip.getNav(nav).getExtern(ip) != null) ip.getNav(nav).name.toOptional() else .none,
+                ));
+            }
+        }
+        for (self.uavs.keys(), self.uavs.values(), uav_shards) |uav, av_block, uav_shard| {
+            if (uav_shard != shard) continue;
+            const av_code = self.getString(av_block.code);
+            if (av_code.len == 0) continue;
+            try code.appendSlice(arena, &.{ shardedPrefix(self.uavStorage(uav)), av_code });
+        }
+        for (self.navs.keys(), self.navs.values(), nav_shards) |nav, av_block, nav_shard| {
+            if (nav_shard != shard) continue;
+            const av_code = self.getString(av_block.code);
+            if (av_code.len == 0) continue;
+            try code.appendSlice(arena, &.{ shardedPrefix(self.navStorage(nav)), av_code });
+        }
+
+        var buffers: std.ArrayList([]const u8) = .empty;
+        try buffers.appendSlice(arena, &.{
+            abi_defines,
+            zig_h,
+            names_aw.written(),
+            sf.ctypes.items,
+            // Global assembly must only be emitted once.
+            if (shard == 0) global_asm else "",
+            f.lazy_fwd_decl.items,
+        });
+        try buffers.appendSlice(arena, fwd_decls.items);
+        try buffers.append(arena, f.lazy_code.items);
+        try buffers.appendSlice(arena, code.items);
+        try self.writeShard(
+            try std.fmt.allocPrint(arena, "{s}.{d}.c", .{ dir_and_stem, shard }),
+            buffers.items,
+            &self.shard_digests[shard],
+        );
+    }
+}
+
+/// Appends `fwd_decl`, replacing internal linkage with external linkage, since the declaration
+/// may be defined in a different shard.
+fn appendShardedFwdDecl(arena: Allocator, fwd_decls: *std.ArrayList([]const u8), fwd_decl: []const u8) Allocator.Error!void {
+    var line_start: usize = 0;
+    while (line_start < fwd_decl.len) {
+        const line_end = if (mem.indexOfScalarPos(u8, fwd_decl, line_start, '\n')) |i| i + 1 else fwd_decl.len;
+        const line = fwd_decl[line_start..line_end];
+        if (mem.cutPrefix(u8, line, "static ")) |rest| {
+            try fwd_decls.appendSlice(arena, &.{ "zig_extern ", rest });
+        } else {
+            try fwd_decls.append(arena, line);
+        }
+        line_start = line_end;
+    }
+}
+
+/// Definitions which would have internal linkage in a single translation unit have external
+/// linkage when sharding, matching their forward declarations in the shared header.
+fn shardedPrefix(storage: Storage) []const u8 {
+    return switch (storage) {
+        .default, .static => Storage.default.prefix(),
+        .zig_extern => Storage.zig_extern.prefix(),
+    };
+}
+
+/// Writes `buffers` to `sub_path` relative to the emit directory, unless the contents are
+/// unchanged since they were last written, according to `digest`.
+fn writeShard(self: *C, sub_path: []const u8, buffers: [][]const u8, digest: *?u64) link.File.FlushError!void {
+    const diags = &self.base.comp.link_diags;
+    const path: Path = .{ .root_dir = self.base.emit.root_dir, .sub_path = sub_path };
+
+    var hasher: std.hash.Wyhash = .init(0);
+    for (buffers) |buf| hasher.update(buf);
+    const new_digest = hasher.final();
+    if (digest.* == new_digest) return;
+
+    const file = path.root_dir.handle.createFile(path.sub_path, .{}) catch |err|
+        return diags.fail("failed to create '{f}': {s}", .{ std.fmt.alt(path, .formatEscapeChar), @errorName(err) });
+    defer file.close();
+    var fw = file.writer(&.{});
+    fw.interface.writeVecAll(buffers) catch |err| switch (err) {
+        error.WriteFailed => return diags.fail("failed to write to '{f}': {s}", .{
+            std.fmt.alt(path, .formatEscapeChar), @errorName(fw.err.?),
+        }),
+    };
+    digest.* = new_digest;
+}
+
 const FlushDeclError = error{
     OutOfMemory,
 };
@@ -642,6 +957,7 @@ fn flushErrDecls(self: *C, pt: Zcu.PerThread, f: *Flush) FlushDeclError!void {
             .ctype_pool = f.lazy_ctype_pool,
             .scratch = .initBuffer(self.scratch_buf),
             .uavs = .empty,
+            .ref_navs = &f.lazy_ref_navs,
         },
         .code_header = undefined,
         .code = undefined,
@@ -664,6 +980,7 @@ fn flushErrDecls(self: *C, pt: Zcu.PerThread, f: *Flush) FlushDeclError!void {
         error.WriteFailed, error.OutOfMemory => return error.OutOfMemory,
     };
 
+    try f.lazy_ref_uavs.appendSlice(gpa, object.dg.uavs.keys());
     try self.addUavsFromCodegen(&object.dg.uavs);
 }
 
@@ -690,6 +1007,7 @@ fn flushLazyFn(
             .ctype_pool = f.lazy_ctype_pool,
             .scratch = .initBuffer(self.scratch_buf),
             .uavs = .empty,
+            .ref_navs = &f.lazy_ref_navs,
         },
         .code_header = undefined,
         .code = undefined,
@@ -742,18 +1060,28 @@ fn flushAvBlock(
     f: *Flush,
     av_block: *const AvBlock,
     exported_block: ?*const ExportedBlock,
-    export_names: std.AutoHashMapUnmanaged(InternPool.NullTerminatedString, void),
+    export_names: *const std.AutoHashMapUnmanaged(InternPool.NullTerminatedString, void),
     extern_name: InternPool.OptionalNullTerminatedString,
 ) FlushDeclError!void {
     const gpa = self.base.comp.gpa;
     try self.flushLazyFns(pt, mod, f, &av_block.ctype_pool, av_block.lazy_fns);
     try f.all_buffers.ensureUnusedCapacity(gpa, 1);
+    f.appendBufAssumeCapacity(self.avBlockFwdDecl(av_block, exported_block, export_names, extern_name));
+}
+
+fn avBlockFwdDecl(
+    self: *const C,
+    av_block: *const AvBlock,
+    exported_block: ?*const ExportedBlock,
+    export_names: *const std.AutoHashMapUnmanaged(InternPool.NullTerminatedString, void),
+    extern_name: InternPool.OptionalNullTerminatedString,
+) []const u8 {
     // avoid emitting extern decls that are already exported
-    if (extern_name.unwrap()) |name| if (export_names.contains(name)) return;
-    f.appendBufAssumeCapacity(self.getString(if (exported_block) |exported|
+    if (extern_name.unwrap()) |name| if (export_names.contains(name)) return &.{};
+    return self.getString(if (exported_block) |exported|
         exported.fwd_decl
     else
-        av_block.fwd_decl));
+        av_block.fwd_decl);
 }
 
 pub fn flushEmitH(zcu: *Zcu) !void {
@@ -467,6 +467,10 @@ pub fn getNavVAddr(self: *Elf, pt: Zcu.PerThread, nav_index: InternPool.Nav.Inde
     return self.zigObjectPtr().?.getNavVAddr(self, pt, nav_index, reloc_info);
 }
 
+pub fn navAtomSize(self: *Elf, nav_index: InternPool.Nav.Index) ?u64 {
+    return self.zigObjectPtr().?.navAtomSize(self, nav_index);
+}
+
 pub fn lowerUav(
     self: *Elf,
     pt: Zcu.PerThread,
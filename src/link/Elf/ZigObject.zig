@@ -915,6 +915,13 @@ pub fn codeAlloc(self: *ZigObject, elf_file: *Elf, atom_index: Atom.Index) ![]u8
     return code;
 }
 
+/// The size of the atom holding `nav_index`, or `null` if no atom was created for it.
+pub fn navAtomSize(self: *ZigObject, elf_file: *Elf, nav_index: InternPool.Nav.Index) ?u64 {
+    const meta = self.navs.get(nav_index) orelse return null;
+    const atom_ptr = self.symbol(meta.symbol_index).atom(elf_file) orelse return null;
+    return atom_ptr.size;
+}
+
 pub fn getNavVAddr(
     self: *ZigObject,
     elf_file: *Elf,
@@ -3096,6 +3096,10 @@ pub fn getNavVAddr(self: *MachO, pt: Zcu.PerThread, nav_index: InternPool.Nav.In
     return self.getZigObject().?.getNavVAddr(self, pt, nav_index, reloc_info);
 }
 
+pub fn navAtomSize(self: *MachO, nav_index: InternPool.Nav.Index) ?u64 {
+    return self.getZigObject().?.navAtomSize(self, nav_index);
+}
+
 pub fn lowerUav(
     self: *MachO,
     pt: Zcu.PerThread,
@@ -608,6 +608,13 @@ pub fn flush(self: *ZigObject, macho_file: *MachO, tid: Zcu.PerThread.Id) link.F
     assert(!self.debug_strtab_dirty);
 }
 
+/// The size of the atom holding `nav_index`, or `null` if no atom was created for it.
+pub fn navAtomSize(self: *ZigObject, macho_file: *MachO, nav_index: InternPool.Nav.Index) ?u64 {
+    const meta = self.navs.get(nav_index) orelse return null;
+    const atom = self.symbols.items[meta.symbol_index].getAtom(macho_file) orelse return null;
+    return atom.size;
+}
+
 pub fn getNavVAddr(
     self: *ZigObject,
     macho_file: *MachO,
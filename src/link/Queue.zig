@@ -53,6 +53,9 @@ air_bytes_waiting: u32,
 /// After setting `air_bytes_waiting`, `enqueueZcu` will wait on this condition (with `mutex`).
 /// When `air_bytes_waiting` many bytes can be queued, this condition should be signaled.
 air_bytes_cond: std.Thread.Condition,
+/// The largest value `air_bytes_in_flight` has reached during this update, for `--mem-report`.
+/// Guarded by `mutex`.
+air_bytes_peak: u32,
 
 /// Guarded by `mutex`.
 state: union(enum) {
@@ -87,6 +90,7 @@ pub const empty: Queue = .{
     .air_bytes_in_flight = 0,
     .air_bytes_waiting = 0,
     .air_bytes_cond = .{},
+    .air_bytes_peak = 0,
 };
 /// `lf` is needed to correctly deinit any pending `ZcuTask`s.
 pub fn deinit(q: *Queue, comp: *Compilation) void {
@@ -195,6 +199,7 @@ pub fn enqueueZcu(q: *Queue, comp: *Compilation, task: ZcuTask) Allocator.Error!
                 q.air_bytes_waiting = 0;
             }
             q.air_bytes_in_flight += task.link_func.air_bytes;
+            q.air_bytes_peak = @max(q.air_bytes_peak, q.air_bytes_in_flight);
         }
         try q.queued_zcu.append(comp.gpa, task);
         switch (q.state) {
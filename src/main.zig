@@ -472,6 +472,9 @@ const usage_build_generic =
     \\  -mexec-model=[value]      (WASI) Execution model
     \\  -municode                 (Windows) Use wmain/wWinMain as entry point
     \\  --time-report             Send timing diagnostics to '--listen' clients
+    \\  --time-report-phases      Send the duration of each phase to '--listen' clients,
+    \\                            without ignoring cache hits like '--time-report'
+    \\  --mem-report              Print memory usage by declaration to stderr after each update
     \\
     \\Per-Module Compile Options:
     \\  -target [name]            <arch><sub>-<os>-<abi> see the targets command
@@ -613,6 +616,7 @@ const usage_build_generic =
     \\  --subsystem [subsystem]        (Windows) /SUBSYSTEM:<subsystem> to the linker
     \\  --stack [size]                 Override default stack size
     \\  --image-base [addr]            Set base address for executable image
+    \\  --c-shards [count]             (C) Also split the output into this many translation units
     \\  -install_name=[value]          (Darwin) add dylib's install name
     \\  --entitlements [path]          (Darwin) add path to entitlements file for embedding in code signature
     \\  -pagezero_size [value]         (Darwin) size of the __PAGEZERO segment in hexadecimal notation
@@ -824,6 +828,8 @@ fn buildOutputType(
     var verbose_cimport = false;
     var verbose_llvm_cpu_features = false;
     var time_report = false;
+    var time_report_phases = false;
+    var mem_report = false;
     var stack_report = false;
     var show_builtin = false;
     var emit_bin: EmitBin = .yes_default_path;
@@ -880,6 +886,7 @@ fn buildOutputType(
     var force_undefined_symbols: std.StringArrayHashMapUnmanaged(void) = .empty;
     var stack_size: ?u64 = null;
     var image_base: ?u64 = null;
+    var c_shards: ?u32 = null;
     var link_eh_frame_hdr = false;
     var link_emit_relocs = false;
     var build_id: ?std.zig.BuildId = null;
@@ -1145,6 +1152,8 @@ fn buildOutputType(
                         stack_size = parseStackSize(args_iter.nextOrFatal());
                     } else if (mem.eql(u8, arg, "--image-base")) {
                         image_base = parseImageBase(args_iter.nextOrFatal());
+                    } else if (mem.eql(u8, arg, "--c-shards")) {
+                        c_shards = parseCShards(args_iter.nextOrFatal());
                     } else if (mem.eql(u8, arg, "--name")) {
                         provided_name = args_iter.nextOrFatal();
                         if (!mem.eql(u8, provided_name.?, fs.path.basename(provided_name.?)))
@@ -1382,6 +1391,10 @@ fn buildOutputType(
                         test_no_exec = true;
                     } else if (mem.eql(u8, arg, "--time-report")) {
                         time_report = true;
+                    } else if (mem.eql(u8, arg, "--time-report-phases")) {
+                        time_report_phases = true;
+                    } else if (mem.eql(u8, arg, "--mem-report")) {
+                        mem_report = true;
                     } else if (mem.eql(u8, arg, "-fstack-report")) {
                         stack_report = true;
                     } else if (mem.eql(u8, arg, "-fPIC")) {
@@ -2877,6 +2890,9 @@ fn buildOutputType(
     if (time_report and listen == .none) {
         fatal("--time-report requires --listen", .{});
     }
+    if (time_report_phases and listen == .none) {
+        fatal("--time-report-phases requires --listen", .{});
+    }
 
     if (arg_mode == .translate_c and create_module.c_source_files.items.len != 1) {
         fatal("translate-c expects exactly 1 source file (found {d})", .{create_module.c_source_files.items.len});
@@ -3465,6 +3481,7 @@ fn buildOutputType(
         .force_undefined_symbols = force_undefined_symbols,
         .stack_size = stack_size,
         .image_base = image_base,
+        .c_shards = c_shards,
         .function_sections = function_sections,
         .data_sections = data_sections,
         .clang_passthrough_mode = clang_passthrough_mode,
@@ -3482,6 +3499,8 @@ fn buildOutputType(
         .verbose_cimport = verbose_cimport,
         .verbose_llvm_cpu_features = verbose_llvm_cpu_features,
         .time_report = time_report,
+        .time_report_phases = time_report_phases,
+        .mem_report = mem_report,
         .stack_report = stack_report,
         .build_id = build_id,
         .test_filters = test_filters.items,
@@ -4222,44 +4241,84 @@ fn serveUpdateResults(s: *Server, comp: *Compilation) !void {
         var decl_data: std.ArrayList(u8) = .empty;
         defer decl_data.deinit(gpa);
 
-        // Each decl needs at least 34 bytes:
-        // * 2 for 1-byte name plus null terminator
-        // * 4 for `file`
-        // * 4 for `sema_count`
-        // * 8 for `sema_ns`
-        // * 8 for `codegen_ns`
-        // * 8 for `link_ns`
-        // Most, if not all, decls in `tr.decl_sema_ns` are valid, so we have a good size estimate.
-        try decl_data.ensureUnusedCapacity(gpa, tr.decl_sema_info.count() * 34);
-
-        for (tr.decl_sema_info.keys(), tr.decl_sema_info.values()) |tracked_inst, sema_info| {
-            const resolved = tracked_inst.resolveFull(&comp.zcu.?.intern_pool) orelse continue;
-            const file = comp.zcu.?.fileByIndex(resolved.file);
-            const zir = file.zir orelse continue;
-            const decl_name = zir.nullTerminatedString(zir.getDeclaration(resolved.inst).name);
-
-            const gop = try files.getOrPut(gpa, resolved.file);
-            if (!gop.found_existing) try file_name_bytes.print(gpa, "{f}\x00", .{file.path.fmt(comp)});
-
-            const codegen_ns = tr.decl_codegen_ns.get(tracked_inst) orelse 0;
-            const link_ns = tr.decl_link_ns.get(tracked_inst) orelse 0;
-
-            decls_len += 1;
-
-            try decl_data.ensureUnusedCapacity(gpa, 33 + decl_name.len);
-            decl_data.appendSliceAssumeCapacity(decl_name);
-            decl_data.appendAssumeCapacity(0);
-
-            const out_file = decl_data.addManyAsArrayAssumeCapacity(4);
-            const out_sema_count = decl_data.addManyAsArrayAssumeCapacity(4);
-            const out_sema_ns = decl_data.addManyAsArrayAssumeCapacity(8);
-            const out_codegen_ns = decl_data.addManyAsArrayAssumeCapacity(8);
-            const out_link_ns = decl_data.addManyAsArrayAssumeCapacity(8);
-            std.mem.writeInt(u32, out_file, @intCast(gop.index), .little);
-            std.mem.writeInt(u32, out_sema_count, sema_info.count, .little);
-            std.mem.writeInt(u64, out_sema_ns, sema_info.ns, .little);
-            std.mem.writeInt(u64, out_codegen_ns, codegen_ns, .little);
-            std.mem.writeInt(u64, out_link_ns, link_ns, .little);
+        // Under `--time-report-phases`, only the stats of whole phases are sent.
+        if (!comp.time_report_phases_only) {
+            // Each decl needs at least 34 bytes:
+            // * 2 for 1-byte name plus null terminator
+            // * 4 for `file`
+            // * 4 for `sema_count`
+            // * 8 for `sema_ns`
+            // * 8 for `codegen_ns`
+            // * 8 for `link_ns`
+            // Most, if not all, decls in `tr.decl_sema_ns` are valid, so we have a good size estimate.
+            try decl_data.ensureUnusedCapacity(gpa, tr.decl_sema_info.count() * 34);
+
+            for (tr.decl_sema_info.keys(), tr.decl_sema_info.values()) |tracked_inst, sema_info| {
+                const resolved = tracked_inst.resolveFull(&comp.zcu.?.intern_pool) orelse continue;
+                const file = comp.zcu.?.fileByIndex(resolved.file);
+                const zir = file.zir orelse continue;
+                const decl_name = zir.nullTerminatedString(zir.getDeclaration(resolved.inst).name);
+
+                const gop = try files.getOrPut(gpa, resolved.file);
+                if (!gop.found_existing) try file_name_bytes.print(gpa, "{f}\x00", .{file.path.fmt(comp)});
+
+                const codegen_ns = tr.decl_codegen_ns.get(tracked_inst) orelse 0;
+                const link_ns = tr.decl_link_ns.get(tracked_inst) orelse 0;
+
+                decls_len += 1;
+
+                try decl_data.ensureUnusedCapacity(gpa, 33 + decl_name.len);
+                decl_data.appendSliceAssumeCapacity(decl_name);
+                decl_data.appendAssumeCapacity(0);
+
+                const out_file = decl_data.addManyAsArrayAssumeCapacity(4);
+                const out_sema_count = decl_data.addManyAsArrayAssumeCapacity(4);
+                const out_sema_ns = decl_data.addManyAsArrayAssumeCapacity(8);
+                const out_codegen_ns = decl_data.addManyAsArrayAssumeCapacity(8);
+                const out_link_ns = decl_data.addManyAsArrayAssumeCapacity(8);
+                std.mem.writeInt(u32, out_file, @intCast(gop.index), .little);
+                std.mem.writeInt(u32, out_sema_count, sema_info.count, .little);
+                std.mem.writeInt(u64, out_sema_ns, sema_info.ns, .little);
+                std.mem.writeInt(u64, out_codegen_ns, codegen_ns, .little);
+                std.mem.writeInt(u64, out_link_ns, link_ns, .little);
+            }
+        }
+
+        var fns_len: u32 = 0;
+        var fn_data: std.ArrayList(u8) = .empty;
+        defer fn_data.deinit(gpa);
+
+        if (!comp.time_report_phases_only) {
+            for (tr.decl_call_info.keys(), tr.decl_call_info.values()) |tracked_inst, info| {
+                const resolved = tracked_inst.resolveFull(&comp.zcu.?.intern_pool) orelse continue;
+                const file = comp.zcu.?.fileByIndex(resolved.file);
+                const zir = file.zir orelse continue;
+                const fn_name = zir.nullTerminatedString(zir.getDeclaration(resolved.inst).name);
+
+                const gop = try files.getOrPut(gpa, resolved.file);
+                if (!gop.found_existing) try file_name_bytes.print(gpa, "{f}\x00", .{file.path.fmt(comp)});
+
+                fns_len += 1;
+
+                try fn_data.ensureUnusedCapacity(gpa, 37 + fn_name.len);
+                fn_data.appendSliceAssumeCapacity(fn_name);
+                fn_data.appendAssumeCapacity(0);
+
+                const out_file = fn_data.addManyAsArrayAssumeCapacity(4);
+                const out_comptime_count = fn_data.addManyAsArrayAssumeCapacity(4);
+                const out_comptime_memoized_count = fn_data.addManyAsArrayAssumeCapacity(4);
+                const out_generic_count = fn_data.addManyAsArrayAssumeCapacity(4);
+                const out_generic_instances = fn_data.addManyAsArrayAssumeCapacity(4);
+                const out_comptime_branches = fn_data.addManyAsArrayAssumeCapacity(8);
+                const out_comptime_ns = fn_data.addManyAsArrayAssumeCapacity(8);
+                std.mem.writeInt(u32, out_file, @intCast(gop.index), .little);
+                std.mem.writeInt(u32, out_comptime_count, info.comptime_count, .little);
+                std.mem.writeInt(u32, out_comptime_memoized_count, info.comptime_memoized_count, .little);
+                std.mem.writeInt(u32, out_generic_count, info.generic_count, .little);
+                std.mem.writeInt(u32, out_generic_instances, info.generic_instances, .little);
+                std.mem.writeInt(u64, out_comptime_branches, info.comptime_branches, .little);
+                std.mem.writeInt(u64, out_comptime_ns, info.comptime_ns, .little);
+            }
         }
 
         const header: std.zig.Server.Message.TimeReport = .{
@@ -4267,16 +4326,18 @@ fn serveUpdateResults(s: *Server, comp: *Compilation) !void {
             .llvm_pass_timings_len = @intCast(tr.llvm_pass_timings.len),
             .files_len = @intCast(files.count()),
             .decls_len = decls_len,
+            .fns_len = fns_len,
             .flags = .{
                 .use_llvm = comp.zcu != null and comp.zcu.?.llvm_object != null,
             },
         };
 
-        var slices: [4][]const u8 = .{
+        var slices: [5][]const u8 = .{
             @ptrCast(&header),
             tr.llvm_pass_timings,
             file_name_bytes.items,
             decl_data.items,
+            fn_data.items,
         };
         try s.serveMessageHeader(.{
             .tag = .time_report,
@@ -4290,6 +4351,8 @@ fn serveUpdateResults(s: *Server, comp: *Compilation) !void {
         try s.out.flush();
     }
 
+    if (comp.mem_report != null) try serveMemReport(s, comp);
+
     if (error_bundle.errorMessageCount() > 0) {
         try s.serveErrorBundle(error_bundle);
         return;
@@ -4305,6 +4368,92 @@ fn serveUpdateResults(s: *Server, comp: *Compilation) !void {
     try s.serveErrorBundle(std.zig.ErrorBundle.empty);
 }
 
+fn serveMemReport(s: *Server, comp: *Compilation) !void {
+    const gpa = comp.gpa;
+    const mr = &comp.mem_report.?;
+    const zcu = comp.zcu orelse return;
+    const ip = &zcu.intern_pool;
+
+    var tag_stats = try ip.tagStats(gpa);
+    defer tag_stats.deinit(gpa);
+
+    var tag_data: std.ArrayList(u8) = .empty;
+    defer tag_data.deinit(gpa);
+    for (tag_stats.keys(), tag_stats.values()) |tag, stats| {
+        const tag_name = @tagName(tag);
+        try tag_data.ensureUnusedCapacity(gpa, 13 + tag_name.len);
+        tag_data.appendSliceAssumeCapacity(tag_name);
+        tag_data.appendAssumeCapacity(0);
+        std.mem.writeInt(u32, tag_data.addManyAsArrayAssumeCapacity(4), @intCast(stats.count), .little);
+        std.mem.writeInt(u64, tag_data.addManyAsArrayAssumeCapacity(8), stats.bytes, .little);
+    }
+
+    var file_name_bytes: std.ArrayList(u8) = .empty;
+    defer file_name_bytes.deinit(gpa);
+    var files: std.AutoArrayHashMapUnmanaged(Zcu.File.Index, void) = .empty;
+    defer files.deinit(gpa);
+    var decls_len: u32 = 0;
+    var decl_data: std.ArrayList(u8) = .empty;
+    defer decl_data.deinit(gpa);
+
+    // Each decl needs at least 38 bytes:
+    // * 2 for 1-byte name plus null terminator
+    // * 4 for `file`
+    // * 4 for `sema_count`
+    // * 4 for `max_air_bytes`
+    // * 8 for `ip_bytes`
+    // * 8 for `air_bytes`
+    // * 8 for `link_bytes`
+    try decl_data.ensureUnusedCapacity(gpa, mr.decls.count() * 38);
+
+    for (mr.decls.keys(), mr.decls.values()) |tracked_inst, decl| {
+        const resolved = tracked_inst.resolveFull(ip) orelse continue;
+        const file = zcu.fileByIndex(resolved.file);
+        const zir = file.zir orelse continue;
+        const decl_name = zir.nullTerminatedString(zir.getDeclaration(resolved.inst).name);
+
+        const gop = try files.getOrPut(gpa, resolved.file);
+        if (!gop.found_existing) try file_name_bytes.print(gpa, "{f}\x00", .{file.path.fmt(comp)});
+
+        decls_len += 1;
+
+        try decl_data.ensureUnusedCapacity(gpa, 37 + decl_name.len);
+        decl_data.appendSliceAssumeCapacity(decl_name);
+        decl_data.appendAssumeCapacity(0);
+
+        std.mem.writeInt(u32, decl_data.addManyAsArrayAssumeCapacity(4), @intCast(gop.index), .little);
+        std.mem.writeInt(u32, decl_data.addManyAsArrayAssumeCapacity(4), decl.sema_count, .little);
+        std.mem.writeInt(u32, decl_data.addManyAsArrayAssumeCapacity(4), decl.max_air_bytes, .little);
+        std.mem.writeInt(u64, decl_data.addManyAsArrayAssumeCapacity(8), decl.ip_bytes, .little);
+        std.mem.writeInt(u64, decl_data.addManyAsArrayAssumeCapacity(8), decl.air_bytes, .little);
+        std.mem.writeInt(u64, decl_data.addManyAsArrayAssumeCapacity(8), decl.link_bytes, .little);
+    }
+
+    const header: std.zig.Server.Message.MemReport = .{
+        .stats = comp.memReportStats(&tag_stats),
+        .files_len = @intCast(files.count()),
+        .tags_len = @intCast(tag_stats.count()),
+        .decls_len = decls_len,
+    };
+
+    var slices: [4][]const u8 = .{
+        @ptrCast(&header),
+        file_name_bytes.items,
+        tag_data.items,
+        decl_data.items,
+    };
+    try s.serveMessageHeader(.{
+        .tag = .mem_report,
+        .bytes_len = len: {
+            var len: u32 = 0;
+            for (slices) |slice| len += @intCast(slice.len);
+            break :len len;
+        },
+    });
+    try s.out.writeVecAll(&slices);
+    try s.out.flush();
+}
+
 fn runOrTest(
     comp: *Compilation,
     gpa: Allocator,
@@ -4532,6 +4681,7 @@ const UpdateModuleError = Compilation.UpdateError || error{
 };
 fn updateModule(comp: *Compilation, color: Color, prog_node: std.Progress.Node) UpdateModuleError!void {
     try comp.update(prog_node);
+    try printMemReport(comp);
 
     var errors = try comp.getAllErrorsAlloc();
     defer errors.deinit(comp.gpa);
@@ -4542,6 +4692,17 @@ fn updateModule(comp: *Compilation, color: Color, prog_node: std.Progress.Node)
     }
 }
 
+fn printMemReport(comp: *Compilation) Allocator.Error!void {
+    if (comp.mem_report == null) return;
+    var buffer: [4096]u8 = undefined;
+    const stderr, _ = std.debug.lockStderrWriter(&buffer);
+    defer std.debug.unlockStderrWriter();
+    comp.writeMemReport(stderr) catch |err| switch (err) {
+        error.OutOfMemory => |e| return e,
+        error.WriteFailed => {},
+    };
+}
+
 fn cmdTranslateC(
     comp: *Compilation,
     arena: Allocator,
@@ -4788,6 +4949,16 @@ test sanitizeExampleName {
     try std.testing.expectEqualStrings("test_project", try sanitizeExampleName(arena, "test project"));
 }
 
+/// Whether the build runner arguments ask to start a build daemon, in which case the build must
+/// not be handed to one which is already running.
+fn startsDaemon(build_runner_args: []const []const u8) bool {
+    for (build_runner_args) |arg| {
+        if (mem.eql(u8, arg, "--")) return false;
+        if (mem.eql(u8, arg, "--daemon")) return true;
+    }
+    return false;
+}
+
 fn cmdBuild(gpa: Allocator, arena: Allocator, io: Io, args: []const []const u8) !void {
     dev.check(.build_command);
 
@@ -5339,6 +5510,23 @@ fn cmdBuild(gpa: Allocator, arena: Allocator, io: Io, args: []const []const u8)
             });
         }
 
+        if (std.Build.Daemon.have_impl and !startsDaemon(child_argv.items)) daemon: {
+            const env_map = try process.getEnvMap(arena);
+            const code = c: {
+                std.debug.lockStdErr();
+                defer std.debug.unlockStdErr();
+                break :c std.Build.Daemon.request(
+                    io,
+                    arena,
+                    child_argv.items[argv_index_cache_dir],
+                    child_argv.items,
+                    &env_map,
+                ) orelse break :daemon;
+            };
+            if (code == 0) return cleanExit();
+            process.exit(code);
+        }
+
         if (process.can_spawn) {
             var child = std.process.Child.init(child_argv.items, gpa);
             child.stdin_behavior = .Inherit;
@@ -7430,6 +7618,13 @@ fn parseImageBase(s: []const u8) u64 {
         fatal("unable to parse image base '{s}': {s}", .{ s, @errorName(err) });
 }
 
+fn parseCShards(s: []const u8) u32 {
+    const count = std.fmt.parseUnsigned(u32, s, 10) catch |err|
+        fatal("unable to parse C shard count '{s}': {s}", .{ s, @errorName(err) });
+    if (count == 0) fatal("C shard count must be at least 1", .{});
+    return count;
+}
+
 fn handleModArg(
     arena: Allocator,
     mod_name: []const u8,
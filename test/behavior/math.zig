@@ -724,6 +724,33 @@ const DivResult = struct {
     remainder: u64,
 };
 
+test "multiplication, division and remainder by powers of two" {
+    if (builtin.zig_backend == .stage2_arm) return error.SkipZigTest; // TODO
+    if (builtin.zig_backend == .stage2_sparc64) return error.SkipZigTest; // TODO
+
+    try testPowerOfTwoArithmetic();
+    try comptime testPowerOfTwoArithmetic();
+}
+fn testPowerOfTwoArithmetic() !void {
+    var a: u32 = 0xdeadbeef;
+    var b: i32 = -0x12345678;
+    var c: u64 = 0x0123456789abcdef;
+    _ = .{ &a, &b, &c };
+    try expect(a *% 16 == 0xeadbeef0);
+    try expect(16 *% a == 0xeadbeef0);
+    try expect(b *% 8 == 0x6e5d4c40);
+    try expect(c * 2 == 0x02468acf13579bde);
+    try expect(c / 1024 == 0x48d159e26af3);
+    try expect(@divFloor(a, 2) == 0x6f56df77);
+    try expect(@divExact(c & ~@as(u64, 0xff), 256) == 0x0123456789abcd);
+    try expect(c % 4096 == 0xdef);
+    try expect(@mod(a, 1) == 0);
+    try expect(a + 0 == 0xdeadbeef);
+    try expect(a - 0 == 0xdeadbeef);
+    try expect(1 * a == 0xdeadbeef);
+    try expect(b * 0 == 0);
+}
+
 test "bit shift a u1" {
     var x: u1 = 1;
     _ = &x;
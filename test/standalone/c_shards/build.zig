@@ -0,0 +1,62 @@
+const std = @import("std");
+
+pub fn build(b: *std.Build) void {
+    const test_step = b.step("test", "Test it");
+    b.default_step = test_step;
+
+    add(b, test_step, .Debug);
+    add(b, test_step, .ReleaseFast);
+}
+
+fn add(b: *std.Build, test_step: *std.Build.Step, optimize: std.builtin.OptimizeMode) void {
+    const shard_count = 4;
+
+    const emit_c = b.addExecutable(.{
+        .name = "main",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("main.zig"),
+            .target = b.resolveTargetQuery(.{ .ofmt = .c }),
+            .optimize = optimize,
+            .link_libc = true,
+        }),
+    });
+    emit_c.c_shards = shard_count;
+
+    // for zig.h
+    const zig_lib_dir: std.Build.LazyPath = .{ .cwd_relative = b.graph.zig_lib_directory.path orelse "." };
+
+    // The complete `main.c` and the shards `main.0.c` through `main.3.c` must each build the same
+    // program.
+    const whole = b.addExecutable(.{
+        .name = "whole",
+        .root_module = b.createModule(.{
+            .target = b.graph.host,
+            .optimize = optimize,
+            .link_libc = true,
+        }),
+    });
+    whole.root_module.addCSourceFile(.{ .file = emit_c.getEmittedBin(), .flags = &.{"-std=c99"} });
+    whole.root_module.addIncludePath(zig_lib_dir);
+
+    const sharded = b.addExecutable(.{
+        .name = "sharded",
+        .root_module = b.createModule(.{
+            .target = b.graph.host,
+            .optimize = optimize,
+            .link_libc = true,
+        }),
+    });
+    for (0..shard_count) |shard| {
+        sharded.root_module.addCSourceFile(.{
+            .file = emit_c.getEmittedBinDirectory().path(b, b.fmt("main.{d}.c", .{shard})),
+            .flags = &.{"-std=c99"},
+        });
+    }
+    sharded.root_module.addIncludePath(zig_lib_dir);
+
+    for ([_]*std.Build.Step.Compile{ whole, sharded }) |exe| {
+        const run = b.addRunArtifact(exe);
+        run.expectExitCode(29);
+        test_step.dependOn(&run.step);
+    }
+}
@@ -0,0 +1,36 @@
+const std = @import("std");
+
+// Spread over several declarations, generic instances and constants, so that the shards define
+// different parts of the program and reference each other's definitions.
+
+var counter: u32 = 0;
+
+fn Pair(comptime T: type) type {
+    return struct {
+        a: T,
+        b: T,
+
+        fn sum(p: @This()) T {
+            counter += 1;
+            return p.a + p.b;
+        }
+    };
+}
+
+const names = [_][]const u8{ "alpha", "beta", "gamma", "delta" };
+
+fn nameLengths() u32 {
+    var total: u32 = 0;
+    for (names) |name| total += @intCast(name.len);
+    return total;
+}
+
+pub fn main() u8 {
+    var values = [_]u32{ 9, 3, 5, 1 };
+    std.mem.sort(u32, &values, {}, std.sort.asc(u32));
+    if (!std.mem.eql(u32, &values, &.{ 1, 3, 5, 9 })) return 1;
+
+    const total = nameLengths() + Pair(u8).sum(.{ .a = 1, .b = 2 }) + Pair(u64).sum(.{ .a = 3, .b = 4 });
+    if (counter != 2) return 2;
+    return @intCast(total);
+}
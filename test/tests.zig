@@ -2211,6 +2211,102 @@ pub fn addCliTests(b: *std.Build) *Step {
         step.dependOn(&cleanup.step);
     }
 
+    {
+        // Test that cached ZIR is reused by later compiler processes, and that processes updating
+        // the cache at the same time after the source changed all see the new ZIR.
+        const tmp_path = b.makeTempPath();
+        const source_path = b.pathJoin(&.{ tmp_path, "zir_cache.zig" });
+        const source_fmt =
+            \\export fn entry() void {{
+            \\    @compileError("{s}");
+            \\}}
+            \\
+        ;
+
+        const write1 = b.addUpdateSourceFiles();
+        write1.addBytesToSource(b.fmt(source_fmt, .{"first version"}), source_path);
+
+        const first_runs: [2]*Step.Run = .{
+            addZirCacheRun(b, tmp_path, "first version"),
+            addZirCacheRun(b, tmp_path, "first version"),
+        };
+        first_runs[0].step.dependOn(&write1.step);
+        first_runs[1].step.dependOn(&first_runs[0].step);
+
+        const write2 = b.addUpdateSourceFiles();
+        write2.addBytesToSource(b.fmt(source_fmt, .{"second version"}), source_path);
+        write2.step.dependOn(&first_runs[1].step);
+
+        const concurrent_runs: [2]*Step.Run = .{
+            addZirCacheRun(b, tmp_path, "second version"),
+            addZirCacheRun(b, tmp_path, "second version"),
+        };
+        const last_run = addZirCacheRun(b, tmp_path, "second version");
+        for (concurrent_runs) |run| {
+            run.step.dependOn(&write2.step);
+            last_run.step.dependOn(&run.step);
+        }
+
+        const cleanup = b.addRemoveDirTree(.{ .cwd_relative = tmp_path });
+        cleanup.step.dependOn(&last_run.step);
+
+        step.dependOn(&cleanup.step);
+    }
+
+    {
+        // Test that a dependency obtained with `lazyDependencyForStep` is not fetched for other
+        // steps, and that selecting its step fetches it and runs the build script again.
+        const tmp_path = b.makeTempPath();
+        const write = b.addUpdateSourceFiles();
+        write.addBytesToSource(
+            \\const std = @import("std");
+            \\
+            \\pub fn build(b: *std.Build) void {
+            \\    const android = b.step("android", "Install a file from the SDK");
+            \\    const sdk = b.lazyDependencyForStep(android, "sdk", .{});
+            \\    if (sdk) |dep| {
+            \\        android.dependOn(&b.addInstallFile(dep.path("hello.txt"), "hello.txt").step);
+            \\    }
+            \\
+            \\    const other = b.step("other", "Do not use the SDK");
+            \\    if (sdk != null) other.dependOn(&b.addFail("the SDK was fetched for the 'other' step").step);
+            \\}
+            \\
+        , b.pathJoin(&.{ tmp_path, "build.zig" }));
+        write.addBytesToSource(
+            \\.{
+            \\    .name = .lazy_step_dep,
+            \\    .version = "0.0.0",
+            \\    .fingerprint = 0x9cdca1795a1e0001,
+            \\    .dependencies = .{
+            \\        .sdk = .{
+            \\            .url = "file:sdk.tar",
+            \\            .hash = "sdk-0.0.0-AQAeWrgAAAAqSnGb9l9GLglAH95Nfsh2Co72tG0PTFmS",
+            \\            .lazy = true,
+            \\        },
+            \\    },
+            \\    .paths = .{""},
+            \\}
+            \\
+        , b.pathJoin(&.{ tmp_path, "build.zig.zon" }));
+        write.addBytesToSource(lazyStepDepSdkTar(b), b.pathJoin(&.{ tmp_path, "sdk.tar" }));
+
+        const run_other = addLazyStepDepRun(b, tmp_path, "other");
+        run_other.step.dependOn(&write.step);
+        const run_android = addLazyStepDepRun(b, tmp_path, "android");
+        run_android.step.dependOn(&run_other.step);
+
+        const check = b.addCheckFile(.{ .cwd_relative = b.pathJoin(&.{ tmp_path, "zig-out", "hello.txt" }) }, .{
+            .expected_exact = "hello from the sdk\n",
+        });
+        check.step.dependOn(&run_android.step);
+
+        const cleanup = b.addRemoveDirTree(.{ .cwd_relative = tmp_path });
+        cleanup.step.dependOn(&check.step);
+
+        step.dependOn(&cleanup.step);
+    }
+
     {
         const run_test = b.addSystemCommand(&.{
             b.graph.zig_exe,
@@ -2234,6 +2330,61 @@ pub fn addCliTests(b: *std.Build) *Step {
     return step;
 }
 
+fn addZirCacheRun(b: *std.Build, tmp_path: []const u8, expected_message: []const u8) *Step.Run {
+    const run = b.addSystemCommand(&.{
+        b.graph.zig_exe,      "build-obj",
+        "--cache-dir",        tmp_path,
+        "--global-cache-dir", tmp_path,
+        "-fno-emit-bin",      "zir_cache.zig",
+    });
+    run.setName(b.fmt("zig build-obj with cached ZIR ({s})", .{expected_message}));
+    run.setCwd(.{ .cwd_relative = tmp_path });
+    run.has_side_effects = true;
+    run.addCheck(.{ .expect_stderr_match = b.fmt("error: {s}", .{expected_message}) });
+    run.expectExitCode(1);
+    return run;
+}
+
+/// Runs `zig build step_name` in the project written by the lazy dependency CLI test, with a global
+/// cache of its own so that the SDK is never already fetched.
+fn addLazyStepDepRun(b: *std.Build, tmp_path: []const u8, step_name: []const u8) *Step.Run {
+    const run = b.addSystemCommand(&.{
+        b.graph.zig_exe,      "build",
+        step_name,            "--cache-dir",
+        ".zig-cache",         "--global-cache-dir",
+        "global-cache",
+    });
+    run.setName(b.fmt("zig build {s} with a step-scoped lazy dependency", .{step_name}));
+    run.setCwd(.{ .cwd_relative = tmp_path });
+    run.has_side_effects = true;
+    run.expectExitCode(0);
+    return run;
+}
+
+/// The SDK package of the lazy dependency CLI test, as a tarball fetched from a `file:` URL.
+fn lazyStepDepSdkTar(b: *std.Build) []const u8 {
+    var aw: std.Io.Writer.Allocating = .init(b.allocator);
+    var tw: std.tar.Writer = .{ .underlying_writer = &aw.writer };
+    tw.setRoot("sdk") catch @panic("OOM");
+    tw.writeFileBytes("build.zig.zon",
+        \\.{
+        \\    .name = .sdk,
+        \\    .version = "0.0.0",
+        \\    .fingerprint = 0x720719685a1e0001,
+        \\    .paths = .{""},
+        \\}
+        \\
+    , .{}) catch @panic("OOM");
+    tw.writeFileBytes("build.zig",
+        \\pub fn build(b: *@import("std").Build) void {
+        \\    _ = b;
+        \\}
+        \\
+    , .{}) catch @panic("OOM");
+    tw.writeFileBytes("hello.txt", "hello from the sdk\n", .{}) catch @panic("OOM");
+    return aw.written();
+}
+
 const ModuleTestOptions = struct {
     test_filters: []const []const u8,
     test_target_filters: []const []const u8,